@@ -4,30 +4,68 @@
 // Date: 2021-04-28
 // By Breno Cunha Queiroz
 //--------------------------------------------------
+#ifndef ATTA_ALGORITHMS_CV_BUNDLE_ADJUSTMENT_H
+#define ATTA_ALGORITHMS_CV_BUNDLE_ADJUSTMENT_H
+
 #include <atta/math/math.h>
 
 namespace atta::cv
 {
+	// Sparse Levenberg-Marquardt bundle adjustment
+	// Camera pose: vec(6) -> [wx, wy, wz, tx, ty, tz] (world to camera, rotation as angle-axis)
+	// Projection: u = focal*Xc.x/Xc.z + principalPoint.x (same for v), Xc = R*X + t
 	class BundleAdjustment
 	{
 		public:
+			struct CreateInfo
+			{
+				float focal = 1.0f;
+				vec2 principalPoint = vec2(0,0);
+				size_t maxIterations = 20;
+				size_t maxPcgIterations = 100;// Conjugate gradient iterations to solve the reduced camera system
+				float pcgTolerance = 1e-6f;// Relative residual to stop the conjugate gradient
+				float initialLambda = 1e-3f;// Levenberg-Marquardt damping
+				size_t qtyThreads = 0;// 0 -> hardware concurrency
+			};
+
 			struct Measurement {
 				size_t imageIndex;
 				size_t point3DIndex;
 				vec2 point;// Image 2D point
 			};
+
+			struct Report {
+				size_t iterations = 0;
+				size_t pcgIterations = 0;// Total conjugate gradient iterations
+				double initialCost = 0;// Half of the squared reprojection error sum
+				double finalCost = 0;
+				double msPerIteration = 0;
+			};
+
 			BundleAdjustment();
+			BundleAdjustment(CreateInfo info);
 
-			void run();
+			// Returns false if a measurement references an image or 3D point that does not exist (nothing is changed)
+			bool run();
 			void clear();
 
+			//---------- Getters ----------//
+			const std::vector<vec>& getCameraPoses() const { return _cameraPoses; }
+			const std::vector<vec3>& get3DPoints() const { return _points3D; }
+			const std::vector<Measurement>& getMeasurements() const { return _measurements; }
+			Report getReport() const { return _report; }
+
 			//---------- Setters ----------//
 			void set3DPoints(std::vector<vec3> points3D) { _points3D = points3D; }
 			void addImage(vec cameraPose, std::vector<std::pair<size_t, vec2>> measurements);
 
-		private: 
+		private:
+			CreateInfo _info;
 			std::vector<vec> _cameraPoses;// Camera pose for each image
 			std::vector<vec3> _points3D;// 3D points being projected to images
 			std::vector<Measurement> _measurements;// 2D points measurements for each image
+			Report _report;
 	};
 }
+
+#endif// ATTA_ALGORITHMS_CV_BUNDLE_ADJUSTMENT_H
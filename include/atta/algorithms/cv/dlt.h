@@ -0,0 +1,54 @@
+//--------------------------------------------------
+// Atta Algorithms - Computer Vision
+// dlt.h
+// Date: 2021-06-07
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_ALGORITHMS_CV_DLT_H
+#define ATTA_ALGORITHMS_CV_DLT_H
+
+#include <atta/math/math.h>
+#include <atta/algorithms/linAlg/SVD/staticSVD.h>
+
+namespace atta::cv
+{
+	// Helpers of the linear solvers (homography and fundamental matrix)
+	// Reference: Multiple View Geometry in Computer Vision - Second Edition - Cap 4.4
+
+	// Transform that moves the centroid of the points of one image to the origin, with an average distance of sqrt(2)
+	// image: 0 -> first point of each pair, 1 -> second point (indices can be nullptr to use the first qty points)
+	bool normalizePoints(const std::pair<vec2i, vec2i>* points, const size_t* indices, size_t qty, size_t image, mat3& T);
+
+	// Least squares solution of Ax=0: x is the smallest eigenvector of A^T*A (accumulated 9x9, does not depend on qty)
+	// rows(p, pp, r) writes the qtyRows rows of A of one normalized point pair
+	template <size_t qtyRows, typename Rows>
+	bool leastSquaresNullVector(const std::pair<vec2i, vec2i>* points, const size_t* indices, size_t qty,
+			const mat3& T1, const mat3& T2, Rows rows, float x[9])
+	{
+		smatd<9,9> AtA;
+		double r[qtyRows][9];
+		for(size_t i=0;i<qty;i++)
+		{
+			const auto& ppair = points[indices ? indices[i] : i];
+			rows(vec2(T1*vec3(ppair.first, 1)), vec2(T2*vec3(ppair.second, 1)), r);
+			for(size_t k=0;k<qtyRows;k++)
+				for(size_t a=0;a<9;a++)
+					for(size_t b=a;b<9;b++)
+						AtA[a][b] += r[k][a]*r[k][b];
+		}
+		for(size_t a=0;a<9;a++)
+			for(size_t b=0;b<a;b++)
+				AtA[a][b] = AtA[b][a];
+
+		linalg::StaticSVD<double,9,9> svd(AtA);
+		if(!svd.converged)
+			return false;
+		double h[9];
+		svd.nullVector(h);
+		for(size_t i=0;i<9;i++)
+			x[i] = h[i];
+		return true;
+	}
+}
+
+#endif// ATTA_ALGORITHMS_CV_DLT_H
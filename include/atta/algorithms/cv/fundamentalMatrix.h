@@ -1,23 +1,47 @@
 //--------------------------------------------------
-// Atta Algorithms - Image Processing
+// Atta Algorithms - Computer Vision
 // fundamentalMatrix.h
 // Date: 2021-04-25
 // By Breno Cunha Queiroz
 //--------------------------------------------------
+#ifndef ATTA_ALGORITHMS_CV_FUNDAMENTAL_MATRIX_H
+#define ATTA_ALGORITHMS_CV_FUNDAMENTAL_MATRIX_H
+
 #include <atta/math/math.h>
+#include <atta/algorithms/cv/ransac.h>
 
-namespace atta::imgproc
+namespace atta::cv
 {
+	// RANSAC estimator (Sampson distance)
+	struct FundamentalMatrixEstimator
+	{
+		using Model = mat3;
+		static constexpr size_t sampleSize = 8;
+		static constexpr float threshold = 3.84f;
+
+		static bool solveMinimal(const std::pair<vec2i, vec2i>* points, const size_t* sample, mat3& F);
+		static bool solveNonMinimal(const std::pair<vec2i, vec2i>* points, const size_t* indices, size_t qty, mat3& F);
+		static void residuals(const mat3& F, const Correspondences& points, size_t begin, size_t end, float* out);
+	};
+
 	class FundamentalMatrix
 	{
 		public:
 			mat3 F;// Fundamental matrix
+			std::vector<size_t> inliers;// Inliers from the last solve8PointsRANSAC
 
 			FundamentalMatrix();
 
-			void solve8Points(std::vector<std::pair<vec2i, vec2i>> points);
-			void solve8PointsRANSAC(std::vector<std::pair<vec2i, vec2i>> points);
+			void solve8Points(const std::vector<std::pair<vec2i, vec2i>>& points);
+			bool solve8PointsRANSAC(const std::vector<std::pair<vec2i, vec2i>>& points, Ransac<FundamentalMatrixEstimator>::CreateInfo info = {});
+
+			// Minimal solver from 8 point pairs (stack only, used inside the RANSAC loop)
+			static bool compute8Points(const std::pair<vec2i, vec2i> points[8], mat3& F);
+			// Least squares solver from qty>=8 point pairs (indices can be nullptr to use the first qty points)
+			static bool compute8Points(const std::pair<vec2i, vec2i>* points, const size_t* indices, size_t qty, mat3& F);
 
 		private: 
 	};
 }
+
+#endif// ATTA_ALGORITHMS_CV_FUNDAMENTAL_MATRIX_H
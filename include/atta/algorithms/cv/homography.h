@@ -1,23 +1,47 @@
 //--------------------------------------------------
-// Atta Algorithms - Image Processing
+// Atta Algorithms - Computer Vision
 // homography.h
 // Date: 2021-04-25
 // By Breno Cunha Queiroz
 //--------------------------------------------------
+#ifndef ATTA_ALGORITHMS_CV_HOMOGRAPHY_H
+#define ATTA_ALGORITHMS_CV_HOMOGRAPHY_H
+
 #include <atta/math/math.h>
+#include <atta/algorithms/cv/ransac.h>
 
-namespace atta::imgproc
+namespace atta::cv
 {
+	// RANSAC estimator (symmetric transfer error)
+	struct HomographyEstimator
+	{
+		using Model = mat3;
+		static constexpr size_t sampleSize = 4;
+		static constexpr float threshold = 5.99f;
+
+		static bool solveMinimal(const std::pair<vec2i, vec2i>* points, const size_t* sample, mat3& H);
+		static bool solveNonMinimal(const std::pair<vec2i, vec2i>* points, const size_t* indices, size_t qty, mat3& H);
+		static void residuals(const mat3& H, const Correspondences& points, size_t begin, size_t end, float* out);
+	};
+
 	class Homography
 	{
 		public:
 			mat3 H;
+			std::vector<size_t> inliers;// Inliers from the last solveRANSAC
 
 			Homography();
 
-			void solveDLT(std::vector<std::pair<vec2i, vec2i>> points);
-			void solveRANSAC(std::vector<std::pair<vec2i, vec2i>> points, size_t width, size_t height);
+			void solveDLT(const std::vector<std::pair<vec2i, vec2i>>& points);
+			bool solveRANSAC(const std::vector<std::pair<vec2i, vec2i>>& points, Ransac<HomographyEstimator>::CreateInfo info = {});
+
+			// Minimal solver from 4 point pairs (stack only, used inside the RANSAC loop)
+			static bool computeDLT(const std::pair<vec2i, vec2i> points[4], mat3& H);
+			// Least squares solver from qty>=4 point pairs (indices can be nullptr to use the first qty points)
+			static bool computeDLT(const std::pair<vec2i, vec2i>* points, const size_t* indices, size_t qty, mat3& H);
 
 		private: 
 	};
 }
+
+#endif// ATTA_ALGORITHMS_CV_HOMOGRAPHY_H
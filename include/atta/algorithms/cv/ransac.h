@@ -0,0 +1,387 @@
+//--------------------------------------------------
+// Atta Algorithms - Computer Vision
+// ransac.h
+// Date: 2021-06-07
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_ALGORITHMS_CV_RANSAC_H
+#define ATTA_ALGORITHMS_CV_RANSAC_H
+
+#include <atta/math/math.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace atta::cv
+{
+	// Point correspondences stored as structure of arrays (contiguous coordinates for vectorized scoring)
+	struct Correspondences
+	{
+		std::vector<float, alignedAllocator<float>> x1, y1;// First image
+		std::vector<float, alignedAllocator<float>> x2, y2;// Second image
+
+		size_t size() const { return x1.size(); }
+		void set(const std::vector<std::pair<vec2i, vec2i>>& points)
+		{
+			x1.resize(points.size());
+			y1.resize(points.size());
+			x2.resize(points.size());
+			y2.resize(points.size());
+			for(size_t i=0; i<points.size(); i++)
+			{
+				x1[i] = points[i].first.x;
+				y1[i] = points[i].first.y;
+				x2[i] = points[i].second.x;
+				y2[i] = points[i].second.y;
+			}
+		}
+	};
+
+	// Generic RANSAC
+	// The Estimator defines the problem:
+	// 	using Model = ...;
+	// 	static constexpr size_t sampleSize;
+	// 	static constexpr float threshold;// Default squared residual threshold
+	// 	static bool solveMinimal(const std::pair<vec2i, vec2i>* points, const size_t* sample, Model& model);
+	// 	static bool solveNonMinimal(const std::pair<vec2i, vec2i>* points, const size_t* indices, size_t qty, Model& model);
+	// 	static void residuals(const Model& model, const Correspondences& points, size_t begin, size_t end, float* out);// Squared errors
+	//
+	// References:
+	// 	Chum and Matas - Matching with PROSAC - Progressive Sample Consensus (2005)
+	// 	Chum, Matas and Kittler - Locally Optimized RANSAC (2003)
+	// 	Matas and Chum - Randomized RANSAC with Sequential Probability Ratio Test (2005)
+	template <typename Estimator>
+	class Ransac
+	{
+		public:
+			using Model = typename Estimator::Model;
+			static constexpr size_t sampleSize = Estimator::sampleSize;
+
+			struct CreateInfo
+			{
+				float threshold = Estimator::threshold;// Squared residual to be considered inlier
+				float confidence = 0.99f;// Probability to choose at least one sample without outliers
+				size_t minIterations = 10;
+				size_t maxIterations = 10000;
+				size_t qtyThreads = 0;// 0 -> hardware concurrency
+				uint32_t seed = 0;
+				bool prosac = false;// Points are sorted by quality (best first)
+				bool localOptimization = true;// LO-RANSAC when a new best model is found
+				bool refine = true;// Refine final model with all inliers
+				bool sprt = true;// Early rejection of bad models
+				float sprtDelta = 0.05f;// Probability of a point being consistent with a bad model
+				float sprtInitialEpsilon = 0.2f;// Initial inlier ratio estimation
+				float sprtModelCost = 200.0f;// Model estimation time in units of residual evaluation
+			};
+
+			Ransac(CreateInfo info);
+
+			bool run(const std::vector<std::pair<vec2i, vec2i>>& points, Model& model);
+
+			//---------- Getters ----------//
+			const std::vector<size_t>& getInliers() const { return _inliers; }
+			size_t getQtyIterations() const { return _qtyIterations; }
+			size_t getQtyRejected() const { return _qtyRejected; }
+
+		private:
+			static constexpr size_t BLOCK_SIZE = 64;// Points scored between SPRT checks
+
+			size_t numIterations(size_t qtyInliers, size_t qtyPoints) const;
+			void prosacSchedule(size_t qtyPoints);
+			void drawSample(size_t iteration, size_t qtyPoints, std::mt19937& rng, size_t* sample) const;
+			size_t score(const Model& model, float* residuals, size_t bestInliers, double logA, double logInlier, double logOutlier, bool& rejected) const;
+			size_t collectInliers(const Model& model, float* residuals, std::vector<size_t>& inliers) const;
+			size_t localOptimization(const std::pair<vec2i, vec2i>* points, Model& model, size_t qtyInliers, float* residuals, std::vector<size_t>& inliers) const;
+			static double sprtThreshold(double epsilon, double delta, double modelCost);
+
+			CreateInfo _info;
+			Correspondences _points;
+			std::vector<size_t> _prosacT;// PROSAC iteration where the sampling set grows to n+1 points
+			std::vector<size_t> _inliers;
+			size_t _qtyIterations;
+			size_t _qtyRejected;
+	};
+
+	template <typename Estimator>
+	Ransac<Estimator>::Ransac(CreateInfo info):
+		_info(info), _qtyIterations(0), _qtyRejected(0)
+	{
+	}
+
+	template <typename Estimator>
+	bool Ransac<Estimator>::run(const std::vector<std::pair<vec2i, vec2i>>& points, Model& model)
+	{
+		const size_t qtyPoints = points.size();
+		_inliers.clear();
+		_qtyIterations = 0;
+		_qtyRejected = 0;
+		if(qtyPoints < sampleSize)
+			return false;
+
+		_points.set(points);
+		if(_info.prosac)
+			prosacSchedule(qtyPoints);
+
+		size_t qtyThreads = _info.qtyThreads ? _info.qtyThreads : std::thread::hardware_concurrency();
+		qtyThreads = std::max<size_t>(qtyThreads, 1);
+
+		// Shared state
+		std::atomic<size_t> nextIteration(0);
+		std::atomic<size_t> maxIterations(_info.maxIterations);
+		std::atomic<size_t> bestInliers(0);
+		std::atomic<size_t> qtyRejected(0);
+		std::atomic<float> epsilon(_info.sprtInitialEpsilon);
+		std::mutex bestMutex;
+		Model bestModel{};
+
+		auto worker = [&](size_t threadIndex)
+		{
+			// Per thread state (allocated once)
+			std::mt19937 rng(_info.seed + 7919*threadIndex);
+			std::vector<float> residuals(std::max(qtyPoints, BLOCK_SIZE));
+			std::vector<size_t> inliers;
+			size_t sample[sampleSize];
+
+			float currEpsilon = -1;
+			double logA = 0, logInlier = 0, logOutlier = 0;
+			while(true)
+			{
+				const size_t it = nextIteration++;
+				if(it >= std::max(maxIterations.load(), _info.minIterations) || it >= _info.maxIterations)
+					break;
+
+				// Update SPRT decision threshold when the inlier ratio estimation changes
+				if(_info.sprt && currEpsilon != epsilon.load())
+				{
+					currEpsilon = epsilon.load();
+					const double delta = _info.sprtDelta;
+					logInlier = std::log(delta/currEpsilon);
+					logOutlier = std::log((1-delta)/(1-currEpsilon));
+					logA = sprtThreshold(currEpsilon, delta, _info.sprtModelCost);
+				}
+
+				//---------- Hypothesis ----------//
+				drawSample(it, qtyPoints, rng, sample);
+				Model hypothesis{};
+				if(!Estimator::solveMinimal(points.data(), sample, hypothesis))
+					continue;
+
+				//---------- Verification ----------//
+				bool rejected = false;
+				const bool useSprt = _info.sprt && currEpsilon > _info.sprtDelta;
+				size_t qtyInliers = score(hypothesis, residuals.data(), bestInliers.load(),
+						useSprt ? logA : INFINITY, logInlier, logOutlier, rejected);
+				if(rejected)
+				{
+					qtyRejected++;
+					continue;
+				}
+				if(qtyInliers <= bestInliers.load())
+					continue;
+
+				//---------- So far the best ----------//
+				if(_info.localOptimization)
+					qtyInliers = localOptimization(points.data(), hypothesis, qtyInliers, residuals.data(), inliers);
+
+				std::lock_guard<std::mutex> lock(bestMutex);
+				if(qtyInliers > bestInliers.load())
+				{
+					bestModel = hypothesis;
+					bestInliers = qtyInliers;
+					maxIterations = std::min(maxIterations.load(), numIterations(qtyInliers, qtyPoints));
+					epsilon = std::min(std::max(float(qtyInliers)/qtyPoints, epsilon.load()), 0.99f);
+				}
+			}
+		};
+
+		if(qtyThreads == 1)
+			worker(0);
+		else
+		{
+			std::vector<std::thread> threads;
+			for(size_t i=0; i<qtyThreads; i++)
+				threads.emplace_back(worker, i);
+			for(auto& thread : threads)
+				thread.join();
+		}
+
+		_qtyIterations = std::min(nextIteration.load(), _info.maxIterations);
+		_qtyRejected = qtyRejected;
+		if(bestInliers.load() < sampleSize)
+			return false;
+
+		//---------- Refine with all inliers ----------//
+		std::vector<float> residuals(qtyPoints);
+		collectInliers(bestModel, residuals.data(), _inliers);
+		if(_info.refine)
+		{
+			Model refined = bestModel;
+			std::vector<size_t> refinedInliers;
+			if(Estimator::solveNonMinimal(points.data(), _inliers.data(), _inliers.size(), refined) &&
+				collectInliers(refined, residuals.data(), refinedInliers) >= _inliers.size())
+			{
+				bestModel = refined;
+				_inliers = std::move(refinedInliers);
+			}
+		}
+
+		model = bestModel;
+		return true;
+	}
+
+	template <typename Estimator>
+	size_t Ransac<Estimator>::numIterations(size_t qtyInliers, size_t qtyPoints) const
+	{
+		// N = log(1-p)/log(1-w^s)
+		const double w = double(qtyInliers)/qtyPoints;
+		const double ws = std::pow(w, double(sampleSize));
+		if(ws >= 1.0)
+			return _info.minIterations;
+		if(ws <= std::numeric_limits<double>::epsilon())
+			return _info.maxIterations;
+		const double N = std::ceil(std::log(1.0-_info.confidence)/std::log(1.0-ws));
+		if(N >= _info.maxIterations)
+			return _info.maxIterations;
+		return std::max<size_t>(size_t(N), _info.minIterations);
+	}
+
+	template <typename Estimator>
+	void Ransac<Estimator>::prosacSchedule(size_t qtyPoints)
+	{
+		// T'_n: number of samples drawn before using the (n+1)th best point
+		_prosacT.assign(qtyPoints+1, _info.maxIterations);
+		double Tn = _info.maxIterations;
+		for(size_t i=0; i<sampleSize; i++)
+			Tn *= double(sampleSize-i)/double(qtyPoints-i);
+		size_t TnPrime = 1;
+		_prosacT[sampleSize] = TnPrime;
+		for(size_t n=sampleSize; n<qtyPoints; n++)
+		{
+			const double TnNext = Tn*double(n+1)/double(n+1-sampleSize);
+			TnPrime += size_t(std::ceil(TnNext-Tn));
+			_prosacT[n+1] = TnPrime;
+			Tn = TnNext;
+		}
+	}
+
+	template <typename Estimator>
+	void Ransac<Estimator>::drawSample(size_t iteration, size_t qtyPoints, std::mt19937& rng, size_t* sample) const
+	{
+		size_t n = qtyPoints;// Sampling set size
+		size_t start = 0;
+		if(_info.prosac)
+		{
+			// Smallest sampling set that is already allowed in this iteration, its last point is always sampled
+			n = std::upper_bound(_prosacT.begin()+sampleSize, _prosacT.end(), iteration+1) - _prosacT.begin() - 1;
+			n = std::clamp(n, sampleSize, qtyPoints);
+			if(n < qtyPoints)
+			{
+				sample[0] = n-1;
+				start = 1;
+				n--;
+			}
+		}
+
+		std::uniform_int_distribution<size_t> dist(0, n-1);
+		for(size_t s=start; s<sampleSize; s++)
+		{
+			bool repeated;
+			do
+			{
+				sample[s] = dist(rng);
+				repeated = false;
+				for(size_t j=0; j<s; j++)
+					repeated |= sample[j]==sample[s];
+			}
+			while(repeated);
+		}
+	}
+
+	template <typename Estimator>
+	size_t Ransac<Estimator>::score(const Model& model, float* residuals, size_t bestInliers, double logA, double logInlier, double logOutlier, bool& rejected) const
+	{
+		const size_t qtyPoints = _points.size();
+		const float threshold = _info.threshold;
+		size_t qtyInliers = 0;
+		double logLambda = 0;
+		rejected = false;
+		for(size_t begin=0; begin<qtyPoints; begin+=BLOCK_SIZE)
+		{
+			const size_t end = std::min(begin+BLOCK_SIZE, qtyPoints);
+			Estimator::residuals(model, _points, begin, end, residuals);
+
+			size_t blockInliers = 0;
+			for(size_t i=0; i<end-begin; i++)
+				blockInliers += residuals[i] <= threshold;
+			qtyInliers += blockInliers;
+
+			// Can't be better than the best model anymore
+			if(qtyInliers + (qtyPoints-end) <= bestInliers)
+			{
+				rejected = true;
+				return qtyInliers;
+			}
+
+			// SPRT (likelihood ratio between bad and good model)
+			logLambda += blockInliers*logInlier + (end-begin-blockInliers)*logOutlier;
+			if(logLambda > logA)
+			{
+				rejected = true;
+				return qtyInliers;
+			}
+		}
+		return qtyInliers;
+	}
+
+	template <typename Estimator>
+	size_t Ransac<Estimator>::collectInliers(const Model& model, float* residuals, std::vector<size_t>& inliers) const
+	{
+		inliers.clear();
+		Estimator::residuals(model, _points, 0, _points.size(), residuals);
+		for(size_t i=0; i<_points.size(); i++)
+			if(residuals[i] <= _info.threshold)
+				inliers.push_back(i);
+		return inliers.size();
+	}
+
+	template <typename Estimator>
+	size_t Ransac<Estimator>::localOptimization(const std::pair<vec2i, vec2i>* points, Model& model, size_t qtyInliers, float* residuals, std::vector<size_t>& inliers) const
+	{
+		// Iterative least squares from the inliers (stops when the consensus does not grow)
+		collectInliers(model, residuals, inliers);
+		for(size_t it=0; it<4; it++)
+		{
+			Model optimized = model;
+			if(!Estimator::solveNonMinimal(points, inliers.data(), inliers.size(), optimized))
+				break;
+			Estimator::residuals(optimized, _points, 0, _points.size(), residuals);
+			size_t optimizedInliers = 0;
+			for(size_t i=0; i<_points.size(); i++)
+				optimizedInliers += residuals[i] <= _info.threshold;
+			if(optimizedInliers <= qtyInliers)
+				break;
+			model = optimized;
+			qtyInliers = collectInliers(model, residuals, inliers);
+		}
+		return qtyInliers;
+	}
+
+	template <typename Estimator>
+	double Ransac<Estimator>::sprtThreshold(double epsilon, double delta, double modelCost)
+	{
+		// A = K + 1 + log(A), K = modelCost*C (one model per sample)
+		const double C = (1-delta)*std::log((1-delta)/(1-epsilon)) + delta*std::log(delta/epsilon);
+		const double K = modelCost*C + 1;
+		double A = K;
+		for(size_t i=0; i<10; i++)
+			A = K + std::log(A);
+		return std::log(A);
+	}
+}
+
+#endif// ATTA_ALGORITHMS_CV_RANSAC_H
@@ -0,0 +1,111 @@
+//--------------------------------------------------
+// Atta Algorithms - Image Processing
+// featureMatcher.h
+// Date: 2021-07-05
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_ALGORITHMS_IMGPROC_FEATURE_MATCHER_H
+#define ATTA_ALGORITHMS_IMGPROC_FEATURE_MATCHER_H
+
+#include <atta/algorithms/imgProc/orb.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace atta::imgproc
+{
+	// Number of different bits between two descriptors
+	inline int hammingDistance(const Descriptor& a, const Descriptor& b)
+	{
+#if defined(__AVX2__)
+		// Nibble lookup popcount (Mula et al. - Faster population counts using AVX2 instructions)
+		const __m256i lut = _mm256_setr_epi8(
+				0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4,
+				0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+		const __m256i lowMask = _mm256_set1_epi8(0x0f);
+		const __m256i x = _mm256_xor_si256(
+				_mm256_load_si256(reinterpret_cast<const __m256i*>(a.bits)),
+				_mm256_load_si256(reinterpret_cast<const __m256i*>(b.bits)));
+		const __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(x, lowMask));
+		const __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(x, 4), lowMask));
+		const __m256i sum = _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+		const __m128i sum128 = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+		return _mm_cvtsi128_si32(sum128) + _mm_extract_epi32(sum128, 2);
+#else
+		return __builtin_popcountll(a.bits[0]^b.bits[0]) + __builtin_popcountll(a.bits[1]^b.bits[1]) +
+			__builtin_popcountll(a.bits[2]^b.bits[2]) + __builtin_popcountll(a.bits[3]^b.bits[3]);
+#endif
+	}
+
+	// Binary descriptor matching
+	// The correspondences are generated in the format used by Homography and FundamentalMatrix
+	class FeatureMatcher
+	{
+		public:
+			struct CreateInfo
+			{
+				int maxDistance = 64;// Maximum hamming distance (out of 256 bits)
+				float ratio = 0.8f;// Best must be smaller than ratio*secondBest (1 -> disabled)
+				bool crossCheck = true;// Keep only mutual best matches
+				int searchRadius = 64;// Grid matcher search window (pixels)
+				size_t qtyThreads = 0;// 0 -> hardware concurrency
+			};
+
+			struct Match
+			{
+				size_t index1;
+				size_t index2;
+				int distance;
+			};
+
+			FeatureMatcher();
+			FeatureMatcher(CreateInfo info);
+
+			// Compare each descriptor with all descriptors of the other image
+			void matchBruteForce(
+					const std::vector<Keypoint>& keypoints1, const std::vector<Descriptor>& descriptors1,
+					const std::vector<Keypoint>& keypoints2, const std::vector<Descriptor>& descriptors2,
+					std::vector<std::pair<vec2i, vec2i>>& correspondences);
+
+			// Compare only with keypoints closer than searchRadius (small motion between frames)
+			void matchGrid(
+					const std::vector<Keypoint>& keypoints1, const std::vector<Descriptor>& descriptors1,
+					const std::vector<Keypoint>& keypoints2, const std::vector<Descriptor>& descriptors2,
+					std::vector<std::pair<vec2i, vec2i>>& correspondences);
+
+			//---------- Getters ----------//
+			// Matches of the last call (same order as the correspondences)
+			const std::vector<Match>& getMatches() const { return _matches; }
+
+		private:
+			struct Grid
+			{
+				int cellSize;
+				int cols, rows;
+				int minX, minY;
+				std::vector<size_t> cellStart;// Cell -> first index in items
+				std::vector<size_t> items;// Keypoint indices sorted by cell
+			};
+
+			// Best match for each query descriptor (-1 if rejected)
+			// With a grid, only train keypoints inside the search radius are compared
+			void bestMatches(const std::vector<Descriptor>& query, const std::vector<Descriptor>& train,
+					const std::vector<Keypoint>* queryKeypoints, const std::vector<Keypoint>* trainKeypoints,
+					const Grid* trainGrid, std::vector<int>& best) const;
+			void buildGrid(const std::vector<Keypoint>& keypoints, Grid& grid) const;
+			void collect(const std::vector<Keypoint>& keypoints1, const std::vector<Descriptor>& descriptors1,
+					const std::vector<Keypoint>& keypoints2, const std::vector<Descriptor>& descriptors2,
+					std::vector<std::pair<vec2i, vec2i>>& correspondences);
+
+			size_t getQtyThreads() const;
+
+			CreateInfo _info;
+			std::vector<Match> _matches;
+			std::vector<int> _best12;
+			std::vector<int> _best21;
+			Grid _grid1;
+			Grid _grid2;
+	};
+}
+
+#endif// ATTA_ALGORITHMS_IMGPROC_FEATURE_MATCHER_H
@@ -0,0 +1,88 @@
+//--------------------------------------------------
+// Atta Algorithms - Image Processing
+// orb.h
+// Date: 2021-07-05
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_ALGORITHMS_IMGPROC_ORB_H
+#define ATTA_ALGORITHMS_IMGPROC_ORB_H
+
+#include <atta/math/math.h>
+#include <cstdint>
+#include <vector>
+
+namespace atta::imgproc
+{
+	struct Keypoint
+	{
+		vec2i point;
+		float score;// FAST corner score
+		float angle;// Orientation by intensity centroid (radians)
+	};
+
+	// 256 bit binary descriptor
+	struct alignas(32) Descriptor
+	{
+		uint64_t bits[4];
+	};
+
+	// FAST-9 corner detector + oriented BRIEF descriptor
+	// Reference: Rublee et al. - ORB: an efficient alternative to SIFT or SURF (2011)
+	// Reference: Rosten and Drummond - Machine learning for high-speed corner detection (2006)
+	//
+	// The image is split in tiles processed in parallel, each tile keeps at most a share of
+	// maxFeatures so the features are spread over the whole image. Internal buffers are reused
+	// between calls with the same resolution (no allocation per frame)
+	class ORB
+	{
+		public:
+			struct CreateInfo
+			{
+				int fastThreshold = 20;// Minimum intensity difference to the circle pixels
+				size_t maxFeatures = 1000;
+				unsigned tileSize = 64;// Tile side in pixels
+				size_t qtyThreads = 0;// 0 -> hardware concurrency
+			};
+
+			ORB();
+			ORB(CreateInfo info);
+
+			// image: row-major, 1 (gray), 3 (RGB) or 4 (RGBA) channels
+			void detectAndCompute(const uint8_t* image, unsigned width, unsigned height, unsigned channels,
+					std::vector<Keypoint>& keypoints, std::vector<Descriptor>& descriptors);
+			void detectAndCompute(const std::vector<uint8_t>& image, unsigned width, unsigned height, unsigned channels,
+					std::vector<Keypoint>& keypoints, std::vector<Descriptor>& descriptors)
+			{
+				detectAndCompute(image.data(), width, height, channels, keypoints, descriptors);
+			}
+
+			//---------- Getters ----------//
+			const std::vector<uint8_t>& getGrayImage() const { return _gray; }
+
+		private:
+			static constexpr int patchRadius = 15;// Orientation/descriptor patch radius
+			static constexpr int border = patchRadius+3;// Keypoints closer to the border are discarded
+			static constexpr size_t qtyAngles = 30;// Steered pattern discretization (12 degrees)
+
+			void createPattern();
+			void toGray(const uint8_t* image, unsigned channels);
+			void computeIntegral();
+			void detectTile(unsigned tile, size_t maxPerTile, std::vector<Keypoint>& out) const;
+			float orientation(int x, int y) const;
+			void describe(const Keypoint& keypoint, Descriptor& descriptor) const;
+			int boxSum(int x, int y) const;
+
+			size_t getQtyThreads() const;
+
+			CreateInfo _info;
+			unsigned _width;
+			unsigned _height;
+			std::vector<uint8_t> _gray;
+			std::vector<uint32_t> _integral;// (width+1)*(height+1)
+			std::vector<std::vector<Keypoint>> _tileKeypoints;
+			std::vector<int8_t> _pattern[qtyAngles];// 256 tests * (x1,y1,x2,y2) for each angle
+			int _umax[patchRadius+1];// Circular patch half width for each row
+	};
+}
+
+#endif// ATTA_ALGORITHMS_IMGPROC_ORB_H
@@ -4,6 +4,9 @@
 // Date: 2021-04-19
 // By Breno Cunha Queiroz
 //--------------------------------------------------
+#ifndef ATTA_ALGORITHMS_LINALG_LU_H
+#define ATTA_ALGORITHMS_LINALG_LU_H
+
 #include <atta/math/math.h>
 
 namespace atta::linalg
@@ -20,3 +23,5 @@ namespace atta::linalg
 			LU(mat& A);
 	};
 }
+
+#endif// ATTA_ALGORITHMS_LINALG_LU_H
@@ -0,0 +1,125 @@
+//--------------------------------------------------
+// Atta Algorithms - Linear Algebra
+// staticLU.h
+// Date: 2021-06-04
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_ALGORITHMS_LINALG_STATIC_LU_H
+#define ATTA_ALGORITHMS_LINALG_STATIC_LU_H
+
+#include <atta/math/smatrix.h>
+#include <cmath>
+
+namespace atta::linalg
+{
+	// Same decomposition as LU, but with compile time dimensions and no heap allocation
+	template <typename T, size_t N>
+	class StaticLU
+	{
+		public:
+			smatrix<T,N,N> lu;
+			size_t indx[N];
+			T d;// If number of row interchanges are even(1) or odd(-1) (used to determine the determinant sign)
+			bool sing;// Indicates wheter A is singular
+
+			StaticLU(const smatrix<T,N,N>& A);
+
+			// Solve Ax = b (b and x can be the same array)
+			void solve(const T b[N], T x[N]) const;
+			T det() const;
+	};
+
+	template <typename T, size_t N>
+	StaticLU<T,N>::StaticLU(const smatrix<T,N,N>& A):
+		lu(A), d(T(1)), sing(false)
+	{
+		// Reference: Numerical Recipes: The Art of Scientific Computing - Third Edition - Cap 2.3
+		const T TINY = T(1.0e-10);
+		T rs[N];// Implicit scaling of each row
+		T big, temp;
+		size_t imax = 0;
+
+		// Find implicit scaling of each row
+		for(size_t r=0;r<N;r++)
+		{
+			big = T(0);
+			for(size_t c=0;c<N;c++)
+				if((temp=std::abs(lu[r][c]))>big) big=temp;
+			if(big == T(0))
+			{
+				sing = true;
+				return;
+			}
+			rs[r] = T(1)/big;
+		}
+
+		// kij loop
+		for(size_t k=0;k<N;k++)
+		{
+			big = T(0);
+			imax = k;
+			// Find largest pivot inside column k
+			for(size_t r=k;r<N;r++)
+			{
+				temp = rs[r]*std::abs(lu[r][k]);
+				if(temp>big)
+				{
+					big = temp;
+					imax = r;
+				}
+			}
+
+			// Interchange rows if necessary (moving pivot to diagonal)
+			if(k!=imax)
+			{
+				lu.swapRows(imax, k);
+				d = -d;// Change parity
+				rs[imax] = rs[k];// Change implicit scale factor for row imax
+			}
+			indx[k] = imax;
+
+			if(lu[k][k]==T(0)) lu[k][k]=TINY;
+
+			// For each row > k (lower triangular)
+			for(size_t i=k+1;i<N;i++)
+			{
+				temp = (lu[i][k]/=lu[k][k]);// Divide by pivot element (lower triangular)
+				for(size_t j=k+1;j<N;j++)
+					lu[i][j] -= temp*lu[k][j];
+			}
+		}
+	}
+
+	template <typename T, size_t N>
+	void StaticLU<T,N>::solve(const T b[N], T x[N]) const
+	{
+		// Forward substitution (unscrambling the permutation)
+		T y[N];
+		for(size_t i=0;i<N;i++) y[i] = b[i];
+		for(size_t i=0;i<N;i++)
+		{
+			std::swap(y[i], y[indx[i]]);
+			T sum = y[i];
+			for(size_t j=0;j<i;j++) sum -= lu[i][j]*y[j];
+			y[i] = sum;
+		}
+		// Backsubstitution
+		for(int i=N-1;i>=0;i--)
+		{
+			T sum = y[i];
+			for(size_t j=i+1;j<N;j++) sum -= lu[i][j]*y[j];
+			y[i] = sum/lu[i][i];
+		}
+		for(size_t i=0;i<N;i++) x[i] = y[i];
+	}
+
+	template <typename T, size_t N>
+	T StaticLU<T,N>::det() const
+	{
+		T dd = d;
+		for(size_t i=0;i<N;i++) dd *= lu[i][i];
+		return dd;
+	}
+}
+
+#endif// ATTA_ALGORITHMS_LINALG_STATIC_LU_H
@@ -4,6 +4,9 @@
 // Date: 2021-04-23
 // By Breno Cunha Queiroz
 //--------------------------------------------------
+#ifndef ATTA_ALGORITHMS_LINALG_QR_H
+#define ATTA_ALGORITHMS_LINALG_QR_H
+
 #include <atta/math/math.h>
 
 namespace atta::linalg
@@ -25,3 +28,5 @@ namespace atta::linalg
 			//void rotate(const int i, const float a, const float b);
 	};
 }
+
+#endif// ATTA_ALGORITHMS_LINALG_QR_H
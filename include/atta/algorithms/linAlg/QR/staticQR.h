@@ -0,0 +1,113 @@
+//--------------------------------------------------
+// Atta Algorithms - Linear Algebra
+// staticQR.h
+// Date: 2021-06-04
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_ALGORITHMS_LINALG_STATIC_QR_H
+#define ATTA_ALGORITHMS_LINALG_STATIC_QR_H
+
+#include <atta/math/smatrix.h>
+#include <cmath>
+
+namespace atta::linalg
+{
+	// Same decomposition as QR, but with compile time dimensions and no heap allocation
+	template <typename T, size_t M, size_t N>
+	class StaticQR
+	{
+		public:
+			smatrix<T,M,M> Qt;// Matrix Q^T
+			smatrix<T,M,N> R;
+			bool sing;// Indicates wheter A is singular
+
+			StaticQR(const smatrix<T,M,N>& A);
+
+			// Solve Ax = b (least squares if M>N)
+			void solve(const T b[M], T x[N]) const;
+
+		private:
+			static T SIGN(const T a, const T b) { return b >= 0 ? (a >= 0 ? a : -a) : (a >= 0 ? -a : a); }
+	};
+
+	template <typename T, size_t M, size_t N>
+	StaticQR<T,M,N>::StaticQR(const smatrix<T,M,N>& A):
+		R(A), sing(false)
+	{
+		// Reference: Numerical Recipes: The Art of Scientific Computing - Third Edition - Cap 2.10
+		T c[N];
+		T d[N];
+		//---------- Holseholder reflections ----------//
+		for(size_t k=0;k<N;k++)
+		{
+			T scale = T(0);
+			for(size_t i=k;i<M;i++) scale = std::max(scale, std::abs(R[i][k]));
+			if(scale == T(0))
+			{
+				sing = true;
+				c[k] = d[k] = T(0);
+			}
+			else
+			{
+				for(size_t i=k;i<M;i++) R[i][k] /= scale;
+				T sum = T(0);
+				for(size_t i=k;i<M;i++) sum += R[i][k]*R[i][k];
+				T beta = SIGN(std::sqrt(sum), R[k][k]);
+				R[k][k] += beta;
+				c[k] = beta*R[k][k];
+				d[k] = beta*(-scale);
+				for(size_t j=k+1;j<N;j++)
+				{
+					sum = T(0);
+					for(size_t i=k;i<M;i++) sum += R[i][k]*R[i][j];
+					T tau = sum/c[k];
+					for(size_t i=k;i<M;i++) R[i][j] -= tau*R[i][k];
+				}
+			}
+		}
+		//---------- Form Q^T explicitly ----------//
+		if(d[N-1]==T(0)) sing = true;
+		Qt.setIdentity();
+		for(size_t k=0;k<N;k++)
+		{
+			if(c[k]!=T(0))
+			{
+				for(size_t j=0;j<M;j++)
+				{
+					T sum = T(0);
+					for(size_t i=k;i<M;i++) sum += R[i][k]*Qt[i][j];
+					sum /= c[k];
+					for(size_t i=k;i<M;i++) Qt[i][j] -= sum*R[i][k];
+				}
+			}
+		}
+		//---------- Form R explicitly ----------//
+		for(size_t i=0;i<N;i++)
+		{
+			R[i][i] = d[i];
+			for(size_t j=0;j<i;j++) R[i][j] = T(0);
+			for(size_t j=i+1;j<M;j++) R[j][i] = T(0);
+		}
+	}
+
+	template <typename T, size_t M, size_t N>
+	void StaticQR<T,M,N>::solve(const T b[M], T x[N]) const
+	{
+		// y = Q^Tb
+		T y[N];
+		for(size_t i=0;i<N;i++)
+		{
+			y[i] = T(0);
+			for(size_t j=0;j<M;j++) y[i] += Qt[i][j]*b[j];
+		}
+		// Solve Rx = y
+		for(int i=N-1;i>=0;i--)
+		{
+			T sum = y[i];
+			for(size_t j=i+1;j<N;j++) sum -= R[i][j]*x[j];
+			x[i] = sum/R[i][i];
+		}
+	}
+}
+
+#endif// ATTA_ALGORITHMS_LINALG_STATIC_QR_H
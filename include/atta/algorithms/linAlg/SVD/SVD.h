@@ -4,6 +4,9 @@
 // Date: 2021-04-19
 // By Breno Cunha Queiroz
 //--------------------------------------------------
+#ifndef ATTA_ALGORITHMS_LINALG_SVD_H
+#define ATTA_ALGORITHMS_LINALG_SVD_H
+
 #include <atta/math/math.h>
 
 namespace atta::linalg
@@ -16,7 +19,7 @@ namespace atta::linalg
 			vec S;// Sigma/Diagonal matrix (eigenvalues)
 			float eps, tsh;
 
-			SVD(mat& A);
+			SVD(const mat& A);
 
 			unsigned rank(float thresh=-1.0f);
 			unsigned nullity(float thresh=-1.0f);
@@ -29,3 +32,5 @@ namespace atta::linalg
 			double pythag(const double a, const double b);
 	};
 }
+
+#endif// ATTA_ALGORITHMS_LINALG_SVD_H
@@ -0,0 +1,345 @@
+//--------------------------------------------------
+// Atta Algorithms - Linear Algebra
+// staticSVD.h
+// Date: 2021-06-04
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_ALGORITHMS_LINALG_STATIC_SVD_H
+#define ATTA_ALGORITHMS_LINALG_STATIC_SVD_H
+
+#include <atta/math/smatrix.h>
+#include <cmath>
+#include <limits>
+
+namespace atta::linalg
+{
+	// Same decomposition as SVD, but with compile time dimensions and no heap allocation
+	// Used in the minimal solvers (RANSAC inner loops)
+	template <typename T, size_t M, size_t N>
+	class StaticSVD
+	{
+		public:
+			smatrix<T,M,N> U;
+			smatrix<T,N,N> V;
+			T S[N];// Singular values (decreasing order)
+			T eps, tsh;
+			bool converged;
+
+			StaticSVD(const smatrix<T,M,N>& A):
+				U(A), converged(true)
+			{
+				eps = std::numeric_limits<T>::epsilon();
+				decompose();
+				reorder();
+				tsh = T(0.5)*std::sqrt(T(M+N+1))*S[0]*eps;
+			}
+
+			// Right singular vector associated with the smallest singular value (solution of Ax~=0)
+			void nullVector(T x[N]) const
+			{
+				for(size_t i=0; i<N; i++)
+					x[i] = V[i][N-1];
+			}
+
+		private:
+			static T SIGN(const T a, const T b) { return b >= 0 ? (a >= 0 ? a : -a) : (a >= 0 ? -a : a); }
+			static T pythag(const T a, const T b)
+			{
+				// Computes (a^2+b^2)^(1/2) without destructive underflow or overflow.
+				T absa = std::abs(a), absb = std::abs(b);
+				return (absa>absb ?
+						absa*std::sqrt(T(1)+(absb/absa)*(absb/absa)) :
+						(absb==T(0) ? T(0) : absb*std::sqrt(T(1)+(absa/absb)*(absa/absb))));
+			}
+
+			void decompose();
+			void reorder();
+	};
+
+	template <typename T, size_t M, size_t N>
+	void StaticSVD<T,M,N>::decompose()
+	{
+		// Reference: Numerical Recipes: The Art of Scientific Computing - Third Edition - Webnote No.2, Rev. 1
+		const int m = M;
+		const int n = N;
+		bool flag;
+		int i,its,j,jj,k,l=0,nm=0;
+		T anorm,c,f,g,h,s,scale,x,y,z;
+		g = scale = anorm = T(0);
+		T rv1[N];
+
+		// Householder reduction to bidiagonal form
+		for(i=0;i<n;i++)
+		{
+			l = i+2;
+			rv1[i] = scale*g;
+			g = s = scale = T(0);
+			if(i<m)
+			{
+				for(k=i;k<m;k++) scale += std::abs(U[k][i]);
+				if(scale != T(0))
+				{
+					for(k=i;k<m;k++)
+					{
+						U[k][i] /= scale;
+						s += U[k][i]*U[k][i];
+					}
+					f = U[i][i];
+					g = -SIGN(std::sqrt(s), f);
+					h = f*g-s;
+					U[i][i] = f-g;
+					for(j=l-1;j<n;j++)
+					{
+						s = T(0);
+						for(k=i;k<m;k++) s += U[k][i]*U[k][j];
+						f = s/h;
+						for(k=i;k<m;k++) U[k][j] += f*U[k][i];
+					}
+					for(k=i;k<m;k++) U[k][i] *= scale;
+				}
+			}
+			S[i] = scale*g;
+			g = s = scale = T(0);
+			if(i+1<=m && i+1!=n)
+			{
+				for(k=l-1;k<n;k++) scale += std::abs(U[i][k]);
+				if(scale != T(0))
+				{
+					for(k=l-1;k<n;k++)
+					{
+						U[i][k] /= scale;
+						s += U[i][k]*U[i][k];
+					}
+					f = U[i][l-1];
+					g = -SIGN(std::sqrt(s), f);
+					h = f*g-s;
+					U[i][l-1] = f-g;
+					for(k=l-1;k<n;k++) rv1[k] = U[i][k]/h;
+					for(j=l-1;j<m;j++)
+					{
+						s = T(0);
+						for(k=l-1;k<n;k++) s += U[j][k]*U[i][k];
+						for(k=l-1;k<n;k++) U[j][k] += s*rv1[k];
+					}
+					for(k=l-1;k<n;k++) U[i][k] *= scale;
+				}
+			}
+			anorm = std::max(anorm, (std::abs(S[i])+std::abs(rv1[i])));
+		}
+
+		// Accumulation of right-hand transformations
+		for(i=n-1;i>=0;i--)
+		{
+			if(i < n-1)
+			{
+				if(g != T(0))
+				{
+					for(j=l;j<n;j++)
+						V[j][i] = (U[i][j]/U[i][l])/g;
+					for(j=l;j<n;j++)
+					{
+						s = T(0);
+						for(k=l;k<n;k++) s += U[i][k]*V[k][j];
+						for(k=l;k<n;k++) V[k][j] += s*V[k][i];
+					}
+				}
+				for(j=l;j<n;j++) V[i][j] = V[j][i] = T(0);
+			}
+			V[i][i] = T(1);
+			g = rv1[i];
+			l = i;
+		}
+
+		// Accumulation of left-hand transformations.
+		for(i=std::min(m,n)-1;i>=0;i--)
+		{
+			l = i+1;
+			g = S[i];
+			for(j=l;j<n;j++) U[i][j] = T(0);
+			if(g != T(0))
+			{
+				g = T(1)/g;
+				for(j=l;j<n;j++)
+				{
+					s = T(0);
+					for(k=l;k<m;k++) s += U[k][i]*U[k][j];
+					f = (s/U[i][i])*g;
+					for(k=i;k<m;k++) U[k][j] += f*U[k][i];
+				}
+				for(j=i;j<m;j++) U[j][i] *= g;
+			} else for(j=i;j<m;j++) U[j][i] = T(0);
+			++U[i][i];
+		}
+
+		// Diagonalization of the bidiagonal form: Loop over singular values, and over allowed iterations
+		for(k=n-1;k>=0;k--)
+		{
+			for(its=0;its<30;its++)
+			{
+				flag = true;
+				for(l=k;l>=0;l--)
+				{
+					nm = l-1;
+					if(l == 0 || std::abs(rv1[l]) <= eps*anorm)
+					{
+						flag = false;
+						break;
+					}
+					if(std::abs(S[nm]) <= eps*anorm) break;
+				}
+				if(flag)
+				{
+					c = T(0);
+					s = T(1);
+					for(i=l;i<k+1;i++)
+					{
+						f = s*rv1[i];
+						rv1[i] = c*rv1[i];
+						if(std::abs(f) <= eps*anorm) break;
+						g = S[i];
+						h = pythag(f,g);
+						S[i] = h;
+						h = T(1)/h;
+						c = g*h;
+						s = -f*h;
+						for(j=0;j<m;j++)
+						{
+							y = U[j][nm];
+							z = U[j][i];
+							U[j][nm] = y*c+z*s;
+							U[j][i] = z*c-y*s;
+						}
+					}
+				}
+				// Convergence
+				z = S[k];
+				if(l == k)
+				{
+					if(z < T(0))
+					{
+						S[k] = -z;
+						for(j=0;j<n;j++) V[j][k] = -V[j][k];
+					}
+					break;
+				}
+				// No convergence
+				if(its == 29)
+				{
+					converged = false;
+					return;
+				}
+				x = S[l];
+				nm = k-1;
+				y = S[nm];
+				g = rv1[nm];
+				h = rv1[k];
+				f = ((y-z)*(y+z)+(g-h)*(g+h))/(T(2)*h*y);
+				g = pythag(f,T(1));
+				f = ((x-z)*(x+z)+h*((y/(f+SIGN(g,f)))-h))/x;
+				c = s = T(1);
+				for(j=l;j<=nm;j++)
+				{
+					i = j+1;
+					g = rv1[i];
+					y = S[i];
+					h = s*g;
+					g = c*g;
+					z = pythag(f,h);
+					rv1[j] = z;
+					c = f/z;
+					s = h/z;
+					f = x*c+g*s;
+					g = g*c-x*s;
+					h = y*s;
+					y *= c;
+					for(jj=0;jj<n;jj++)
+					{
+						x = V[jj][j];
+						z = V[jj][i];
+						V[jj][j] = x*c+z*s;
+						V[jj][i] = z*c-x*s;
+					}
+					z = pythag(f,h);
+					S[j] = z;
+					if(z != T(0))
+					{
+						z = T(1)/z;
+						c = f*z;
+						s = h*z;
+					}
+					f = c*g+s*y;
+					x = c*y-s*g;
+					for(jj=0;jj<m;jj++)
+					{
+						y = U[jj][j];
+						z = U[jj][i];
+						U[jj][j] = y*c+z*s;
+						U[jj][i] = z*c-y*s;
+					}
+				}
+				rv1[l] = T(0);
+				rv1[k] = f;
+				S[k] = x;
+			}
+		}
+	}
+
+	template <typename T, size_t M, size_t N>
+	void StaticSVD<T,M,N>::reorder()
+	{
+		// Reference: Numerical Recipes: The Art of Scientific Computing - Third Edition - Webnote No.2, Rev. 1
+		// Sort with Shell's sort (U and V columns ordered by decreasing singular value) and flip signs
+		const int m = M;
+		const int n = N;
+		int i,j,k,s,inc=1;
+		T sw;
+		T su[M];
+		T sv[N];
+		// Sort
+		do
+		{
+			inc *= 3;
+			inc++;
+		}
+		while(inc<=n);
+		do
+		{
+			inc /= 3;
+			for(i=inc;i<n;i++)
+			{
+				sw = S[i];
+				for(k=0;k<m;k++) su[k] = U[k][i];
+				for(k=0;k<n;k++) sv[k] = V[k][i];
+				j = i;
+				while(S[j-inc] < sw)
+				{
+					S[j] = S[j-inc];
+					for(k=0;k<m;k++) U[k][j] = U[k][j-inc];
+					for(k=0;k<n;k++) V[k][j] = V[k][j-inc];
+					j -= inc;
+					if(j<inc) break;
+				}
+				S[j] = sw;
+				for(k=0;k<m;k++) U[k][j] = su[k];
+				for(k=0;k<n;k++) V[k][j] = sv[k];
+			}
+		}
+		while(inc>1);
+		// Flip signs
+		for(k=0;k<n;k++)
+		{
+			s=0;
+			for(i=0;i<m;i++)
+				if(U[i][k] < T(0)) s++;
+			for(j=0;j<n;j++)
+				if(V[j][k] < T(0)) s++;
+			if(s>(m+n)/2)
+			{
+				for(i=0;i<m;i++) U[i][k] = -U[i][k];
+				for(j=0;j<n;j++) V[j][k] = -V[j][k];
+			}
+		}
+	}
+}
+
+#endif// ATTA_ALGORITHMS_LINALG_STATIC_SVD_H
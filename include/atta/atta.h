@@ -34,6 +34,17 @@ namespace atta
 				std::vector<std::shared_ptr<Object>> objects = {};
 				std::vector<std::shared_ptr<Robot>> robots = {};
 
+				// Deterministic mode (same seed, same result independently of the quantity of threads)
+				bool deterministic = false;
+				float fixedDt = 0.01f;
+				uint64_t seed = 0;
+				std::string stateHashFile = "";
+
+				// Stream the state to remote subscribers (StateSubscriber) on this port (0 -> disabled)
+				unsigned stateStreamPort = 0;
+				// Publish the camera images to local controllers (ShmClient) in the shared memory with this name (empty -> disabled)
+				std::string sharedMemoryName = "";
+
 				std::function<void(void)> runAfterRobots;
 				std::function<void(WorkerGui*)> runBeforeWorkerGuiRender;
 				std::function<void(int key, int action)> handleKeyboard;
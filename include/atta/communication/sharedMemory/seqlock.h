@@ -0,0 +1,99 @@
+//--------------------------------------------------
+// Atta Project
+// seqlock.h
+// Date: 2021-07-10
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_COMMUNICATION_SHARED_MEMORY_SEQLOCK_H
+#define ATTA_COMMUNICATION_SHARED_MEMORY_SEQLOCK_H
+#include <atta/helpers/span.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace atta
+{
+	// Single writer snapshot protected by a sequence counter (the writer never waits for readers)
+	// Odd sequence -> write in progress. Readers copy the data and retry if the sequence changed
+	// Used to publish the last sensor value/camera frame, older values are overwritten
+	class SeqlockBuffer
+	{
+		public:
+			struct alignas(64) Control
+			{
+				std::atomic<uint64_t> sequence;
+				std::atomic<uint64_t> size;
+				uint64_t capacity;
+			};
+
+			static size_t requiredSize(size_t capacity) { return sizeof(Control) + ((capacity+63) & ~size_t(63)); }
+
+			SeqlockBuffer(): _control(nullptr), _data(nullptr) {}
+			SeqlockBuffer(uint8_t* memory, size_t capacity, bool initialize):
+				_control(reinterpret_cast<Control*>(memory)), _data(memory+sizeof(Control))
+			{
+				if(initialize)
+				{
+					new(_control) Control();
+					_control->sequence.store(0, std::memory_order_relaxed);
+					_control->size.store(0, std::memory_order_relaxed);
+					_control->capacity = capacity;
+				}
+			}
+
+			//---------- Writer ----------//
+			// Returns the buffer inside the shared memory, data can be generated directly there (zero-copy)
+			uint8_t* beginWrite()
+			{
+				const uint64_t seq = _control->sequence.load(std::memory_order_relaxed);
+				_control->sequence.store(seq+1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+				return _data;
+			}
+			void endWrite(size_t size)
+			{
+				_control->size.store(size, std::memory_order_relaxed);
+				const uint64_t seq = _control->sequence.load(std::memory_order_relaxed);
+				_control->sequence.store(seq+1, std::memory_order_release);
+			}
+			bool write(span<const uint8_t> data)
+			{
+				if(data.size() > getCapacity())
+					return false;
+				std::memcpy(beginWrite(), data.data(), data.size());
+				endWrite(data.size());
+				return true;
+			}
+
+			//---------- Reader ----------//
+			// Copy the last published snapshot, returns its sequence (0 if nothing was published)
+			uint64_t read(std::vector<uint8_t>& out) const
+			{
+				while(true)
+				{
+					const uint64_t seq = _control->sequence.load(std::memory_order_acquire);
+					if(seq & 1)
+					{
+						std::this_thread::yield();
+						continue;
+					}
+					const size_t size = std::min<size_t>(_control->size.load(std::memory_order_relaxed), getCapacity());
+					out.resize(size);
+					std::memcpy(out.data(), _data, size);
+					std::atomic_thread_fence(std::memory_order_acquire);
+					if(_control->sequence.load(std::memory_order_relaxed) == seq)
+						return seq/2;
+				}
+			}
+			// Number of snapshots published (cheap check for new data)
+			uint64_t getSequence() const { return _control->sequence.load(std::memory_order_acquire)/2; }
+			size_t getCapacity() const { return _control->capacity; }
+
+		private:
+			Control* _control;
+			uint8_t* _data;
+	};
+}
+
+#endif// ATTA_COMMUNICATION_SHARED_MEMORY_SEQLOCK_H
@@ -0,0 +1,45 @@
+//--------------------------------------------------
+// Atta Project
+// sharedMemory.h
+// Date: 2021-07-10
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_COMMUNICATION_SHARED_MEMORY_SHARED_MEMORY_H
+#define ATTA_COMMUNICATION_SHARED_MEMORY_SHARED_MEMORY_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace atta
+{
+	// Named POSIX shared memory segment mapped in the process address space
+	// The creator owns the name and unlinks it when destroyed
+	class SharedMemory
+	{
+		public:
+			SharedMemory();
+			~SharedMemory();
+			SharedMemory(const SharedMemory&) = delete;
+			void operator=(const SharedMemory&) = delete;
+
+			// Create a new segment (an old segment with the same name is replaced)
+			bool create(const std::string& name, size_t size);
+			// Map a segment created by another process
+			bool open(const std::string& name);
+			void close();
+
+			//---------- Getters ----------//
+			uint8_t* getData() const { return _data; }
+			size_t getSize() const { return _size; }
+			bool getValid() const { return _data != nullptr; }
+			const std::string& getName() const { return _name; }
+
+		private:
+			std::string _name;
+			uint8_t* _data;
+			size_t _size;
+			bool _owner;
+	};
+}
+
+#endif// ATTA_COMMUNICATION_SHARED_MEMORY_SHARED_MEMORY_H
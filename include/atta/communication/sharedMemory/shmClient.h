@@ -0,0 +1,68 @@
+//--------------------------------------------------
+// Atta Project
+// shmClient.h
+// Date: 2021-07-10
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_COMMUNICATION_SHARED_MEMORY_SHM_CLIENT_H
+#define ATTA_COMMUNICATION_SHARED_MEMORY_SHM_CLIENT_H
+#include <atta/communication/sharedMemory/shmServer.h>
+
+namespace atta
+{
+	// Controller side of the shared memory transport (same interface as atta::Client)
+	// No system calls are made to send/receive messages or read snapshots
+	class ShmClient
+	{
+		public:
+			ShmClient(std::string name="atta");
+			~ShmClient();
+
+			// Map the segment created by the ShmServer (can be called again if it failed)
+			void connectToServer();
+			bool sendToServer(span<const uint8_t> data) { return _connected && _clientRing.push(data); }
+			bool sendToServer(const std::string& data) { return sendToServer(asBytes(data)); }
+			// Busy waits until one message is received
+			std::string readFromServer();
+			// Non blocking read
+			bool tryReadFromServer(std::string& message);
+			// Call f(span<const uint8_t>) for each received message (span valid only inside f)
+			template <typename F>
+			size_t readFromServer(F&& f);
+
+			// Copy latest snapshot (returns its sequence, 0 if nothing was published yet or invalid index)
+			uint64_t readSnapshot(size_t index, std::vector<uint8_t>& out) const { return index < _snapshots.size() ? _snapshots[index].read(out) : 0; }
+			uint64_t getSnapshotSequence(size_t index) const { return index < _snapshots.size() ? _snapshots[index].getSequence() : 0; }
+
+			//---------- Getters ----------//
+			bool getConnected() const { return _connected; }
+			size_t getQtySnapshots() const { return _snapshots.size(); }
+
+		private:
+			std::string _name;
+			bool _connected;
+
+			SharedMemory _memory;
+			ShmHeader* _header;
+			SpscRing _clientRing;
+			SpscRing _serverRing;
+			std::vector<SeqlockBuffer> _snapshots;
+	};
+
+	template <typename F>
+	size_t ShmClient::readFromServer(F&& f)
+	{
+		size_t qty = 0;
+		if(!_connected)
+			return qty;
+		for(span<const uint8_t> message = _serverRing.front(); message.data(); message = _serverRing.front())
+		{
+			f(message);
+			_serverRing.pop();
+			qty++;
+		}
+		return qty;
+	}
+}
+
+#endif// ATTA_COMMUNICATION_SHARED_MEMORY_SHM_CLIENT_H
@@ -0,0 +1,96 @@
+//--------------------------------------------------
+// Atta Project
+// shmServer.h
+// Date: 2021-07-10
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_COMMUNICATION_SHARED_MEMORY_SHM_SERVER_H
+#define ATTA_COMMUNICATION_SHARED_MEMORY_SHM_SERVER_H
+#include <atta/communication/sharedMemory/sharedMemory.h>
+#include <atta/communication/sharedMemory/spscRing.h>
+#include <atta/communication/sharedMemory/seqlock.h>
+#include <vector>
+
+namespace atta
+{
+	// Shared memory segment layout (same for server and client)
+	// [ShmHeader][ring client->server][ring server->client][snapshot 0]...[snapshot n-1]
+	struct ShmHeader
+	{
+		static constexpr uint64_t magicValue = 0x314d485341545441ull;// "ATTASHM1"
+		static constexpr size_t size = 256;
+
+		uint64_t magic;
+		uint64_t ringCapacity;
+		uint64_t qtySnapshots;
+		uint64_t snapshotCapacity;
+		std::atomic<uint32_t> ready;// Set after the rings were initialized
+		std::atomic<uint32_t> clientConnected;
+
+		size_t clientRingOffset() const { return size; }
+		size_t serverRingOffset() const { return clientRingOffset() + SpscRing::requiredSize(ringCapacity); }
+		size_t snapshotOffset(size_t i) const { return serverRingOffset() + SpscRing::requiredSize(ringCapacity) + i*SeqlockBuffer::requiredSize(snapshotCapacity); }
+		size_t totalSize() const { return snapshotOffset(qtySnapshots); }
+	};
+
+	// Simulator side of the shared memory transport (one segment per local controller)
+	// - Commands from the controller arrive in a SPSC ring (poll without system calls)
+	// - Messages to the controller are sent through another SPSC ring
+	// - Sensor data (camera frames, robot state) are published in seqlock snapshots, the controller
+	//   always reads the latest value
+	// Each ring/snapshot must be written by only one thread
+	class ShmServer
+	{
+		public:
+			struct CreateInfo {
+				std::string name = "atta";
+				size_t ringCapacity = 1<<20;// Bytes in each ring (rounded to power of two)
+				size_t qtySnapshots = 1;
+				size_t snapshotCapacity = 1920*1080*4;// Bytes in each snapshot
+			};
+
+			ShmServer(CreateInfo info);
+			~ShmServer();
+
+			// Fail (false/nullptr) if the shared memory could not be created
+			bool sendToClient(span<const uint8_t> message) { return getValid() && _serverRing.push(message); }
+			bool sendToClient(const std::string& message) { return sendToClient(asBytes(message)); }
+			// Call f(span<const uint8_t>) for each received message (span valid only inside f)
+			template <typename F>
+			size_t readFromClient(F&& f);
+
+			// Snapshot written in place (ex: render the camera frame directly to the pointer)
+			uint8_t* beginSnapshot(size_t index) { return index < _snapshots.size() ? _snapshots[index].beginWrite() : nullptr; }
+			void endSnapshot(size_t index, size_t size) { if(index < _snapshots.size()) _snapshots[index].endWrite(size); }
+			bool publishSnapshot(size_t index, span<const uint8_t> data) { return index < _snapshots.size() && _snapshots[index].write(data); }
+
+			//---------- Getters ----------//
+			bool getValid() const { return _memory.getValid(); }
+			bool getClientConnected() const { return getValid() && _header->clientConnected.load(std::memory_order_relaxed); }
+			size_t getSnapshotCapacity() const { return getValid() ? _header->snapshotCapacity : 0; }
+
+		private:
+			SharedMemory _memory;
+			ShmHeader* _header;
+			SpscRing _clientRing;
+			SpscRing _serverRing;
+			std::vector<SeqlockBuffer> _snapshots;
+	};
+
+	template <typename F>
+	size_t ShmServer::readFromClient(F&& f)
+	{
+		size_t qty = 0;
+		if(!getValid())
+			return qty;
+		for(span<const uint8_t> message = _clientRing.front(); message.data(); message = _clientRing.front())
+		{
+			f(message);
+			_clientRing.pop();
+			qty++;
+		}
+		return qty;
+	}
+}
+
+#endif// ATTA_COMMUNICATION_SHARED_MEMORY_SHM_SERVER_H
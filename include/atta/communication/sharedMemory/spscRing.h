@@ -0,0 +1,154 @@
+//--------------------------------------------------
+// Atta Project
+// spscRing.h
+// Date: 2021-07-10
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_COMMUNICATION_SHARED_MEMORY_SPSC_RING_H
+#define ATTA_COMMUNICATION_SHARED_MEMORY_SPSC_RING_H
+#include <atta/helpers/span.h>
+#include <atomic>
+#include <cstring>
+
+namespace atta
+{
+	// Lock-free single producer single consumer ring of variable size messages
+	// The ring lives in memory shared by both processes, this class is only a view over it
+	//
+	// Message layout: [uint32 size][data] padded to 8 bytes
+	// When a message does not fit at the end of the ring a wrap marker is written and it starts at offset 0
+	class SpscRing
+	{
+		public:
+			struct alignas(64) Control
+			{
+				alignas(64) std::atomic<uint64_t> head;// Written by the producer
+				alignas(64) std::atomic<uint64_t> tail;// Written by the consumer
+				alignas(64) uint64_t capacity;
+			};
+			static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared memory atomics must be lock free");
+
+			// Bytes needed in the shared memory for a ring with capacity bytes (power of two)
+			static size_t requiredSize(size_t capacity) { return sizeof(Control) + capacity; }
+
+			SpscRing(): _control(nullptr), _data(nullptr), _mask(0), _cachedHead(0), _cachedTail(0), _reserved(0) {}
+			// initialize should be true only for the process that creates the shared memory
+			SpscRing(uint8_t* memory, size_t capacity, bool initialize):
+				_control(reinterpret_cast<Control*>(memory)), _data(memory+sizeof(Control)), _mask(capacity-1), _reserved(0)
+			{
+				if(initialize)
+				{
+					new(_control) Control();
+					_control->head.store(0, std::memory_order_relaxed);
+					_control->tail.store(0, std::memory_order_relaxed);
+					_control->capacity = capacity;
+				}
+				_cachedHead = _control->head.load(std::memory_order_acquire);
+				_cachedTail = _control->tail.load(std::memory_order_acquire);
+			}
+
+			// Biggest message that is guaranteed to fit in an empty ring
+			size_t getMaxMessageSize() const { return (_mask+1)/2 - headerSize; }
+
+			//---------- Producer ----------//
+			// Reserve space to write size bytes directly in the ring (nullptr if full)
+			uint8_t* reserve(size_t size)
+			{
+				if(size > getMaxMessageSize())
+					return nullptr;
+				const uint64_t head = _control->head.load(std::memory_order_relaxed);
+				const size_t capacity = _mask+1;
+				const size_t pos = head & _mask;
+				const size_t total = align(headerSize+size);
+				const size_t skip = capacity-pos < total ? capacity-pos : 0;// Wrap to the start
+
+				if(head+skip+total-_cachedTail > capacity)
+				{
+					_cachedTail = _control->tail.load(std::memory_order_acquire);
+					if(head+skip+total-_cachedTail > capacity)
+						return nullptr;
+				}
+
+				if(skip)
+				{
+					writeSize(pos, wrapMarker);
+					_reservedStart = 0;
+				}
+				else
+					_reservedStart = pos;
+				_reserved = skip+total;
+				writeSize(_reservedStart, size);
+				return _data+_reservedStart+headerSize;
+			}
+			// Publish the reserved message
+			void commit()
+			{
+				const uint64_t head = _control->head.load(std::memory_order_relaxed);
+				_control->head.store(head+_reserved, std::memory_order_release);
+				_reserved = 0;
+			}
+			bool push(span<const uint8_t> message)
+			{
+				uint8_t* data = reserve(message.size());
+				if(!data)
+					return false;
+				std::memcpy(data, message.data(), message.size());
+				commit();
+				return true;
+			}
+
+			//---------- Consumer ----------//
+			// Oldest message (valid until pop), empty span if there is no message
+			span<const uint8_t> front()
+			{
+				uint64_t tail = _control->tail.load(std::memory_order_relaxed);
+				while(true)
+				{
+					if(tail == _cachedHead)
+					{
+						_cachedHead = _control->head.load(std::memory_order_acquire);
+						if(tail == _cachedHead)
+							return span<const uint8_t>();
+					}
+					const size_t pos = tail & _mask;
+					const uint32_t size = readSize(pos);
+					if(size != wrapMarker)
+					{
+						_frontSize = align(headerSize+size);
+						return span<const uint8_t>(_data+pos+headerSize, size);
+					}
+					// Skip the end of the ring
+					tail += (_mask+1)-pos;
+					_control->tail.store(tail, std::memory_order_release);
+				}
+			}
+			void pop()
+			{
+				const uint64_t tail = _control->tail.load(std::memory_order_relaxed);
+				_control->tail.store(tail+_frontSize, std::memory_order_release);
+			}
+			bool empty() const { return _control->tail.load(std::memory_order_relaxed) == _control->head.load(std::memory_order_acquire); }
+
+		private:
+			static constexpr size_t headerSize = sizeof(uint32_t);
+			static constexpr uint32_t wrapMarker = 0xffffffff;
+			static size_t align(size_t size) { return (size+7) & ~size_t(7); }
+
+			void writeSize(size_t pos, uint32_t size) { std::memcpy(_data+pos, &size, headerSize); }
+			uint32_t readSize(size_t pos) const { uint32_t size; std::memcpy(&size, _data+pos, headerSize); return size; }
+
+			Control* _control;
+			uint8_t* _data;
+			size_t _mask;
+
+			// Local copies of the other side index (avoid reading its cache line on every operation)
+			uint64_t _cachedHead;
+			uint64_t _cachedTail;
+
+			size_t _reserved;
+			size_t _reservedStart;
+			size_t _frontSize;
+	};
+}
+
+#endif// ATTA_COMMUNICATION_SHARED_MEMORY_SPSC_RING_H
@@ -9,6 +9,7 @@
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <atta/helpers/span.h>
 #include <string>
 
 namespace atta
@@ -20,21 +21,24 @@ namespace atta
 			~Client();
 
 			void connectToServer();
-			void sendToServer(std::string data);
-			std::string readFromServer(unsigned maxSize=1024);
+			// Messages are framed as expected by the Server ([uint32 size][data])
+			bool sendToServer(span<const uint8_t> data);
+			bool sendToServer(const std::string& data) { return sendToServer(asBytes(data)); }
+			// Blocks until one message is received (empty if disconnected or bigger than maxSize, bigger messages are
+			// discarded and the connection is kept)
+			std::string readFromServer(unsigned maxSize=16*1024*1024);
 
 			bool getConnected() const { return _connected; }
 
 		private:
 			bool _connected;
-			unsigned _clientId;
 
 			// Server info
 			std::string _serverIp;
 			unsigned _serverPort;
 
 			// Socket connection
-			unsigned _clientFd;
+			int _clientFd;
 			struct sockaddr_in _serverAddr;
 	};
 }
@@ -6,11 +6,12 @@
 //--------------------------------------------------
 #ifndef ATTA_COMMUNICATION_SOCKET_SERVER_H
 #define ATTA_COMMUNICATION_SOCKET_SERVER_H
-#include <unistd.h>
+#include <atta/helpers/span.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
-#include <sys/types.h>
-#include <arpa/inet.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
 #include <thread>
@@ -18,6 +19,14 @@
 
 namespace atta
 {
+	// TCP server based on edge triggered epoll (one thread handles all clients)
+	//
+	// Messages are framed: [uint32 size (little endian)][size bytes]
+	// The read callback receives a span pointing to the connection receive buffer (valid only during the callback)
+	// send() can be called from any thread. It writes directly to the socket when nothing is queued,
+	// otherwise the message is queued and flushed by the server thread when the socket is writable
+	// Client ids are [generation (16 bits)][slot (16 bits)], an id of a closed connection is not valid for the
+	// next connection that reuses the slot
 	class Server
 	{
 		public:
@@ -34,45 +43,88 @@ namespace atta
 				unsigned port=4114;
 				Domain domain = IPV4;
 				Protocol protocol = TCP;
-				bool createClientThreads = false;
-				std::function<void(unsigned clientId, std::vector<uint8_t> buffer)> clientReadCallback;
+				size_t maxMessageSize = 16*1024*1024;// Bigger messages close the connection
+				size_t maxQueuedBytes = 4*1024*1024;// Per client send queue limit (backpressure)
+				std::function<void(unsigned clientId, span<const uint8_t> message)> clientReadCallback;
+				std::function<void(unsigned clientId)> clientConnectCallback;
+				std::function<void(unsigned clientId)> clientDisconnectCallback;
 			};
 
 			Server(CreateInfo info);
 			~Server();
 
+			// Send one framed message (returns false if the client is not connected or the send queue is full)
+			bool send(unsigned clientId, span<const uint8_t> message);
+			// Send one framed message made of multiple parts (gathered with writev, no concatenation)
+			bool send(unsigned clientId, span<const span<const uint8_t>> parts);
+			// Send to all connected clients
+			void broadcast(span<const uint8_t> message);
+
+			// Connection slot of a client id (0..maxClients-1)
+			static unsigned getSlot(unsigned clientId) { return clientId & slotMask; }
+
+			//---------- Getters ----------//
+			bool getRunning() const { return _running; }
+			bool getConnected(unsigned clientId) const;
+			unsigned getPort() const { return _port; }
+			size_t getQtyConnected() const { return _qtyConnected; }
+
 		private:
-			void createMainThread();
+			struct Connection {
+				std::mutex mutex;// Protects fd and the send queue
+				int fd = -1;
+				unsigned generation = 0;// Incremented when the slot is reused
+				std::string ip = "";
+				unsigned port = 0;
+
+				// Receive buffer (only accessed by the server thread)
+				std::vector<uint8_t> rxBuffer;
+				size_t rxSize = 0;
+
+				// Bytes that could not be written yet
+				std::vector<uint8_t> txQueue;
+				size_t txOffset = 0;
+			};
+
+			static constexpr unsigned slotBits = 16;
+			static constexpr unsigned slotMask = (1u<<slotBits)-1;
+			static unsigned makeClientId(unsigned slot, unsigned generation) { return (generation<<slotBits) | slot; }
+
+			bool init();
 			void mainThreadLoop();
 
-			void checkMasterSocket();
-			void checkClientSockets();
+			void acceptClients();
+			void readClient(unsigned slot);
+			void flushClient(unsigned slot);
+			void closeClient(unsigned slot);
+			void wakeUp();
 
 			unsigned _maxClients;
 			unsigned _port;
 			Domain _domain;
 			Protocol _protocol;
+			size_t _maxMessageSize;
+			size_t _maxQueuedBytes;
 
-			// Main thread + optional client threads
-			std::vector<std::thread> _threads;
-			bool _shouldFinish;
-			bool _createClientThreads;
+			// Main thread
+			std::thread _thread;
+			std::atomic<bool> _shouldFinish;
+			std::atomic<bool> _running;
 
 			// Server info
 			int _serverFd;
-			struct sockaddr_in _address;
-			fd_set _fdSet;// File descriptor set
+			int _epollFd;
+			int _wakeFd;// eventfd used to stop the main thread
 
 			// Clients info
-			struct ClientInfo {
-				int fd = -1;
-				std::string ip = "";
-				unsigned port = 0;
-			};
-			std::vector<ClientInfo> _clientSockets;// Client sockets file descriptors
+			std::vector<std::unique_ptr<Connection>> _connections;
+			std::vector<unsigned> _freeSlots;
+			std::atomic<size_t> _qtyConnected;
 
 			// Callbacks
-			std::function<void(unsigned clientId, std::vector<uint8_t> buffer)> _clientReadCallback;
+			std::function<void(unsigned clientId, span<const uint8_t> message)> _clientReadCallback;
+			std::function<void(unsigned clientId)> _clientConnectCallback;
+			std::function<void(unsigned clientId)> _clientDisconnectCallback;
 	};
 }
 
@@ -0,0 +1,99 @@
+//--------------------------------------------------
+// Atta Project
+// stateEncoder.h
+// Date: 2021-07-12
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_COMMUNICATION_STATE_STREAM_STATE_ENCODER_H
+#define ATTA_COMMUNICATION_STATE_STREAM_STATE_ENCODER_H
+#include <atta/math/math.h>
+#include <cstdint>
+#include <vector>
+
+namespace atta
+{
+	//---------- State streaming protocol ----------//
+	// Subscriber -> streamer: [STATE_MESSAGE_SUBSCRIBE][uint8 topics][varint rateDivisor]
+	// Streamer -> subscriber:
+	//     [STATE_MESSAGE_FRAME][uint8 flags][uint8 topics][varint step][varint qtyObjects]
+	//     keyframe:   [float positionPrecision][float velocityPrecision][zigzag varint id per object]
+	//     transforms: [changed bitmask][zigzag varint deltas x,y,z,qr,qi,qj,qk of changed objects]
+	//     velocities: [changed bitmask][zigzag varint deltas vx,vy,vz,wx,wy,wz of changed objects]
+	//     sensors (keyframe only): [varint qty][varint objectId, varint type, varint width, varint height, float fov]
+	// Deltas are computed against the last frame sent to the subscriber (keyframes against zero)
+	enum StateMessage : uint8_t {
+		STATE_MESSAGE_FRAME = 1,
+		STATE_MESSAGE_SUBSCRIBE = 2
+	};
+
+	enum StateTopic : uint8_t {
+		STATE_TOPIC_TRANSFORMS = 1<<0,
+		STATE_TOPIC_VELOCITIES = 1<<1,
+		STATE_TOPIC_SENSORS = 1<<2,
+		STATE_TOPIC_ALL = STATE_TOPIC_TRANSFORMS | STATE_TOPIC_VELOCITIES | STATE_TOPIC_SENSORS
+	};
+
+	enum StateFrameFlag : uint8_t {
+		STATE_FRAME_KEYFRAME = 1<<0
+	};
+
+	struct ObjectState
+	{
+		int id;
+		vec3 position;
+		quat orientation;
+		vec3 velocity;
+		vec3 angularVelocity;
+	};
+
+	struct SensorState
+	{
+		enum Type : uint32_t {
+			CAMERA = 0
+		};
+		int objectId;
+		Type type;
+		uint32_t width;
+		uint32_t height;
+		float fov;
+	};
+
+	// Integer state of all objects (deltas are computed between quantized states, no drift)
+	struct QuantizedState
+	{
+		static constexpr size_t transformStride = 7;
+		static constexpr size_t velocityStride = 6;
+		static constexpr float orientationScale = 32767.0f;
+
+		std::vector<int32_t> ids;
+		std::vector<int32_t> transforms;
+		std::vector<int32_t> velocities;
+
+		size_t size() const { return ids.size(); }
+		void quantize(const std::vector<ObjectState>& states, float positionPrecision, float velocityPrecision);
+		void dequantize(std::vector<ObjectState>& states, float positionPrecision, float velocityPrecision) const;
+	};
+
+	class StateEncoder
+	{
+		public:
+			//---------- Encoding ----------//
+			static void writeVarint(uint64_t value, std::vector<uint8_t>& out);
+			static void writeFloat(float value, std::vector<uint8_t>& out);
+			// Values of objects that changed from the baseline (nullptr baseline -> keyframe)
+			static void encodeSection(const int32_t* values, const int32_t* baseline, size_t qtyObjects, size_t stride, std::vector<uint8_t>& out);
+			static void encodeSensors(const std::vector<SensorState>& sensors, std::vector<uint8_t>& out);
+
+			//---------- Decoding (return false if the data is truncated) ----------//
+			static bool readVarint(const uint8_t*& data, const uint8_t* end, uint64_t& value);
+			static bool readFloat(const uint8_t*& data, const uint8_t* end, float& value);
+			// Applies the deltas to values (must contain the baseline, zero for keyframes)
+			static bool decodeSection(const uint8_t*& data, const uint8_t* end, int32_t* values, size_t qtyObjects, size_t stride);
+			static bool decodeSensors(const uint8_t*& data, const uint8_t* end, std::vector<SensorState>& sensors);
+
+			static uint32_t zigzag(int32_t v) { return (uint32_t(v)<<1) ^ uint32_t(v>>31); }
+			static int32_t unzigzag(uint32_t v) { return int32_t(v>>1) ^ -int32_t(v&1); }
+	};
+}
+
+#endif// ATTA_COMMUNICATION_STATE_STREAM_STATE_ENCODER_H
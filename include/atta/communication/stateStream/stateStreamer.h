@@ -0,0 +1,111 @@
+//--------------------------------------------------
+// Atta Project
+// stateStreamer.h
+// Date: 2021-07-12
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_COMMUNICATION_STATE_STREAM_STATE_STREAMER_H
+#define ATTA_COMMUNICATION_STATE_STREAM_STATE_STREAMER_H
+#include <atta/communication/stateStream/stateEncoder.h>
+#include <atta/communication/socket/server.h>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace atta
+{
+	class Object;
+
+	// Publishes the simulation state to remote subscribers (dashboards, loggers) through the socket server
+	//
+	// The simulation thread only copies the state in publish(). Quantization, delta encoding and sending
+	// happen in the streamer thread. If it is still busy when a new step is published, the older pending
+	// step is replaced (subscribers always get the most recent state).
+	// Subscribers with the same rate share the encoded frame, each one receives only the topics it asked for.
+	class StateStreamer
+	{
+		public:
+			struct CreateInfo {
+				unsigned port = 4115;
+				unsigned maxSubscribers = 64;
+				float positionPrecision = 1e-4f;// Meters
+				float velocityPrecision = 1e-3f;// m/s and rad/s
+				size_t keyframeInterval = 300;// Frames sent to a group between keyframes
+				size_t maxQueuedBytes = 16*1024*1024;// Per subscriber (frame is dropped if exceeded)
+			};
+
+			StateStreamer(CreateInfo info);
+			~StateStreamer();
+
+			// Called once per step by the simulation thread
+			void publish(const std::vector<std::shared_ptr<Object>>& objects);
+			void publish(const std::vector<ObjectState>& objects, const std::vector<SensorState>& sensors);
+
+			//---------- Getters ----------//
+			size_t getQtySubscribers() const;
+			uint64_t getQtyReplacedSteps() const { return _qtyReplacedSteps; }
+			uint64_t getQtyDroppedFrames() const { return _qtyDroppedFrames; }
+
+		private:
+			struct Snapshot {
+				uint64_t step = 0;
+				std::vector<ObjectState> objects;
+				std::vector<SensorState> sensors;
+			};
+
+			struct Subscriber {
+				unsigned clientId = 0;// Server client id (indexed by Server::getSlot)
+				bool active = false;
+				bool needsKeyframe = false;
+				uint8_t topics = 0;
+				uint32_t rateDivisor = 1;
+			};
+
+			// Subscribers with the same rate (same delta baseline)
+			struct Group {
+				uint64_t nextStep = 0;
+				uint64_t qtyFrames = 0;
+				bool forceKeyframe = true;
+				uint8_t topics = 0;// Topics of all subscribers in the group
+				QuantizedState baseline;
+				std::vector<uint8_t> keyframeData;// precisions + ids
+				std::vector<uint8_t> transforms;
+				std::vector<uint8_t> velocities;
+				std::vector<uint8_t> sensors;
+			};
+
+			void threadLoop();
+			void encodeAndSend(const Snapshot& snapshot);
+			void onMessage(unsigned clientId, span<const uint8_t> message);
+			void publishSnapshot();
+
+			CreateInfo _info;
+
+			// Snapshots: written by the simulation thread -> pending -> encoded by the streamer thread
+			Snapshot _publishing;
+			Snapshot _pending;
+			Snapshot _encoding;
+			bool _hasPending;
+			uint64_t _step;
+			std::mutex _pendingMutex;
+			std::condition_variable _pendingCv;
+
+			std::thread _thread;
+			bool _shouldFinish;
+
+			// Subscribers (changed by the server thread)
+			mutable std::mutex _subscribersMutex;
+			std::vector<Subscriber> _subscribers;
+			std::vector<Subscriber> _subscribersCopy;
+			std::map<uint32_t, Group> _groups;// Rate divisor -> group
+			QuantizedState _current;
+
+			std::atomic<uint64_t> _qtyReplacedSteps;
+			std::atomic<uint64_t> _qtyDroppedFrames;
+
+			std::unique_ptr<Server> _server;
+	};
+}
+
+#endif// ATTA_COMMUNICATION_STATE_STREAM_STATE_STREAMER_H
@@ -0,0 +1,50 @@
+//--------------------------------------------------
+// Atta Project
+// stateSubscriber.h
+// Date: 2021-07-12
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_COMMUNICATION_STATE_STREAM_STATE_SUBSCRIBER_H
+#define ATTA_COMMUNICATION_STATE_STREAM_STATE_SUBSCRIBER_H
+#include <atta/communication/stateStream/stateEncoder.h>
+#include <atta/communication/socket/client.h>
+
+namespace atta
+{
+	// Remote side of the StateStreamer (keeps the decoded state of the last received frame)
+	class StateSubscriber
+	{
+		public:
+			StateSubscriber(std::string serverIp="127.0.0.1", unsigned serverPort=4115);
+
+			void connectToServer() { _client.connectToServer(); }
+			// Receive one frame every rateDivisor steps with the selected topics (StateTopic bitmask)
+			bool subscribe(uint8_t topics=STATE_TOPIC_ALL, uint32_t rateDivisor=1);
+			// Blocks until one frame is received and decoded (returns false if disconnected or invalid)
+			bool receive();
+
+			//---------- Getters ----------//
+			bool getConnected() const { return _client.getConnected(); }
+			bool getSynchronized() const { return _synchronized; }
+			uint64_t getStep() const { return _step; }
+			uint8_t getTopics() const { return _topics; }
+			const std::vector<ObjectState>& getObjects() const { return _objects; }
+			const std::vector<SensorState>& getSensors() const { return _sensors; }
+
+		private:
+			bool decode(const uint8_t* data, const uint8_t* end);
+
+			Client _client;
+			bool _synchronized;// Received a keyframe (deltas can be applied)
+			uint64_t _step;
+			uint8_t _topics;// Topics of the last frame
+			float _positionPrecision;
+			float _velocityPrecision;
+
+			QuantizedState _state;
+			std::vector<ObjectState> _objects;
+			std::vector<SensorState> _sensors;
+	};
+}
+
+#endif// ATTA_COMMUNICATION_STATE_STREAM_STATE_SUBSCRIBER_H
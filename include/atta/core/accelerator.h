@@ -24,8 +24,12 @@ namespace atta
 			Accelerator(CreateInfo info);
 			~Accelerator();
 
+			// Root objects spawned/despawned at runtime
+			void addObject(std::shared_ptr<Object> object);
+			void removeObject(Object* object);
+
 			//---------- Getters ----------//
-			std::vector<std::shared_ptr<Object>> getObjects() const { return _objects; }
+			const std::vector<std::shared_ptr<Object>>& getObjects() const { return _objects; }
 
 		private:
 			std::vector<std::shared_ptr<Object>> _objects;
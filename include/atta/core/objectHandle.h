@@ -0,0 +1,29 @@
+//--------------------------------------------------
+// Atta Robot Simulator
+// objectHandle.h
+// Date: 2021-07-25
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_CORE_OBJECT_HANDLE_H
+#define ATTA_CORE_OBJECT_HANDLE_H
+
+#include <cstdint>
+
+namespace atta
+{
+	// Reference to an object in the scene registry
+	//
+	// The generation changes every time the slot is reused, so a handle to a destroyed object is never valid again.
+	struct ObjectHandle
+	{
+		static constexpr uint32_t invalidIndex = UINT32_MAX;
+		uint32_t index = invalidIndex;
+		uint32_t generation = 0;
+
+		bool isValid() const { return index != invalidIndex; }
+		bool operator==(const ObjectHandle& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const ObjectHandle& other) const { return !(*this == other); }
+	};
+}
+
+#endif// ATTA_CORE_OBJECT_HANDLE_H
@@ -9,6 +9,7 @@
 
 #include <vector>
 #include <atta/objects/object.h>
+#include <atta/helpers/random.h>
 
 namespace atta
 {
@@ -18,13 +19,26 @@ namespace atta
 			Robot();
 			~Robot();
 
+			// Robots may run in parallel (ROBOT_PROCESSING_PARALLEL_CPU), run() should only change the robot objects and
+			// use _random (not rand()). Shared APIs that can be called from run():
+			// - Drawer::add*/clearGroup (per thread buffers, uploaded after all robots finished)
+			// - Scene::spawn*/despawn* (applied at the start of the next frame)
+			// - Log, Camera::getBuffer (the sensor stage finished before the robots run)
+			// - Creating objects (Model/Mesh registries are locked)
+			// Other scene/renderer state must only be changed in runAfterRobots
 			virtual void run(float dt) = 0;
 
 			//---------- Getters ----------//
 			std::shared_ptr<Object> getRootObject() const { return _rootObject; }
+			const RandomStream& getRandom() const { return _random; }
+
+			//---------- Setters ----------//
+			// Set by the scene (stream from the scene seed and the robot index)
+			void setRandom(RandomStream random) { _random = random; }
 
 		protected:
 			std::shared_ptr<Object> _rootObject;
+			RandomStream _random;
 	};
 }
 
@@ -9,8 +9,12 @@
 
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <utility>
 #include <atta/core/robot.h>
 #include <atta/objects/object.h>
+#include <atta/core/transformSystem.h>
+#include <atta/core/sceneRegistry.h>
 #include <atta/graphics/core/light.h>
 
 namespace atta
@@ -22,22 +26,84 @@ namespace atta
 			{
 				std::vector<std::shared_ptr<Object>> objects = {};
 				std::vector<std::shared_ptr<Robot>> robots = {};
+				uint64_t seed = 0;// Random streams of the robots and the systems
+			};
+
+			// Objects spawned/despawned by applyChanges (roots and all their descendants)
+			struct Changes
+			{
+				std::vector<std::shared_ptr<Object>> spawnedRoots;
+				std::vector<std::shared_ptr<Object>> despawnedRoots;
+				std::vector<std::shared_ptr<Object>> spawned;
+				std::vector<std::shared_ptr<Object>> despawned;
+
+				bool empty() const { return spawnedRoots.empty() && despawnedRoots.empty(); }
 			};
 
 			Scene(CreateInfo info);
 			~Scene();
 
+			//---------- Spawn/despawn ----------//
+			// Can be called from any thread (robots, GUI), the requests are applied at the start of the next frame.
+			// Only root objects can be spawned/despawned (with all their children)
+			void spawn(std::shared_ptr<Object> object);
+			void despawn(ObjectHandle handle);
+			void despawn(Object* object);
+			void spawnRobot(std::shared_ptr<Robot> robot);
+			void despawnRobot(Robot* robot);
+			// Requests of the calling thread are applied sorted by this value (the thread manager sets the robot
+			// index while the robots run), so the order does not depend on the thread scheduling
+			static void setRequestOrder(uint64_t order);
+
+			// Called by the thread manager with getMutex() locked
+			Changes applyChanges();
+
+			// Held while the object lists change, lock it to read the scene outside the pipeline stages
+			std::mutex& getMutex() { return _mutex; }
+			// Incremented every time objects are spawned/despawned
+			uint64_t getVersion() const { return _version; }
+
 			//---------- Getters ----------//
-			std::vector<std::shared_ptr<Object>> getObjects() const { return _objects; }
-			std::vector<std::shared_ptr<Object>> getObjectsFlat() const { return _objectsFlat; }
-			std::vector<std::shared_ptr<Robot>> getRobots() const { return _robots; }
-			std::vector<std::shared_ptr<Object>> getLights() const { return _lights; }
+			const std::vector<std::shared_ptr<Object>>& getObjects() const { return _objects; }
+			const std::vector<std::shared_ptr<Object>>& getObjectsFlat() const { return _objectsFlat; }
+			const std::vector<std::shared_ptr<Robot>>& getRobots() const { return _robots; }
+			const std::vector<std::shared_ptr<Object>>& getLights() const { return _lights; }
+			// Flat object/component views (prefer them to iterate the scene every frame)
+			const SceneRegistry& getRegistry() const { return _registry; }
+			std::shared_ptr<TransformSystem> getTransformSystem() const { return _transformSystem; }
+
+			// Update the cached object world matrices (once per frame)
+			void updateTransforms() { _transformSystem->update(); }
+
+			//---------- Deterministic runs ----------//
+			uint64_t getSeed() const { return _seed; }
+			// Random stream of a simulation system (robots get theirs when added to the scene)
+			RandomStream createRandomStream(const std::string& system) const;
+			// Hash of the object transforms, body velocities and robot random counters (compared between runs)
+			uint64_t computeStateHash() const;
 
 		private:
 			std::vector<std::shared_ptr<Object>> _objects;// All objects
 			std::vector<std::shared_ptr<Object>> _lights;// Only light objects
 			std::vector<std::shared_ptr<Object>> _objectsFlat;
 			std::vector<std::shared_ptr<Robot>> _robots;
+			std::shared_ptr<TransformSystem> _transformSystem;
+			SceneRegistry _registry;
+
+			std::mutex _mutex;
+			uint64_t _version;
+
+			// Robot random streams, in the order the robots were added
+			void assignRandomStream(Robot* robot);
+			uint64_t _seed;
+			uint64_t _qtyRobotStreams;
+
+			// Pending requests with their order (protected by _pendingMutex)
+			std::mutex _pendingMutex;
+			std::vector<std::pair<uint64_t, std::shared_ptr<Object>>> _pendingSpawn;
+			std::vector<std::pair<uint64_t, Object*>> _pendingDespawn;
+			std::vector<std::pair<uint64_t, std::shared_ptr<Robot>>> _pendingSpawnRobots;
+			std::vector<std::pair<uint64_t, Robot*>> _pendingDespawnRobots;
 	};
 }
 
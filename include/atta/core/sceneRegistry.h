@@ -0,0 +1,121 @@
+//--------------------------------------------------
+// Atta Robot Simulator
+// sceneRegistry.h
+// Date: 2021-07-25
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_CORE_SCENE_REGISTRY_H
+#define ATTA_CORE_SCENE_REGISTRY_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <atta/helpers/span.h>
+#include <atta/core/objectHandle.h>
+#include <atta/objects/object.h>
+
+namespace atta
+{
+	// Dense array of one component type (swap remove, the order is not stable)
+	template <typename T>
+	class ComponentArray
+	{
+		public:
+			void add(ObjectHandle handle, Object* object, T component)
+			{
+				if(handle.index >= _dense.size())
+					_dense.resize(handle.index+1, invalidDense);
+				_dense[handle.index] = _components.size();
+				_components.push_back(component);
+				_objects.push_back(object);
+				_handles.push_back(handle);
+			}
+
+			void remove(ObjectHandle handle)
+			{
+				if(!has(handle))
+					return;
+				const uint32_t i = _dense[handle.index];
+				const uint32_t last = _components.size()-1;
+				_components[i] = _components[last];
+				_objects[i] = _objects[last];
+				_handles[i] = _handles[last];
+				_dense[_handles[i].index] = i;
+				_dense[handle.index] = invalidDense;
+				_components.pop_back();
+				_objects.pop_back();
+				_handles.pop_back();
+			}
+
+			// Handles of destroyed objects (older generation) are rejected
+			bool has(ObjectHandle handle) const
+			{
+				return handle.index < _dense.size() && _dense[handle.index] != invalidDense &&
+					_handles[_dense[handle.index]].generation == handle.generation;
+			}
+
+			T get(ObjectHandle handle) const { return has(handle) ? _components[_dense[handle.index]] : T{}; }
+
+			span<const T> getComponents() const { return _components; }
+			span<Object* const> getObjects() const { return _objects; }
+			span<const ObjectHandle> getHandles() const { return _handles; }
+			size_t size() const { return _components.size(); }
+
+		private:
+			static constexpr uint32_t invalidDense = UINT32_MAX;
+			std::vector<T> _components;
+			std::vector<Object*> _objects;// Owner of each component
+			std::vector<ObjectHandle> _handles;
+			std::vector<uint32_t> _dense;// Slot index -> component index
+	};
+
+	// Flat storage of the scene objects
+	//
+	// Objects and their components (physics body, model, sensor) are stored in dense arrays of raw pointers, the views
+	// are spans over them, so iterating all objects is a linear walk without copies or reference counting. The shared
+	// pointers are only held to keep the objects alive. The transforms are stored by the TransformSystem.
+	class SceneRegistry
+	{
+		public:
+			SceneRegistry();
+			~SceneRegistry();
+
+			// Register the object (its children are not registered)
+			// Only bodies of root objects are added to the bodies view, the children move with their root
+			ObjectHandle create(std::shared_ptr<Object> object);
+			void destroy(ObjectHandle handle);
+
+			bool isAlive(ObjectHandle handle) const;
+			Object* get(ObjectHandle handle) const;// nullptr if not alive
+
+			//---------- Views ----------//
+			span<Object* const> getObjects() const { return _objects; }
+			span<const ObjectHandle> getHandles() const { return _handles; }
+			const ComponentArray<phy::Body*>& getBodies() const { return _bodies; }
+			const ComponentArray<Model*>& getModels() const { return _models; }
+			const ComponentArray<Object*>& getSensors() const { return _sensors; }
+			size_t size() const { return _objects.size(); }
+
+		private:
+			struct Slot
+			{
+				uint32_t generation = 0;
+				uint32_t dense = UINT32_MAX;// Index in the dense arrays (UINT32_MAX if free)
+			};
+
+			std::vector<Slot> _slots;
+			std::vector<uint32_t> _freeSlots;
+
+			// Dense arrays (same index)
+			std::vector<Object*> _objects;
+			std::vector<ObjectHandle> _handles;
+			std::vector<std::shared_ptr<Object>> _owners;
+
+			// Components
+			ComponentArray<phy::Body*> _bodies;
+			ComponentArray<Model*> _models;
+			ComponentArray<Object*> _sensors;
+	};
+}
+
+#endif// ATTA_CORE_SCENE_REGISTRY_H
@@ -0,0 +1,70 @@
+//--------------------------------------------------
+// Atta Robot Simulator
+// transformSystem.h
+// Date: 2021-07-24
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_CORE_TRANSFORM_SYSTEM_H
+#define ATTA_CORE_TRANSFORM_SYSTEM_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atta/math/math.h>
+#include <atta/objects/object.h>
+
+namespace atta
+{
+	// Cached local and world matrices of the scene objects
+	//
+	// The matrices are stored in contiguous arrays ordered by hierarchy depth (all roots, then all their children, ...),
+	// so a parent is always updated before its children. Object setters (and the physics bodies) only mark the local
+	// matrix as dirty, update() recalculates the dirty local matrices and the world matrices of their subtrees with the
+	// batch kernels (math/batch.h). The objects of the same depth are independent and are split between threads when
+	// there are many of them (the threads are created the first time and wait for the next level after that).
+	class TransformSystem
+	{
+		public:
+			TransformSystem(const std::vector<std::shared_ptr<Object>>& rootObjects);
+			~TransformSystem();
+
+			// Called once per frame before the world matrices are used
+			void update();
+			// Called when objects are spawned/despawned (all world matrices are recalculated)
+			void rebuild(const std::vector<std::shared_ptr<Object>>& rootObjects);
+
+			//---------- Getters ----------//
+			const mat4& getWorldMat(unsigned index) const { return _world[index]; }
+			const mat4& getLocalMat(unsigned index) const { return _local[index]; }
+			unsigned getQtyObjects() const { return _objects.size(); }
+			unsigned getQtyLevels() const { return _levels.size()-1; }
+
+		private:
+			void updateRange(size_t begin, size_t end);
+			void workerLoop(unsigned index);
+
+			std::vector<Object*> _objects;
+			std::vector<int> _parents;// Parent index (-1 for root objects)
+			std::vector<size_t> _levels;// First index of each depth (last element is the quantity of objects)
+			std::vector<mat4> _local;
+			std::vector<mat4> _world;
+			std::vector<uint8_t> _changed;// World matrix changed in the current update
+			unsigned _qtyThreads;
+
+			//---------- Workers ----------//
+			std::vector<std::thread> _workers;// Worker i updates the range i+1 of the level
+			std::mutex _mutex;
+			std::condition_variable _startCv;
+			std::condition_variable _doneCv;
+			uint64_t _job;// Incremented for each level split between threads
+			size_t _jobBegin, _jobEnd, _jobChunk;
+			unsigned _jobQtyThreads;
+			unsigned _qtyPending;// Workers that did not finish the current job
+			bool _stop;
+	};
+}
+
+#endif// ATTA_CORE_TRANSFORM_SYSTEM_H
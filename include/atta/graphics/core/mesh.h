@@ -9,7 +9,10 @@
 
 #include <string>
 #include <vector>
+#include <mutex>
 #include <atta/graphics/core/vertex.h>
+#include <atta/graphics/core/meshCache.h>
+#include <atta/math/matrix.h>
 
 namespace atta
 {
@@ -29,12 +32,28 @@ namespace atta
 			unsigned getVerticesOffset() const { return _verticesOffset; }
 			unsigned getIndicesOffset() const { return _indicesOffset; }
 			unsigned getIndex() const { return _index; }
+			vec3 getBoundsMin() const { return _boundsMin; }
+			vec3 getBoundsMax() const { return _boundsMax; }
+
+			//---------- Level of detail ----------//
+			// Level 0 is the full mesh, level i is getLods()[i-1]
+			const std::vector<MeshLod>& getLods() const { return _lods; }
+			const std::vector<uint32_t>& getLodIndices() const { return _lodIndices; }
+			unsigned getQtyLods() const { return _lods.size()+1; }
+			unsigned getLodIndicesSize(unsigned lod) const { return lod == 0 ? _indices.size() : _lods[lod-1].qtyIndices; }
+			unsigned getLodIndicesOffset(unsigned lod) const { return lod == 0 ? _indicesOffset : _lodIndicesOffset+_lods[lod-1].indicesOffset; }
+			// Coarsest level with projected error below maxPixelError pixels
+			// projectionScale: pixels per world unit at distance 1 (viewportHeight/(2*tan(fov/2))), 0 -> full mesh
+			unsigned selectLod(const mat4& modelMat, vec3 cameraPosition, float projectionScale, float maxPixelError = 1.0f) const;
 
 			//---------- Setters ----------//
 			void setVerticesOffset(unsigned verticesOffset) { _verticesOffset = verticesOffset; }
 			void setIndicesOffset(unsigned indicesOffset) { _indicesOffset = indicesOffset; }
+			void setLodIndicesOffset(unsigned lodIndicesOffset) { _lodIndicesOffset = lodIndicesOffset; }
 
+			// Indexed by getIndex() (nullptr after the mesh is released), lock allMeshesMutex to access it
 			static std::vector<Mesh*> allMeshes;
+			static std::mutex allMeshesMutex;
 
 		private:
 			void loadMesh();
@@ -48,7 +67,10 @@ namespace atta
 			std::vector<Vertex> _vertices;
 			std::vector<uint32_t> _indices;
 			std::vector<std::string> _materialNames;
-			unsigned _verticesOffset, _indicesOffset;// TODO Remove them
+			vec3 _boundsMin, _boundsMax;
+			std::vector<MeshLod> _lods;
+			std::vector<uint32_t> _lodIndices;
+			unsigned _verticesOffset, _indicesOffset, _lodIndicesOffset;// TODO Remove them
 	};
 }
 
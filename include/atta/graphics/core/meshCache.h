@@ -0,0 +1,79 @@
+//--------------------------------------------------
+// Atta Graphics
+// meshCache.h
+// Date: 2021-07-15
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_GRAPHICS_CORE_MESH_CACHE_H
+#define ATTA_GRAPHICS_CORE_MESH_CACHE_H
+
+#include <string>
+#include <vector>
+#include <atta/graphics/core/vertex.h>
+
+namespace atta
+{
+	// Simplified level of detail (indices of the full mesh vertices)
+	struct MeshLod
+	{
+		uint32_t indicesOffset;// Offset in MeshData::lodIndices
+		uint32_t qtyIndices;
+		float error;// Object space geometric error
+	};
+
+	// Geometry of a mesh file after importing
+	struct MeshData
+	{
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		std::vector<std::string> materialNames;
+		std::vector<MeshLod> lods;// From the most to the least detailed (the full mesh is not included)
+		std::vector<uint32_t> lodIndices;
+		vec3 boundsMin;
+		vec3 boundsMax;
+
+		void computeBounds() { computeBounds(vertices, boundsMin, boundsMax); }
+		static void computeBounds(const std::vector<Vertex>& vertices, vec3& boundsMin, vec3& boundsMax);
+	};
+
+	// Binary mesh cache written next to the imported file (<file>.attamesh)
+	//
+	// The cache is memory mapped when loading, vertices and indices are copied with a single memcpy each.
+	// It is ignored if the version, the vertex layout, or the size/modification time of the source file changed.
+	//
+	// Layout (native endianness):
+	// [Header][vertices (16 byte aligned)][indices (16 byte aligned)][lods][lod indices][material names: (uint32 size, chars)...]
+	class MeshCache
+	{
+		public:
+			static constexpr uint32_t version = 3;
+
+			static bool load(const std::string& sourceFile, MeshData& data);
+			static bool save(const std::string& sourceFile, const MeshData& data);
+			static std::string getCacheFileName(const std::string& sourceFile) { return sourceFile+".attamesh"; }
+
+		private:
+			struct Header
+			{
+				char magic[8];// "ATTAMESH"
+				uint32_t version;
+				uint32_t vertexSize;
+				uint64_t sourceSize;
+				int64_t sourceModificationTime;
+				uint64_t qtyVertices;
+				uint64_t qtyIndices;
+				uint64_t qtyMaterials;
+				uint64_t qtyLods;
+				uint64_t qtyLodIndices;
+				uint64_t verticesOffset;
+				uint64_t indicesOffset;
+				uint64_t lodsOffset;
+				uint64_t lodIndicesOffset;
+				uint64_t materialsOffset;
+				float boundsMin[3];
+				float boundsMax[3];
+			};
+	};
+}
+
+#endif// ATTA_GRAPHICS_CORE_MESH_CACHE_H
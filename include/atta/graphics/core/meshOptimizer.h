@@ -0,0 +1,37 @@
+//--------------------------------------------------
+// Atta Graphics
+// meshOptimizer.h
+// Date: 2021-07-16
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_GRAPHICS_CORE_MESH_OPTIMIZER_H
+#define ATTA_GRAPHICS_CORE_MESH_OPTIMIZER_H
+
+#include <vector>
+#include <atta/graphics/core/meshCache.h>
+
+namespace atta
+{
+	// Import time mesh processing (the result is stored in the mesh cache)
+	//
+	// 1. Vertex cache: triangles reordered with Tom Forsyth's linear-speed algorithm
+	// 2. Overdraw: the new order is split where the vertex cache is cold, clusters facing outwards are drawn first
+	// 3. Vertex fetch: vertices renumbered by first use (sequential reads from the vertex buffer)
+	class MeshOptimizer
+	{
+		public:
+			static constexpr unsigned cacheSize = 32;// Forsyth simulated LRU cache
+			static constexpr unsigned fifoSize = 16;// Post transform cache of current GPUs (used to measure/split)
+
+			static void optimize(MeshData& data);
+
+			static void optimizeVertexCache(std::vector<uint32_t>& indices, size_t qtyVertices);
+			static void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices);
+			static void optimizeVertexFetch(std::vector<uint32_t>& indices, std::vector<Vertex>& vertices);
+
+			// Average cache miss ratio (transformed vertices per triangle, 0.5 is ideal for large grids, 3 is worst)
+			static float computeAcmr(const std::vector<uint32_t>& indices, size_t qtyVertices);
+	};
+}
+
+#endif// ATTA_GRAPHICS_CORE_MESH_OPTIMIZER_H
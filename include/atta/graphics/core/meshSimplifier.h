@@ -0,0 +1,39 @@
+//--------------------------------------------------
+// Atta Graphics
+// meshSimplifier.h
+// Date: 2021-07-17
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_GRAPHICS_CORE_MESH_SIMPLIFIER_H
+#define ATTA_GRAPHICS_CORE_MESH_SIMPLIFIER_H
+
+#include <vector>
+#include <atta/graphics/core/meshCache.h>
+
+namespace atta
+{
+	// Level of detail generation with quadric error edge collapses (Garland and Heckbert)
+	//
+	// Edges are collapsed into one of their vertices, so every level is only an index buffer that
+	// reuses the vertices of the full mesh. Vertices with the same position are welded while simplifying,
+	// corners moved to a new position take the vertex of that position with the closest attributes.
+	// Border vertices are locked (no holes are opened).
+	class MeshSimplifier
+	{
+		public:
+			static constexpr unsigned maxLods = 4;
+			static constexpr unsigned minTriangles = 16;// Meshes/levels smaller than this are not simplified
+
+			// Fills data.lods and data.lodIndices (each level has about half of the triangles of the previous one)
+			static void generateLods(MeshData& data) { generateLods(data.vertices, data.indices, data.lods, data.lodIndices); }
+			static void generateLods(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+					std::vector<MeshLod>& lods, std::vector<uint32_t>& lodIndices);
+
+			// Returns the simplified index buffer with at most targetIndexCount indices (if possible)
+			// error receives the object space geometric error of the result
+			static std::vector<uint32_t> simplify(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+					size_t targetIndexCount, float& error);
+	};
+}
+
+#endif// ATTA_GRAPHICS_CORE_MESH_SIMPLIFIER_H
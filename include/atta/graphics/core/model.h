@@ -10,6 +10,7 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <atta/graphics/core/mesh.h>
 #include <atta/graphics/core/material.h>
 
@@ -31,6 +32,7 @@ namespace atta
 			// Store all loaded meshes to avoid duplicate meshes in memory
 			// map<fileName, Mesh*>
 			static std::map<std::string, std::weak_ptr<Mesh>> allMeshes;
+			static std::mutex allMeshesMutex;
 
 			//---------- Setters ----------//
 			void setMaterialOffset(int materialOffset) { _materialOffset = materialOffset; }
@@ -39,14 +41,14 @@ namespace atta
 			std::map<std::string, Material> getMaterials() const { return _materials; }
 			int getMaterialOffset() const { return _materialOffset; }
 			std::string getMeshName() const { return _meshName; }
-			std::shared_ptr<Mesh> getMesh() const { return _mesh; }
+			const std::shared_ptr<Mesh>& getMesh() const { return _mesh; }
 			unsigned getMeshIndex() const { return _mesh->getIndex(); }
 
 		private:
 			std::string _meshName;
 			std::shared_ptr<Mesh> _mesh;
 			std::map<std::string, Material> _materials;
-			int _materialOffset;
+			int _materialOffset;// -1 until the mesh and the materials are in the GPU buffers (not rendered)
 	};
 }
 
@@ -0,0 +1,97 @@
+//--------------------------------------------------
+// Atta Graphics
+// objParser.h
+// Date: 2021-07-15
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_GRAPHICS_CORE_OBJ_PARSER_H
+#define ATTA_GRAPHICS_CORE_OBJ_PARSER_H
+
+#include <array>
+#include <climits>
+#include <functional>
+#include <string>
+#include <vector>
+#include <atta/graphics/core/meshCache.h>
+
+namespace atta
+{
+	// Multithreaded Wavefront OBJ importer
+	//
+	// The memory mapped file is split at line boundaries and each thread parses one chunk (faces are
+	// triangulated as fans). The chunks are merged, then the vertices are deduplicated by their
+	// (position, normal, texCoord, material) indices in hash partitions processed in parallel.
+	// Vertices are numbered by first use, the result does not depend on the number of threads.
+	class ObjParser
+	{
+		public:
+			struct CreateInfo {
+				std::string fileName;
+				unsigned qtyThreads = 0;// 0 -> std::thread::hardware_concurrency()
+			};
+
+			ObjParser(CreateInfo info);
+
+			// Returns false if the file could not be parsed (see getError())
+			bool parse(MeshData& data);
+
+			//---------- Getters ----------//
+			std::string getError() const { return _error; }
+			std::string getWarning() const { return _warning; }
+
+		private:
+			static constexpr int32_t noIndex = INT32_MIN;
+			static constexpr unsigned partitionBits = 6;
+			static constexpr unsigned qtyPartitions = 1<<partitionBits;
+
+			enum RelativeFlags : uint8_t {
+				RELATIVE_POSITION = 1,
+				RELATIVE_NORMAL = 2,
+				RELATIVE_TEX_COORD = 4
+			};
+
+			// Vertex of a triangle (indices in the obj arrays)
+			struct Corner
+			{
+				int32_t position;
+				int32_t normal;
+				int32_t texCoord;
+				int32_t material;
+				bool operator==(const Corner& o) const
+				{
+					return position == o.position && normal == o.normal && texCoord == o.texCoord && material == o.material;
+				}
+			};
+
+			struct Chunk
+			{
+				std::vector<float> positions;
+				std::vector<float> normals;
+				std::vector<float> texCoords;
+				std::vector<Corner> corners;
+				std::vector<uint8_t> relative;// RelativeFlags of each corner (negative obj indices)
+				std::vector<std::string> materials;// Names used in this chunk (corner material is the slot, -1 -> previous chunk)
+				std::vector<std::string> materialLibs;
+				int32_t lastMaterial = -1;
+				std::string error;
+
+				// After merging
+				size_t positionsOffset, normalsOffset, texCoordsOffset, cornersOffset;
+				int32_t inheritedMaterial;
+				std::vector<int32_t> materialMap;// Slot -> material index
+				std::array<std::vector<uint32_t>, qtyPartitions> partitions;// Corners of each hash partition
+			};
+
+			void parseChunk(Chunk& chunk, const char* begin, const char* end);
+			void loadMaterialNames(const std::vector<std::string>& libs, std::vector<std::string>& names);
+			void runParallel(unsigned qtyTasks, const std::function<void(unsigned)>& task);
+			static uint64_t hash(const Corner& c);
+
+			CreateInfo _info;
+			unsigned _qtyThreads;
+			std::string _error;
+			std::string _warning;
+	};
+}
+
+#endif// ATTA_GRAPHICS_CORE_OBJ_PARSER_H
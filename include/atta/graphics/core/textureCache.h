@@ -0,0 +1,79 @@
+//--------------------------------------------------
+// Atta Graphics
+// textureCache.h
+// Date: 2021-07-18
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_GRAPHICS_CORE_TEXTURE_CACHE_H
+#define ATTA_GRAPHICS_CORE_TEXTURE_CACHE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace atta
+{
+	// Mip chain of a texture file after importing
+	struct TextureData
+	{
+		enum Format : uint32_t {
+			FORMAT_NONE = 0,
+			FORMAT_RGBA8_SRGB,
+			FORMAT_BC1_SRGB,// 4x4 blocks of 8 bytes (opaque)
+			FORMAT_BC3_SRGB,// 4x4 blocks of 16 bytes (with alpha)
+			FORMAT_RGBA32F,// HDR (also used as storage image by the texture processes)
+		};
+
+		struct Level
+		{
+			uint32_t width;
+			uint32_t height;
+			uint64_t offset;// Offset in data
+			uint64_t size;
+		};
+
+		Format format = FORMAT_NONE;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector<Level> levels;
+		std::vector<uint8_t> data;
+
+		// Fills levels for the full mip chain (data is not allocated)
+		void setLayout(Format format, uint32_t width, uint32_t height);
+
+		static bool isCompressed(Format format) { return format == FORMAT_BC1_SRGB || format == FORMAT_BC3_SRGB; }
+		static uint64_t levelSize(Format format, uint32_t width, uint32_t height);
+		static uint32_t qtyMipLevels(uint32_t width, uint32_t height);
+	};
+
+	// Binary texture cache written next to the imported file (<file>.attatex)
+	//
+	// KTX2 like container: the header is followed by the level index and the mip levels (16 byte aligned),
+	// the data is uploaded as is. The cache is ignored if the version, the format, or the size/modification
+	// time of the source file changed.
+	class TextureCache
+	{
+		public:
+			static constexpr uint32_t version = 1;
+
+			static bool load(const std::string& sourceFile, TextureData::Format format, TextureData& data);
+			static bool save(const std::string& sourceFile, const TextureData& data);
+			static std::string getCacheFileName(const std::string& sourceFile) { return sourceFile+".attatex"; }
+
+		private:
+			struct Header
+			{
+				char magic[8];// "ATTATEX"
+				uint32_t version;
+				uint32_t format;
+				uint32_t width;
+				uint32_t height;
+				uint32_t qtyLevels;
+				uint32_t padding;
+				uint64_t sourceSize;
+				int64_t sourceModificationTime;
+			};
+	};
+}
+
+#endif// ATTA_GRAPHICS_CORE_TEXTURE_CACHE_H
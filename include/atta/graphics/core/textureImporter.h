@@ -0,0 +1,40 @@
+//--------------------------------------------------
+// Atta Graphics
+// textureImporter.h
+// Date: 2021-07-18
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_GRAPHICS_CORE_TEXTURE_IMPORTER_H
+#define ATTA_GRAPHICS_CORE_TEXTURE_IMPORTER_H
+
+#include <string>
+#include <vector>
+#include <atta/graphics/core/textureCache.h>
+
+namespace atta
+{
+	// Texture file decoding and mip chain generation (the result is stored in the texture cache)
+	//
+	// LDR mips are averaged in linear space, then block compressed (BC1 if the file has no alpha channel,
+	// BC3 otherwise) when the device supports it. HDR (.hdr) textures are kept as RGBA32F.
+	class TextureImporter
+	{
+		public:
+			// Format that the file will be imported to, only reads the file header
+			static bool readInfo(const std::string& fileName, bool compress, TextureData::Format& format, uint32_t& width, uint32_t& height);
+
+			// Returns false if the file could not be decoded (error receives the reason)
+			static bool import(const std::string& fileName, bool compress, TextureData& data, std::string& error);
+
+			// Solid color tile of tileSize x tileSize texels (multiple of 4) in the format layout
+			// Copied over the image while the texture is loading
+			static std::vector<uint8_t> createPlaceholderTile(TextureData::Format format, uint32_t tileSize, const uint8_t color[4]);
+
+			//---------- Block compression ----------//
+			// rgba: 4x4 texels, row major
+			static void encodeBC1(const uint8_t rgba[64], uint8_t block[8]);
+			static void encodeBC3(const uint8_t rgba[64], uint8_t block[16]);
+	};
+}
+
+#endif// ATTA_GRAPHICS_CORE_TEXTURE_IMPORTER_H
@@ -10,34 +10,109 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include <vector>
+#include <deque>
 #include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <atta/graphics/gui/font/fontStructs.h>
+#include <atta/graphics/gui/font/glyphAtlas.h>
 #include <atta/graphics/vulkan/texture.h>
 #include <atta/graphics/vulkan/device.h>
 #include <atta/graphics/vulkan/commandPool.h>
 
 namespace guib {
+	// Lazy signed distance field glyph atlas
+	//
+	// Only the glyph advances are loaded when a font is added. The distance field of a glyph is generated by a
+	// background thread the first time it is requested (getGlyph), and update() packs the generated glyphs in the
+	// atlas (shelves with LRU eviction) and uploads only their regions. The same glyph is used for any text size
+	// (the shader thresholds the distance), and all fonts share the atlas.
 	class FontLoader
 	{
 		public:
 			FontLoader(std::shared_ptr<atta::vk::Device> device, std::shared_ptr<atta::vk::CommandPool> commandPool, std::string filename);
 			~FontLoader();
 
+			// Returns the font index (the first font is 0)
+			unsigned addFont(std::string filename);
+
+			// Glyph to render (requested if it is not resident, the gui is invalidated when it is ready)
+			const GlyphInfo& getGlyph(unsigned char letter, unsigned font = 0);
+			// Advance in pixels for the text size (always available)
+			float getAdvance(unsigned char letter, float textSize, unsigned font = 0) const;
+
+			// Called by the gui thread before rendering, returns true if glyphs were added to the atlas
+			bool update();
+			// Glyphs requested after this call are in use (their atlas shelves are not evicted)
+			void beginGlyphUse() { _generation++; }
+
 			//---------- Getters and Setters ----------//
 			std::shared_ptr<atta::vk::Texture> getTexture() const { return _texture; }
-			FontTexture getFontTexture() const { return _fontTexture; }
+			const FontAtlas& getAtlas() const { return _atlas; }
 			int getBaseHeight() const { return _baseHeight; }
+			int getGlyphSize() const { return _glyphSize; }
 
 		private:
-			void loadGlyphs();
-			void testFontTerminal(std::string text);
+			enum GlyphState
+			{
+				GLYPH_STATE_NOT_REQUESTED = 0,
+				GLYPH_STATE_GENERATING,
+				GLYPH_STATE_GENERATED,// Distance field available (may not be resident)
+				GLYPH_STATE_EMPTY,// Nothing to draw (space, missing glyph)
+			};
+
+			struct Glyph
+			{
+				GlyphInfo info;
+				GlyphState state = GLYPH_STATE_NOT_REQUESTED;
+				std::vector<uint8_t> sdf;// Kept to pack again after eviction
+				unsigned shelf = 0;
+				bool toPack = false;// Already in _toPack
+			};
+
+			struct Font
+			{
+				std::string filename;
+				FT_Face face;
+				std::vector<Glyph> glyphs = std::vector<Glyph>(256);
+			};
+
+			struct GeneratedGlyph
+			{
+				uint32_t key;
+				GlyphInfo info;
+				std::vector<uint8_t> sdf;
+			};
+
+			static uint32_t toKey(unsigned font, unsigned char letter) { return (font<<8) | letter; }
+			void generateThread();
+			void generateGlyph(GeneratedGlyph& glyph);
+			void packGlyph(uint32_t key, std::vector<uint8_t>& upload, std::vector<VkBufferImageCopy>& regions);
+
+			void request(uint32_t key);
 
-			std::string _filename;
 			FT_Library _library;
-			FT_Face    _face;
+			std::vector<Font> _fonts;
+			std::mutex _freeTypeMutex;// FreeType library/faces are not thread safe
+
+			FontAtlas _atlas;
+			GlyphAtlas _glyphAtlas;
+			int _baseHeight;// Default text height in pixels
+			int _glyphSize;// Glyph height in the atlas
+			int _oversample;// Glyphs are rasterized with oversample times the atlas resolution
+			int _spread;// Distance field border in pixels
+			unsigned _generation;
+			std::vector<uint32_t> _toPack;// Requested glyphs that were generated but are not resident
+			bool _atlasFullWarned;
 
-			FontTexture _fontTexture;
-			int _baseHeight;// Base glyph height in pixels
+			// Background generation
+			std::thread _thread;
+			std::mutex _mutex;
+			std::condition_variable _cv;
+			std::deque<uint32_t> _requests;
+			std::vector<GeneratedGlyph> _generated;
+			bool _stop;
 
 			// Vulkan specific
 			std::shared_ptr<atta::vk::Device> _device;
@@ -11,10 +11,9 @@ namespace guib {
 
 	struct FontAtlas
 	{
-		// Matrix to store glyphs bitmaps (GPU font texture data)
+		// Size of the glyph atlas texture (signed distance fields, one channel)
 		unsigned int width=0;
 		unsigned int height=0;
-    	unsigned char* data;
 	};
 
 	// GLYPH INFO DESCRIPTION
@@ -35,25 +34,19 @@ namespace guib {
 
 	struct GlyphInfo
 	{
-		// Info about each glyph stored in the atlas [0,1]
-		unsigned width=0;
-		unsigned height=0;
+		// Metrics in pixels at the atlas glyph size (FontLoader::getGlyphSize)
+		// The glyph rectangle includes the distance field border
+		float width=0;
+		float height=0;
+		float left=0;
+		float top=0;
+		float advance=0;
+
+		// Atlas region in pixels (only valid if resident)
 		unsigned x=0;
 		unsigned y=0;
-		unsigned left=0;
-		unsigned top=0;
-		unsigned advance=0;
+		bool resident=false;
 	};
-
-
-	struct FontTexture
-	{
-		// Atlas image texture and info about the font and glyphs
-		FontAtlas atlas;
-		std::vector<GlyphInfo> glyphsInfo = std::vector<GlyphInfo>(255);
-		int padding = 3;
-	};
-
 }
 
 #endif// GUIB_FONT_STRUCTS_H
@@ -0,0 +1,60 @@
+//--------------------------------------------------
+// GuiB
+// glyphAtlas.h
+// Date: 2021-07-23
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef GUIB_GLYPH_ATLAS_H
+#define GUIB_GLYPH_ATLAS_H
+
+#include <vector>
+#include <cstdint>
+
+namespace guib {
+	// Shelf packer of the font atlas with LRU eviction (CPU side only)
+	//
+	// Regions are allocated left to right in horizontal shelves (the shelf with the smallest height that fits is
+	// used). Each shelf stores when it was last used; when the atlas is full, the least recently used shelf that was
+	// not used in the current generation is cleared and the keys of its regions are returned to be evicted.
+	class GlyphAtlas
+	{
+		public:
+			struct Region
+			{
+				unsigned x;
+				unsigned y;
+				unsigned shelf;
+			};
+
+			GlyphAtlas(unsigned width, unsigned height);
+
+			// Returns false if there is no space (all shelves that could hold the region are in use)
+			bool allocate(uint32_t key, unsigned width, unsigned height, unsigned generation, Region& region, std::vector<uint32_t>& evicted);
+			void use(unsigned shelf, unsigned generation);
+
+			unsigned getWidth() const { return _width; }
+			unsigned getHeight() const { return _height; }
+
+			// Signed distance field from a coverage bitmap rasterized with oversample times the output resolution.
+			// The output has spread texels of border, 128 is the glyph edge (inside is brighter)
+			static void generateSdf(const uint8_t* coverage, int width, int height, int pitch, int oversample, int spread,
+					std::vector<uint8_t>& sdf, int& sdfWidth, int& sdfHeight);
+
+		private:
+			struct Shelf
+			{
+				unsigned y;
+				unsigned height;
+				unsigned x;// Next free x
+				unsigned lastUse;
+				std::vector<uint32_t> keys;
+			};
+
+			unsigned _width;
+			unsigned _height;
+			unsigned _nextShelfY;
+			std::vector<Shelf> _shelves;
+	};
+}
+
+#endif// GUIB_GLYPH_ATLAS_H
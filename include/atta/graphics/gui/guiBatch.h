@@ -0,0 +1,57 @@
+//--------------------------------------------------
+// Guib
+// guiBatch.h
+// Date: 2021-07-20
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef GUI_BATCH_H
+#define GUI_BATCH_H
+
+#include <vector>
+#include <memory>
+#include <atta/graphics/vulkan/device.h>
+#include <atta/graphics/vulkan/buffer.h>
+#include <atta/graphics/gui/guiStructs.h>
+
+namespace guib
+{
+	// Quads of one frame drawn with a single instanced draw (GuiObjectInfo is the instance data)
+	//
+	// Widgets append quads in render order and the order is kept, so overlapping quads blend as before. The texture
+	// index is per instance (bindless sampler array), so different textures do not split the draw. If the device does
+	// not support non uniform sampled image indexing, each run of quads with the same texture is drawn separately.
+	// Each swapchain image has its own persistently mapped instance buffer, grown when needed.
+	//
+	// The quads are retained between frames: after clear() and the new quads are added, each instance buffer
+	// is updated only once (on its next flush), an unchanged batch is drawn without copying.
+	class GuiBatch
+	{
+		public:
+			GuiBatch(std::shared_ptr<atta::vk::Device> device);
+			~GuiBatch();
+
+			void clear();
+			void addQuad(const GuiObjectInfo& quad) { _quads.push_back(quad); }
+			// frameIndex: swapchain image index
+			void flush(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+			size_t getQtyQuads() const { return _quads.size(); }
+
+		private:
+			struct FrameBuffer
+			{
+				std::shared_ptr<atta::vk::Buffer> buffer;
+				void* data = nullptr;
+				size_t capacity = 0;// In quads
+				unsigned version = 0;// Batch version copied to the buffer
+			};
+
+			std::shared_ptr<atta::vk::Device> _device;
+			bool _nonUniformIndexing;// false -> One draw per texture run
+			std::vector<FrameBuffer> _frames;
+			unsigned _version;// Incremented by clear()
+			std::vector<GuiObjectInfo> _quads;
+	};
+}
+
+#endif// GUI_BATCH_H
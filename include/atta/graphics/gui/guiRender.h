@@ -14,16 +14,23 @@
 #include <atta/graphics/gui/widgets/widgets.h>
 #include <atta/graphics/gui/font/fontLoader.h>
 #include <atta/graphics/gui/guiState.h>
+#include <atta/graphics/gui/guiBatch.h>
+#include <atta/graphics/gui/guiSpatialIndex.h>
 
 namespace guib
 {
+	// Retained mode: the widget tree is only traversed when state::version (or the focused widget) changed, otherwise
+	// the quads of the last traversal are drawn again. The layout is solved once by treePreProcess.
 	class GuiRender
 	{
 		public:
-			GuiRender(VkExtent2D _imageExtent, std::shared_ptr<atta::GuiPipelineLayout> _pipelineLayout, GLFWwindow* glfwWindow, std::shared_ptr<guib::FontLoader> fontLoader);
+			GuiRender(std::shared_ptr<atta::vk::Device> device, VkExtent2D _imageExtent, std::shared_ptr<atta::GuiPipelineLayout> _pipelineLayout, GLFWwindow* glfwWindow, std::shared_ptr<guib::FontLoader> fontLoader);
 			~GuiRender();
 
-			void render(VkCommandBuffer commandBuffer);
+			// frameIndex: swapchain image index (each one has its own quad buffer)
+			void render(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+			// Called by the widgets while rendering, the quads are drawn at the end of render()
+			void addQuad(const GuiObjectInfo& quad) { _batch.addQuad(quad); }
 			//void renderWidget(VkCommandBuffer commandBuffer, guib::Offset currOffset, guib::Size currSize, guib::Widget* widget);
 
 			// Window callbacks
@@ -43,9 +50,20 @@ namespace guib
 		private:
 			//void preProcessWidgetTree(guib::Widget* root);
 			void updateCursor(CursorType cursorType);
+			// Rebuild the click/drag area indices if some widget changed
+			void updateSpatialIndex();
 
 			std::shared_ptr<atta::GuiPipelineLayout> _pipelineLayout;
 			VkCommandBuffer _commandBuffer;
+			GuiBatch _batch;
+			unsigned _quadsVersion;// state::version of the quads in the batch
+			guib::Widget* _quadsFocusedWidget;
+
+			//---------- Hit-testing ----------//
+			GuiSpatialIndex _clickIndex;// Over state::clickableAreas
+			GuiSpatialIndex _dragIndex;// Over state::draggables (widget to hover)
+			GuiSpatialIndex _scrollIndex;// Over state::scrollables
+			unsigned _indexVersion;
 
 			//---------- GuiB window/viewport handling ----------//
 			VkExtent2D _imageExtent;
@@ -0,0 +1,47 @@
+//--------------------------------------------------
+// Guib
+// guiSpatialIndex.h
+// Date: 2021-07-21
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef GUI_SPATIAL_INDEX_H
+#define GUI_SPATIAL_INDEX_H
+
+#include <vector>
+#include <atta/graphics/gui/widgets/widgetStructs.h>
+
+namespace guib
+{
+	// Uniform grid over the screen (UNIT_SCREEN coordinates) used for hit-testing
+	//
+	// Each cell stores the areas overlapping it in insertion order. The area inserted last has priority
+	// (same result as the reverse linear scan over state::clickableAreas/state::draggables).
+	// Areas/points outside the screen are clamped to the border cells.
+	class GuiSpatialIndex
+	{
+		public:
+			GuiSpatialIndex(unsigned gridSize = 32);
+
+			void clear();
+			void insert(Offset offset, Size size);
+
+			// Index (insertion order) of the last inserted area containing the point, -1 if none
+			int find(Offset point) const;
+			size_t getQtyAreas() const { return _areas.size(); }
+
+		private:
+			struct Area
+			{
+				Offset offset;
+				Size size;
+			};
+
+			unsigned cellCoord(float value) const;
+
+			unsigned _gridSize;
+			std::vector<Area> _areas;
+			std::vector<std::vector<unsigned>> _cells;
+	};
+}
+
+#endif// GUI_SPATIAL_INDEX_H
@@ -26,6 +26,7 @@ namespace guib
 	class FontLoader;
 	class GuiRender;
 	class Draggable;
+	class ListView;
 	class Widget;
 
 	namespace state
@@ -44,6 +45,11 @@ namespace guib
 		extern float renderDepth;
 		extern guib::Widget* focusedWidget;// Last one to render to apply right transparency 
 
+		//---------- GuiB retained rendering ----------//
+		// The quads and the hit-testing index are only rebuilt when the version changes
+		extern unsigned version;
+		void invalidate();// Must be called when something that changes the rendered widgets/click areas is modified
+
 		//---------- GuiB special widget handler ----------//
 		// Handling ClickDetector
 		extern std::vector<guib::ClickDetectorArea> clickableAreas;
@@ -54,6 +60,9 @@ namespace guib
 		extern guib::Draggable* currDragging;
 		extern guib::Offset lastDraggingCursorPos;
 
+		// Handling scroll (ListView)
+		extern std::vector<guib::ListView*> scrollables;
+
 		//---------- GuiB font render ----------//
 		extern guib::FontLoader* fontLoader;
 
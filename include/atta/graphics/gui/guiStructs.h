@@ -7,7 +7,10 @@
 #ifndef GUI_STRUCTS_H
 #define GUI_STRUCTS_H
 #include <atta/math/math.h>
+#include <atta/graphics/vulkan/vulkan.h>
 #include <vector>
+#include <array>
+#include <cstddef>
 
 struct GuiUniformBufferObject
 {
@@ -25,6 +28,42 @@ struct GuiObjectInfo
 	alignas(4) int textureIndex = -1;
 	alignas(8) atta::vec2 offsetLetter = atta::vec2(0.0f, 0.0f);
 	alignas(8) atta::vec2 sizeLetter = atta::vec2(1.0f, 1.0f);
+
+	// Used as instance data (one quad per instance, see guib::GuiBatch)
+	static VkVertexInputBindingDescription getBindingDescription()
+	{
+		VkVertexInputBindingDescription bindingDescription{};
+		bindingDescription.binding = 0;
+		bindingDescription.stride = sizeof(GuiObjectInfo);
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+		return bindingDescription;
+	}
+
+	static std::array<VkVertexInputAttributeDescription, 8> getAttributeDescriptions()
+	{
+		std::array<VkVertexInputAttributeDescription, 8> attributeDescriptions{};
+		const std::array<std::pair<VkFormat, uint32_t>, 8> attributes = {{
+			{VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(GuiObjectInfo, position)},
+			{VK_FORMAT_R32G32_SFLOAT, offsetof(GuiObjectInfo, size)},
+			{VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(GuiObjectInfo, color)},
+			{VK_FORMAT_R32_SFLOAT, offsetof(GuiObjectInfo, radius)},
+			{VK_FORMAT_R32_SINT, offsetof(GuiObjectInfo, isLetter)},
+			{VK_FORMAT_R32_SINT, offsetof(GuiObjectInfo, textureIndex)},
+			{VK_FORMAT_R32G32_SFLOAT, offsetof(GuiObjectInfo, offsetLetter)},
+			{VK_FORMAT_R32G32_SFLOAT, offsetof(GuiObjectInfo, sizeLetter)}
+		}};
+
+		for(uint32_t i=0; i<attributes.size(); i++)
+		{
+			attributeDescriptions[i].binding = 0;
+			attributeDescriptions[i].location = i;
+			attributeDescriptions[i].format = attributes[i].first;
+			attributeDescriptions[i].offset = attributes[i].second;
+		}
+
+		return attributeDescriptions;
+	}
 };
 
 #endif// GUI_STRUCTS_H
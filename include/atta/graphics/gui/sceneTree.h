@@ -0,0 +1,79 @@
+//--------------------------------------------------
+// Robot Simulator
+// sceneTree.h
+// Date: 2021-07-22
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_GRAPHICS_GUI_SCENE_TREE_H
+#define ATTA_GRAPHICS_GUI_SCENE_TREE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <atta/core/scene.h>
+#include <atta/graphics/gui/widgets/listView.h>
+
+namespace atta
+{
+	// Rows of the scene tree list view
+	//
+	// Without filter, the rows are the object hierarchy (only expanded objects show their children).
+	// With filter, the rows are the objects (Scene::getObjectsFlat order) whose name contains the filter (case
+	// insensitive). The search is incremental: update() only checks a limited number of objects per call, and a
+	// filter that contains the previous one only searches the previous matches (plus the objects not checked yet).
+	class SceneTree
+	{
+		public:
+			SceneTree(std::shared_ptr<Scene> scene);
+
+			// Called by update() when objects are spawned/despawned
+			void rebuild();
+
+			void setFilter(std::string filter);
+			std::string getFilter() const { return _filter; }
+			// Continue the search (rebuild if the scene changed), returns true if the rows changed
+			// Must be called with the scene mutex locked
+			bool update(size_t maxObjects = 20000);
+			bool isSearching() const { return !_filter.empty() && _searchPos < _searchSource.size(); }
+
+			size_t getQtyRows() const;
+			guib::ListViewRow getRow(size_t row) const;
+			void toggle(size_t row);// Expand/collapse
+			void select(size_t row);
+			std::shared_ptr<Object> getSelected() const { return _selected; }
+
+		private:
+			struct Row
+			{
+				size_t object;// Index in _objectsFlat
+				unsigned depth;
+			};
+
+			size_t getObjectIndex(size_t row) const;
+			// Add the rows of the expanded children of object to rows
+			void addChildrenRows(size_t object, unsigned depth, std::vector<Row>& rows) const;
+
+			std::shared_ptr<Scene> _scene;
+			std::vector<std::shared_ptr<Object>> _objectsFlat;
+			std::vector<std::string> _names;// Lower case
+			std::unordered_map<Object*, size_t> _objectIndex;// Index in _objectsFlat
+			std::vector<std::vector<size_t>> _children;
+
+			// Hierarchy
+			std::vector<Row> _rows;
+			std::unordered_set<Object*> _expanded;
+
+			// Search
+			std::string _filter;// Lower case
+			std::vector<size_t> _searchSource;// Objects to check
+			size_t _searchPos;
+			std::vector<size_t> _matches;
+
+			std::shared_ptr<Object> _selected;
+			uint64_t _sceneVersion;// Scene version when rebuilt
+	};
+}
+
+#endif// ATTA_GRAPHICS_GUI_SCENE_TREE_H
@@ -9,6 +9,7 @@
 
 #include <iostream>
 #include <string>
+#include <chrono>
 
 #include <atta/graphics/vulkan/device.h>
 #include <atta/graphics/core/window.h>
@@ -24,6 +25,7 @@
 #include <atta/graphics/gui/guiRender.h>
 #include <atta/graphics/gui/widgets/widgets.h>
 #include <atta/graphics/gui/font/fontLoader.h>
+#include <atta/graphics/gui/sceneTree.h>
 
 namespace atta
 {
@@ -63,6 +65,9 @@ namespace atta
 		private:
 			void createWidgetTree();
 			void createTextures();
+			// Continue the scene tree search and sample the inspector values (throttled)
+			void updateSceneTree();
+			void updateInspector();
 			void copyRendererImage(VkCommandBuffer commandBuffer, int imageIndex, std::string rendererName, VkOffset2D dstOffset={0,0});
 
 			std::shared_ptr<vk::Device> _device;
@@ -87,6 +92,13 @@ namespace atta
 
 			//---------- GuiB font render ----------//
 			std::shared_ptr<guib::FontLoader> _fontLoader;
+
+			//---------- Scene tree/inspector ----------//
+			std::shared_ptr<SceneTree> _sceneTree;
+			guib::ListView* _sceneTreeView;
+			guib::Text* _sceneTreeSearchText;
+			std::vector<guib::Text*> _inspectorTexts;
+			std::chrono::steady_clock::time_point _lastInspectorUpdate;
 	};
 }
 
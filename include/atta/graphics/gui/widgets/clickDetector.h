@@ -40,9 +40,9 @@ namespace guib {
 			bool getHovering() const { return _hovering; }
 			bool getClicking() const { return _clicking; }
 			bool getRightClicking() const { return _rightClicking; }
-			void setHovering(bool hovering) { _hovering=hovering; }
-			void setClicking(bool clicking) { _clicking=clicking; }
-			void setRightClicking(bool rightClicking) { _rightClicking=rightClicking; }
+			void setHovering(bool hovering) { if(hovering!=_hovering) { _hovering=hovering; invalidate(); } }
+			void setClicking(bool clicking) { if(clicking!=_clicking) { _clicking=clicking; invalidate(); } }
+			void setRightClicking(bool rightClicking) { if(rightClicking!=_rightClicking) { _rightClicking=rightClicking; invalidate(); } }
 
 		private:
 			std::function<void()> _onClick;
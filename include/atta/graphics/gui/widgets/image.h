@@ -28,7 +28,7 @@ namespace guib {
 			void render() override;
 
 			//---------- Getters and Setters ----------//
-			void setColor(Color color) { _color=color; }
+			void setColor(Color color) { if(color!=_color) { _color=color; invalidate(); } }
 			Color getColor() const { return _color; }
 			BoxRadius getRadius() const { return _radius; }
 
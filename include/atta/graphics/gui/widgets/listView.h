@@ -0,0 +1,79 @@
+//--------------------------------------------------
+// GuiB
+// listView.h
+// Date: 2021-07-22
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef GUIB_LIST_VIEW_H
+#define GUIB_LIST_VIEW_H
+
+#include <atta/graphics/gui/widgets/widget.h>
+#include <atta/graphics/gui/widgets/box.h>
+#include <functional>
+
+namespace guib {
+	struct ListViewRow {
+		std::string text;
+		unsigned depth = 0;// Tree indentation
+		bool hasChildren = false;// Draws the expand/collapse arrow
+		bool expanded = false;
+		bool selected = false;
+	};
+
+	struct ListViewInfo {
+		Color color = {.25,.25,.25,1};
+		Color selectColor = {.4,.4,.4,1};
+		Color textColor = {1,1,1,1};
+		int rowHeight = 18;// Pixels
+		int textSize = 10;
+		int indent = 12;// Pixels per depth level
+		std::function<size_t()> getQtyRows;
+		std::function<ListViewRow(size_t row)> getRow;
+		std::function<void(size_t row)> onClickRow;
+		std::function<void(size_t row)> onToggleRow;// Clicked on the arrow
+		Offset offset = {0,0};
+		Size size = {1,1};
+	};
+
+	// Virtualized list/tree
+	//
+	// The rows are not widgets: only the visible ones are requested (getRow) and rendered, so the cost does not
+	// depend on the number of rows. Trees are flattened by the data source (depth/hasChildren/expanded).
+	// refresh() must be called when the rows change.
+	class ListView : public Widget
+	{
+		public:
+			ListView(ListViewInfo info);
+
+			void preProcess() override;
+			void render() override;
+
+			void scroll(float qtyRows);// Positive -> down
+			void refresh();// Data changed
+			void scrollTo(size_t row);// Only scrolls if the row is not visible
+
+			//---------- Getters and Setters ----------//
+			size_t getFirstVisibleRow() const { return _firstRow; }
+			size_t getQtyVisibleRows() const;
+
+		private:
+			void onClick();
+			float getRowHeight() const;// Screen coordinates
+			size_t getMaxFirstRow() const;
+
+			Color _selectColor;
+			Color _textColor;
+			int _rowHeight;
+			int _textSize;
+			int _indent;
+			std::function<size_t()> _getQtyRows;
+			std::function<ListViewRow(size_t)> _getRow;
+			std::function<void(size_t)> _onClickRow;
+			std::function<void(size_t)> _onToggleRow;
+
+			Box* _background;
+			size_t _firstRow;
+	};
+}
+
+#endif// GUIB_LIST_VIEW_H
@@ -9,6 +9,7 @@
 
 #include <atta/graphics/gui/widgets/widget.h>
 #include <atta/graphics/gui/widgets/widgetStructs.h>
+#include <limits>
 
 namespace guib {
 	struct TextInfo {
@@ -27,11 +28,17 @@ namespace guib {
 			void render() override;
 
 			//---------- Getters and Setters ----------//
-			void setColor(Color color) { _color=color; }
+			void setColor(Color color) { if(color!=_color) { _color=color; invalidate(); } }
 			Color getColor() const { return _color; }
+			// The widget size is not changed (it is calculated from the initial text)
+			void setText(std::string text) { if(text!=_text) { _text=text; invalidate(); } }
 			std::string getText() const { return _text; }
 			int getTextSize() const { return _textSize; }
 
+			// Add the glyph quads of a text line (screen coordinates, vertically centered in height)
+			// Glyphs that would pass offset.x+maxWidth are not added
+			static void renderText(const std::string& text, Offset offset, float height, int textSize, Color color, float maxWidth=std::numeric_limits<float>::max());
+
 		private:
 			Size calculateTextSize(std::string text, unsigned textSize);
 
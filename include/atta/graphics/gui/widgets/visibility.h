@@ -24,7 +24,7 @@ namespace guib {
 			void render() override;
 
 			//---------- Getters and Setters ----------//
-			void setVisible(bool visible) { _visible=visible; }
+			void setVisible(bool visible) { if(visible!=_visible) { _visible=visible; invalidate(); } }
 			bool getVisible() const { return _visible; }
 
 		private:
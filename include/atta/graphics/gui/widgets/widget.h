@@ -32,15 +32,15 @@ namespace guib {
 			virtual void addOffsetTree(Offset offset);
 
 			//---------- Getters and Setters ----------//
-			void setChild(Widget* child) { _child=child; }
+			void setChild(Widget* child) { if(child!=_child) { _child=child; invalidate(); } }
 			Widget* getChild() const { return _child; }
 			void setParent(Widget* parent) { _parent=parent; }
 			Widget* getParent() const { return _parent; }
 			std::string getType() const { return _type; }
-			void setSize(Size size) { _size=size; }
+			void setSize(Size size) { if(size!=_size) { _size=size; invalidate(); } }
 			Size getSize() const { return _size; }
 			Size& getSize() { return _size; }
-			void setOffset(Offset offset) { _offset=offset; }
+			void setOffset(Offset offset) { if(offset!=_offset) { _offset=offset; invalidate(); } }
 			Offset getOffset() const { return _offset; }
 			Offset& getOffset() { return _offset; }
 
@@ -52,6 +52,8 @@ namespace guib {
 
 		protected:
 			void setType(std::string type) { _type=type; }
+			// Rendered quads/click areas changed (next frame rebuilds them)
+			void invalidate();
 			Widget** getChildPtr() { return &_child; }
 			void getParentSizeOffset(Size &pSize, Offset &pOffset);
 
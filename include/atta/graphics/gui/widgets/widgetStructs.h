@@ -16,6 +16,16 @@ namespace guib
 		float g=1;
 		float b=1;
 		float a=1;
+
+		bool operator==(const Color& o) const
+		{
+			return r==o.r && g==o.g && b==o.b && a==o.a;
+		}
+
+		bool operator!=(const Color& o) const
+		{
+			return !(*this == o);
+		}
 	};
 
 	enum Alignment
@@ -64,6 +74,16 @@ namespace guib
 			return {x-o.x, y-o.y, unitX, unitY};
 		}
 
+		bool operator==(const Offset& o) const
+		{
+			return x==o.x && y==o.y && unitX==o.unitX && unitY==o.unitY;
+		}
+
+		bool operator!=(const Offset& o) const
+		{
+			return !(*this == o);
+		}
+
 		std::string toString()
 		{
 			std::string strUX = "UNIT_PERCENT";
@@ -113,6 +133,16 @@ namespace guib
 			return *this;
 		}
 
+		bool operator==(const Size& s) const
+		{
+			return width==s.width && height==s.height && unitW==s.unitW && unitH==s.unitH;
+		}
+
+		bool operator!=(const Size& s) const
+		{
+			return !(*this == s);
+		}
+
 		std::string toString()
 		{
 			std::string strUW = "UNIT_PERCENT";
@@ -26,5 +26,6 @@
 #include <atta/graphics/gui/widgets/topBar.h>
 #include <atta/graphics/gui/widgets/menuButton.h>
 #include <atta/graphics/gui/widgets/menuItem.h>
+#include <atta/graphics/gui/widgets/listView.h>
 
 #endif// GUIB_WIDGETS_H
@@ -31,8 +31,14 @@ namespace atta::vk
 
 			void render(VkCommandBuffer commandBuffer, int imageIndex=0);
 
+			// Level of detail selection (see Mesh::selectLod)
+			void setLodView(vec3 cameraPosition, float projectionScale);
+
 		private:
-			void renderObjectAndChildren(VkCommandBuffer commandBuffer, std::shared_ptr<Object> object);
+			void renderObject(VkCommandBuffer commandBuffer, const Object* object, const Model* model);
+
+			vec3 _cameraPosition;
+			float _projectionScale;
 	};
 }
 
@@ -45,6 +45,7 @@ namespace atta
 			void createRenderPass();
 			void createFrameBuffers();
 			void createPipelines();
+			void updateLodView();
 
 			std::shared_ptr<Scene> _scene;
 			std::shared_ptr<vk::UniformBuffer> _uniformBuffer;
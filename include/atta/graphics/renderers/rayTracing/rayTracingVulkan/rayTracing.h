@@ -54,19 +54,25 @@ namespace atta::rt::vk
 		private:
 			void createPipeline();
 			void createAccelerationStructures();
+			// Only for the meshes without a bottom level structure
 			void createBottomLevelStructures(VkCommandBuffer commandBuffer);
+			// Instances and object infos of the objects currently in the scene (same order, gl_InstanceID)
 			void createTopLevelStructures(VkCommandBuffer commandBuffer);
+			// Objects spawned/despawned (called with the scene mutex locked)
+			void updateSceneStructures();
 			void createAccumulationImage();
 
 			std::shared_ptr<atta::vk::Device> _device;
 			std::shared_ptr<rt::vk::UniformBuffer> _uniformBuffer;
 			std::shared_ptr<Scene> _scene;
+			uint64_t _sceneVersion;// Scene version of the acceleration structures
 
 			std::shared_ptr<RayTracingProperties> _rayTracingProperties;
 			std::shared_ptr<DeviceProcedures> _deviceProcedures;
 
 			// Ray Tracing objects
 			std::vector<std::shared_ptr<BottomLevelAccelerationStructure>> _blas;
+			std::vector<int> _meshBlas;// Blas of each Mesh::getIndex() (-1 if not created)
 			std::vector<std::shared_ptr<TopLevelAccelerationStructure>> _tlas;
 
 			// Ray Tracing pipeline
@@ -80,11 +86,12 @@ namespace atta::rt::vk
 			std::shared_ptr<atta::vk::ImageView> _accumulationImageView;
 			
 			// Ray tracing buffers
-			std::shared_ptr<atta::vk::Buffer> _bottomBuffer;
+			std::vector<std::shared_ptr<atta::vk::Buffer>> _bottomBuffers;// One for each group of meshes built together
 			std::shared_ptr<atta::vk::Buffer> _bottomScratchBuffer;
 			std::shared_ptr<atta::vk::Buffer> _topBuffer;
 			std::shared_ptr<atta::vk::Buffer> _topScratchBuffer;
 			std::shared_ptr<atta::vk::Buffer> _instancesBuffer;
+			std::shared_ptr<atta::vk::Buffer> _objectInfoBuffer;
 	};
 }
 
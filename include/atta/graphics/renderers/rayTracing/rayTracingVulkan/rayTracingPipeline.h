@@ -26,12 +26,16 @@ namespace atta::rt::vk
 				std::shared_ptr<atta::vk::Device> device,
 				std::shared_ptr<DeviceProcedures> deviceProcedures,
 				std::shared_ptr<TopLevelAccelerationStructure> accelerationStructure,
+				std::shared_ptr<atta::vk::Buffer> objectInfoBuffer,
 				std::shared_ptr<atta::vk::ImageView> accumulationImageView,
 				std::shared_ptr<atta::vk::ImageView> outputImageView,
 				std::shared_ptr<rt::vk::UniformBuffer> uniformBuffer,
 				std::shared_ptr<atta::vk::VulkanCore> vkCore);
 			~RayTracingPipeline();
 
+			// Bind the structures rebuilt after the scene changed (the descriptor set must not be in use)
+			void updateScene(std::shared_ptr<TopLevelAccelerationStructure> accelerationStructure, std::shared_ptr<atta::vk::Buffer> objectInfoBuffer);
+
 			uint32_t getRayGenShaderIndex() const { return _rayGenIndex; }
 			uint32_t getMissShaderIndex() const { return _missIndex; }
 			uint32_t getMissShadowShaderIndex() const { return _missShadowIndex; }
@@ -28,7 +28,7 @@ namespace atta
 			void render(VkCommandBuffer commandBuffer, int imageIndex=0);
 
 		private:
-			void renderObjectAndChildren(VkCommandBuffer commandBuffer, std::shared_ptr<Object> object);
+			void renderObject(VkCommandBuffer commandBuffer, const Object* object, const Model* model);
 	};
 }
 
@@ -9,6 +9,7 @@
 
 #include <iostream>
 #include <string.h>
+#include <vector>
 #include <atta/graphics/vulkan/device.h>
 #include <atta/graphics/vulkan/commandPool.h>
 
@@ -26,6 +27,8 @@ namespace atta::vk
 			VkDeviceAddress getDeviceAddress() const;
 
 			void copyFrom(std::shared_ptr<CommandPool> commandPool, VkBuffer srcBuffer, VkDeviceSize size);
+			// Copy multiple ranges with one submission
+			void copyFrom(std::shared_ptr<CommandPool> commandPool, VkBuffer srcBuffer, const std::vector<VkBufferCopy>& regions);
 
 			void* mapMemory(const size_t offset, const size_t size);
 			void unmapMemory();
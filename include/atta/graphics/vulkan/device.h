@@ -13,6 +13,8 @@
 #include <set>
 #include <string>
 #include <memory>
+#include <map>
+#include <mutex>
 #include <atta/graphics/vulkan/physicalDevice.h>
 
 namespace atta::vk
@@ -31,6 +33,8 @@ namespace atta::vk
 			VkQueue getPresentQueueGUI() const { return _presentQueueGUI; }
 			VkQueue getGraphicsQueueGUI() const { return _graphicsQueueGUI; }
 			VkQueue getTransferQueueGUI() const { return _transferQueueGUI; }
+			// Queue access must be externally synchronized (the texture streamer submits from its own thread)
+			std::recursive_mutex& getQueueMutex(VkQueue queue) { return *_queueMutexes.at(queue); }
 
 			VkSampleCountFlagBits getMsaaSamples() const { return _msaaSamples; }
 
@@ -44,6 +48,7 @@ namespace atta::vk
 			VkQueue _presentQueueGUI;
 			VkQueue _graphicsQueueGUI;
 			VkQueue _transferQueueGUI;
+			std::map<VkQueue, std::unique_ptr<std::recursive_mutex>> _queueMutexes;// One mutex per distinct queue handle
 
 			std::shared_ptr<PhysicalDevice> _physicalDevice;
 			VkSampleCountFlagBits _msaaSamples;
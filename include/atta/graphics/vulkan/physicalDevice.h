@@ -38,6 +38,8 @@ namespace atta::vk
 		bool differentQueuesThreadManagerGUI = false;// true -> Thread manager and GUI do not need synchronization (TODO not being used)
 		bool samplerAnisotropyFeature = false;// true -> Samplers can do anisotropic filtering
 		bool fillModeNonSolidFeature = false;// true -> Can draw lines and points
+		bool textureCompressionBCFeature = false;// true -> Can sample BC compressed textures
+		bool sampledImageNonUniformIndexingFeature = false;// true -> Sampler arrays can be indexed with non uniform indices
 	};
 
 
@@ -50,6 +52,8 @@ namespace atta::vk
 			WARN_NO_DEDICATED_TRANSFER_QUEUE_FAMILY,
 			WARN_NO_SAMPLER_ANISOTROPY_FEATURE_SUPPORT,
 			WARN_NO_FILL_MODE_NON_SOLID_FEATURE_SUPPORT,
+			WARN_NO_TEXTURE_COMPRESSION_BC_FEATURE_SUPPORT,
+			WARN_NO_SAMPLED_IMAGE_NON_UNIFORM_INDEXING_FEATURE_SUPPORT,
 			ERROR_REQUIRED_QUEUE_FAMILIES_NOT_FOUND=1000,
 		};
 
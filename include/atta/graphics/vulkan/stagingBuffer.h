@@ -23,11 +23,16 @@ namespace atta::vk
 			//StagingBuffer(std::shared_ptr<Device> device, std::vector<T>& content);
 
 			StagingBuffer(std::shared_ptr<Device> device, void* dataToMap, VkDeviceSize size);
+			// Persistently mapped staging buffer (reused between uploads, write to getData())
+			StagingBuffer(std::shared_ptr<Device> device, VkDeviceSize size);
 			~StagingBuffer();
 
 			void mapFromData(std::shared_ptr<Device> device, void* dataToMap, VkDeviceSize size);
 
+			void* getData() const { return _data; }
+
 		private:
+			void* _data;
 	};
 }
 
@@ -16,6 +16,7 @@
 #include <atta/graphics/vulkan/imageView.h>
 #include <atta/graphics/vulkan/sampler.h>
 #include <atta/graphics/core/texture.h>
+#include <atta/graphics/core/textureCache.h>
 
 namespace atta::vk
 {
@@ -28,7 +29,9 @@ namespace atta::vk
 					VkExtent2D size, 
 					VkFormat format = VK_FORMAT_R8G8B8A8_SRGB, 
 					VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
-			Texture(std::shared_ptr<Device> device, std::shared_ptr<CommandPool> commandPool, void* buffer, VkExtent2D size, atta::Texture::Format format, bool editable=true);
+			Texture(std::shared_ptr<Device> device, std::shared_ptr<CommandPool> commandPool, void* buffer, VkExtent2D size, atta::Texture::Format format, bool editable=true, bool mipmaps=true);
+			// Streamed texture: created with its final size and mip chain and filled with a placeholder until the streamer uploads it
+			Texture(std::shared_ptr<Device> device, std::shared_ptr<CommandPool> commandPool, TextureData::Format format, VkExtent2D size);
 			~Texture();
 
 			std::shared_ptr<Device> getDevice() const { return _device; }
@@ -37,6 +40,14 @@ namespace atta::vk
 			std::shared_ptr<Sampler> getSampler() const { return _sampler; }
 
 			void updateImage(void* data);
+			// Record the copy of the mip chain from the buffer (data.levels layout), discarding the previous content. The image
+			// ownership is released from srcQueueFamily (recording queue) to dstQueueFamily (VK_QUEUE_FAMILY_IGNORED if the same)
+			void recordUploadLevels(VkCommandBuffer commandBuffer, VkBuffer buffer, const TextureData& data, uint32_t srcQueueFamily, uint32_t dstQueueFamily);
+			// Record the ownership acquire matching recordUploadLevels on a dstQueueFamily queue
+			void recordAcquire(VkCommandBuffer commandBuffer, uint32_t srcQueueFamily, uint32_t dstQueueFamily);
+			// Copy regions of the base level from the buffer keeping the rest of the image, must be called with the texture locked
+			void updateRegions(std::shared_ptr<CommandPool> commandPool, VkBuffer buffer, const std::vector<VkBufferImageCopy>& regions);
+			static VkFormat toVulkan(TextureData::Format format);
 			void lock() { if(_editable) _mtx.lock(); }
 			void unlock() { if(_editable) _mtx.unlock(); }
 
@@ -46,6 +57,7 @@ namespace atta::vk
 			void copyBufferToCubeMapImages(VkBuffer buffer, uint32_t width, uint32_t height);
 			void copyEquToCubeMapImages(float* buffer, uint32_t width, uint32_t height);
 			void generateMipmaps();
+			void copyLevels(std::shared_ptr<CommandPool> commandPool, VkBuffer buffer, const std::vector<VkBufferImageCopy>& regions, bool keepContent=false);
 
 			std::shared_ptr<Device> _device;
 			std::shared_ptr<CommandPool> _commandPool;
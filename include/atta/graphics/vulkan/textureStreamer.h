@@ -0,0 +1,115 @@
+//--------------------------------------------------
+// Atta Graphics
+// textureStreamer.h
+// Date: 2021-07-18
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_GRAPHICS_VULKAN_TEXTURE_STREAMER_H
+#define ATTA_GRAPHICS_VULKAN_TEXTURE_STREAMER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atta/graphics/vulkan/device.h>
+#include <atta/graphics/vulkan/commandPool.h>
+#include <atta/graphics/vulkan/semaphore.h>
+#include <atta/graphics/vulkan/fence.h>
+#include <atta/graphics/vulkan/stagingBuffer.h>
+#include <atta/graphics/vulkan/texture.h>
+#include <atta/graphics/core/textureCache.h>
+
+namespace atta::vk
+{
+	// Asynchronous texture file loading
+	//
+	// load() only reads the file header and returns a texture with its final size, format and mip chain filled with a
+	// placeholder (descriptor sets never need to be updated). The decode threads load the mip chain from the texture
+	// cache (or import the file and write the cache), and the upload thread copies it using the transfer queue.
+	//
+	// Each upload is ordered with the graphics queues (GUI and thread manager) only with semaphores and barriers:
+	// - The graphics queues signal when the work already submitted finished (nothing is sampling the placeholder)
+	// - The transfer queue copies the mip chain and releases the image to the graphics queue family
+	// - The GUI queue acquires the image, and the thread manager queue waits for the acquire
+	// The queues are only held while these batches are submitted, so the same submissions of both graphics queues come
+	// before and after the copy. The upload thread waits for the fences before the next upload.
+	class TextureStreamer
+	{
+		public:
+			struct CreateInfo
+			{
+				std::shared_ptr<Device> device;
+				unsigned qtyDecodeThreads = 0;// 0 -> hardware concurrency-1
+			};
+
+			TextureStreamer(CreateInfo info);
+			~TextureStreamer();
+
+			// Fatal error if the file header can not be read (same behavior as loading the texture synchronously)
+			std::shared_ptr<Texture> load(std::shared_ptr<CommandPool> commandPool, const std::string& fileName);
+
+			// Called by the upload thread after the texture is uploaded (with the texture locked). If the texture is not being
+			// streamed, it is called now by the caller thread.
+			void addLoadedCallback(std::shared_ptr<Texture> texture, std::function<void()> callback);
+
+			// Block until all requested textures are uploaded (or cancelled by the destructor)
+			void waitIdle();
+
+		private:
+			struct Job
+			{
+				std::shared_ptr<Texture> texture;
+				std::string fileName;
+				TextureData::Format format;
+				TextureData data;
+			};
+
+			void decodeThread();
+			void uploadThread();
+			void upload(Job& job);
+			void finish(Job& job);
+			VkCommandBuffer createCommandBuffer(std::shared_ptr<CommandPool> commandPool);
+
+			std::shared_ptr<Device> _device;
+			bool _compress;
+			std::vector<std::thread> _decodeThreads;
+			std::thread _uploadThread;
+
+			std::mutex _mutex;
+			std::condition_variable _decodeCv;
+			std::condition_variable _uploadCv;
+			std::condition_variable _idleCv;
+			std::deque<Job> _decodeJobs;
+			std::deque<Job> _uploadJobs;
+			bool _stop;
+			std::map<Texture*, std::vector<std::function<void()>>> _callbacks;
+			std::set<Texture*> _streaming;// Requested but not uploaded
+
+			// Only used by the upload thread
+			uint32_t _graphicsFamily;
+			uint32_t _transferFamily;
+			std::shared_ptr<CommandPool> _transferCommandPool;
+			std::shared_ptr<CommandPool> _guiCommandPool;
+			std::shared_ptr<CommandPool> _graphicsCommandPool;
+			VkCommandBuffer _transferCommandBuffer;
+			VkCommandBuffer _guiCommandBuffer;// Acquire (recorded for each texture)
+			VkCommandBuffer _guiBarrier;
+			VkCommandBuffer _graphicsBarrier;// Submitted before and after the copy
+			std::unique_ptr<Semaphore> _guiIdle;
+			std::unique_ptr<Semaphore> _graphicsIdle;
+			std::unique_ptr<Semaphore> _uploaded;
+			std::unique_ptr<Semaphore> _acquired;
+			std::unique_ptr<Fence> _guiFence;
+			std::unique_ptr<Fence> _graphicsFence;
+			std::unique_ptr<StagingBuffer> _stagingBuffer;
+			VkDeviceSize _stagingSize;
+	};
+}
+
+#endif// ATTA_GRAPHICS_VULKAN_TEXTURE_STREAMER_H
@@ -9,12 +9,15 @@
 
 #include <vector>
 #include <memory>
+#include <map>
+#include <unordered_map>
 #include <atta/graphics/vulkan/instance.h>
 #include <atta/graphics/vulkan/debugMessenger.h>
 #include <atta/graphics/vulkan/physicalDevice.h>
 #include <atta/graphics/vulkan/device.h>
 #include <atta/graphics/vulkan/buffer.h>
 #include <atta/graphics/vulkan/texture.h>
+#include <atta/graphics/vulkan/textureStreamer.h>
 #include <atta/graphics/core/texture.h>
 #include <atta/core/scene.h>
 
@@ -34,38 +37,71 @@ namespace atta::vk
 			std::shared_ptr<Buffer> getVertexBuffer() const { return _vertexBuffer; }
 			std::shared_ptr<Buffer> getIndexBuffer() const { return _indexBuffer; }
 			std::shared_ptr<Buffer> getMaterialBuffer() const { return _materialBuffer; }
-			std::shared_ptr<Buffer> getObjectInfoBuffer() const { return _objectInfoBuffer; }
 			std::shared_ptr<Buffer> getLightBuffer() const { return _lightBuffer; }
 			std::shared_ptr<Buffer> getLineBuffer() const { return _lineBuffer; }
 			std::shared_ptr<Buffer> getPointBuffer() const { return _pointBuffer; }
 
 			std::vector<std::shared_ptr<vk::Texture>> getTextures() const { return _textures; }
+			TextureStreamer* getTextureStreamer() const { return _textureStreamer.get(); }
 
 			void createBuffers(std::shared_ptr<Scene> scene, std::shared_ptr<CommandPool> commandPool);
-			void updateBuffers(std::shared_ptr<Scene> scene, std::shared_ptr<CommandPool> commandPool);
+			// Upload the meshes/materials of the spawned objects and release the materials of the despawned ones
+			// (must be called with the scene mutex locked, before the spawned objects are rendered)
+			void updateBuffers(const Scene::Changes& changes, std::shared_ptr<CommandPool> commandPool);
 
 		private:
+			struct MeshRange
+			{
+				uint32_t vertexOffset;
+				uint32_t indexOffset;
+				uint32_t lodIndicesOffset;
+			};
+
+			struct MaterialRange
+			{
+				uint32_t offset;
+				uint32_t qtyMaterials;
+			};
+
+			void addMesh(Mesh* mesh, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+			static std::vector<Material> getModelMaterials(Model* model);
+			bool allocateMaterials(uint32_t qtyMaterials, MaterialRange& range);
+
 			template <class T>
 			std::shared_ptr<Buffer> createBufferMemory(std::shared_ptr<CommandPool> commandPool,
 					const VkBufferUsageFlags usage, 
-					std::vector<T>& content);
+					std::vector<T>& content, size_t capacity = 0);
+			template <class T>
+			void writeBufferMemory(std::shared_ptr<CommandPool> commandPool, std::shared_ptr<Buffer> buffer,
+					std::vector<T>& content, const std::vector<VkBufferCopy>& regions);
 
 			std::shared_ptr<Instance> _instance;
 			std::unique_ptr<DebugMessenger> _debugMessenger;
 			std::shared_ptr<PhysicalDevice> _physicalDevice;
 			std::shared_ptr<Device> _device;
+			std::unique_ptr<TextureStreamer> _textureStreamer;
 
 			// Buffers
 			std::shared_ptr<Buffer> _vertexBuffer;
 			std::shared_ptr<Buffer> _indexBuffer;
 			std::shared_ptr<Buffer> _materialBuffer;
-			std::shared_ptr<Buffer> _objectInfoBuffer;
 			std::shared_ptr<Buffer> _lightBuffer;
 
 			// Aux/Debug buffers
 			std::shared_ptr<Buffer> _lineBuffer;
 			std::shared_ptr<Buffer> _pointBuffer;
 
+			// Used/reserved space (elements)
+			static constexpr size_t minVertexCapacity = 1<<16;
+			static constexpr size_t minIndexCapacity = 1<<18;
+			static constexpr size_t minMaterialCapacity = 1<<10;
+			size_t _qtyVertices, _vertexCapacity;
+			size_t _qtyIndices, _indexCapacity;
+			size_t _qtyMaterials, _materialCapacity;
+			std::map<std::string, MeshRange> _meshRanges;// Uploaded meshes (by mesh name)
+			std::unordered_map<const Model*, MaterialRange> _materialRanges;
+			std::vector<MaterialRange> _freeMaterialRanges;
+
 			// Texture images
 			std::vector<std::shared_ptr<vk::Texture>> _textures;
 	};
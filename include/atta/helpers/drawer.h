@@ -9,9 +9,12 @@
 
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <atta/math/math.h>
 #include <atta/graphics/vulkan/vulkanCore.h>
 #include <atta/graphics/vulkan/commandPool.h>
+#include <atta/graphics/vulkan/stagingBuffer.h>
 
 namespace atta
 {
@@ -33,6 +36,10 @@ namespace atta
 				alignas(16) vec4 c = vec4(1,0,1,1);
 			};
 
+			// Lines and points are drawn in groups (each group can be cleared independently)
+			using GroupHandle = uint32_t;
+			static constexpr GroupHandle defaultGroup = 0;
+
 			Drawer(const Drawer&) = delete;
         	void operator=(const Drawer&) = delete;
 
@@ -42,70 +49,107 @@ namespace atta
 				return drawer;
 			}
 
-			// Drawer for debugging
-			static void addLine(Line line) { get().addLineImpl(line); }
-			static void addLine(std::string group, Line line) { get().addLineImpl(group, line); }
-			static void addPoint(Point point) { get().addPointImpl(point); }
+			// Drawer for debugging (can be called from multiple threads without locking)
+			// The data is appended to a buffer owned by the calling thread and merged in updateBufferMemory
+			// Clearing removes the uploaded data and the data added before by the calling thread (data added in this
+			// frame by other threads is kept, there is no order between threads until the merge)
+			static void addLine(Line line) { get().addLineImpl(defaultGroup, line); }
+			static void addLine(GroupHandle group, Line line) { get().addLineImpl(group, line); }
+			static void addPoint(Point point) { get().addPointImpl(defaultGroup, point); }
+			static void addPoint(GroupHandle group, Point point) { get().addPointImpl(group, point); }
+			static void addPoints(GroupHandle group, const std::vector<Point>& points) { get().addPointsImpl(group, points); }
+			static void clearGroup(GroupHandle group) { get().clearGroupImpl(group); }
 			static void clear() { get().clearImpl(); }
+			// Returns the handle of the group with this name (created if necessary)
+			static GroupHandle createGroup(std::string name) { return get().createGroupImpl(name); }
 
 			// Get line data to render
-			static std::vector<Line>& getLines() { return get().getLinesImpl(); }
 			static unsigned getMaxNumberOfLines() { return get().getMaxNumberOfLinesImpl(); }
-			static unsigned getCurrNumberOfLines() { return get().getCurrNumberOfLinesImpl(); }
 			static unsigned getCurrNumberOfLinesMemory() { return get().getCurrNumberOfLinesMemoryImpl(); }
 
 			// Get point data to render
-			static std::vector<Point>& getPoints() { return get().getPointsImpl(); }
 			static unsigned getMaxNumberOfPoints() { return get().getMaxNumberOfPointsImpl(); }
-			static unsigned getCurrNumberOfPoints() { return get().getCurrNumberOfPointsImpl(); }
 			static unsigned getCurrNumberOfPointsMemory() { return get().getCurrNumberOfPointsMemoryImpl(); }
 
-			// Update buffer memory
+			// Update buffer memory (must not run while other threads are adding lines/points, called between stages)
 			static void updateBufferMemory(std::shared_ptr<vk::VulkanCore> vkCore, std::shared_ptr<vk::CommandPool> commandPool) { return get().updateBufferMemoryImpl(vkCore, commandPool); }
 
 		private:
+			// Data added by one thread since the last update
+			struct ThreadBuffer
+			{
+				std::vector<std::vector<Line>> lines;// Indexed by group handle
+				std::vector<std::vector<Point>> points;
+				std::vector<GroupHandle> clearedGroups;
+				bool clearAll = false;
+				bool exited = false;// Owner thread exited, removed after the next merge
+			};
+
+			// Merged data of one group (kept between frames)
+			struct Group
+			{
+				std::string name;
+				std::vector<Line> lines;
+				std::vector<Point> points;
+				bool linesChanged = false;
+				bool pointsChanged = false;
+				unsigned lineOffset = 0;// Position in the device buffer
+				unsigned pointOffset = 0;
+			};
+
+			// Host visible buffer used to upload only the changed ranges (the copy is waited, so one is enough)
+			struct Staging
+			{
+				std::shared_ptr<vk::StagingBuffer> buffer;
+				void* data = nullptr;// Persistently mapped
+				size_t size = 0;
+			};
+
 			Drawer(): 
 				_maxNumberOfLines(100000),
-				_maxNumberOfPoints(1000000),
-				_currNumberOfLines(0),
 				_currNumberOfLinesMemory(0),
-				_linesChanged(false),
-				_currNumberOfPoints(0),
+				_maxNumberOfPoints(1000000),
 				_currNumberOfPointsMemory(0)
 			{
-				_lines.resize(_maxNumberOfLines);
-				_points.resize(_maxNumberOfPoints);
+				_groups.emplace_back();
+				_groups.back().name = "atta";
 			};
 
 			// Core impl
 			void clearImpl();
+			void clearGroupImpl(GroupHandle group);
+			GroupHandle createGroupImpl(std::string name);
 			void updateBufferMemoryImpl(std::shared_ptr<vk::VulkanCore> vkCore, std::shared_ptr<vk::CommandPool> commandPool);
+			ThreadBuffer& getThreadBuffer();
+			// Move the thread buffers to the groups, returns true if some group changed
+			bool mergeThreadBuffers();
+			// Write the changed groups to the staging memory (returns the copy regions to the device buffer)
+			template <typename T>
+			std::vector<VkBufferCopy> stageGroups(std::vector<T> Group::*data, bool Group::*changed, unsigned Group::*offset,
+					unsigned maxNumber, unsigned& currNumber, Staging& staging, std::shared_ptr<vk::Device> device);
 
 			// Line impl
-			void addLineImpl(Line line);
-			void addLineImpl(std::string group, Line line);
-			std::vector<Line>& getLinesImpl() { return _lines; }
+			void addLineImpl(GroupHandle group, Line line);
 			unsigned getMaxNumberOfLinesImpl() { return _maxNumberOfLines; }
-			unsigned getCurrNumberOfLinesImpl() { return _currNumberOfLines; }
 			unsigned getCurrNumberOfLinesMemoryImpl() { return _currNumberOfLinesMemory; }
 
 			// Point impl
-			void addPointImpl(Point point);
-			std::vector<Point>& getPointsImpl() { return _points; }
+			void addPointImpl(GroupHandle group, Point point);
+			void addPointsImpl(GroupHandle group, const std::vector<Point>& points);
 			unsigned getMaxNumberOfPointsImpl() { return _maxNumberOfPoints; }
-			unsigned getCurrNumberOfPointsImpl() { return _currNumberOfPoints; }
 			unsigned getCurrNumberOfPointsMemoryImpl() { return _currNumberOfPointsMemory; }
 
-			std::vector<Line> _lines;
-			std::map<std::string, std::vector<Line>> _lineGroups;
 			unsigned _maxNumberOfLines;
-			unsigned _currNumberOfLines;
 			unsigned _currNumberOfLinesMemory;
-			bool _linesChanged;
-			std::vector<Point> _points;
 			unsigned _maxNumberOfPoints;
-			unsigned _currNumberOfPoints;
 			unsigned _currNumberOfPointsMemory;
+
+			std::mutex _mutex;// Protects groups and thread buffer registration (not used when adding data)
+			std::vector<Group> _groups;
+			std::vector<std::unique_ptr<ThreadBuffer>> _threadBuffers;
+
+			Staging _lineStaging;
+			Staging _pointStaging;
 	};
 }
 #endif// ATTA_HELPERS_DRAWER_H
@@ -9,40 +9,13 @@
 
 #include <string>
 #include <chrono>
-#include <map>
+#include <cstdint>
 
 namespace atta
 {
-	// Used to obtain global stats on simulator performance
-	// (Must deal with concurrency updates by the threads)
-	class Evaluator
-	{
-		public:
-			Evaluator(const Evaluator&) = delete;
-        	void operator=(const Evaluator&) = delete;
-
-			static Evaluator& get()
-			{
-				static Evaluator instance;
-				return instance;
-			}
-
-			static void reportCounter(std::string name, int64_t val=1) { get().reportCounterImpl(name, val); } 
-			static void showReports() { get().showReportsImpl(); }
-			static void clear() { get().clearImpl(); }
-
-		private:
-			Evaluator(){}
-
-			void reportCounterImpl(std::string name, int64_t val);
-			void showReportsImpl();
-			void clearImpl();
-
-    		std::map<std::string, int64_t> _counters;
-	};
-
 	// Used to obtain stats that will be displayed at the end of the scope
 	// Ex: Time to load model mesh
+	// (Per frame timings should use ATTA_PROFILE_ZONE from atta/helpers/profiler.h)
 	class LocalEvaluator
 	{
 		public:
@@ -58,6 +31,9 @@ namespace atta
 			bool _finished;
 			std::chrono::time_point<std::chrono::high_resolution_clock> _startTime;
 			long long int _duration;
+#ifdef ATTA_PROFILER
+			uint64_t _profilerStart;
+#endif
 	};
 }
 #endif// ATTA_HELPERS_EVALUATOR_H
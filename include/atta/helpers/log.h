@@ -6,10 +6,12 @@
 //----------------------------------------
 #ifndef ATTA_HELPERS_LOG_H
 #define ATTA_HELPERS_LOG_H
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
-#include <tuple>
-#include <iostream>
 //---------------------------------//
 //---------- Description ----------//
 //---------------------------------//
@@ -64,6 +66,10 @@
 //---------------------------------//
 //----------- Log class -----------//
 //---------------------------------//
+// Log calls only copy the arguments to a queue owned by the calling thread (no formatting, no I/O),
+// a background thread formats and writes them in order. Literal tags/texts are not copied and their
+// format is parsed once. Errors that do not fit in the queue and messages logged after exit() (or while
+// the thread is exiting) are written synchronously. The queue of a thread is released after it exits.
 class Log
 {
 	public:
@@ -78,57 +84,116 @@ class Log
 		};
 		const static LogLevel logLevel = LOG_LEVEL_DEBUG;
 
-		template<class...Args>
-		static void verbose(std::string tag, std::string text, Args&&... args)
+		template<class Tag, class Text, class...Args>
+		static void verbose(Tag&& tag, Text&& text, Args&&... args)
 		{
 			if(logLevel<=LOG_LEVEL_VERBOSE)
-				log(COLOR_BOLD_WHITE, tag, COLOR_WHITE, text, args...);
+				log(LOG_LEVEL_VERBOSE, toRef<Tag>(tag), toRef<Text>(text), prepare(std::forward<Args>(args))...);
 		}
 
-		template<class...Args>
-		static void debug(std::string tag, std::string text, Args&&... args)
+		template<class Tag, class Text, class...Args>
+		static void debug(Tag&& tag, Text&& text, Args&&... args)
 		{
 			if(logLevel<=LOG_LEVEL_DEBUG)
-				log(COLOR_BOLD_BLUE, tag, COLOR_BLUE, text, args...);
+				log(LOG_LEVEL_DEBUG, toRef<Tag>(tag), toRef<Text>(text), prepare(std::forward<Args>(args))...);
 		}
 
-		template<class...Args>
-		static void success(std::string tag, std::string text, Args&&... args)
+		template<class Tag, class Text, class...Args>
+		static void success(Tag&& tag, Text&& text, Args&&... args)
 		{
 			if(logLevel<=LOG_LEVEL_SUCCESS)
-				log(COLOR_BOLD_GREEN, tag, COLOR_GREEN, text, args...);
+				log(LOG_LEVEL_SUCCESS, toRef<Tag>(tag), toRef<Text>(text), prepare(std::forward<Args>(args))...);
 		}
 
-		template<class...Args>
-		static void info(std::string tag, std::string text, Args&&... args)
+		template<class Tag, class Text, class...Args>
+		static void info(Tag&& tag, Text&& text, Args&&... args)
 		{
 			if(logLevel<=LOG_LEVEL_INFO)
-				log(COLOR_BOLD_CYAN, tag, COLOR_CYAN, text, args...);
+				log(LOG_LEVEL_INFO, toRef<Tag>(tag), toRef<Text>(text), prepare(std::forward<Args>(args))...);
 		}
 
-		template<class...Args>
-		static void warning(std::string tag, std::string text, Args&&... args)
+		template<class Tag, class Text, class...Args>
+		static void warning(Tag&& tag, Text&& text, Args&&... args)
 		{
 			if(logLevel<=LOG_LEVEL_WARNING)
-				log(COLOR_BOLD_YELLOW, tag, COLOR_YELLOW, text, args...);
+				log(LOG_LEVEL_WARNING, toRef<Tag>(tag), toRef<Text>(text), prepare(std::forward<Args>(args))...);
 		}
 
-		template<class...Args>
-		static void error(std::string tag, std::string text, Args&&... args)
+		template<class Tag, class Text, class...Args>
+		static void error(Tag&& tag, Text&& text, Args&&... args)
 		{
 			if(logLevel<=LOG_LEVEL_ERROR)
-				log(COLOR_BOLD_RED, tag, COLOR_RED, text, args...);
+				log(LOG_LEVEL_ERROR, toRef<Tag>(tag), toRef<Text>(text), prepare(std::forward<Args>(args))...);
 		}
 
+		// Block until all queued messages were written
+		static void flush();
+		static void setTerminalOutput(bool enabled);
+		// Also write all messages to a binary file (empty name to close it)
+		static bool setBinaryFile(std::string fileName);
+		// Print a binary log file to the terminal
+		static bool printBinaryFile(std::string fileName);
+
 	private:
-		static void replace(std::string& str, const std::string& oldStr, const std::string& newStr);
-		
-		//---------- Convert parameters to string ----------//
-		static std::string toString(const char* str);
-		static std::string toString(std::string str);
+		enum ArgType : uint8_t {
+			ARG_TYPE_INT = 0,
+			ARG_TYPE_UINT,
+			ARG_TYPE_FLOAT,
+			ARG_TYPE_STRING
+		};
+
+		// Tag/text reference (literals are not copied)
+		struct StringRef
+		{
+			const char* data;
+			uint32_t size;
+			bool literal;
+		};
+
+		// T is the deduced forwarding type (string literals are const char(&)[N])
+		// Const char arrays that are not literals (e.g. VkExtensionProperties::extensionName) are copied
+		template<class T>
+		static StringRef toRef(const std::remove_reference_t<T>& str)
+		{
+			using U = std::remove_reference_t<T>;
+			if constexpr(std::is_array_v<U> && std::is_const_v<std::remove_extent_t<U>>)
+			{
+				const size_t size = std::char_traits<char>::length(str);
+				return {str, uint32_t(size), size+1 == std::extent_v<U> && isReadOnlyImage(str)};
+			}
+			else if constexpr(std::is_convertible_v<const U&, std::string_view>)
+			{
+				std::string_view view(str);
+				return {view.data(), uint32_t(view.size()), false};
+			}
+			else
+				static_assert(sizeof(U) == 0, "Log tag and text must be strings");
+		}
+
+		//---------- Convert parameters (done by the calling thread) ----------//
+		// Numbers and strings are captured as they are, other types are converted to string
+		template<class T>
+		static decltype(auto) prepare(T&& t)
+		{
+			using U = std::decay_t<T>;
+			if constexpr(std::is_same_v<U, bool>)
+				return uint64_t(t);
+			else if constexpr(std::is_integral_v<U> && std::is_signed_v<U>)
+				return int64_t(t);
+			else if constexpr(std::is_integral_v<U>)
+				return uint64_t(t);
+			else if constexpr(std::is_floating_point_v<U>)
+				return double(t);
+			else if constexpr(std::is_enum_v<U>)
+				return int64_t(t);
+			else if constexpr(std::is_convertible_v<const U&, std::string_view>)
+				return std::string_view(t);
+			else
+				return toString(t);
+		}
 
 		template<class T>
-		static std::string toString(std::vector<T> vec)
+		static std::string toString(const std::vector<T>& vec)
 		{
 			std::string str = "{";
 			for(unsigned int i=0; i<vec.size(); i++)
@@ -142,48 +207,52 @@ class Log
 			return str;
 		}
 
+		static std::string toString(const std::string& str) { return str; }
+
 		template<class T>
-		static std::string toString(T t)
+		static std::string toString(const T& t)
 		{
 			return std::to_string(t);
 		}
 
+		static size_t argSize(int64_t) { return 1+8; }
+		static size_t argSize(uint64_t) { return 1+8; }
+		static size_t argSize(double) { return 1+8; }
+		static size_t argSize(std::string_view str) { return 1+4+str.size(); }
+		static void writeArg(uint8_t*& dst, int64_t value) { writeValue(dst, ARG_TYPE_INT, &value, 8); }
+		static void writeArg(uint8_t*& dst, uint64_t value) { writeValue(dst, ARG_TYPE_UINT, &value, 8); }
+		static void writeArg(uint8_t*& dst, double value) { writeValue(dst, ARG_TYPE_FLOAT, &value, 8); }
+		static void writeArg(uint8_t*& dst, std::string_view str)
+		{
+			const uint32_t size = str.size();
+			writeValue(dst, ARG_TYPE_STRING, &size, 4);
+			std::memcpy(dst, str.data(), size);
+			dst += size;
+		}
+		static void writeValue(uint8_t*& dst, ArgType type, const void* value, size_t size)
+		{
+			*dst++ = type;
+			std::memcpy(dst, value, size);
+			dst += size;
+		}
+
 		//---------- Main log function ----------//
 		template<class...Args>
-		static void log(const char* tagColor, std::string tag, const char* textColor, std::string text, Args&&... args)
+		static void log(LogLevel level, StringRef tag, StringRef text, const Args&... args)
 		{
-			//int size = argSize(args...);
-			
-			// Replace special sequences by color (TODO more efficient algorithm)
-			replace(text, "[k]", std::string(COLOR_BLACK));
-			replace(text, "[r]", std::string(COLOR_RED));
-			replace(text, "[g]", std::string(COLOR_GREEN));
-			replace(text, "[y]", std::string(COLOR_YELLOW));
-			replace(text, "[b]", std::string(COLOR_BLUE));
-			replace(text, "[m]", std::string(COLOR_MAGENTA));
-			replace(text, "[c]", std::string(COLOR_CYAN));
-			replace(text, "[w]", std::string(COLOR_WHITE));
-			replace(text, "[*k]", std::string(COLOR_BOLD_BLACK));
-			replace(text, "[*r]", std::string(COLOR_BOLD_RED));
-			replace(text, "[*g]", std::string(COLOR_BOLD_GREEN));
-			replace(text, "[*y]", std::string(COLOR_BOLD_YELLOW));
-			replace(text, "[*b]", std::string(COLOR_BOLD_BLUE));
-			replace(text, "[*m]", std::string(COLOR_BOLD_MAGENTA));
-			replace(text, "[*c]", std::string(COLOR_BOLD_CYAN));
-			replace(text, "[*w]", std::string(COLOR_BOLD_WHITE));
-			replace(text, "[]", std::string(textColor));
-
-			// Replace arguments
-			std::vector<std::string> argsStr;
-			(argsStr.push_back(toString(std::forward<Args>(args))), ...);
-
-			for(unsigned int i=0; i<argsStr.size(); i++)
-				replace(text, "$"+std::to_string(i), argsStr[i]);
-
-			// Print [tag] text
-			std::string output = std::string(tagColor) + "[" + tag + "] " + textColor + text + COLOR_RESET + "\n";
-			std::cout << output;
+			const size_t argsSize = (size_t(0) + ... + argSize(args));
+			uint8_t* dst = beginRecord(level, tag, text, sizeof...(Args), argsSize);
+			if(dst == nullptr)
+				return;
+			(writeArg(dst, args), ...);
+			endRecord(level);
 		}
+
+		// Reserve space in the thread queue and write the record header (returns where the arguments go)
+		static uint8_t* beginRecord(LogLevel level, StringRef tag, StringRef text, uint16_t qtyArgs, size_t argsSize);
+		static void endRecord(LogLevel level);
+		// Literals are in a read-only segment of the executable/libraries (other arrays may change or be freed)
+		static bool isReadOnlyImage(const void* data);
 };
 
 //#undef COLOR_RESET
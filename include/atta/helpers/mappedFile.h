@@ -0,0 +1,40 @@
+//--------------------------------------------------
+// Atta Helpers
+// mappedFile.h
+// Date: 2021-07-15
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_HELPERS_MAPPED_FILE_H
+#define ATTA_HELPERS_MAPPED_FILE_H
+#include <atta/helpers/span.h>
+#include <string>
+
+namespace atta
+{
+	// Read only memory mapped file (pages are loaded by the OS when accessed)
+	class MappedFile
+	{
+		public:
+			MappedFile(std::string fileName);
+			~MappedFile();
+
+			MappedFile(const MappedFile&) = delete;
+			void operator=(const MappedFile&) = delete;
+
+			//---------- Getters ----------//
+			bool isValid() const { return _valid; }
+			const uint8_t* getData() const { return _data; }
+			size_t getSize() const { return _size; }
+			span<const uint8_t> getSpan() const { return span<const uint8_t>(_data, _size); }
+			// Last modification time in nanoseconds (0 if the file could not be opened)
+			int64_t getModificationTime() const { return _modificationTime; }
+
+		private:
+			const uint8_t* _data;
+			size_t _size;
+			bool _valid;
+			int64_t _modificationTime;
+	};
+}
+
+#endif// ATTA_HELPERS_MAPPED_FILE_H
@@ -0,0 +1,105 @@
+//--------------------------------------------------
+// Atta Helpers
+// pool.h
+// Date: 2021-07-26
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_HELPERS_POOL_H
+#define ATTA_HELPERS_POOL_H
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace atta
+{
+	// Fixed size block allocator
+	//
+	// Blocks are allocated in chunks and reused through a free list, so objects created and destroyed at runtime do not
+	// call the heap allocator after the pool grows (and do not fragment the heap). Thread safe.
+	class Pool
+	{
+		public:
+			Pool(size_t blockSize, size_t blockAlign, size_t qtyBlocksPerChunk = 256);
+			~Pool();
+
+			Pool(const Pool&) = delete;
+			void operator=(const Pool&) = delete;
+
+			void* allocate();
+			void deallocate(void* block);
+
+			//---------- Getters ----------//
+			size_t getBlockSize() const { return _blockSize; }
+			size_t getQtyAllocated() const;// Blocks in use
+			size_t getCapacity() const;// Blocks in all chunks
+
+			// Pool shared by all allocations with this size and alignment
+			// (never destroyed, pooled objects may be released by static destructors)
+			template <size_t Size, size_t Align>
+			static Pool& get()
+			{
+				static Pool* pool = new Pool(Size, Align);
+				return *pool;
+			}
+
+		private:
+			struct FreeBlock
+			{
+				FreeBlock* next;
+			};
+
+			void addChunk();
+
+			size_t _blockSize;
+			size_t _blockAlign;
+			size_t _qtyBlocksPerChunk;
+			std::vector<void*> _chunks;
+			FreeBlock* _free;
+			size_t _qtyAllocated;
+			mutable std::mutex _mutex;
+	};
+
+	// STL allocator using the shared pools (only single element allocations use the pool)
+	template <typename T>
+	class PoolAllocator
+	{
+		public:
+			using value_type = T;
+
+			PoolAllocator() = default;
+			template <typename U>
+			PoolAllocator(const PoolAllocator<U>&) {}
+
+			T* allocate(size_t n)
+			{
+				if(n == 1)
+					return static_cast<T*>(Pool::get<sizeof(T), alignof(T)>().allocate());
+				return static_cast<T*>(::operator new(n*sizeof(T), std::align_val_t(alignof(T))));
+			}
+
+			void deallocate(T* p, size_t n)
+			{
+				if(n == 1)
+					Pool::get<sizeof(T), alignof(T)>().deallocate(p);
+				else
+					::operator delete(p, std::align_val_t(alignof(T)));
+			}
+
+			template <typename U>
+			bool operator==(const PoolAllocator<U>&) const { return true; }
+			template <typename U>
+			bool operator!=(const PoolAllocator<U>&) const { return false; }
+	};
+
+	// Object and shared pointer control block allocated from a pool (use it for objects spawned at runtime)
+	template <typename T, typename... Args>
+	std::shared_ptr<T> makePooled(Args&&... args)
+	{
+		return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+	}
+}
+
+#endif// ATTA_HELPERS_POOL_H
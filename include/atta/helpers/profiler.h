@@ -0,0 +1,201 @@
+//--------------------------------------------------
+// Atta Profiler
+// profiler.h
+// Date: 2021-07-14
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_HELPERS_PROFILER_H
+#define ATTA_HELPERS_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+//---------- Profiler macros ----------//
+// The profiler is only compiled when ATTA_PROFILER is defined (cmake -DATTA_PROFILER=ON),
+// otherwise the macros expand to nothing
+// Zone names must be string literals (only the pointer is stored)
+//
+// void PhysicsEngine::stepPhysics(float dt)
+// {
+//     ATTA_PROFILE_ZONE("Physics");
+//     {
+//         ATTA_PROFILE_ZONE("Broad phase");
+//         ...
+//     }
+//     ATTA_PROFILE_COUNTER("Contacts", qtyContacts);
+// }
+#ifdef ATTA_PROFILER
+#define ATTA_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ATTA_PROFILE_CONCAT(a, b) ATTA_PROFILE_CONCAT_IMPL(a, b)
+#define ATTA_PROFILE_ZONE(name) \
+	static const uint32_t ATTA_PROFILE_CONCAT(attaProfileZone, __LINE__) = atta::Profiler::registerZone(name, atta::Profiler::ZONE_TYPE_SCOPE); \
+	atta::ProfileScope ATTA_PROFILE_CONCAT(attaProfileScope, __LINE__)(ATTA_PROFILE_CONCAT(attaProfileZone, __LINE__))
+#define ATTA_PROFILE_FUNCTION() ATTA_PROFILE_ZONE(__func__)
+#define ATTA_PROFILE_COUNTER(name, value) \
+	do { \
+		static const uint32_t attaProfileCounter = atta::Profiler::registerZone(name, atta::Profiler::ZONE_TYPE_COUNTER); \
+		atta::Profiler::addCounter(attaProfileCounter, value); \
+	} while(0)
+#define ATTA_PROFILE_THREAD(name) atta::Profiler::setThreadName(name)
+#else
+#define ATTA_PROFILE_ZONE(name)
+#define ATTA_PROFILE_FUNCTION()
+#define ATTA_PROFILE_COUNTER(name, value)
+#define ATTA_PROFILE_THREAD(name)
+#endif
+
+namespace atta
+{
+	// Hierarchical scoped-zone profiler
+	// Each thread writes its zones to its own ring buffer and statistics, no locks are used after the
+	// first zone of a thread. Readers (reports, trace export) can run at any time from any thread.
+	class Profiler
+	{
+		public:
+			enum ZoneType : uint8_t {
+				ZONE_TYPE_SCOPE = 0,
+				ZONE_TYPE_COUNTER
+			};
+
+			struct ZoneReport {
+				std::string name;
+				ZoneType type;
+				uint64_t count;// Number of times the zone was executed (counter value for counters)
+				double totalMs;
+				double maxMs;
+			};
+
+			static constexpr uint32_t maxZones = 1024;
+			static constexpr size_t eventsPerThread = 1<<16;// Most recent zones kept for the trace
+
+			Profiler(const Profiler&) = delete;
+        	void operator=(const Profiler&) = delete;
+
+			static Profiler& get()
+			{
+				static Profiler profiler;
+				return profiler;
+			}
+
+			// Returns the zone id (called once per zone through the macros)
+			static uint32_t registerZone(const char* name, ZoneType type) { return get().registerZoneImpl(name, type); }
+			// Runtime names are copied (slower, used by LocalEvaluator)
+			static uint32_t registerZone(const std::string& name, ZoneType type) { return get().registerZoneImpl(name, type); }
+			static void setThreadName(std::string name) { get().setThreadNameImpl(name); }
+
+			// Time in ticks (rdtsc when available)
+			static uint64_t now()
+			{
+#if defined(__x86_64__) || defined(__i386__)
+				return __rdtsc();
+#else
+				return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+			}
+			static void record(uint32_t zone, uint64_t begin, uint64_t end) { get().record(getThreadData(), zone, begin, end); }
+			static void addCounter(uint32_t zone, int64_t value);
+
+			// Aggregated statistics of all threads
+			static std::vector<ZoneReport> getReports() { return get().getReportsImpl(); }
+			static void showReports() { get().showReportsImpl(); }
+			// Chrome trace event format (open with chrome://tracing or ui.perfetto.dev)
+			static bool exportChromeTrace(std::string fileName) { return get().exportChromeTraceImpl(fileName); }
+			static void clear() { get().clearImpl(); }
+
+		private:
+			friend class ProfileScope;
+
+			struct Event {
+				uint64_t begin;
+				uint64_t end;
+				uint32_t zone;
+				uint32_t depth;
+			};
+
+			struct ZoneStats {
+				std::atomic<uint64_t> count;
+				std::atomic<uint64_t> ticks;
+				std::atomic<uint64_t> maxTicks;
+			};
+
+			// Written only by its thread, read by anyone
+			struct ThreadData {
+				std::string name;
+				uint32_t depth = 0;
+				std::atomic<uint64_t> head;// Total number of events written
+				std::atomic<uint64_t> tail;// Events before tail were cleared
+				std::unique_ptr<Event[]> events;
+				std::unique_ptr<ZoneStats[]> stats;
+			};
+
+			struct Zone {
+				const char* name;
+				ZoneType type;
+			};
+
+			Profiler();
+
+			static ThreadData& getThreadData()
+			{
+				thread_local ThreadData* data = nullptr;
+				if(data == nullptr)
+					data = get().registerThread();
+				return *data;
+			}
+
+			void record(ThreadData& data, uint32_t zone, uint64_t begin, uint64_t end);
+			uint32_t registerZoneImpl(const char* name, ZoneType type);
+			uint32_t registerZoneImpl(const std::string& name, ZoneType type);
+			uint32_t addZone(const char* name, ZoneType type);// Must be called with the mutex locked
+			ThreadData* registerThread();
+			void setThreadNameImpl(std::string name);
+			std::vector<ZoneReport> getReportsImpl();
+			void showReportsImpl();
+			bool exportChromeTraceImpl(std::string fileName);
+			void clearImpl();
+			double getTicksPerMs();
+
+			std::mutex _mutex;// Only used to register zones/threads
+			Zone _zones[maxZones];
+			std::atomic<uint32_t> _qtyZones;
+			std::deque<std::string> _runtimeNames;
+			std::vector<std::unique_ptr<ThreadData>> _threads;
+
+			// Tick calibration
+			uint64_t _startTicks;
+			std::chrono::steady_clock::time_point _startTime;
+	};
+
+	// Records the zone from construction to destruction
+	class ProfileScope
+	{
+		public:
+			ProfileScope(uint32_t zone):
+				_data(Profiler::getThreadData()), _zone(zone)
+			{
+				_data.depth++;
+				_begin = Profiler::now();
+			}
+			~ProfileScope()
+			{
+				const uint64_t end = Profiler::now();
+				_data.depth--;
+				Profiler::get().record(_data, _zone, _begin, end);
+			}
+
+		private:
+			Profiler::ThreadData& _data;
+			uint32_t _zone;
+			uint64_t _begin;
+	};
+}
+#endif// ATTA_HELPERS_PROFILER_H
@@ -0,0 +1,60 @@
+//--------------------------------------------------
+// Atta Helpers
+// random.h
+// Date: 2021-07-29
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_HELPERS_RANDOM_H
+#define ATTA_HELPERS_RANDOM_H
+
+#include <cstdint>
+#include <string>
+
+namespace atta
+{
+	// Counter-based random number stream (Philox4x32-10)
+	//
+	// Value n of a stream only depends on (seed, stream, n), there is no shared generator state. Each robot/system
+	// gets its own stream, so the values it draws do not depend on how many threads run the simulation or on the
+	// order the other streams are used.
+	class RandomStream
+	{
+		public:
+			RandomStream(uint64_t seed = 0, uint64_t stream = 0);
+
+			uint32_t next();
+			// [0, 1)
+			float uniform();
+			// [min, max)
+			float uniform(float min, float max);
+			// [0, qty)
+			uint32_t uniformInt(uint32_t qty);
+			// Mean 0, standard deviation 1
+			float normal();
+
+			//---------- Getters ----------//
+			uint64_t getSeed() const { return _seed; }
+			uint64_t getStream() const { return _stream; }
+			// Quantity of values drawn (part of the simulation state)
+			uint64_t getCounter() const { return _counter; }
+
+			//---------- Setters ----------//
+			void setCounter(uint64_t counter) { _counter = counter; }
+
+			// Value index of a stream
+			static uint32_t generate(uint64_t seed, uint64_t stream, uint64_t index);
+			// Stream of a named system (same name, same stream)
+			static uint64_t streamFromName(const std::string& name);
+
+		private:
+			uint64_t _seed;
+			uint64_t _stream;
+			uint64_t _counter;
+
+			// Each Philox block has 4 values
+			uint64_t _cachedBlock;
+			uint32_t _cached[4];
+	};
+}
+
+#endif// ATTA_HELPERS_RANDOM_H
@@ -0,0 +1,51 @@
+//--------------------------------------------------
+// Atta Helpers
+// span.h
+// Date: 2021-07-08
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_HELPERS_SPAN_H
+#define ATTA_HELPERS_SPAN_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace atta
+{
+	// Non owning view of contiguous memory (subset of c++20 std::span)
+	template <typename T>
+	class span
+	{
+		public:
+			span(): _data(nullptr), _size(0) {}
+			span(T* data, size_t size): _data(data), _size(size) {}
+			template <typename U, typename = std::enable_if_t<std::is_convertible_v<U(*)[], T(*)[]>>>
+			span(std::vector<U>& v): _data(v.data()), _size(v.size()) {}
+			template <typename U, typename = std::enable_if_t<std::is_convertible_v<const U(*)[], T(*)[]>>>
+			span(const std::vector<U>& v): _data(v.data()), _size(v.size()) {}
+			template <typename U, typename = std::enable_if_t<std::is_convertible_v<U(*)[], T(*)[]>>>
+			span(const span<U>& s): _data(s.data()), _size(s.size()) {}
+
+			T* data() const { return _data; }
+			size_t size() const { return _size; }
+			bool empty() const { return _size == 0; }
+			T& operator[](size_t i) const { return _data[i]; }
+			T* begin() const { return _data; }
+			T* end() const { return _data+_size; }
+			span<T> subspan(size_t offset, size_t count) const { return span<T>(_data+offset, count); }
+
+		private:
+			T* _data;
+			size_t _size;
+	};
+
+	// Byte view of a string (no copy)
+	inline span<const uint8_t> asBytes(const std::string& s)
+	{
+		return span<const uint8_t>(reinterpret_cast<const uint8_t*>(s.data()), s.size());
+	}
+}
+
+#endif// ATTA_HELPERS_SPAN_H
@@ -0,0 +1,46 @@
+//--------------------------------------------------
+// Atta Math
+// alignedAllocator.h
+// Date: 2021-06-02
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_MATH_ALIGNED_ALLOCATOR_H
+#define ATTA_MATH_ALIGNED_ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+
+namespace atta
+{
+	// STL allocator that returns memory aligned to Alignment bytes (default to cache line size)
+	template <typename T, size_t Alignment = 64>
+	class alignedAllocator
+	{
+		public:
+			using value_type = T;
+
+			template <typename U>
+			struct rebind { using other = alignedAllocator<U, Alignment>; };
+
+			alignedAllocator() noexcept {}
+			template <typename U>
+			alignedAllocator(const alignedAllocator<U, Alignment>&) noexcept {}
+
+			T* allocate(size_t n)
+			{
+				return static_cast<T*>(::operator new(n*sizeof(T), std::align_val_t(Alignment)));
+			}
+
+			void deallocate(T* p, size_t) noexcept
+			{
+				::operator delete(p, std::align_val_t(Alignment));
+			}
+
+			template <typename U>
+			bool operator==(const alignedAllocator<U, Alignment>&) const noexcept { return true; }
+			template <typename U>
+			bool operator!=(const alignedAllocator<U, Alignment>&) const noexcept { return false; }
+	};
+}
+
+#endif// ATTA_MATH_ALIGNED_ALLOCATOR_H
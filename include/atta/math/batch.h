@@ -0,0 +1,67 @@
+//--------------------------------------------------
+// Atta Math
+// batch.h
+// Date: 2021-07-28
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_MATH_BATCH_H
+#define ATTA_MATH_BATCH_H
+
+#include <cstddef>
+#include <atta/math/matrix.h>
+
+// Kernels over arrays of transforms
+//
+// Points, positions, orientations and scales are structure of arrays (one array per component), the matrices are
+// arrays of mat4 (layout used by the transform system and the GPU). The kernels are compiled for the baseline
+// SIMD backend (SSE/NEON, see simd.h), AVX2 and AVX-512, the best target supported by the CPU is selected at the
+// first call.
+namespace atta::batch
+{
+	// Element i is (x[i], y[i], z[i])
+	struct Vec3Arrays
+	{
+		float* x;
+		float* y;
+		float* z;
+	};
+
+	// Element i is (r[i], i[i], j[i], k[i])
+	struct QuatArrays
+	{
+		float* r;
+		float* i;
+		float* j;
+		float* k;
+	};
+
+	enum Target
+	{
+		TARGET_BASELINE = 0,
+		TARGET_AVX2,
+		TARGET_AVX512
+	};
+
+	//---------- Kernels ----------//
+	// points[i] = matrices[i]*points[i] (w=1)
+	void transformPoints(size_t n, const mat4* matrices, Vec3Arrays points);
+
+	// out[i] = parents[parentIndices[i]]*locals[i] (locals[i] if the parent index is negative)
+	// out can be in the parents array when no element is its own parent (transform hierarchy levels)
+	void compose(size_t n, const mat4* parents, const int* parentIndices, const mat4* locals, mat4* out);
+
+	// orientations[i] += angularVelocities[i]*dt (same as quat::operator+=), normalized
+	void integrateOrientations(size_t n, QuatArrays orientations, Vec3Arrays angularVelocities, float dt);
+
+	// out[i] = posOriScale(positions[i], orientations[i], scales[i])
+	void posOriScale(size_t n, Vec3Arrays positions, QuatArrays orientations, Vec3Arrays scales, mat4* out);
+
+	//---------- Target ----------//
+	Target getTarget();
+	bool isTargetSupported(Target target);
+	// Used to compare the targets (ignored if not supported by the CPU)
+	void setTarget(Target target);
+	const char* getTargetName(Target target);
+}
+
+#endif// ATTA_MATH_BATCH_H
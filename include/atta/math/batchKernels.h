@@ -0,0 +1,231 @@
+//--------------------------------------------------
+// Atta Math
+// batchKernels.h
+// Date: 2021-07-28
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_MATH_BATCH_KERNELS_H
+#define ATTA_MATH_BATCH_KERNELS_H
+
+// Only included by the batch*.cpp files
+//
+// The kernels are templates over a lanes type (one element per lane), each target translation unit instantiates
+// them with its own lanes type. Everything is in an anonymous namespace, the instances compiled for AVX2/AVX-512
+// are never merged with the baseline ones by the linker.
+#include <cfloat>
+#include <cmath>
+#include <atta/math/batch.h>
+
+// AVX2/AVX-512 translation units (the target is selected with #pragma GCC target)
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__) && !defined(ATTA_SIMD_DISABLED)
+	#define ATTA_BATCH_X86
+#endif
+
+namespace atta::batch::detail
+{
+	struct Kernels
+	{
+		void (*transformPoints)(size_t n, const mat4* matrices, Vec3Arrays points);
+		void (*compose)(size_t n, const mat4* parents, const int* parentIndices, const mat4* locals, mat4* out);
+		void (*integrateOrientations)(size_t n, QuatArrays orientations, Vec3Arrays angularVelocities, float dt);
+		void (*posOriScale)(size_t n, Vec3Arrays positions, QuatArrays orientations, Vec3Arrays scales, mat4* out);
+	};
+
+	Kernels baselineKernels();
+#ifdef ATTA_BATCH_X86
+	Kernels avx2Kernels();
+	Kernels avx512Kernels();
+#endif
+}
+
+namespace atta::batch::detail
+{
+	namespace
+	{
+		// Lanes interface (width elements per register):
+		//   load/store                  width consecutive floats
+		//   splat/add/sub/mul/div/sqrt
+		//   madd(a, b, c)               a*b+c
+		//   less(a, b)/select(m, a, b)  mask, m ? a : b
+		//   loadRows(m, row, e)         e[c] lane l = m[l].data[row*4+c]
+		//   storeRows(m, row, e)        inverse of loadRows
+		struct ScalarLanes
+		{
+			using type = float;
+			using mask = bool;
+			static constexpr size_t width = 1;
+
+			static float load(const float* p) { return *p; }
+			static void store(float* p, float v) { *p = v; }
+			static float splat(float v) { return v; }
+			static float add(float a, float b) { return a+b; }
+			static float sub(float a, float b) { return a-b; }
+			static float mul(float a, float b) { return a*b; }
+			static float div(float a, float b) { return a/b; }
+			static float sqrt(float a) { return std::sqrt(a); }
+			static float madd(float a, float b, float c) { return a*b+c; }
+			static bool less(float a, float b) { return a<b; }
+			static float select(bool m, float a, float b) { return m ? a : b; }
+			static void loadRows(const mat4* m, int row, float e[4])
+			{
+				for(int c=0; c<4; c++)
+					e[c] = m->data[row*4+c];
+			}
+			static void storeRows(mat4* m, int row, const float e[4])
+			{
+				for(int c=0; c<4; c++)
+					m->data[row*4+c] = e[c];
+			}
+		};
+
+		//---------- Kernels (return the first element not processed) ----------//
+		template <typename L>
+		size_t transformPointsLanes(size_t begin, size_t end, const mat4* matrices, Vec3Arrays points)
+		{
+			using V = typename L::type;
+			size_t i = begin;
+			for(; i+L::width<=end; i+=L::width)
+			{
+				const V x = L::load(points.x+i);
+				const V y = L::load(points.y+i);
+				const V z = L::load(points.z+i);
+				float* out[3] = {points.x+i, points.y+i, points.z+i};
+				for(int row=0; row<3; row++)
+				{
+					V e[4];
+					L::loadRows(matrices+i, row, e);
+					L::store(out[row], L::madd(e[0], x, L::madd(e[1], y, L::madd(e[2], z, e[3]))));
+				}
+			}
+			return i;
+		}
+
+		template <typename L>
+		size_t integrateOrientationsLanes(size_t begin, size_t end, QuatArrays q, Vec3Arrays w, float dt)
+		{
+			using V = typename L::type;
+			const V halfDt = L::splat(0.5f*dt);
+			const V one = L::splat(1.0f);
+			const V epsilon = L::splat(FLT_EPSILON);
+			size_t i = begin;
+			for(; i+L::width<=end; i+=L::width)
+			{
+				V r = L::load(q.r+i);
+				V qi = L::load(q.i+i);
+				V qj = L::load(q.j+i);
+				V qk = L::load(q.k+i);
+				const V wx = L::mul(L::load(w.x+i), halfDt);
+				const V wy = L::mul(L::load(w.y+i), halfDt);
+				const V wz = L::mul(L::load(w.z+i), halfDt);
+
+				// q += (0, w*dt)*q*0.5
+				const V dr = L::sub(L::splat(0.0f), L::madd(wx, qi, L::madd(wy, qj, L::mul(wz, qk))));
+				const V di = L::madd(wx, r, L::sub(L::mul(wy, qk), L::mul(wz, qj)));
+				const V dj = L::madd(wy, r, L::sub(L::mul(wz, qi), L::mul(wx, qk)));
+				const V dk = L::madd(wz, r, L::sub(L::mul(wx, qj), L::mul(wy, qi)));
+				r = L::add(r, dr);
+				qi = L::add(qi, di);
+				qj = L::add(qj, dj);
+				qk = L::add(qk, dk);
+
+				// Normalize (no-rotation quaternion if the length is zero, same as quat::normalize)
+				const V d = L::madd(r, r, L::madd(qi, qi, L::madd(qj, qj, L::mul(qk, qk))));
+				const auto zero = L::less(d, epsilon);
+				const V inv = L::div(one, L::sqrt(d));
+				L::store(q.r+i, L::select(zero, one, L::mul(r, inv)));
+				L::store(q.i+i, L::select(zero, qi, L::mul(qi, inv)));
+				L::store(q.j+i, L::select(zero, qj, L::mul(qj, inv)));
+				L::store(q.k+i, L::select(zero, qk, L::mul(qk, inv)));
+			}
+			return i;
+		}
+
+		template <typename L>
+		size_t posOriScaleLanes(size_t begin, size_t end, Vec3Arrays p, QuatArrays q, Vec3Arrays s, mat4* out)
+		{
+			using V = typename L::type;
+			const V zero = L::splat(0.0f);
+			const V one = L::splat(1.0f);
+			size_t i = begin;
+			for(; i+L::width<=end; i+=L::width)
+			{
+				const V r = L::load(q.r+i);
+				const V qi = L::load(q.i+i);
+				const V qj = L::load(q.j+i);
+				const V qk = L::load(q.k+i);
+				const V sx = L::load(s.x+i);
+				const V sy = L::load(s.y+i);
+				const V sz = L::load(s.z+i);
+				const V i2 = L::add(qi, qi);
+				const V j2 = L::add(qj, qj);
+				const V k2 = L::add(qk, qk);
+
+				// Same terms as mat4::setPosOriScale
+				const V ii = L::mul(i2, qi), jj = L::mul(j2, qj), kk = L::mul(k2, qk);
+				const V ij = L::mul(i2, qj), ik = L::mul(i2, qk), jk = L::mul(j2, qk);
+				const V ir = L::mul(i2, r), jr = L::mul(j2, r), kr = L::mul(k2, r);
+
+				V e[4];
+				e[0] = L::mul(L::sub(one, L::add(jj, kk)), sx);
+				e[1] = L::mul(L::add(ij, kr), sy);
+				e[2] = L::mul(L::sub(ik, jr), sz);
+				e[3] = L::load(p.x+i);
+				L::storeRows(out+i, 0, e);
+
+				e[0] = L::mul(L::sub(ij, kr), sx);
+				e[1] = L::mul(L::sub(one, L::add(ii, kk)), sy);
+				e[2] = L::mul(L::add(jk, ir), sz);
+				e[3] = L::load(p.y+i);
+				L::storeRows(out+i, 1, e);
+
+				e[0] = L::mul(L::add(ik, jr), sx);
+				e[1] = L::mul(L::sub(jk, ir), sy);
+				e[2] = L::mul(L::sub(one, L::add(ii, jj)), sz);
+				e[3] = L::load(p.z+i);
+				L::storeRows(out+i, 2, e);
+
+				e[0] = zero;
+				e[1] = zero;
+				e[2] = zero;
+				e[3] = one;
+				L::storeRows(out+i, 3, e);
+			}
+			return i;
+		}
+
+		//---------- Kernels over all elements (the remainder uses the scalar lanes) ----------//
+		template <typename L>
+		void transformPoints(size_t n, const mat4* matrices, Vec3Arrays points)
+		{
+			transformPointsLanes<ScalarLanes>(transformPointsLanes<L>(0, n, matrices, points), n, matrices, points);
+		}
+
+		template <typename L>
+		void integrateOrientations(size_t n, QuatArrays orientations, Vec3Arrays angularVelocities, float dt)
+		{
+			const size_t i = integrateOrientationsLanes<L>(0, n, orientations, angularVelocities, dt);
+			integrateOrientationsLanes<ScalarLanes>(i, n, orientations, angularVelocities, dt);
+		}
+
+		template <typename L>
+		void posOriScale(size_t n, Vec3Arrays positions, QuatArrays orientations, Vec3Arrays scales, mat4* out)
+		{
+			const size_t i = posOriScaleLanes<L>(0, n, positions, orientations, scales, out);
+			posOriScaleLanes<ScalarLanes>(i, n, positions, orientations, scales, out);
+		}
+
+		// compose is not lane based (each matrix product is done with the rows in registers)
+		template <typename L>
+		Kernels makeKernels(void (*compose)(size_t, const mat4*, const int*, const mat4*, mat4*))
+		{
+			Kernels kernels;
+			kernels.transformPoints = transformPoints<L>;
+			kernels.compose = compose;
+			kernels.integrateOrientations = integrateOrientations<L>;
+			kernels.posOriScale = posOriScale<L>;
+			return kernels;
+		}
+	}
+}
+
+#endif// ATTA_MATH_BATCH_KERNELS_H
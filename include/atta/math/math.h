@@ -14,6 +14,7 @@
 #include <atta/math/point.h>
 #include <atta/math/quaternion.h>
 #include <atta/math/ray.h>
+#include <atta/math/smatrix.h>
 #include <atta/math/vector.cpp>
 #include <atta/math/vector.h>
 
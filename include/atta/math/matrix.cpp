@@ -5,40 +5,34 @@
 // By Breno Cunha Queiroz
 //--------------------------------------------------
 #include <atta/math/matrix.h>
+#include <algorithm>
+#include <thread>
 
 namespace atta
 {
+	template <typename T>
+	matrix<T>::matrix():
+		nrows(0), ncols(0)
+	{
+	}
 
 	template <typename T>
 	matrix<T>::matrix(size_t _nrows, size_t _ncols):
-		nrows(_nrows), ncols(_ncols)
+		nrows(_nrows), ncols(_ncols), data(_nrows*_ncols)
 	{
-		rows = std::vector<vector<T>>(nrows);
-		for(int i=0;i<nrows;i++)
-			rows[i] = vector<T>(ncols);
 	}
 
 	template <typename T>
 	matrix<T>::matrix(size_t _nrows, size_t _ncols, T val):
-		nrows(_nrows), ncols(_ncols)
+		nrows(_nrows), ncols(_ncols), data(_nrows*_ncols, val)
 	{
-		rows = std::vector<atta::vector<T>>(nrows);
-		for(int i=0;i<nrows;i++)
-			rows[i] = atta::vector<T>(ncols, val);
 	}
 
 	template <typename T>
 	template <typename U>
 	matrix<T>::matrix(const matrix<U>& m):
-		nrows(m.nrows), ncols(m.ncols)
+		nrows(m.nrows), ncols(m.ncols), data(m.data.begin(), m.data.end())
 	{
-		rows = std::vector<atta::vector<T>>(nrows);
-		for(int i=0;i<nrows;i++)
-			rows[i] = atta::vector<T>(ncols);
-
-		for(int i=0;i<nrows;i++)
-			for(int j=0;j<ncols;j++)
-				rows[i][j] = m.rows.at(i).at(j);
 	}
 
 	template <typename T>
@@ -46,19 +40,43 @@ namespace atta
 	{
 	}
 
+	//---------- Storage ----------//
+	template <typename T>
+	void matrix<T>::resize(size_t _nrows, size_t _ncols)
+	{
+		nrows = _nrows;
+		ncols = _ncols;
+		data.resize(nrows*ncols);
+	}
+
+	template <typename T>
+	void matrix<T>::fill(T val)
+	{
+		std::fill(data.begin(), data.end(), val);
+	}
+
 	template <typename T>
-	vector<T>& matrix<T>::operator[](size_t i)
+	void matrix<T>::setIdentity()
 	{
-		return rows[i];
+		fill(T(0));
+		for(size_t i=0; i<std::min(nrows, ncols); i++)
+			(*this)[i][i] = T(1);
 	}
 
+	template <typename T>
+	void matrix<T>::swapRows(size_t i, size_t j)
+	{
+		if(i != j)
+			std::swap_ranges((*this)[i], (*this)[i]+ncols, (*this)[j]);
+	}
+
+	//---------- Basic operations ----------//
 	template <typename T>
 	template <typename U>
 	matrix<T> matrix<T>::operator+(const matrix<U>& o) const
 	{
 		matrix<T> res = *this;
-		for(size_t i=0; i<nrows; i++)
-			res.rows[i]+=o.rows[i];
+		res += o;
 		return res;
 	}
 
@@ -66,8 +84,10 @@ namespace atta
 	template <typename U>
 	void matrix<T>::operator+=(const matrix<U>& o)
 	{
-		for(size_t i=0; i<nrows; i++)
-			rows[i]+=o.rows[i];
+		T* a = data.data();
+		const U* b = o.data.data();
+		for(size_t i=0; i<data.size(); i++)
+			a[i] += b[i];
 	}
 
 	template <typename T>
@@ -75,8 +95,7 @@ namespace atta
 	matrix<T> matrix<T>::operator-(const matrix<U>& o) const
 	{
 		matrix<T> res = *this;
-		for(size_t i=0; i<nrows; i++)
-			res.rows[i]-=o.rows[i];
+		res -= o;
 		return res;
 	}
 
@@ -84,96 +103,83 @@ namespace atta
 	template <typename U>
 	void matrix<T>::operator-=(const matrix<U>& o)
 	{
-		for(size_t i=0; i<nrows; i++)
-			rows[i]-=o.rows[i];
+		T* a = data.data();
+		const U* b = o.data.data();
+		for(size_t i=0; i<data.size(); i++)
+			a[i] -= b[i];
 	}
 
 	template <typename T>
-	template <typename U>
-	matrix<T> matrix<T>::operator*(const matrix<U>& o)
+	matrix<T> matrix<T>::operator*(const matrix<T>& o) const
 	{
-		matrix<T> res = matrix<T>(nrows, o.ncols);
-		
-		size_t i, j, k;
-		for(i=0; i<res.nrows; i++)
-		{
-			for(j=0; j<res.ncols; j++)
-			{
-				res[i][j] = 0;
-				for(k=0; k<ncols; k++)
-					res[i][j] += rows[i][k] * o.rows.at(k).at(j);
-			}
-		}
-
+		matrix<T> res;
+		multiply(*this, o, res);
 		return res;
 	}
 
 	template <typename T>
-	template <typename U>
-	void matrix<T>::operator*=(const matrix<U>& o)
+	void matrix<T>::operator*=(const matrix<T>& o)
 	{
-		matrix<T> res = (*this)*o;
+		// The result can't be written over the operands
+		*this = (*this)*o;
+	}
 
-		nrows = res.nrows;
-		ncols = res.ncols;
-		rows = res.rows;
+	template <typename T>
+	matrix<T> matrix<T>::operator*(T v) const
+	{
+		matrix<T> res = *this;
+		res *= v;
+		return res;
 	}
 
 	template <typename T>
-	template <typename U>
-	void matrix<T>::operator*=(U v)
+	void matrix<T>::operator*=(T v)
 	{
-		(*this) = (*this)*v;
+		for(T& val : data)
+			val *= v;
 	}
 
 	template <typename T>
 	template <typename U>
-	vector<U> matrix<T>::operator*(const vector<U>& v)
+	vector<U> matrix<T>::operator*(const vector<U>& v) const
 	{
 		vector<U> res(nrows);
-		for(int i=0;i<nrows;i++)
+		for(size_t i=0;i<nrows;i++)
 		{
+			const T* row = (*this)[i];
 			U sum = 0;
-			for(int j=0;j<ncols;j++)
-				sum += rows[i][j]*v.at(j);
+			for(size_t j=0;j<ncols;j++)
+				sum += row[j]*v.at(j);
 			res[i] = sum;
 		}
 		return res;
 	}
 
-	template <typename T>
-	template <typename U>
-	matrix<T> matrix<T>::operator*(U v)
-	{
-		matrix<T> res = matrix<T>(nrows, ncols);
-		for(int i=0;i<res.nrows;i++)
-			for(int j=0;j<res.ncols;j++)
-				res.rows[i][j] = rows[i][j]*v;
-
-		return res;
-	}
-
 	template <typename T>
 	matrix<T>& matrix<T>::transpose()
 	{
-		std::swap(nrows, ncols);
-
-		std::vector<vector<T>> cols = std::vector<vector<T>>(nrows);
-
-		for(int i=0;i<nrows;i++)
+		if(nrows == ncols)
 		{
-			cols[i] = vector<T>(ncols);
-			for(int j=0;j<ncols;j++)
-				cols[i][j] = rows[j][i];
+			// Square matrix is transposed in place
+			for(size_t i=0;i<nrows;i++)
+				for(size_t j=i+1;j<ncols;j++)
+					std::swap((*this)[i][j], (*this)[j][i]);
+			return *this;
 		}
 
-		rows = std::move(cols);	
+		std::vector<T, alignedAllocator<T>> t(data.size());
+		for(size_t i=0;i<nrows;i++)
+			for(size_t j=0;j<ncols;j++)
+				t[j*nrows+i] = data[i*ncols+j];
+
+		std::swap(nrows, ncols);
+		data = std::move(t);
 
 		return *this;
 	}
 
 	template <typename T>
-	std::string matrix<T>::toString()
+	std::string matrix<T>::toString() const
 	{
 		std::string res = "\n[";
 
@@ -181,13 +187,120 @@ namespace atta
 		{
 			res+="[";
 			for(size_t j=0; j<ncols; j++)
-				res += std::to_string(rows[i][j]) + (j!=ncols-1 ? ", " : "]");
+				res += std::to_string((*this)[i][j]) + (j!=ncols-1 ? ", " : "]");
 			res += i!=nrows-1 ? ",\n" : "]";
 		}
 
 		return res;
 	}
 
+	//------------------------------------------------------------//
+	//--------------------------- GEMM ---------------------------//
+	//------------------------------------------------------------//
+	// Computes rows [r0,r1) of C += alpha*A*B
+	// The k and j loops are blocked to keep the B block in cache, and four rows of C
+	// are updated together so each loaded B row is reused. The inner loops are contiguous
+	// and are vectorized by the compiler
+	template <typename T>
+	void gemmRows(size_t r0, size_t r1, T alpha, matrixView<const T> A, matrixView<const T> B, matrixView<T> C)
+	{
+		const size_t KC = 256;// Block of k (rows of B)
+		const size_t NC = 1024;// Block of j (columns of B)
+		const size_t n = B.ncols;
+		const size_t K = A.ncols;
+
+		for(size_t kk=0; kk<K; kk+=KC)
+		{
+			const size_t kEnd = std::min(kk+KC, K);
+			for(size_t jj=0; jj<n; jj+=NC)
+			{
+				const size_t jEnd = std::min(jj+NC, n);
+				size_t i = r0;
+				for(; i+4<=r1; i+=4)
+				{
+					T* __restrict c0 = C[i];
+					T* __restrict c1 = C[i+1];
+					T* __restrict c2 = C[i+2];
+					T* __restrict c3 = C[i+3];
+					for(size_t k=kk; k<kEnd; k++)
+					{
+						const T a0 = alpha*A[i][k];
+						const T a1 = alpha*A[i+1][k];
+						const T a2 = alpha*A[i+2][k];
+						const T a3 = alpha*A[i+3][k];
+						const T* __restrict b = B[k];
+						for(size_t j=jj; j<jEnd; j++)
+						{
+							const T bj = b[j];
+							c0[j] += a0*bj;
+							c1[j] += a1*bj;
+							c2[j] += a2*bj;
+							c3[j] += a3*bj;
+						}
+					}
+				}
+				// Remaining rows
+				for(; i<r1; i++)
+				{
+					T* __restrict c = C[i];
+					for(size_t k=kk; k<kEnd; k++)
+					{
+						const T a = alpha*A[i][k];
+						const T* __restrict b = B[k];
+						for(size_t j=jj; j<jEnd; j++)
+							c[j] += a*b[j];
+					}
+				}
+			}
+		}
+	}
+
+	template <typename T>
+	void gemm(T alpha, matrixView<const T> A, matrixView<const T> B, T beta, matrixView<T> C)
+	{
+		// C must not overlap A or B
+		//---------- C = beta*C ----------//
+		for(size_t i=0; i<C.nrows; i++)
+		{
+			T* c = C[i];
+			if(beta == T(0))
+				std::fill(c, c+C.ncols, T(0));
+			else if(beta != T(1))
+				for(size_t j=0; j<C.ncols; j++)
+					c[j] *= beta;
+		}
+		if(A.nrows==0 || A.ncols==0 || B.ncols==0)
+			return;
+
+		//---------- C += alpha*A*B ----------//
+		// Only split between threads when the work pays for the threads creation
+		const size_t work = A.nrows*A.ncols*B.ncols;
+		size_t qtyThreads = work >= (size_t(1)<<21) ? std::thread::hardware_concurrency() : 1;
+		qtyThreads = std::max<size_t>(1, std::min(qtyThreads, A.nrows/16));
+
+		if(qtyThreads == 1)
+		{
+			gemmRows<T>(0, A.nrows, alpha, A, B, C);
+			return;
+		}
+
+		// Each thread computes a band of rows of C (multiple of 4 rows)
+		size_t rowsPerThread = (A.nrows+qtyThreads-1)/qtyThreads;
+		rowsPerThread = (rowsPerThread+3)/4*4;
+		std::vector<std::thread> threads;
+		for(size_t r0=0; r0<A.nrows; r0+=rowsPerThread)
+			threads.emplace_back(gemmRows<T>, r0, std::min(r0+rowsPerThread, A.nrows), alpha, A, B, C);
+		for(auto& thread : threads)
+			thread.join();
+	}
+
+	template <typename T>
+	void multiply(const matrix<T>& A, const matrix<T>& B, matrix<T>& C)
+	{
+		C.resize(A.nrows, B.ncols);
+		gemm<T>(T(1), A.view(), B.view(), T(0), C.view());
+	}
+
 	//------------------------------------------------------------//
 	//-------------------------- Inline --------------------------//
 	//------------------------------------------------------------//
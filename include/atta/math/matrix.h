@@ -10,6 +10,7 @@
 #include <atta/math/vector.h>
 #include <atta/math/point.h>
 #include <atta/math/quaternion.h>
+#include <atta/math/alignedAllocator.h>
 #include <vector>
 
 namespace atta
@@ -19,7 +20,8 @@ namespace atta
 	//------------------------------------------------------------//
 	//--------------------------- mat4 ---------------------------//
 	//------------------------------------------------------------//
-    class mat4
+	// Row-major, 16 byte aligned (each row is loaded as one SIMD register)
+    class alignas(16) mat4
     {
     public:
 		union
@@ -284,21 +286,51 @@ namespace atta
 	//------------------------------------------------------------//
 	//--------------------------- mat ---------------------------//
 	//------------------------------------------------------------//
+	// Non-owning view of a (sub)matrix, rows are separated by stride elements
+	template <typename T>
+	struct matrixView
+	{
+		T* data;
+		size_t nrows, ncols;
+		size_t stride;
+
+		T* operator[](size_t i) const { return data+i*stride; }
+		matrixView<T> block(size_t r, size_t c, size_t nr, size_t nc) const { return {data+r*stride+c, nr, nc, stride}; }
+		operator matrixView<const T>() const { return {data, nrows, ncols, stride}; }
+	};
+
+	// Dense matrix stored contiguously in row-major order (aligned to cache line)
 	template <typename T>
 	class matrix
 	{
 		public:
 			size_t nrows, ncols;
-			std::vector<vector<T>> rows;
+			std::vector<T, alignedAllocator<T>> data;
 
+			matrix();
 			matrix(size_t _nrows, size_t _ncols);
 			matrix(size_t _nrows, size_t _ncols, T val);
 			template <typename U>
 			matrix(const matrix<U>& m);
 			~matrix();
 
-			// Access
-			vector<T>& operator[](size_t i);
+			// Access (returns pointer to the row, A[i][j] is still valid)
+			T* operator[](size_t i) { return data.data()+i*ncols; }
+			const T* operator[](size_t i) const { return data.data()+i*ncols; }
+			T& at(size_t i, size_t j) { return data.at(i*ncols+j); }
+			const T& at(size_t i, size_t j) const { return data.at(i*ncols+j); }
+
+			// Views (no copy)
+			matrixView<T> view() { return {data.data(), nrows, ncols, ncols}; }
+			matrixView<const T> view() const { return {data.data(), nrows, ncols, ncols}; }
+			matrixView<T> block(size_t r, size_t c, size_t nr, size_t nc) { return view().block(r, c, nr, nc); }
+			matrixView<const T> block(size_t r, size_t c, size_t nr, size_t nc) const { return view().block(r, c, nr, nc); }
+
+			// Storage (resize keeps the allocated memory when possible)
+			void resize(size_t _nrows, size_t _ncols);
+			void fill(T val);
+			void setIdentity();
+			void swapRows(size_t i, size_t j);
 
 			// Basic operations
 			// +
@@ -312,26 +344,29 @@ namespace atta
 			template <typename U>
 			void operator-=(const matrix<U>& o);
 			// *
-			template <typename U>
-			matrix<T> operator*(const matrix<U>& o);
-			template <typename U>
-			matrix<T> operator*(U v);
-			template <typename U>
-			void operator*=(const matrix<U>& o);
-			template <typename U>
-			void operator*=(U v);
+			matrix<T> operator*(const matrix<T>& o) const;
+			matrix<T> operator*(T v) const;
+			void operator*=(const matrix<T>& o);
+			void operator*=(T v);
 
 			// Matrix operations
 			matrix<T>& transpose();
 
 			// Vector operations
 			template <typename U>
-			vector<U> operator*(const vector<U>& v);
-
-			std::string toString();
+			vector<U> operator*(const vector<U>& v) const;
 
+			std::string toString() const;
 	};
 
+	// C = alpha*A*B + beta*C (blocked, split between threads when the matrices are large)
+	template <typename T>
+	void gemm(T alpha, matrixView<const T> A, matrixView<const T> B, T beta, matrixView<T> C);
+
+	// C = A*B (C is resized, reuses its memory when possible)
+	template <typename T>
+	void multiply(const matrix<T>& A, const matrix<T>& B, matrix<T>& C);
+
 	template <typename T>
 	inline matrix<T> transpose(const matrix<T>& m);
 
@@ -13,7 +13,8 @@
 
 namespace atta
 {
-    class quat
+	// 16 byte aligned (r,i,j,k are loaded as one SIMD register)
+    class alignas(16) quat
     {
     public:
         union {
@@ -36,7 +37,12 @@ namespace atta
 
         void normalize()
         {
+#ifdef ATTA_SIMD
+			simd::float4 q = simd::load(data);
+			float d = simd::first(simd::dot4(q, q));
+#else
             float d = r*r+i*i+j*j+k*k;
+#endif
 
             // Check for zero length quaternion, and use the no-rotation
             // quaternion in that case
@@ -46,23 +52,38 @@ namespace atta
             }
 
             d = 1.0f/std::sqrt(d);
+#ifdef ATTA_SIMD
+			simd::store(data, simd::mul(q, simd::splat(d)));
+#else
             r *= d;
             i *= d;
             j *= d;
             k *= d;
+#endif
         }
 
 		// quat multiplication
         void operator *=(const quat &multiplier)
         {
+#ifdef ATTA_SIMD
+			// Each component of this quaternion times the multiplier components shuffled and signed
+			simd::float4 q = simd::load(data);
+			simd::float4 m = simd::load(multiplier.data);
+			simd::float4 res = simd::mul(simd::splatLane<0>(q), m);
+			res = simd::madd(simd::splatLane<1>(q), simd::mul(simd::shuffle<1,0,3,2>(m, m), simd::set(-1, 1,-1, 1)), res);
+			res = simd::madd(simd::splatLane<2>(q), simd::mul(simd::shuffle<2,3,0,1>(m, m), simd::set(-1, 1, 1,-1)), res);
+			res = simd::madd(simd::splatLane<3>(q), simd::mul(simd::shuffle<3,2,1,0>(m, m), simd::set(-1,-1, 1, 1)), res);
+			simd::store(data, res);
+#else
             quat q = *this;
             r = q.r*multiplier.r - q.i*multiplier.i - q.j*multiplier.j - q.k*multiplier.k;
             i = q.r*multiplier.i + q.i*multiplier.r + q.j*multiplier.k - q.k*multiplier.j;
             j = q.r*multiplier.j + q.j*multiplier.r + q.k*multiplier.i - q.i*multiplier.k;
             k = q.r*multiplier.k + q.k*multiplier.r + q.i*multiplier.j - q.j*multiplier.i;
+#endif
         }
 
-        quat operator *(const quat &multiplier)
+        quat operator *(const quat &multiplier) const
         {
 			quat result = (*this);
 			result*=multiplier;
@@ -74,10 +95,14 @@ namespace atta
             quat q(0, vec.x, vec.y, vec.z);
             q *= *this;
 
+#ifdef ATTA_SIMD
+			simd::store(data, simd::madd(simd::load(q.data), simd::splat(0.5f), simd::load(data)));
+#else
             r += q.r * 0.5f;
             i += q.i * 0.5f;
             j += q.j * 0.5f;
             k += q.k * 0.5f;
+#endif
         }
 
         void addScaledVector(const vec3& vec, float scale)
@@ -87,10 +112,14 @@ namespace atta
                 vec.y * scale,
                 vec.z * scale);
             q *= *this;
+#ifdef ATTA_SIMD
+			simd::store(data, simd::madd(simd::load(q.data), simd::splat(0.5f), simd::load(data)));
+#else
             r += q.r * 0.5f;
             i += q.i * 0.5f;
             j += q.j * 0.5f;
             k += q.k * 0.5f;
+#endif
         }
 
         void rotateByVector(const vec3& vector)
@@ -99,6 +128,30 @@ namespace atta
             (*this) *= q;
         }
 
+		// Rotate the vector by this (unit) quaternion
+		vec3 rotate(const vec3& v) const
+		{
+#ifdef ATTA_SIMD
+			// v + 2*cross(u, cross(u, v) + r*v), with u=(i,j,k) in the lanes 1..3
+			auto cross = [](simd::float4 a, simd::float4 b)
+			{
+				return simd::sub(
+						simd::mul(simd::shuffle<0,2,3,1>(a, a), simd::shuffle<0,3,1,2>(b, b)),
+						simd::mul(simd::shuffle<0,3,1,2>(a, a), simd::shuffle<0,2,3,1>(b, b)));
+			};
+			simd::float4 q = simd::load(data);
+			simd::float4 p = simd::set(0, v.x, v.y, v.z);
+			simd::float4 t = simd::madd(simd::splatLane<0>(q), p, cross(q, p));
+			alignas(16) float res[4];
+			simd::store(res, simd::madd(simd::splat(2.0f), cross(q, t), p));
+			return vec3(res[1], res[2], res[3]);
+#else
+			vec3 u(i, j, k);
+			vec3 t = u.cross(v) + v*r;
+			return v + u.cross(t)*2.0f;
+#endif
+		}
+
 		void transformVector(const vec3& before, const vec3& after);
 
 		void fromEuler(const vec3 &e)
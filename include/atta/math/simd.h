@@ -0,0 +1,141 @@
+//--------------------------------------------------
+// Atta Math
+// simd.h
+// Date: 2021-07-27
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_MATH_SIMD_H
+#define ATTA_MATH_SIMD_H
+
+// 4-wide float operations used by vec4, quat, mat3 and mat4
+//
+// SSE backend on x86-64 (AVX/FMA are used when enabled by the compiler flags) and NEON backend on AArch64.
+// ATTA_SIMD is only defined when a backend is available, with -DATTA_SIMD_DISABLED the math types use their
+// scalar implementation (reference results and benchmarks).
+#if !defined(ATTA_SIMD_DISABLED) && (defined(__SSE2__) || defined(_M_X64))
+	#define ATTA_SIMD
+	#define ATTA_SIMD_SSE
+	#include <immintrin.h>
+#elif !defined(ATTA_SIMD_DISABLED) && defined(__ARM_NEON) && defined(__aarch64__)
+	#define ATTA_SIMD
+	#define ATTA_SIMD_NEON
+	#include <arm_neon.h>
+#endif
+
+#ifdef ATTA_SIMD
+namespace atta::simd
+{
+#ifdef ATTA_SIMD_SSE
+	using float4 = __m128;
+
+	inline float4 load(const float* p) { return _mm_load_ps(p); }// 16 byte aligned
+	inline float4 loadu(const float* p) { return _mm_loadu_ps(p); }
+	// Only reads p[0..2] (w=0)
+	inline float4 load3(const float* p)
+	{
+		return _mm_movelh_ps(_mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(p))), _mm_load_ss(p+2));
+	}
+	inline void store(float* p, float4 v) { _mm_store_ps(p, v); }
+	inline void storeu(float* p, float4 v) { _mm_storeu_ps(p, v); }
+	// Only writes p[0..2]
+	inline void store3(float* p, float4 v)
+	{
+		_mm_store_sd(reinterpret_cast<double*>(p), _mm_castps_pd(v));
+		_mm_store_ss(p+2, _mm_movehl_ps(v, v));
+	}
+
+	inline float4 set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+	inline float4 splat(float v) { return _mm_set1_ps(v); }
+	inline float first(float4 v) { return _mm_cvtss_f32(v); }
+
+	inline float4 add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+	inline float4 sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+	inline float4 mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+	inline float4 div(float4 a, float4 b) { return _mm_div_ps(a, b); }
+	inline float4 sqrt(float4 a) { return _mm_sqrt_ps(a); }
+	// a*b+c
+	inline float4 madd(float4 a, float4 b, float4 c)
+	{
+	#ifdef __FMA__
+		return _mm_fmadd_ps(a, b, c);
+	#else
+		return _mm_add_ps(_mm_mul_ps(a, b), c);
+	#endif
+	}
+
+	// {a[x], a[y], b[z], b[w]}
+	template <int x, int y, int z, int w>
+	inline float4 shuffle(float4 a, float4 b) { return _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x)); }
+
+	// Lane masks (all bits set when true)
+	inline float4 less(float4 a, float4 b) { return _mm_cmplt_ps(a, b); }
+	// mask ? a : b
+	inline float4 select(float4 mask, float4 a, float4 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+#else
+	using float4 = float32x4_t;
+
+	inline float4 load(const float* p) { return vld1q_f32(p); }
+	inline float4 loadu(const float* p) { return vld1q_f32(p); }
+	inline float4 load3(const float* p) { return vcombine_f32(vld1_f32(p), vset_lane_f32(p[2], vdup_n_f32(0), 0)); }
+	inline void store(float* p, float4 v) { vst1q_f32(p, v); }
+	inline void storeu(float* p, float4 v) { vst1q_f32(p, v); }
+	inline void store3(float* p, float4 v)
+	{
+		vst1_f32(p, vget_low_f32(v));
+		vst1q_lane_f32(p+2, v, 2);
+	}
+
+	inline float4 set(float x, float y, float z, float w) { const float v[4] = {x, y, z, w}; return vld1q_f32(v); }
+	inline float4 splat(float v) { return vdupq_n_f32(v); }
+	inline float first(float4 v) { return vgetq_lane_f32(v, 0); }
+
+	inline float4 add(float4 a, float4 b) { return vaddq_f32(a, b); }
+	inline float4 sub(float4 a, float4 b) { return vsubq_f32(a, b); }
+	inline float4 mul(float4 a, float4 b) { return vmulq_f32(a, b); }
+	inline float4 div(float4 a, float4 b) { return vdivq_f32(a, b); }
+	inline float4 sqrt(float4 a) { return vsqrtq_f32(a); }
+	inline float4 madd(float4 a, float4 b, float4 c) { return vmlaq_f32(c, a, b); }
+
+	template <int x, int y, int z, int w>
+	inline float4 shuffle(float4 a, float4 b) { return __builtin_shufflevector(a, b, x, y, z+4, w+4); }
+
+	inline float4 less(float4 a, float4 b) { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+	inline float4 select(float4 mask, float4 a, float4 b) { return vbslq_f32(vreinterpretq_u32_f32(mask), a, b); }
+#endif
+
+	template <int i>
+	inline float4 splatLane(float4 v) { return shuffle<i, i, i, i>(v, v); }
+
+	// Dot product in all lanes
+	inline float4 dot4(float4 a, float4 b)
+	{
+		float4 m = mul(a, b);
+		m = add(m, shuffle<1, 0, 3, 2>(m, m));
+		return add(m, shuffle<2, 3, 0, 1>(m, m));
+	}
+
+	// Rows to columns
+	inline void transpose(float4& a, float4& b, float4& c, float4& d)
+	{
+		const float4 t0 = shuffle<0, 1, 0, 1>(a, b);
+		const float4 t1 = shuffle<2, 3, 2, 3>(a, b);
+		const float4 t2 = shuffle<0, 1, 0, 1>(c, d);
+		const float4 t3 = shuffle<2, 3, 2, 3>(c, d);
+		a = shuffle<0, 2, 0, 2>(t0, t2);
+		b = shuffle<1, 3, 1, 3>(t0, t2);
+		c = shuffle<0, 2, 0, 2>(t1, t3);
+		d = shuffle<1, 3, 1, 3>(t1, t3);
+	}
+
+	// {dot(a,v), dot(b,v), dot(c,v), dot(d,v)}
+	inline float4 dot4x4(float4 a, float4 b, float4 c, float4 d, float4 v)
+	{
+		a = mul(a, v); b = mul(b, v); c = mul(c, v); d = mul(d, v);
+		float4 ab = add(shuffle<0, 2, 0, 2>(a, b), shuffle<1, 3, 1, 3>(a, b));
+		float4 cd = add(shuffle<0, 2, 0, 2>(c, d), shuffle<1, 3, 1, 3>(c, d));
+		return add(shuffle<0, 2, 0, 2>(ab, cd), shuffle<1, 3, 1, 3>(ab, cd));
+	}
+}
+#endif// ATTA_SIMD
+
+#endif// ATTA_MATH_SIMD_H
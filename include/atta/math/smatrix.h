@@ -0,0 +1,111 @@
+//--------------------------------------------------
+// Atta Math
+// smatrix.h
+// Date: 2021-06-04
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#ifndef ATTA_MATH_SMATRIX_H
+#define ATTA_MATH_SMATRIX_H
+
+#include <atta/math/matrix.h>
+#include <algorithm>
+#include <string>
+
+namespace atta
+{
+	// Dense matrix with compile time dimensions, stored row-major on the stack (never allocates)
+	template <typename T, size_t R, size_t C>
+	class smatrix
+	{
+		public:
+			static constexpr size_t nrows = R;
+			static constexpr size_t ncols = C;
+			T data[R*C];
+
+			smatrix(): data{} {}
+			explicit smatrix(T val) { fill(val); }
+
+			// Access (returns pointer to the row, A[i][j] is valid)
+			T* operator[](size_t i) { return data+i*C; }
+			const T* operator[](size_t i) const { return data+i*C; }
+
+			// Views (no copy)
+			matrixView<T> view() { return {data, R, C, C}; }
+			matrixView<const T> view() const { return {data, R, C, C}; }
+
+			void fill(T val) { std::fill(data, data+R*C, val); }
+			void setIdentity()
+			{
+				fill(T(0));
+				for(size_t i=0; i<std::min(R, C); i++)
+					data[i*C+i] = T(1);
+			}
+			void swapRows(size_t i, size_t j)
+			{
+				if(i != j)
+					std::swap_ranges((*this)[i], (*this)[i]+C, (*this)[j]);
+			}
+
+			// Basic operations
+			// +
+			smatrix<T,R,C> operator+(const smatrix<T,R,C>& o) const { smatrix<T,R,C> res = *this; res += o; return res; }
+			void operator+=(const smatrix<T,R,C>& o) { for(size_t i=0; i<R*C; i++) data[i] += o.data[i]; }
+			// -
+			smatrix<T,R,C> operator-(const smatrix<T,R,C>& o) const { smatrix<T,R,C> res = *this; res -= o; return res; }
+			void operator-=(const smatrix<T,R,C>& o) { for(size_t i=0; i<R*C; i++) data[i] -= o.data[i]; }
+			// *
+			smatrix<T,R,C> operator*(T v) const { smatrix<T,R,C> res = *this; res *= v; return res; }
+			void operator*=(T v) { for(size_t i=0; i<R*C; i++) data[i] *= v; }
+			template <size_t C2>
+			smatrix<T,R,C2> operator*(const smatrix<T,C,C2>& o) const
+			{
+				smatrix<T,R,C2> res;
+				for(size_t i=0; i<R; i++)
+					for(size_t k=0; k<C; k++)
+					{
+						const T a = data[i*C+k];
+						for(size_t j=0; j<C2; j++)
+							res.data[i*C2+j] += a*o.data[k*C2+j];
+					}
+				return res;
+			}
+
+			std::string toString() const
+			{
+				std::string res = "\n[";
+				for(size_t i=0; i<R; i++)
+				{
+					res+="[";
+					for(size_t j=0; j<C; j++)
+						res += std::to_string(data[i*C+j]) + (j!=C-1 ? ", " : "]");
+					res += i!=R-1 ? ",\n" : "]";
+				}
+				return res;
+			}
+	};
+
+	template <typename T, size_t R, size_t C>
+	inline smatrix<T,C,R> transpose(const smatrix<T,R,C>& m)
+	{
+		smatrix<T,C,R> t;
+		for(size_t i=0; i<R; i++)
+			for(size_t j=0; j<C; j++)
+				t.data[j*R+i] = m.data[i*C+j];
+		return t;
+	}
+
+	inline mat3 toMat3(const smatrix<float,3,3>& m)
+	{
+		mat3 res;
+		for(size_t i=0; i<9; i++)
+			res.data[i] = m.data[i];
+		return res;
+	}
+
+	template <size_t R, size_t C>
+	using smatf = smatrix<float, R, C>;
+	template <size_t R, size_t C>
+	using smatd = smatrix<double, R, C>;
+}
+
+#endif// ATTA_MATH_SMATRIX_H
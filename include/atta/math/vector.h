@@ -10,6 +10,7 @@
 #include <math.h>
 #include <string>
 #include <vector>
+#include <atta/math/simd.h>
 
 namespace atta
 {
@@ -23,8 +24,9 @@ namespace atta
 	//----------------------------------------//
 	//--------------- Vector 4 ---------------//
 	//----------------------------------------//
+	// 16 byte aligned (vec4 operations use SIMD registers, see the specializations below)
 	template <typename T>
-	class vector4
+	class alignas(16) vector4
 	{
 		public:
 			T x, y, z, w;
@@ -257,6 +259,96 @@ namespace atta
 		return v;
 	}
 
+#ifdef ATTA_SIMD
+	//---------- vec4 SIMD ----------//
+	template <>
+	template <>
+	inline void vector4<float>::operator+=(const vector4<float>& v)
+	{
+		simd::store(&x, simd::add(simd::load(&x), simd::load(&v.x)));
+	}
+
+	template <>
+	template <>
+	inline vector4<float> vector4<float>::operator+(const vector4<float>& v) const
+	{
+		vector4<float> result;
+		simd::store(&result.x, simd::add(simd::load(&x), simd::load(&v.x)));
+		return result;
+	}
+
+	template <>
+	template <>
+	inline void vector4<float>::operator-=(const vector4<float>& v)
+	{
+		simd::store(&x, simd::sub(simd::load(&x), simd::load(&v.x)));
+	}
+
+	template <>
+	template <>
+	inline vector4<float> vector4<float>::operator-(const vector4<float>& v) const
+	{
+		vector4<float> result;
+		simd::store(&result.x, simd::sub(simd::load(&x), simd::load(&v.x)));
+		return result;
+	}
+
+	template <>
+	template <>
+	inline void vector4<float>::operator*=(const float value)
+	{
+		simd::store(&x, simd::mul(simd::load(&x), simd::splat(value)));
+	}
+
+	template <>
+	template <>
+	inline vector4<float> vector4<float>::operator*(const float value) const
+	{
+		vector4<float> result;
+		simd::store(&result.x, simd::mul(simd::load(&x), simd::splat(value)));
+		return result;
+	}
+
+	template <>
+	template <>
+	inline void vector4<float>::operator*=(const vector4<float> vector)
+	{
+		simd::store(&x, simd::mul(simd::load(&x), simd::load(&vector.x)));
+	}
+
+	template <>
+	template <>
+	inline vector4<float> vector4<float>::operator*(const vector4<float> vector) const
+	{
+		vector4<float> result;
+		simd::store(&result.x, simd::mul(simd::load(&x), simd::load(&vector.x)));
+		return result;
+	}
+
+	template <>
+	template <>
+	inline float vector4<float>::dot(const vector4<float> &vec) const
+	{
+		return simd::first(simd::dot4(simd::load(&x), simd::load(&vec.x)));
+	}
+
+	template <>
+	inline float vector4<float>::squareLength() const
+	{
+		simd::float4 v = simd::load(&x);
+		return simd::first(simd::dot4(v, v));
+	}
+
+	template <>
+	inline void vector4<float>::normalize()
+	{
+		simd::float4 v = simd::load(&x);
+		float l = sqrt(simd::first(simd::dot4(v, v)));
+		if(l > 0)
+			simd::store(&x, simd::mul(v, simd::splat(1.0f/l)));
+	}
+#endif// ATTA_SIMD
+
 	//----------------------------------------//
 	//--------------- Vector 3 ---------------//
 	//----------------------------------------//
@@ -264,9 +356,8 @@ namespace atta
 	class vector3
 	{
 		public:
+			// Not padded, vec3 is part of the vertex and GPU buffer layouts
 			T x, y, z;
-		//private:
-		//	T pad;// 4 word alignment
 
 		public:
         	vector3(): x(0), y(0), z(0) {};
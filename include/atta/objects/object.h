@@ -11,14 +11,19 @@
 #include <vector>
 #include <memory>
 #include <atta/math/math.h>
+#include <atta/core/objectHandle.h>
+#include <atta/helpers/pool.h>
 #include <atta/physics/body.h>
 #include <atta/physics/constraints/constraints.h>
 #include <atta/graphics/core/model.h>
 
 namespace atta
 {
+	class TransformSystem;
 	class Object
 	{
+		friend class TransformSystem;
+		friend class SceneRegistry;
 		public:
 			enum ObjectSelection {
 				UNSELECTED = 0,
@@ -44,6 +49,8 @@ namespace atta
 			std::string getName() const { return _name; }
 			bool isLight() const { return _isLight; }
 			int getId() const { return _id; }
+			ObjectHandle getHandle() const { return _handle; }
+			// World matrix (cached by the scene transform system, recalculated if the object or an ancestor changed after the last update)
 			mat4 getModelMat() const;
 			quat getOrientation() const { return _orientation; }
 
@@ -58,13 +65,13 @@ namespace atta
 
 			// Object hierarchy
 			Object* getParent() const { return _parent; }
-			std::vector<std::shared_ptr<Object>> getChildren() const { return _children; }
+			const std::vector<std::shared_ptr<Object>>& getChildren() const { return _children; }
 			//std::shared_ptr<atta::phy::Constraint> getParentConstraint() const { return _parentConstraint; }
 
 
 			//---------- Setters ----------//
-			void setPosition(vec3 position) { _position = position; }
-			void setOrientation(quat orientation) { _orientation = orientation; }
+			void setPosition(vec3 position) { _position = position; _transformDirty = true; }
+			void setOrientation(quat orientation) { _orientation = orientation; _transformDirty = true; }
 
 		protected:
 			void setParent(Object* parent) { _parent = parent; };
@@ -87,6 +94,12 @@ namespace atta
 			vec3 _position;
 			quat _orientation;
 			vec3 _scale;
+			bool _transformDirty;// Local matrix must be recalculated
+
+			// Transform cache (nullptr if the object is not in a scene)
+			TransformSystem* _transformSystem;
+			unsigned _transformIndex;
+			ObjectHandle _handle;// Scene registry handle (invalid if the object is not in a scene)
 			
 			//----- Graphics -----//
 			std::shared_ptr<Model> _model;
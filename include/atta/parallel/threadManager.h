@@ -11,6 +11,7 @@
 #include <thread>
 #include <memory>
 #include <functional>
+#include <fstream>
 #include <atta/parallel/barrier.h>
 #include <atta/parallel/workerGeneralist.h>
 #include <atta/parallel/workerGui.h>
@@ -21,6 +22,8 @@
 #include <atta/graphics/vulkan/vulkanCore.h>
 #include <atta/physics/physicsEngine.h>
 #include <atta/objects/sensors/camera/camera.h>
+#include <atta/communication/stateStream/stateStreamer.h>
+#include <atta/communication/sharedMemory/shmServer.h>
 
 namespace atta
 {
@@ -32,6 +35,16 @@ namespace atta
 				std::shared_ptr<Scene> scene;
 				DimMode dimensionMode = DIM_MODE_3D;
 				std::shared_ptr<vk::VulkanCore> vkCore;
+
+				// Deterministic mode: fixed dt and a state hash after each step (optionally written to stateHashFile)
+				bool deterministic = false;
+				float fixedDt = 0.01f;
+				std::string stateHashFile = "";
+
+				// Publish the state after each step to remote subscribers (0 -> disabled)
+				unsigned stateStreamPort = 0;
+				// Publish the camera images in shared memory snapshots (empty -> disabled)
+				std::string sharedMemoryName = "";
 			};
 
 			struct PhysicsStage {
@@ -70,6 +83,11 @@ namespace atta
 
 			void run();
 
+			//---------- Getters ----------//
+			// Steps finished since run() started and the scene state hash after the last one (deterministic mode)
+			uint64_t getStep() const { return _step; }
+			uint64_t getStateHash() const { return _stateHash; }
+
 		private:
 			void createGeneralistWorkers();
 			void createGuiWorker();
@@ -78,6 +96,11 @@ namespace atta
 			void createPhysicsObjects();
 			void createRenderingObjects();
 
+			// Spawn/despawn requested since the last frame
+			void applySceneChanges();
+			// Robots of this thread (main thread is 0) with ROBOT_PROCESSING_PARALLEL_CPU
+			void runRobots(unsigned threadIndex);
+
 			bool _shouldFinish;
 
 			//---------- Parallel ----------//
@@ -99,6 +122,12 @@ namespace atta
 			std::shared_ptr<Accelerator> _accelerator;
 			DimMode _dimensionMode;
 			std::shared_ptr<vk::VulkanCore> _vkCore;
+			bool _deterministic;
+			float _fixedDt;
+			uint64_t _step;
+			uint64_t _stateHash;
+			std::ofstream _stateHashFile;
+			std::unique_ptr<StateStreamer> _stateStreamer;
 
 			//---------- Physics stage ----------//
 			std::shared_ptr<phy::PhysicsEngine> _physicsEngine;
@@ -108,10 +137,15 @@ namespace atta
 			std::shared_ptr<vk::CommandBuffers> _commandBuffers;
 			// Camera
 			std::vector<std::shared_ptr<Renderer>> _cameraRenderers;
-			std::vector<std::shared_ptr<Camera>> _cameras;
+			std::vector<Camera*> _cameras;// Owned by the scene
+			// Camera images published to local controllers (snapshot index of each camera, fixed at start)
+			std::string _sharedMemoryName;
+			std::unique_ptr<ShmServer> _shmServer;
+			std::vector<size_t> _cameraSnapshots;
 
 			//---------- Robot stage ----------//
 			RobotProcessing _robotProcessing;
+			float _robotDt;// dt of the current frame (read by the workers)
 			std::function<void(WorkerGui*)> _runBeforeWorkerGuiRender;
 			std::function<void(void)> _runAfterRobots;
 
@@ -7,6 +7,7 @@
 #ifndef ATTA_PARALLEL_WORKER_GENERALIST_H
 #define ATTA_PARALLEL_WORKER_GENERALIST_H
 
+#include <functional>
 #include <atta/parallel/worker.h>
 #include <atta/parallel/barrier.h>
 
@@ -21,6 +22,8 @@ namespace atta
 				std::shared_ptr<Barrier> physicsStageBarrier;
 				std::shared_ptr<Barrier> sensorStageBarrier;
 				std::shared_ptr<Barrier> robotStageBarrier;
+				unsigned index = 1;// Main thread is 0
+				std::function<void(unsigned index)> runRobotStage;
 			};
 			WorkerGeneralist(CreateInfo createInfo);
 			~WorkerGeneralist();
@@ -32,6 +35,8 @@ namespace atta
 			std::shared_ptr<Barrier> _physicsStageBarrier;
 			std::shared_ptr<Barrier> _sensorStageBarrier;
 			std::shared_ptr<Barrier> _robotStageBarrier;
+			unsigned _index;
+			std::function<void(unsigned index)> _runRobotStage;
 	};
 }
 
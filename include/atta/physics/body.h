@@ -18,7 +18,8 @@ namespace atta::phy
 	{
 		friend class Contact;
 		public:
-			Body(vec3* position, quat* orientation, float mass=1.0);
+			// transformDirty is set when the position/orientation changes (object transform cache)
+			Body(vec3* position, quat* orientation, float mass=1.0, bool* transformDirty=nullptr);
 			~Body();
 
 			//---------- Shape ----------//
@@ -29,6 +30,9 @@ namespace atta::phy
 			void addForceAtBodyPoint(vec3 force, vec3 point);
 			void addForceAtPoint(vec3 force, vec3 point);
 			void integrate(float dt);
+			// integrate() in two parts, the physics engine integrates the orientations of all bodies in between
+			void integrateVelocities(float dt);// Velocities and position
+			void finishIntegration();// Derived data, accumulators and sleep (after the orientation is integrated)
 
 			//---------- Velocity ----------//
 			void addVelocity(vec3 vel) { _velocity+=vel; }
@@ -43,24 +47,24 @@ namespace atta::phy
 			vec3 getAcceleration() const { return _acceleration; };
 			vec3 getLastFrameAcceleration() const { return _lastFrameAcceleration; };
 			float getInverseMass() const { return _inverseMass; }
-			float getMass() const { return _inverseMass<=0 ? 0 : _inverseMass; };
+			float getMass() const { return _inverseMass<=0 ? 0 : 1/_inverseMass; };// 0 -> Infinite mass (static body)
 			float getDamping() const { return _damping; };
 
 			mat3 getInverseInertiaTensorWorld() const { return _inverseInertiaTensorWorld; }
 			quat getOrientation() const { return *_orientation; };
 			vec3 getRotation() const { return _rotation; };
 
-			std::vector<std::shared_ptr<Shape>> getShapes() const { return _shapes; }
+			const std::vector<std::shared_ptr<Shape>>& getShapes() const { return _shapes; }
 			mat4 getTransformMatrix() const { return _transformMatrix; };
 			bool getIsAwake() const { return _isAwake; }
 
 			//---------- Setters ----------//
-			void setPosition(vec3 position) { *_position = position; };
+			void setPosition(vec3 position) { *_position = position; markTransformDirty(); };
 			void setVelocity(vec3 velocity) { _velocity = velocity; };
 			void setAcceleration(vec3 acceleration) { _acceleration = acceleration; };
 			void setMass(float mass) { _inverseMass = mass>0 ? 1/mass : 0; };
 
-			void setOrientation(quat orientation) { (*_orientation) = orientation; }
+			void setOrientation(quat orientation) { (*_orientation) = orientation; markTransformDirty(); }
         	void setIsAwake(const bool awake=true);
 
 		private:
@@ -69,6 +73,7 @@ namespace atta::phy
 			void calculateDerivedData();
 			void calculateTransformMatrix();
 			void transformInertiaTensor();
+			void markTransformDirty() { if(_transformDirty) *_transformDirty = true; }
 
 			// Shape
 			std::vector<std::shared_ptr<Shape>> _shapes;
@@ -96,9 +101,14 @@ namespace atta::phy
 			bool _isAwake;
 			bool _canSleep;
 			float _motion;// Stores the amount of kinect energy (if it is low, body will sleep)
+			float _lastDt;// Damping factors for the last integration step
+			float _dampingDt;
+			float _angularDampingDt;
+			float _motionBiasDt;
 
 			// Useful while rendering and some calculations
 			mat4 _transformMatrix;
+			bool* _transformDirty;
 	};
 }
 #endif// ATTA_PHYSICS_BODY_H
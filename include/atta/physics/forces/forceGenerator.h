@@ -27,6 +27,8 @@ namespace atta::phy
 
 			void add(std::shared_ptr<Body> object, std::shared_ptr<Force> force);
 			void remove(std::shared_ptr<Body> object, std::shared_ptr<Force> force);
+			// Remove all forces applied to the body (body despawned)
+			void removeBody(Body* object);
 			void clear();
 			
 			void updateForces(float dt);
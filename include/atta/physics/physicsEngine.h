@@ -11,6 +11,7 @@
 #include <atta/physics/body.h>
 #include <atta/math/math.h>
 #include <atta/core/accelerator.h>
+#include <atta/core/scene.h>
 #include <atta/physics/forces/forceGenerator.h>
 #include <atta/physics/contacts/contactGenerator.h>
 #include <atta/physics/contacts/contactResolver.h>
@@ -22,6 +23,7 @@ namespace atta::phy
 		public:
 			struct CreateInfo {
 				std::shared_ptr<Accelerator> accelerator;
+				std::shared_ptr<Scene> scene;// The bodies are read from the scene registry
 			};
 
 			PhysicsEngine(CreateInfo info);
@@ -29,10 +31,17 @@ namespace atta::phy
 
 			void stepPhysics(float dt);
 
+			// Root objects spawned/despawned at runtime (also updates the accelerator)
+			void addObject(std::shared_ptr<Object> object);
+			void removeObject(Object* object);
+
 		private:
+			// Forces and integration of all bodies
+			void integrateBodies(float dt);
+
 			std::shared_ptr<Accelerator> _accelerator;
+			std::shared_ptr<Scene> _scene;
 
-			std::vector<std::shared_ptr<Body>> _bodies;
 			std::shared_ptr<ForceGenerator> _forceGenerator;
 			std::shared_ptr<ContactResolver> _contactResolver;
 			std::shared_ptr<ContactGenerator> _contactGenerator;
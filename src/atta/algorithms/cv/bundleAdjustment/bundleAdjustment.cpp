@@ -5,19 +5,547 @@
 // By Breno Cunha Queiroz
 //--------------------------------------------------
 #include <atta/algorithms/cv/bundleAdjustment/bundleAdjustment.h>
+#include <atta/algorithms/linAlg/LU/staticLU.h>
+#include <atta/helpers/evaluator.h>
+#include <atta/helpers/log.h>
+#include <thread>
 
 namespace atta::cv
 {
+	// Reference: Triggs et al. - Bundle Adjustment, A Modern Synthesis (2000)
+	// Reference: Agarwal et al. - Bundle Adjustment in the Large (2010)
+	namespace
+	{
+		struct Camera
+		{
+			smatd<3,3> R;
+			double t[3];
+		};
+
+		// Residual and jacobians of one measurement
+		struct MeasurementJacobian
+		{
+			double r[2];
+			double A[2][6];// d(proj)/d(camera) (left rotation perturbation, translation)
+			double B[2][3];// d(proj)/d(point)
+			double W[6][3];// A^T*B
+		};
+
+		// Split [0,n) in contiguous ranges between threads
+		template <typename F>
+		void parallelFor(size_t n, size_t qtyThreads, F&& f)
+		{
+			if(qtyThreads <= 1 || n < 512)
+			{
+				f(0, n, 0);
+				return;
+			}
+			std::vector<std::thread> threads;
+			const size_t chunk = (n+qtyThreads-1)/qtyThreads;
+			for(size_t t=0; t<qtyThreads && t*chunk<n; t++)
+				threads.emplace_back(f, t*chunk, std::min(n, (t+1)*chunk), t);
+			for(auto& thread : threads)
+				thread.join();
+		}
+
+		smatd<3,3> skew(const double a[3])
+		{
+			smatd<3,3> S;
+			S[0][1] = -a[2]; S[0][2] = a[1];
+			S[1][0] = a[2]; S[1][2] = -a[0];
+			S[2][0] = -a[1]; S[2][1] = a[0];
+			return S;
+		}
+
+		// Rodrigues formula (angle-axis to rotation matrix)
+		smatd<3,3> expRotation(const double w[3])
+		{
+			const double theta = std::sqrt(w[0]*w[0]+w[1]*w[1]+w[2]*w[2]);
+			smatd<3,3> R;
+			R.setIdentity();
+			const smatd<3,3> K = skew(w);
+			if(theta < 1e-12)
+				return R+K;
+			const double a = std::sin(theta)/theta;
+			const double b = (1-std::cos(theta))/(theta*theta);
+			return R + K*a + (K*K)*b;
+		}
+
+		// Rotation matrix to angle-axis
+		void logRotation(const smatd<3,3>& R, double w[3])
+		{
+			const double c = std::clamp((R[0][0]+R[1][1]+R[2][2]-1)*0.5, -1.0, 1.0);
+			const double theta = std::acos(c);
+			const double v[3] = {R[2][1]-R[1][2], R[0][2]-R[2][0], R[1][0]-R[0][1]};// 2*sin(theta)*axis
+			if(c < -0.99)
+			{
+				// Near pi the skew part vanishes, axis from the symmetric part: (R+R^T)/2 - c*I = (1-c)*axis*axis^T
+				size_t i = 0;
+				for(size_t k=1; k<3; k++)
+					if(R[k][k] > R[i][i])
+						i = k;
+				double axis[3];
+				axis[i] = std::sqrt(std::max((R[i][i]-c)/(1-c), 0.0));
+				for(size_t k=0; k<3; k++)
+					if(k != i)
+						axis[k] = (R[i][k]+R[k][i])*0.5/((1-c)*axis[i]);
+				// Same direction as the skew part (if not exactly pi)
+				const double sign = axis[0]*v[0]+axis[1]*v[1]+axis[2]*v[2] < 0 ? -1.0 : 1.0;
+				for(size_t k=0; k<3; k++)
+					w[k] = axis[k]*theta*sign;
+				return;
+			}
+			const double s = std::sin(theta);
+			const double k = s < 1e-9 ? 0.5 : theta/(2*s);
+			for(size_t i=0; i<3; i++)
+				w[i] = v[i]*k;
+		}
+
+		smatd<3,3> inverse3(const smatd<3,3>& m)
+		{
+			smatd<3,3> inv;
+			inv[0][0] = m[1][1]*m[2][2]-m[1][2]*m[2][1];
+			inv[0][1] = m[0][2]*m[2][1]-m[0][1]*m[2][2];
+			inv[0][2] = m[0][1]*m[1][2]-m[0][2]*m[1][1];
+			inv[1][0] = m[1][2]*m[2][0]-m[1][0]*m[2][2];
+			inv[1][1] = m[0][0]*m[2][2]-m[0][2]*m[2][0];
+			inv[1][2] = m[0][2]*m[1][0]-m[0][0]*m[1][2];
+			inv[2][0] = m[1][0]*m[2][1]-m[1][1]*m[2][0];
+			inv[2][1] = m[0][1]*m[2][0]-m[0][0]*m[2][1];
+			inv[2][2] = m[0][0]*m[1][1]-m[0][1]*m[1][0];
+			const double det = m[0][0]*inv[0][0]+m[0][1]*inv[1][0]+m[0][2]*inv[2][0];
+			if(std::abs(det) < 1e-300)
+				return smatd<3,3>();
+			return inv*(1.0/det);
+		}
+
+		smatd<6,6> inverse6(const smatd<6,6>& m)
+		{
+			linalg::StaticLU<double,6> lu(m);
+			smatd<6,6> inv;
+			if(lu.sing)
+				return inv;
+			for(size_t c=0; c<6; c++)
+			{
+				double e[6] = {0,0,0,0,0,0};
+				double x[6];
+				e[c] = 1;
+				lu.solve(e, x);
+				for(size_t r=0; r<6; r++)
+					inv[r][c] = x[r];
+			}
+			return inv;
+		}
+	}
+
 	BundleAdjustment::BundleAdjustment()
 	{
 
 	}
 
-	void BundleAdjustment::run()
+	BundleAdjustment::BundleAdjustment(CreateInfo info):
+		_info(info)
 	{
 
 	}
 
+	bool BundleAdjustment::run()
+	{
+		const size_t qtyCameras = _cameraPoses.size();
+		const size_t qtyPoints = _points3D.size();
+		const size_t qtyMeasurements = _measurements.size();
+		_report = {};
+
+		// The sparsity structure is indexed by the measurements
+		for(const auto& m : _measurements)
+			if(m.imageIndex >= qtyCameras || m.point3DIndex >= qtyPoints)
+			{
+				Log::warning("BundleAdjustment", "Measurement of image $0 and 3D point $1 is out of range ($2 images, $3 points)",
+						m.imageIndex, m.point3DIndex, qtyCameras, qtyPoints);
+				return false;
+			}
+		if(qtyCameras == 0 || qtyPoints == 0 || qtyMeasurements == 0)
+			return true;
+
+		const size_t qtyThreads = std::max<size_t>(1, _info.qtyThreads ? _info.qtyThreads : std::thread::hardware_concurrency());
+		const double focal = _info.focal;
+		const double cx = _info.principalPoint.x;
+		const double cy = _info.principalPoint.y;
+
+		//---------- Parameters (double precision) ----------//
+		std::vector<Camera> cameras(qtyCameras);
+		std::vector<double> points(qtyPoints*3);
+		for(size_t j=0; j<qtyCameras; j++)
+		{
+			const vec& pose = _cameraPoses[j];
+			const double w[3] = {pose.at(0), pose.at(1), pose.at(2)};
+			cameras[j].R = expRotation(w);
+			for(size_t k=0; k<3; k++)
+				cameras[j].t[k] = pose.at(3+k);
+		}
+		for(size_t i=0; i<qtyPoints; i++)
+		{
+			points[i*3+0] = _points3D[i].x;
+			points[i*3+1] = _points3D[i].y;
+			points[i*3+2] = _points3D[i].z;
+		}
+
+		//---------- Sparsity structure (measurements of each camera/point) ----------//
+		std::vector<size_t> cameraStart(qtyCameras+1, 0), pointStart(qtyPoints+1, 0);
+		for(const auto& m : _measurements)
+		{
+			cameraStart[m.imageIndex+1]++;
+			pointStart[m.point3DIndex+1]++;
+		}
+		for(size_t j=0; j<qtyCameras; j++) cameraStart[j+1] += cameraStart[j];
+		for(size_t i=0; i<qtyPoints; i++) pointStart[i+1] += pointStart[i];
+		std::vector<size_t> cameraMeasurements(qtyMeasurements), pointMeasurements(qtyMeasurements);
+		{
+			std::vector<size_t> cameraFill(cameraStart.begin(), cameraStart.end()-1);
+			std::vector<size_t> pointFill(pointStart.begin(), pointStart.end()-1);
+			for(size_t m=0; m<qtyMeasurements; m++)
+			{
+				cameraMeasurements[cameraFill[_measurements[m].imageIndex]++] = m;
+				pointMeasurements[pointFill[_measurements[m].point3DIndex]++] = m;
+			}
+		}
+
+		//---------- Buffers (allocated once) ----------//
+		std::vector<MeasurementJacobian> jac(qtyMeasurements);
+		std::vector<smatd<6,6>> U(qtyCameras), P(qtyCameras);// Camera blocks and block-Jacobi preconditioner
+		std::vector<smatd<3,3>> Vinv(qtyPoints);
+		std::vector<double> gc(qtyCameras*6), gp(qtyPoints*3);
+		std::vector<double> b(qtyCameras*6), x(qtyCameras*6), r(qtyCameras*6), z(qtyCameras*6), d(qtyCameras*6), Sd(qtyCameras*6);
+		std::vector<double> pointTmp(qtyPoints*3), dp(qtyPoints*3);
+		std::vector<double> threadCost(qtyThreads);
+		std::vector<size_t> threadBehind(qtyThreads);
+		size_t qtyBehind = 0;// Measurements with the point behind the camera (last evaluate)
+		std::vector<Camera> camerasBackup;
+		std::vector<double> pointsBackup;
+
+		// Cost (and optionally residuals/jacobians) of all measurements
+		auto evaluate = [&](bool computeJacobians)
+		{
+			std::fill(threadCost.begin(), threadCost.end(), 0.0);
+			std::fill(threadBehind.begin(), threadBehind.end(), 0);
+			parallelFor(qtyMeasurements, qtyThreads, [&](size_t begin, size_t end, size_t thread)
+			{
+				double cost = 0;
+				size_t behind = 0;
+				for(size_t m=begin; m<end; m++)
+				{
+					const Measurement& meas = _measurements[m];
+					const Camera& cam = cameras[meas.imageIndex];
+					const double* X = &points[meas.point3DIndex*3];
+					double RX[3], Xc[3];
+					for(size_t k=0; k<3; k++)
+					{
+						RX[k] = cam.R[k][0]*X[0]+cam.R[k][1]*X[1]+cam.R[k][2]*X[2];
+						Xc[k] = RX[k]+cam.t[k];
+					}
+					MeasurementJacobian& J = jac[m];
+					if(Xc[2] < 1e-9)
+					{
+						// Behind the camera, no residual (steps that move points behind the cameras are rejected)
+						J = {};
+						behind++;
+						continue;
+					}
+					const double iz = 1.0/Xc[2];
+					J.r[0] = focal*Xc[0]*iz + cx - meas.point.x;
+					J.r[1] = focal*Xc[1]*iz + cy - meas.point.y;
+					cost += 0.5*(J.r[0]*J.r[0]+J.r[1]*J.r[1]);
+					if(!computeJacobians)
+						continue;
+
+					// d(proj)/d(Xc)
+					const double dp0[3] = {focal*iz, 0, -focal*Xc[0]*iz*iz};
+					const double dp1[3] = {0, focal*iz, -focal*Xc[1]*iz*iz};
+					const double* dproj[2] = {dp0, dp1};
+					// d(Xc)/d(w) = -[RX]x, d(Xc)/d(t) = I, d(Xc)/d(X) = R
+					const smatd<3,3> negSkew = skew(RX)*(-1.0);
+					for(size_t row=0; row<2; row++)
+					{
+						for(size_t c=0; c<3; c++)
+						{
+							J.A[row][c] = dproj[row][0]*negSkew[0][c]+dproj[row][1]*negSkew[1][c]+dproj[row][2]*negSkew[2][c];
+							J.A[row][3+c] = dproj[row][c];
+							J.B[row][c] = dproj[row][0]*cam.R[0][c]+dproj[row][1]*cam.R[1][c]+dproj[row][2]*cam.R[2][c];
+						}
+					}
+					for(size_t a=0; a<6; a++)
+						for(size_t c=0; c<3; c++)
+							J.W[a][c] = J.A[0][a]*J.B[0][c]+J.A[1][a]*J.B[1][c];
+				}
+				threadCost[thread] += cost;
+				threadBehind[thread] += behind;
+			});
+			double cost = 0;
+			qtyBehind = 0;
+			for(size_t t=0; t<qtyThreads; t++)
+			{
+				cost += threadCost[t];
+				qtyBehind += threadBehind[t];
+			}
+			return cost;
+		};
+
+		// y = S*v, S = U - W*V^-1*W^T (implicit Schur complement, camera 0 is fixed)
+		auto schurProduct = [&](const std::vector<double>& v, std::vector<double>& y)
+		{
+			// pointTmp_i = V_i^-1 * sum(W^T*v)
+			parallelFor(qtyPoints, qtyThreads, [&](size_t begin, size_t end, size_t)
+			{
+				for(size_t i=begin; i<end; i++)
+				{
+					double s[3] = {0,0,0};
+					for(size_t k=pointStart[i]; k<pointStart[i+1]; k++)
+					{
+						const size_t m = pointMeasurements[k];
+						const double* vj = &v[_measurements[m].imageIndex*6];
+						for(size_t c=0; c<3; c++)
+							for(size_t a=0; a<6; a++)
+								s[c] += jac[m].W[a][c]*vj[a];
+					}
+					for(size_t c=0; c<3; c++)
+						pointTmp[i*3+c] = Vinv[i][c][0]*s[0]+Vinv[i][c][1]*s[1]+Vinv[i][c][2]*s[2];
+				}
+			});
+			// y_j = U_j*v_j - sum(W*pointTmp)
+			parallelFor(qtyCameras, qtyThreads, [&](size_t begin, size_t end, size_t)
+			{
+				for(size_t j=begin; j<end; j++)
+				{
+					double* yj = &y[j*6];
+					const double* vj = &v[j*6];
+					for(size_t a=0; a<6; a++)
+					{
+						yj[a] = 0;
+						for(size_t c=0; c<6; c++)
+							yj[a] += U[j][a][c]*vj[c];
+					}
+					for(size_t k=cameraStart[j]; k<cameraStart[j+1]; k++)
+					{
+						const size_t m = cameraMeasurements[k];
+						const double* pt = &pointTmp[_measurements[m].point3DIndex*3];
+						for(size_t a=0; a<6; a++)
+							yj[a] -= jac[m].W[a][0]*pt[0]+jac[m].W[a][1]*pt[1]+jac[m].W[a][2]*pt[2];
+					}
+				}
+			});
+			for(size_t a=0; a<6; a++) y[a] = 0;// Gauge fixed by the first camera
+		};
+
+		auto dot = [](const std::vector<double>& u, const std::vector<double>& v)
+		{
+			double s = 0;
+			for(size_t k=0; k<u.size(); k++) s += u[k]*v[k];
+			return s;
+		};
+
+		auto precondition = [&](const std::vector<double>& v, std::vector<double>& y)
+		{
+			for(size_t j=0; j<qtyCameras; j++)
+				for(size_t a=0; a<6; a++)
+				{
+					y[j*6+a] = 0;
+					for(size_t c=0; c<6; c++)
+						y[j*6+a] += P[j][a][c]*v[j*6+c];
+				}
+			for(size_t a=0; a<6; a++) y[a] = 0;
+		};
+
+		double lambda = _info.initialLambda;
+		double cost = evaluate(true);
+		_report.initialCost = cost;
+		LocalEvaluator eval;
+		size_t it;
+		for(it=0; it<_info.maxIterations; it++)
+		{
+			//---------- Point blocks: V^-1 and gradient ----------//
+			parallelFor(qtyPoints, qtyThreads, [&](size_t begin, size_t end, size_t)
+			{
+				for(size_t i=begin; i<end; i++)
+				{
+					smatd<3,3> V;
+					double g[3] = {0,0,0};
+					for(size_t k=pointStart[i]; k<pointStart[i+1]; k++)
+					{
+						const MeasurementJacobian& J = jac[pointMeasurements[k]];
+						for(size_t a=0; a<3; a++)
+						{
+							for(size_t c=0; c<3; c++)
+								V[a][c] += J.B[0][a]*J.B[0][c]+J.B[1][a]*J.B[1][c];
+							g[a] -= J.B[0][a]*J.r[0]+J.B[1][a]*J.r[1];
+						}
+					}
+					for(size_t a=0; a<3; a++)
+					{
+						V[a][a] += lambda*V[a][a] + 1e-12;// Marquardt damping
+						gp[i*3+a] = g[a];
+					}
+					Vinv[i] = inverse3(V);
+				}
+			});
+
+			//---------- Camera blocks, reduced right side and preconditioner ----------//
+			parallelFor(qtyCameras, qtyThreads, [&](size_t begin, size_t end, size_t)
+			{
+				for(size_t j=begin; j<end; j++)
+				{
+					smatd<6,6>& Uj = U[j];
+					Uj.fill(0);
+					double g[6] = {0,0,0,0,0,0};
+					for(size_t k=cameraStart[j]; k<cameraStart[j+1]; k++)
+					{
+						const MeasurementJacobian& J = jac[cameraMeasurements[k]];
+						for(size_t a=0; a<6; a++)
+						{
+							for(size_t c=0; c<6; c++)
+								Uj[a][c] += J.A[0][a]*J.A[0][c]+J.A[1][a]*J.A[1][c];
+							g[a] -= J.A[0][a]*J.r[0]+J.A[1][a]*J.r[1];
+						}
+					}
+					for(size_t a=0; a<6; a++)
+					{
+						Uj[a][a] += lambda*Uj[a][a] + 1e-12;
+						gc[j*6+a] = g[a];
+					}
+
+					// b_j = gc_j - sum(W*V^-1*gp), S_jj = U_j - sum(W*V^-1*W^T)
+					smatd<6,6> Sjj = Uj;
+					for(size_t a=0; a<6; a++) b[j*6+a] = g[a];
+					for(size_t k=cameraStart[j]; k<cameraStart[j+1]; k++)
+					{
+						const size_t m = cameraMeasurements[k];
+						const size_t i = _measurements[m].point3DIndex;
+						const MeasurementJacobian& J = jac[m];
+						// WV = W*V^-1 (6x3)
+						double WV[6][3];
+						for(size_t a=0; a<6; a++)
+							for(size_t c=0; c<3; c++)
+								WV[a][c] = J.W[a][0]*Vinv[i][0][c]+J.W[a][1]*Vinv[i][1][c]+J.W[a][2]*Vinv[i][2][c];
+						for(size_t a=0; a<6; a++)
+						{
+							b[j*6+a] -= WV[a][0]*gp[i*3]+WV[a][1]*gp[i*3+1]+WV[a][2]*gp[i*3+2];
+							for(size_t c=0; c<6; c++)
+								Sjj[a][c] -= WV[a][0]*J.W[c][0]+WV[a][1]*J.W[c][1]+WV[a][2]*J.W[c][2];
+						}
+					}
+					P[j] = inverse6(Sjj);
+				}
+			});
+			for(size_t a=0; a<6; a++) b[a] = 0;
+
+			//---------- Preconditioned conjugate gradient (S*x = b) ----------//
+			std::fill(x.begin(), x.end(), 0.0);
+			r = b;
+			precondition(r, z);
+			d = z;
+			double rz = dot(r, z);
+			const double bNorm = std::sqrt(dot(b, b));
+			for(size_t k=0; k<_info.maxPcgIterations && bNorm > 0; k++)
+			{
+				if(std::sqrt(dot(r, r)) <= _info.pcgTolerance*bNorm)
+					break;
+				schurProduct(d, Sd);
+				const double dSd = dot(d, Sd);
+				if(dSd <= 0)
+					break;
+				const double alpha = rz/dSd;
+				for(size_t a=0; a<x.size(); a++)
+				{
+					x[a] += alpha*d[a];
+					r[a] -= alpha*Sd[a];
+				}
+				precondition(r, z);
+				const double rzNew = dot(r, z);
+				const double beta = rzNew/rz;
+				rz = rzNew;
+				for(size_t a=0; a<d.size(); a++)
+					d[a] = z[a]+beta*d[a];
+				_report.pcgIterations++;
+			}
+
+			//---------- Back substitution (dp = V^-1*(gp - W^T*dc)) ----------//
+			parallelFor(qtyPoints, qtyThreads, [&](size_t begin, size_t end, size_t)
+			{
+				for(size_t i=begin; i<end; i++)
+				{
+					double s[3] = {gp[i*3], gp[i*3+1], gp[i*3+2]};
+					for(size_t k=pointStart[i]; k<pointStart[i+1]; k++)
+					{
+						const size_t m = pointMeasurements[k];
+						const double* xj = &x[_measurements[m].imageIndex*6];
+						for(size_t c=0; c<3; c++)
+							for(size_t a=0; a<6; a++)
+								s[c] -= jac[m].W[a][c]*xj[a];
+					}
+					for(size_t c=0; c<3; c++)
+						dp[i*3+c] = Vinv[i][c][0]*s[0]+Vinv[i][c][1]*s[1]+Vinv[i][c][2]*s[2];
+				}
+			});
+
+			//---------- Update ----------//
+			camerasBackup = cameras;
+			pointsBackup = points;
+			for(size_t j=1; j<qtyCameras; j++)
+			{
+				const smatd<3,3> dR = expRotation(&x[j*6]);
+				cameras[j].R = dR*cameras[j].R;
+				for(size_t k=0; k<3; k++)
+					cameras[j].t[k] += x[j*6+3+k];
+			}
+			for(size_t k=0; k<points.size(); k++)
+				points[k] += dp[k];
+
+			const size_t lastQtyBehind = qtyBehind;
+			const double newCost = evaluate(false);
+			if(newCost < cost && qtyBehind <= lastQtyBehind)
+			{
+				// Accept step
+				const bool converged = (cost-newCost) < 1e-10*cost;
+				cost = evaluate(true);
+				lambda = std::max(lambda/10, 1e-12);
+				if(converged)
+				{
+					it++;
+					break;
+				}
+			}
+			else
+			{
+				// Reject step
+				cameras.swap(camerasBackup);
+				points.swap(pointsBackup);
+				lambda *= 10;
+				evaluate(true);
+			}
+		}
+		eval.stop();
+
+		_report.iterations = it;
+		_report.finalCost = cost;
+		_report.msPerIteration = it ? eval.getMs()/it : 0;
+
+		//---------- Write back results ----------//
+		for(size_t j=0; j<qtyCameras; j++)
+		{
+			double w[3];
+			logRotation(cameras[j].R, w);
+			vec pose(6);
+			for(size_t k=0; k<3; k++)
+			{
+				pose[k] = w[k];
+				pose[3+k] = cameras[j].t[k];
+			}
+			_cameraPoses[j] = pose;
+		}
+		for(size_t i=0; i<qtyPoints; i++)
+			_points3D[i] = vec3(points[i*3], points[i*3+1], points[i*3+2]);
+		return true;
+	}
+
 	void BundleAdjustment::clear()
 	{
 		_measurements.clear();
@@ -27,6 +555,12 @@ namespace atta::cv
 
 	void BundleAdjustment::addImage(vec cameraPose, std::vector<std::pair<size_t, vec2>> measurements)
 	{
+		if(cameraPose.n != 6)
+		{
+			Log::warning("BundleAdjustment", "Camera pose must have 6 values (angle-axis and translation), got $0", cameraPose.n);
+			return;
+		}
+
 		_cameraPoses.push_back(cameraPose);
 		for(const auto& measurement : measurements)
 		{
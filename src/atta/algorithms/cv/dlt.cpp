@@ -0,0 +1,48 @@
+//--------------------------------------------------
+// Atta Algorithms - Computer Vision
+// dlt.cpp
+// Date: 2021-06-07
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/algorithms/cv/dlt.h>
+
+namespace atta::cv
+{
+	bool normalizePoints(const std::pair<vec2i, vec2i>* points, const size_t* indices, size_t qty, size_t image, mat3& T)
+	{
+		// Calculate translation
+		vec2 centroid(0,0);
+		for(size_t i=0;i<qty;i++)
+		{
+			const auto& ppair = points[indices ? indices[i] : i];
+			vec2i point = image==0 ? ppair.first : ppair.second;
+			centroid += point;
+		}
+		centroid/=float(qty);
+
+		// Calculate scale
+		float currScale=0;
+		for(size_t i=0;i<qty;i++)
+		{
+			const auto& ppair = points[indices ? indices[i] : i];
+			vec2i pointi = image==0 ? ppair.first : ppair.second;
+			vec2 point(pointi.x, pointi.y);
+			point -= centroid;
+			currScale += sqrt(point.x*point.x+point.y*point.y);
+		}
+		currScale/=float(qty);
+		if(currScale == 0.0f)
+			return false;
+
+		// Define scale
+		float scale = sqrt(2)/currScale;
+		T = mat3();
+		T.mat[0][0] = scale;
+		T.mat[1][1] = scale;
+		T.mat[2][2] = 1;
+		// Define translation
+		T.mat[0][2] = -centroid.x*scale;
+		T.mat[1][2] = -centroid.y*scale;
+		return true;
+	}
+}
@@ -1,21 +1,58 @@
 //--------------------------------------------------
-// Atta Algorithms - Image Processing
+// Atta Algorithms - Computer Vision
 // fundamentalMatrix.cpp
 // Date: 2021-04-25
 // By Breno Cunha Queiroz
 //--------------------------------------------------
-#include <atta/algorithms/imgProc/fundamentalMatrix.h>
-#include <atta/algorithms/linAlg/SVD/SVD.h>
+#include <atta/algorithms/cv/fundamentalMatrix.h>
+#include <atta/algorithms/cv/dlt.h>
 #include <atta/helpers/log.h>
 
-namespace atta::imgproc
+namespace atta::cv
 {
+	// Reference: Multiple View Geometry in Computer Vision - Second Edition - Part II, Cap 11
+
+	// Row of A from one normalized point pair (x'^T*F*x=0 -> Af=0)
+	template <typename T>
+	static void eightPointsRow(const vec2& p, const vec2& pp, T* r)
+	{
+		r[0] = pp.x*p.x;
+		r[1] = pp.x*p.y;
+		r[2] = pp.x;
+		r[3] = pp.y*p.x;
+		r[4] = pp.y*p.y;
+		r[5] = pp.y;
+		r[6] = p.x;
+		r[7] = p.y;
+		r[8] = 1;
+	}
+
+	// Enforce rank 2 and denormalize
+	static bool singularityConstraint(const smatf<3,3>& Fsvd, const mat3& T1, const mat3& T2, mat3& F)
+	{
+		linalg::StaticSVD<float,3,3> svd(Fsvd);
+		if(!svd.converged)
+			return false;
+
+		// Set last singular value to zero
+		smatf<3,3> S;
+		S[0][0] = svd.S[0];
+		S[1][1] = svd.S[1];
+
+		// Reconstruct F = U*S*V^T
+		F = toMat3(svd.U*(S*transpose(svd.V)));
+
+		//---------- Denormalization ----------//
+		F = transpose(T2)*(F*T1);
+		return true;
+	}
+
 	FundamentalMatrix::FundamentalMatrix()
 	{
 
 	}
 
-	void FundamentalMatrix::solve8Points(std::vector<std::pair<vec2i, vec2i>> points)
+	void FundamentalMatrix::solve8Points(const std::vector<std::pair<vec2i, vec2i>>& points)
 	{
 		if(points.size()!=8)
 		{
@@ -23,132 +60,103 @@ namespace atta::imgproc
 			return;
 		}
 
-		// Reference: Multiple View Geometry in Computer Vision - Second Edition - Part II, Cap 11, Cap 4.4
+		if(!compute8Points(points.data(), F))
+			Log::warning("FundamentalMatrix", "Degenerate configuration in solve8Points. F not calculated");
+	}
+
+	bool FundamentalMatrix::compute8Points(const std::pair<vec2i, vec2i> points[8], mat3& F)
+	{
 		//---------- Normalization ----------//
-		// We want the new coordinate system origin be the points centroid
-		// We want the points in the new coordinate system to have an average distance of sqrt(2) to the origin
-		// Applied to each image individually
 		mat3 T1;
 		mat3 T2;
-		for(size_t image=0;image<2;image++)
-		{
-			// Calculate translation (for each of the 8 points)
-			vec2 centroid(0,0);
-			for(size_t i=0;i<points.size();i++)
-			{
-				vec2i point = image==0 ? points[i].first : points[i].second;
-				centroid += point;
-			}
-			centroid/=float(points.size());
-
-			// Calculate scale
-			float currScale=0;
-			for(size_t i=0;i<points.size();i++)
-			{
-				vec2 point = image==0 ? points[i].first : points[i].second;
-				point -= centroid;
-				currScale += sqrt(point.x*point.x+point.y*point.y);
-			}
-			currScale/=float(points.size());
-
-			// Calculate transform
-			mat3& T = image==0?T1:T2;
-			// Define scale
-			float scale = sqrt(2)/currScale;
-			T.mat[0][0] = scale;
-			T.mat[1][1] = scale;
-			T.mat[2][2] = 1;
-			// Define translation
-			T.mat[0][2] = -centroid.x*scale;
-			T.mat[1][2] = -centroid.y*scale;
-		}
-
-		// Check normalized coords
-		//vec2 centroid(0,0);
-		//float scale=0;
-		//for(size_t i=0;i<points.size();i++)
-		//	centroid += vec2(T1*vec3(points[i].first,1.0f));
-		//centroid/=points.size();
-		//for(size_t i=0;i<points.size();i++)
-		//{
-		//	vec2 point = vec2(T1*vec3(points[i].first,1.0f));
-		//	point -= centroid;
-		//	scale += sqrt(point.x*point.x+point.y*point.y);
-		//}
-		//scale/=points.size();
-		//Log::debug("FundamentalMatrix", "Centroid: $0, Scale: $1", centroid.toString(), scale);
-
-		std::vector<std::pair<vec2, vec2>> pointsNorm(8);
-		// Transform points
-		for(size_t i=0;i<pointsNorm.size();i++)
-		{
-			pointsNorm[i].first = vec2(T1*vec3(points[i].first, 1));
-			pointsNorm[i].second = vec2(T2*vec3(points[i].second, 1));
-		}
+		if(!normalizePoints(points, nullptr, 8, 0, T1) || !normalizePoints(points, nullptr, 8, 1, T2))
+			return false;
 
 		//---------- Find solution f from A ----------//
-		mat A(8, 9);
-		vec f(9);
+		// The last row is kept zero so A is square and V has the full null space vector
+		smatf<9,9> A;
 		for(size_t i=0;i<8;i++)
-		{
-			A[i][0] = pointsNorm[i].second.x*pointsNorm[i].first.x;
-			A[i][1] = pointsNorm[i].second.x*pointsNorm[i].first.y;
-			A[i][2] = pointsNorm[i].second.x;
-			A[i][3] = pointsNorm[i].second.y*pointsNorm[i].first.x;
-			A[i][4] = pointsNorm[i].second.y*pointsNorm[i].first.y;
-			A[i][5] = pointsNorm[i].second.y;
-			A[i][6] = pointsNorm[i].first.x;
-			A[i][7] = pointsNorm[i].first.y;
-			A[i][8] = 1;
-		}
+			eightPointsRow(vec2(T1*vec3(points[i].first, 1)), vec2(T2*vec3(points[i].second, 1)), A[i]);
 
-		mat Fsvd(3,3);
+		smatf<3,3> Fsvd;
 		{
 			// Solve svd to find f where Af~=0
-			linalg::SVD svd(A);
-			//Log::debug("FundamentalMatrix", "S:\n$0\nV:$1", svd.S.toString(), svd.V.toString());
-
-			float sumSqr=0;
-			for(size_t i=0;i<8;i++)
-			{
-				f[i] = svd.V[i][8];
-				Fsvd[i/3][i%3] = f[i];
-				sumSqr += f[i]*f[i];
-			}
-			f[8] = sqrt(1-sumSqr);// Find last coordinate with constraint ||f||=1
-			Fsvd[2][2] = f[8];
-			//Log::debug("FundamentalMatrix", "A: $0", A.toString());
-			//Log::debug("FundamentalMatrix", "f: $0", f.toString());
-			//Log::debug("FundamentalMatrix", "Af: $0", (A*f).toString());
+			linalg::StaticSVD<float,9,9> svd(A);
+			if(!svd.converged)
+				return false;
+			svd.nullVector(Fsvd.data);
 		}
+
 		//---------- Singularity constraint enforcement ----------//
+		return singularityConstraint(Fsvd, T1, T2, F);
+	}
+
+	bool FundamentalMatrix::compute8Points(const std::pair<vec2i, vec2i>* points, const size_t* indices, size_t qty, mat3& F)
+	{
+		if(qty < 8)
+			return false;
+
+		mat3 T1;
+		mat3 T2;
+		if(!normalizePoints(points, indices, qty, 0, T1) || !normalizePoints(points, indices, qty, 1, T2))
+			return false;
+
+		// Least squares (one row per point pair)
+		smatf<3,3> Fsvd;
+		if(!leastSquaresNullVector<1>(points, indices, qty, T1, T2,
+				[](const vec2& p, const vec2& pp, double (*r)[9]){ eightPointsRow(p, pp, r[0]); }, Fsvd.data))
+			return false;
+
+		return singularityConstraint(Fsvd, T1, T2, F);
+	}
+
+	bool FundamentalMatrix::solve8PointsRANSAC(const std::vector<std::pair<vec2i, vec2i>>& points, Ransac<FundamentalMatrixEstimator>::CreateInfo info)
+	{
+		Ransac<FundamentalMatrixEstimator> ransac(info);
+		mat3 bestF;
+		if(!ransac.run(points, bestF))
 		{
-			//Log::debug("FundamentalMatrix", "Fprev: $0", F.toString());
-			linalg::SVD svd(Fsvd);
-			//Log::debug("FundamentalMatrix", "----SVD----\nU:$0\nS:\n$1\nV:$2", 
-			//	svd.U.toString(), svd.S.toString(), svd.V.toString());
-
-			// Set last eigenvalue to zero
-			mat S(3,3);
-			S[0][0] = svd.S[0];
-			S[1][1] = svd.S[1];
-
-			// Reconstruct F
-			mat newF = svd.U*(S*svd.V);
-			for(size_t i=0;i<9;i++)
-				F.mat[i/3][i%3] = newF[i/3][i%3];
-			//Log::debug("FundamentalMatrix", "Fafter $0", F.toString());
+			inliers.clear();
+			return false;
 		}
-		//---------- Denormalization ----------//
-		F = transpose(T2)*(F*T1);
+		F = bestF;
+		inliers = ransac.getInliers();
+		return true;
+	}
 
-		// Test if points lie in the same line
-		//Log::debug("FundamentalMatrix", "two points: $0 -> $1", vec3(points[0].first,1).toString(), vec3(points[0].second, 1).toString());
-		//Log::debug("FundamentalMatrix", "p'*F*p: $0", vec3(points[0].second,1).dot(F*vec3(points[0].first,1)));
+	//---------- Estimator ----------//
+	bool FundamentalMatrixEstimator::solveMinimal(const std::pair<vec2i, vec2i>* points, const size_t* sample, mat3& F)
+	{
+		std::pair<vec2i, vec2i> points8[8];
+		for(size_t i=0;i<8;i++)
+			points8[i] = points[sample[i]];
+		return FundamentalMatrix::compute8Points(points8, F);
 	}
 
-	void solve8PointsRANSAC(std::vector<std::pair<vec2i, vec2i>> points)
+	bool FundamentalMatrixEstimator::solveNonMinimal(const std::pair<vec2i, vec2i>* points, const size_t* indices, size_t qty, mat3& F)
 	{
-		// TODO
+		return FundamentalMatrix::compute8Points(points, indices, qty, F);
+	}
+
+	void FundamentalMatrixEstimator::residuals(const mat3& F, const Correspondences& points, size_t begin, size_t end, float* out)
+	{
+		// Sampson distance: (x'^T*F*x)^2 / ((Fx)_0^2 + (Fx)_1^2 + (F^Tx')_0^2 + (F^Tx')_1^2)
+		const float f0=F.data[0], f1=F.data[1], f2=F.data[2], f3=F.data[3], f4=F.data[4], f5=F.data[5], f6=F.data[6], f7=F.data[7], f8=F.data[8];
+		const float* __restrict x1 = points.x1.data()+begin;
+		const float* __restrict y1 = points.y1.data()+begin;
+		const float* __restrict x2 = points.x2.data()+begin;
+		const float* __restrict y2 = points.y2.data()+begin;
+		float* __restrict res = out;
+
+		for(size_t i=0;i<end-begin;i++)
+		{
+			const float Fx0 = f0*x1[i]+f1*y1[i]+f2;
+			const float Fx1 = f3*x1[i]+f4*y1[i]+f5;
+			const float Fx2 = f6*x1[i]+f7*y1[i]+f8;
+			const float Ftxp0 = f0*x2[i]+f3*y2[i]+f6;
+			const float Ftxp1 = f1*x2[i]+f4*y2[i]+f7;
+			const float xpFx = x2[i]*Fx0+y2[i]*Fx1+Fx2;
+			res[i] = xpFx*xpFx/(Fx0*Fx0+Fx1*Fx1+Ftxp0*Ftxp0+Ftxp1*Ftxp1);
+		}
 	}
 }
@@ -1,21 +1,46 @@
 //--------------------------------------------------
-// Atta Algorithms - Image Processing
+// Atta Algorithms - Computer Vision
 // homography.cpp
 // Date: 2021-04-25
 // By Breno Cunha Queiroz
 //--------------------------------------------------
-#include <atta/algorithms/imgProc/homography.h>
-#include <atta/algorithms/linAlg/SVD/SVD.h>
+#include <atta/algorithms/cv/homography.h>
+#include <atta/algorithms/cv/dlt.h>
 #include <atta/helpers/log.h>
 
-namespace atta::imgproc
+namespace atta::cv
 {
+	// Two rows of A from one normalized point pair (Ah=0)
+	template <typename T>
+	static void dltRows(const vec2& p, const vec2& pp, T* r0, T* r1)
+	{
+		r0[0] = 0;
+		r0[1] = 0;
+		r0[2] = 0;
+		r0[3] = -p.x;
+		r0[4] = -p.y;
+		r0[5] = -1;
+		r0[6] = pp.y*p.x;
+		r0[7] = pp.y*p.y;
+		r0[8] = pp.y;
+
+		r1[0] = p.x;
+		r1[1] = p.y;
+		r1[2] = 1;
+		r1[3] = 0;
+		r1[4] = 0;
+		r1[5] = 0;
+		r1[6] = -pp.x*p.x;
+		r1[7] = -pp.x*p.y;
+		r1[8] = -pp.x;
+	}
+
 	Homography::Homography()
 	{
 
 	}
 
-	void Homography::solveDLT(std::vector<std::pair<vec2i, vec2i>> points)
+	void Homography::solveDLT(const std::vector<std::pair<vec2i, vec2i>>& points)
 	{
 		if(points.size()!=4)
 		{
@@ -23,229 +48,101 @@ namespace atta::imgproc
 			return;
 		}
 
+		if(!computeDLT(points.data(), H))
+			Log::warning("Homography", "Degenerate configuration in DLT. H not calculated");
+	}
+
+	bool Homography::computeDLT(const std::pair<vec2i, vec2i> points[4], mat3& H)
+	{
 		//---------- Normalization ----------//
-		// We want the new coordinate system origin be the points centroid
-		// We want the points in the new coordinate system to have an average distance of sqrt(2) to the origin
-		// Applied to each image individually
 		mat3 T1;
 		mat3 T2;
-		for(size_t image=0;image<2;image++)
-		{
-			// Calculate translation (for each of the 8 points)
-			vec2 centroid(0,0);
-			for(size_t i=0;i<points.size();i++)
-			{
-				vec2i point = image==0 ? points[i].first : points[i].second;
-				centroid += point;
-			}
-			centroid/=float(points.size());
-
-			// Calculate scale
-			float currScale=0;
-			for(size_t i=0;i<points.size();i++)
-			{
-				vec2 point = image==0 ? points[i].first : points[i].second;
-				point -= centroid;
-				currScale += sqrt(point.x*point.x+point.y*point.y);
-			}
-			currScale/=float(points.size());
-
-			// Calculate transform
-			mat3& T = image==0?T1:T2;
-			// Define scale
-			float scale = sqrt(2)/currScale;
-			T.mat[0][0] = scale;
-			T.mat[1][1] = scale;
-			T.mat[2][2] = 1;
-			// Define translation
-			T.mat[0][2] = -centroid.x*scale;
-			T.mat[1][2] = -centroid.y*scale;
-		}
+		if(!normalizePoints(points, nullptr, 4, 0, T1) || !normalizePoints(points, nullptr, 4, 1, T2))
+			return false;
 
-		std::vector<std::pair<vec2, vec2>> pointsNorm(4);
-		// Transform points
-		for(size_t i=0;i<pointsNorm.size();i++)
-		{
-			pointsNorm[i].first = vec2(T1*vec3(points[i].first, 1));
-			pointsNorm[i].second = vec2(T2*vec3(points[i].second, 1));
-		}
 		//---------- Direct Linear Transformation ----------//
-		mat A(8,9);
-		vec h(9);
+		// The last row is kept zero so A is square and V has the full null space vector
+		smatf<9,9> A;
 		for(size_t i=0;i<4;i++)
-		{
-			A[i*2][0] = 0;
-			A[i*2][1] = 0;
-			A[i*2][2] = 0;
-			A[i*2][3] = -pointsNorm[i].first.x;
-			A[i*2][4] = -pointsNorm[i].first.y;
-			A[i*2][5] = -1;
-			A[i*2][6] = pointsNorm[i].second.y*pointsNorm[i].first.x;
-			A[i*2][7] = pointsNorm[i].second.y*pointsNorm[i].first.y;
-			A[i*2][8] = pointsNorm[i].second.y;
-
-			A[i*2+1][0] = pointsNorm[i].first.x;
-			A[i*2+1][1] = pointsNorm[i].first.y;
-			A[i*2+1][2] = 1;
-			A[i*2+1][3] = 0;
-			A[i*2+1][4] = 0;
-			A[i*2+1][5] = 0;
-			A[i*2+1][6] = -pointsNorm[i].second.x*pointsNorm[i].first.x;
-			A[i*2+1][7] = -pointsNorm[i].second.x*pointsNorm[i].first.y;
-			A[i*2+1][8] = -pointsNorm[i].second.x;
-		}
-		// Solving Ah=0
-		{
-			// Solve svd to find h where Ah~=0
-			linalg::SVD svd(A);
-			//Log::debug("Homography", "S:\n$0\nV:$1", svd.S.toString(), svd.V.toString());
-
-			float sumSqr=0;
-			for(size_t i=0;i<8;i++)
-			{
-				h[i] = svd.V[i][8];
-				H.mat[i/3][i%3] = h[i];
-				sumSqr += h[i]*h[i];
-			}
-			h[8] = sqrt(1-sumSqr);// Find last coordinate with constraint ||h||=1
-			H.mat[2][2] = h[8];
-			//Log::debug("Homography", "A: $0", A.toString());
-			//Log::debug("Homography", "h: $0", h.toString());
-			//Log::debug("Homography", "Ah: $0", (A*h).toString());
-		}
+			dltRows(vec2(T1*vec3(points[i].first, 1)), vec2(T2*vec3(points[i].second, 1)), A[i*2], A[i*2+1]);
+
+		// Solving Ah=0 (h is the singular vector of the smallest singular value)
+		linalg::StaticSVD<float,9,9> svd(A);
+		if(!svd.converged)
+			return false;
+		svd.nullVector(H.data);
+
 		//---------- Denormalization ----------//
 		H = inverse(T2)*(H*T1);
+		return true;
+	}
+
+	bool Homography::computeDLT(const std::pair<vec2i, vec2i>* points, const size_t* indices, size_t qty, mat3& H)
+	{
+		if(qty < 4)
+			return false;
 
-		// Check points
-		//for(auto ppair : points)
-		//{
-		//	vec3 pp = H*vec3(ppair.first,1);
-		//	pp/=pp.z;
+		mat3 T1;
+		mat3 T2;
+		if(!normalizePoints(points, indices, qty, 0, T1) || !normalizePoints(points, indices, qty, 1, T2))
+			return false;
+
+		// Least squares (two rows per point pair)
+		if(!leastSquaresNullVector<2>(points, indices, qty, T1, T2,
+				[](const vec2& p, const vec2& pp, double (*r)[9]){ dltRows(p, pp, r[0], r[1]); }, H.data))
+			return false;
 
-		//	Log::debug("Homography", "Hp -- p':\n$0\n$1", pp.toString(), vec3(ppair.second, 1).toString());
-		//}
+		H = inverse(T2)*(H*T1);
+		return true;
 	}
 
-	void Homography::solveRANSAC(std::vector<std::pair<vec2i, vec2i>> points, size_t width, size_t height)
+	bool Homography::solveRANSAC(const std::vector<std::pair<vec2i, vec2i>>& points, Ransac<HomographyEstimator>::CreateInfo info)
 	{
-		//---------- Distribute samples in tiles (8x8) ----------//
-		size_t tiles1D = 8;
-		size_t numTiles = tiles1D*tiles1D;
-		std::vector<std::vector<std::pair<vec2i, vec2i>>> tiles(numTiles);
-		std::vector<size_t> tileIndexes;// Indexes of tiles with points (to avoid testing empty tiles)
-		size_t tileWidth = width/tiles1D;
-		size_t tileHeight = height/tiles1D;
-
-		// Add point pairs to tiles
-		for(auto& ppair : points)
-		{
-			size_t tileIndex = ppair.first.x/tileWidth + tiles1D*(ppair.first.y/tileHeight);
-			tiles[tileIndex].push_back(ppair);
-		}
-
-		// Check which tiles are not empty
-		for(size_t i=0;i<tiles.size();i++)
+		Ransac<HomographyEstimator> ransac(info);
+		mat3 bestH;
+		if(!ransac.run(points, bestH))
 		{
-			if(tiles[i].size()>0)
-			{
-				//Log::debug("Homography", "solveRANSAC $0 -> $1", i, tiles[i].size());
-				tileIndexes.push_back(i);
-			}
+			inliers.clear();
+			return false;
 		}
+		H = bestH;
+		inliers = ransac.getInliers();
+		return true;
+	}
 
-		if(tileIndexes.size()<4)
-		{
-			//Log::warning("Homography", "Could not distribute points in at least four tiles");
-			return;
-		}
+	//---------- Estimator ----------//
+	bool HomographyEstimator::solveMinimal(const std::pair<vec2i, vec2i>* points, const size_t* sample, mat3& H)
+	{
+		const std::pair<vec2i, vec2i> pointsDLT[4] = {points[sample[0]], points[sample[1]], points[sample[2]], points[sample[3]]};
+		return Homography::computeDLT(pointsDLT, H);
+	}
 
-		//---------- First stage (find homography approximation) ----------//
-		mat3 bestH;
-		size_t bestNumInliers = 0;
+	bool HomographyEstimator::solveNonMinimal(const std::pair<vec2i, vec2i>* points, const size_t* indices, size_t qty, mat3& H)
+	{
+		return Homography::computeDLT(points, indices, qty, H);
+	}
 
-		float p = 0.99;// Probability to choose sample without outliers within the iterations
-		float e = 0.5;// Chance of a point being an outlier
-		size_t N = ceil(log10(1-p)/log10(1-pow(1-e, 4)));
-		for(size_t it=0;it<N;it++)
+	void HomographyEstimator::residuals(const mat3& H, const Correspondences& points, size_t begin, size_t end, float* out)
+	{
+		// Symmetric transfer error: dist(x, H^-1*x')^2 + dist(x', H*x)^2
+		const mat3 Hinv = inverse(H);
+		const float h0=H.data[0], h1=H.data[1], h2=H.data[2], h3=H.data[3], h4=H.data[4], h5=H.data[5], h6=H.data[6], h7=H.data[7], h8=H.data[8];
+		const float i0=Hinv.data[0], i1=Hinv.data[1], i2=Hinv.data[2], i3=Hinv.data[3], i4=Hinv.data[4], i5=Hinv.data[5], i6=Hinv.data[6], i7=Hinv.data[7], i8=Hinv.data[8];
+		const float* __restrict x1 = points.x1.data()+begin;
+		const float* __restrict y1 = points.y1.data()+begin;
+		const float* __restrict x2 = points.x2.data()+begin;
+		const float* __restrict y2 = points.y2.data()+begin;
+		float* __restrict res = out;
+
+		for(size_t i=0;i<end-begin;i++)
 		{
-			// Choose random sample of 4 points
-			std::vector<std::pair<vec2i, vec2i>> pointsDLT;
-			std::vector<size_t> tilesChosen;
-			while(pointsDLT.size()<4)
-			{
-				// Select tile without repeating
-				size_t tileIndex;
-				while(true)
-				{
-					// Checking only tiles with points
-					tileIndex = tileIndexes[rand()%tileIndexes.size()];
-					bool newTile=true;
-					// Try again if tile was already chosen
-					for(size_t i=0;i<tilesChosen.size();i++)
-					{
-						if(tileIndex==tilesChosen[i])
-						{
-							newTile = false;
-							break;
-						}
-					}
-					// If found suitable tile
-					if(newTile)
-					{
-						tilesChosen.push_back(tileIndex);
-						break;
-					}
-				}
-
-				// Select random point from tile
-				size_t ppairIndex = rand()%(tiles[tileIndex].size());
-				std::pair<vec2i, vec2i> ppair = tiles[tileIndex][ppairIndex];
-				pointsDLT.push_back(ppair);
-			}
-
-			// Calculate homography with DLT
-			solveDLT(pointsDLT);
-
-			// Check number of inliers (symmetric transfer error)
-			size_t numInliers = 0;
-			mat3 Hinv = inverse(H);
-			for(auto ppair : points)
-			{
-				float error = 0;
-				// dist(x, H^-1*x')^2
-				{
-					vec3 H1xp = Hinv*vec3(ppair.second, 1);
-					H1xp/=H1xp.z;
-					float dx = H1xp.x-ppair.first.x;
-					float dy = H1xp.y-ppair.first.y;
-					error += dx*dx+dy*dy;
-				}
-				// dist(x', H*x)^2
-				{
-					vec3 Hx = H*vec3(ppair.first, 1);
-					Hx/=Hx.z;
-					float dx = Hx.x-ppair.second.x;
-					float dy = Hx.y-ppair.second.y;
-					error += dx*dx+dy*dy;
-				}
-				if(error<5.99)
-					numInliers++;
-			}
-			if(numInliers>bestNumInliers)
-			{
-				// Update best H found so far
-				bestH = H;
-				bestNumInliers = numInliers;
-
-				// Update N with from proportion of outliers
-				e = 1-(bestNumInliers/float(points.size()));// Chance of a point being an outlier
-				N = std::min(N, (size_t)ceil(log10(1-p)/log10(1-pow(1-e, 4))));
-			}
+			const float wx = 1.0f/(h6*x1[i]+h7*y1[i]+h8);
+			const float dx = (h0*x1[i]+h1*y1[i]+h2)*wx - x2[i];
+			const float dy = (h3*x1[i]+h4*y1[i]+h5)*wx - y2[i];
+			const float wp = 1.0f/(i6*x2[i]+i7*y2[i]+i8);
+			const float dxp = (i0*x2[i]+i1*y2[i]+i2)*wp - x1[i];
+			const float dyp = (i3*x2[i]+i4*y2[i]+i5)*wp - y1[i];
+			res[i] = dx*dx+dy*dy+dxp*dxp+dyp*dyp;
 		}
-
-		//Log::debug("Homogrpahy", "N: $0 ($1/$2)", N, bestNumInliers, points.size());
-		//---------- Second stage (Refines homography with inliers) ----------//
-	
-		
 	}
 }
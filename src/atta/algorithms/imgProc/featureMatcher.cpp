@@ -0,0 +1,183 @@
+//--------------------------------------------------
+// Atta Algorithms - Image Processing
+// featureMatcher.cpp
+// Date: 2021-07-05
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/algorithms/imgProc/featureMatcher.h>
+#include <algorithm>
+#include <climits>
+#include <thread>
+
+namespace atta::imgproc
+{
+	FeatureMatcher::FeatureMatcher()
+	{
+
+	}
+
+	FeatureMatcher::FeatureMatcher(CreateInfo info):
+		_info(info)
+	{
+
+	}
+
+	size_t FeatureMatcher::getQtyThreads() const
+	{
+		size_t qtyThreads = _info.qtyThreads ? _info.qtyThreads : std::thread::hardware_concurrency();
+		return std::max<size_t>(qtyThreads, 1);
+	}
+
+	void FeatureMatcher::matchBruteForce(
+			const std::vector<Keypoint>& keypoints1, const std::vector<Descriptor>& descriptors1,
+			const std::vector<Keypoint>& keypoints2, const std::vector<Descriptor>& descriptors2,
+			std::vector<std::pair<vec2i, vec2i>>& correspondences)
+	{
+		bestMatches(descriptors1, descriptors2, nullptr, nullptr, nullptr, _best12);
+		if(_info.crossCheck)
+			bestMatches(descriptors2, descriptors1, nullptr, nullptr, nullptr, _best21);
+		collect(keypoints1, descriptors1, keypoints2, descriptors2, correspondences);
+	}
+
+	void FeatureMatcher::matchGrid(
+			const std::vector<Keypoint>& keypoints1, const std::vector<Descriptor>& descriptors1,
+			const std::vector<Keypoint>& keypoints2, const std::vector<Descriptor>& descriptors2,
+			std::vector<std::pair<vec2i, vec2i>>& correspondences)
+	{
+		buildGrid(keypoints2, _grid2);
+		bestMatches(descriptors1, descriptors2, &keypoints1, &keypoints2, &_grid2, _best12);
+		if(_info.crossCheck)
+		{
+			buildGrid(keypoints1, _grid1);
+			bestMatches(descriptors2, descriptors1, &keypoints2, &keypoints1, &_grid1, _best21);
+		}
+		collect(keypoints1, descriptors1, keypoints2, descriptors2, correspondences);
+	}
+
+	void FeatureMatcher::buildGrid(const std::vector<Keypoint>& keypoints, Grid& grid) const
+	{
+		// Cells with the search radius size -> search only in the 3x3 neighbour cells
+		grid.cellSize = std::max(_info.searchRadius, 1);
+		grid.minX = grid.minY = INT_MAX;
+		int maxX = INT_MIN, maxY = INT_MIN;
+		for(const Keypoint& k : keypoints)
+		{
+			grid.minX = std::min(grid.minX, k.point.x);
+			grid.minY = std::min(grid.minY, k.point.y);
+			maxX = std::max(maxX, k.point.x);
+			maxY = std::max(maxY, k.point.y);
+		}
+		if(keypoints.empty())
+			grid.minX = grid.minY = maxX = maxY = 0;
+		grid.cols = (maxX-grid.minX)/grid.cellSize+1;
+		grid.rows = (maxY-grid.minY)/grid.cellSize+1;
+
+		// Counting sort by cell
+		grid.cellStart.assign(grid.cols*grid.rows+1, 0);
+		auto cellOf = [&](const Keypoint& k)
+		{
+			return ((k.point.y-grid.minY)/grid.cellSize)*grid.cols + (k.point.x-grid.minX)/grid.cellSize;
+		};
+		for(const Keypoint& k : keypoints)
+			grid.cellStart[cellOf(k)+1]++;
+		for(size_t c=1; c<grid.cellStart.size(); c++)
+			grid.cellStart[c] += grid.cellStart[c-1];
+		grid.items.resize(keypoints.size());
+		std::vector<size_t> fill(grid.cellStart.begin(), grid.cellStart.end()-1);
+		for(size_t i=0; i<keypoints.size(); i++)
+			grid.items[fill[cellOf(keypoints[i])]++] = i;
+	}
+
+	void FeatureMatcher::bestMatches(const std::vector<Descriptor>& query, const std::vector<Descriptor>& train,
+			const std::vector<Keypoint>* queryKeypoints, const std::vector<Keypoint>* trainKeypoints,
+			const Grid* trainGrid, std::vector<int>& best) const
+	{
+		best.assign(query.size(), -1);
+		const int radius = _info.searchRadius;
+
+		auto matchRange = [&](size_t begin, size_t end)
+		{
+			for(size_t q=begin; q<end; q++)
+			{
+				int bestDist = INT_MAX, secondDist = INT_MAX, bestIdx = -1;
+				auto test = [&](size_t t)
+				{
+					const int dist = hammingDistance(query[q], train[t]);
+					if(dist < bestDist)
+					{
+						secondDist = bestDist;
+						bestDist = dist;
+						bestIdx = t;
+					}
+					else if(dist < secondDist)
+						secondDist = dist;
+				};
+
+				if(trainGrid == nullptr)
+				{
+					for(size_t t=0; t<train.size(); t++)
+						test(t);
+				}
+				else
+				{
+					const vec2i& p = (*queryKeypoints)[q].point;
+					const Grid& g = *trainGrid;
+					const int cx0 = std::max((p.x-radius-g.minX)/g.cellSize, 0);
+					const int cy0 = std::max((p.y-radius-g.minY)/g.cellSize, 0);
+					const int cx1 = std::min((p.x+radius-g.minX)/g.cellSize, g.cols-1);
+					const int cy1 = std::min((p.y+radius-g.minY)/g.cellSize, g.rows-1);
+					for(int cy=cy0; cy<=cy1; cy++)
+						for(int cx=cx0; cx<=cx1; cx++)
+						{
+							const size_t cell = cy*g.cols+cx;
+							for(size_t k=g.cellStart[cell]; k<g.cellStart[cell+1]; k++)
+							{
+								// Cells also contain keypoints outside the search circle
+								const vec2i& pt = (*trainKeypoints)[g.items[k]].point;
+								const int dx = pt.x-p.x;
+								const int dy = pt.y-p.y;
+								if(dx*dx+dy*dy <= radius*radius)
+									test(g.items[k]);
+							}
+						}
+				}
+
+				if(bestIdx < 0 || bestDist > _info.maxDistance)
+					continue;
+				if(_info.ratio < 1.0f && secondDist != INT_MAX && bestDist >= _info.ratio*secondDist)
+					continue;
+				best[q] = bestIdx;
+			}
+		};
+
+		// Parallel by blocks of query descriptors (brute force is quadratic)
+		const size_t qtyThreads = std::min(getQtyThreads(), std::max<size_t>(query.size()/256, 1));
+		if(qtyThreads == 1)
+			matchRange(0, query.size());
+		else
+		{
+			std::vector<std::thread> threads;
+			const size_t chunk = (query.size()+qtyThreads-1)/qtyThreads;
+			for(size_t t=0; t<qtyThreads; t++)
+				threads.emplace_back(matchRange, t*chunk, std::min(query.size(), (t+1)*chunk));
+			for(auto& thread : threads)
+				thread.join();
+		}
+	}
+
+	void FeatureMatcher::collect(const std::vector<Keypoint>& keypoints1, const std::vector<Descriptor>& descriptors1,
+			const std::vector<Keypoint>& keypoints2, const std::vector<Descriptor>& descriptors2,
+			std::vector<std::pair<vec2i, vec2i>>& correspondences)
+	{
+		_matches.clear();
+		correspondences.clear();
+		for(size_t i=0; i<_best12.size(); i++)
+		{
+			const int j = _best12[i];
+			if(j < 0 || (_info.crossCheck && _best21[j] != int(i)))
+				continue;
+			_matches.push_back({i, size_t(j), hammingDistance(descriptors1[i], descriptors2[j])});
+			correspondences.push_back(std::make_pair(keypoints1[i].point, keypoints2[j].point));
+		}
+	}
+}
@@ -0,0 +1,365 @@
+//--------------------------------------------------
+// Atta Algorithms - Image Processing
+// orb.cpp
+// Date: 2021-07-05
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/algorithms/imgProc/orb.h>
+#include <atta/helpers/log.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+
+namespace atta::imgproc
+{
+	namespace
+	{
+		// Bresenham circle of radius 3 (clockwise starting at the top)
+		const int circleX[16] = { 0, 1, 2, 3, 3, 3, 2, 1, 0,-1,-2,-3,-3,-3,-2,-1};
+		const int circleY[16] = {-3,-3,-2,-1, 0, 1, 2, 3, 3, 3, 2, 1, 0,-1,-2,-3};
+
+		// Run f(i) for i in [0,n), items are taken dynamically by the threads
+		template <typename F>
+		void parallelFor(size_t n, size_t qtyThreads, F&& f)
+		{
+			qtyThreads = std::min(qtyThreads, n);
+			if(qtyThreads <= 1)
+			{
+				for(size_t i=0; i<n; i++)
+					f(i);
+				return;
+			}
+			std::atomic<size_t> next(0);
+			auto worker = [&]()
+			{
+				size_t i;
+				while((i = next.fetch_add(1)) < n)
+					f(i);
+			};
+			std::vector<std::thread> threads;
+			for(size_t t=0; t<qtyThreads; t++)
+				threads.emplace_back(worker);
+			for(auto& thread : threads)
+				thread.join();
+		}
+
+		// True if the 16 bit circular mask has 9 contiguous bits set
+		inline bool hasArc9(uint32_t mask)
+		{
+			uint32_t m = mask | (mask<<16);
+			uint32_t run = m;
+			for(int i=1; i<9; i++)
+				run &= m>>i;
+			return run != 0;
+		}
+	}
+
+	ORB::ORB():
+		_width(0), _height(0)
+	{
+		createPattern();
+	}
+
+	ORB::ORB(CreateInfo info):
+		_info(info), _width(0), _height(0)
+	{
+		createPattern();
+	}
+
+	void ORB::createPattern()
+	{
+		// Circular patch used by the orientation
+		for(int v=0; v<=patchRadius; v++)
+			_umax[v] = std::round(std::sqrt(double(patchRadius*patchRadius - v*v)));
+
+		// BRIEF tests sampled from an isotropic gaussian (sigma = patchSize/5)
+		// The radius is limited so the rotated tests + smoothing window stay inside the patch
+		const float maxRadius = patchRadius-2;
+		std::mt19937 gen(0x0b5);
+		std::normal_distribution<float> dist(0.0f, (2*patchRadius+1)/5.0f);
+		std::vector<float> base(256*4);
+		for(size_t i=0; i<base.size(); i+=2)
+		{
+			float x, y;
+			do
+			{
+				x = dist(gen);
+				y = dist(gen);
+			}
+			while(x*x+y*y > maxRadius*maxRadius);
+			base[i] = x;
+			base[i+1] = y;
+		}
+
+		// Steered BRIEF (pattern rotated for each discretized angle)
+		for(size_t a=0; a<qtyAngles; a++)
+		{
+			const float theta = 2*M_PI*a/qtyAngles;
+			const float c = std::cos(theta);
+			const float s = std::sin(theta);
+			_pattern[a].resize(base.size());
+			for(size_t i=0; i<base.size(); i+=2)
+			{
+				_pattern[a][i] = std::round(c*base[i] - s*base[i+1]);
+				_pattern[a][i+1] = std::round(s*base[i] + c*base[i+1]);
+			}
+		}
+	}
+
+	size_t ORB::getQtyThreads() const
+	{
+		size_t qtyThreads = _info.qtyThreads ? _info.qtyThreads : std::thread::hardware_concurrency();
+		return std::max<size_t>(qtyThreads, 1);
+	}
+
+	void ORB::detectAndCompute(const uint8_t* image, unsigned width, unsigned height, unsigned channels,
+			std::vector<Keypoint>& keypoints, std::vector<Descriptor>& descriptors)
+	{
+		keypoints.clear();
+		descriptors.clear();
+		if(channels != 1 && channels != 3 && channels != 4)
+		{
+			Log::error("imgproc::ORB", "$0 color channels given, must be 1, 3 or 4", channels);
+			return;
+		}
+		if(width <= 2*border || height <= 2*border)
+		{
+			Log::warning("imgproc::ORB", "Image too small ($0x$1)", width, height);
+			return;
+		}
+
+		_width = width;
+		_height = height;
+		toGray(image, channels);
+		computeIntegral();
+
+		//---------- Detection (parallel by tiles) ----------//
+		const size_t qtyThreads = getQtyThreads();
+		const unsigned tileSize = std::max(_info.tileSize, 8u);
+		const unsigned tilesX = (width+tileSize-1)/tileSize;
+		const unsigned tilesY = (height+tileSize-1)/tileSize;
+		const size_t qtyTiles = tilesX*tilesY;
+		// Each tile keeps more than its share, the best ones are selected globally
+		const size_t maxPerTile = std::max<size_t>(2*_info.maxFeatures/qtyTiles, 4);
+		_tileKeypoints.resize(qtyTiles);
+
+		parallelFor(qtyTiles, qtyThreads, [&](size_t tile)
+		{
+			detectTile(tile, maxPerTile, _tileKeypoints[tile]);
+		});
+
+		for(const auto& tileKeypoints : _tileKeypoints)
+			keypoints.insert(keypoints.end(), tileKeypoints.begin(), tileKeypoints.end());
+		if(keypoints.size() > _info.maxFeatures)
+		{
+			std::nth_element(keypoints.begin(), keypoints.begin()+_info.maxFeatures, keypoints.end(),
+					[](const Keypoint& a, const Keypoint& b){ return a.score > b.score; });
+			keypoints.resize(_info.maxFeatures);
+		}
+
+		//---------- Orientation and descriptors (parallel by blocks of keypoints) ----------//
+		descriptors.resize(keypoints.size());
+		const size_t blockSize = 64;
+		const size_t qtyBlocks = (keypoints.size()+blockSize-1)/blockSize;
+		parallelFor(qtyBlocks, qtyThreads, [&](size_t block)
+		{
+			const size_t end = std::min(keypoints.size(), (block+1)*blockSize);
+			for(size_t i=block*blockSize; i<end; i++)
+			{
+				keypoints[i].angle = orientation(keypoints[i].point.x, keypoints[i].point.y);
+				describe(keypoints[i], descriptors[i]);
+			}
+		});
+	}
+
+	void ORB::toGray(const uint8_t* image, unsigned channels)
+	{
+		const size_t size = size_t(_width)*_height;
+		_gray.resize(size);
+		if(channels == 1)
+		{
+			std::copy(image, image+size, _gray.begin());
+			return;
+		}
+		// ITU-R BT.601 luma (fixed point)
+		for(size_t i=0; i<size; i++)
+		{
+			const uint8_t* p = image+i*channels;
+			_gray[i] = (77*p[0] + 150*p[1] + 29*p[2] + 128)>>8;
+		}
+	}
+
+	void ORB::computeIntegral()
+	{
+		const size_t stride = _width+1;
+		_integral.resize(stride*(_height+1));
+		std::fill(_integral.begin(), _integral.begin()+stride, 0);
+		for(unsigned y=0; y<_height; y++)
+		{
+			const uint8_t* row = &_gray[size_t(y)*_width];
+			const uint32_t* prev = &_integral[size_t(y)*stride];
+			uint32_t* curr = &_integral[size_t(y+1)*stride];
+			uint32_t sum = 0;
+			curr[0] = 0;
+			for(unsigned x=0; x<_width; x++)
+			{
+				sum += row[x];
+				curr[x+1] = prev[x+1] + sum;
+			}
+		}
+	}
+
+	void ORB::detectTile(unsigned tile, size_t maxPerTile, std::vector<Keypoint>& out) const
+	{
+		out.clear();
+		const unsigned tileSize = std::max(_info.tileSize, 8u);
+		const unsigned tilesX = (_width+tileSize-1)/tileSize;
+		const int tileX = (tile%tilesX)*tileSize;
+		const int tileY = (tile/tilesX)*tileSize;
+		const int x0 = std::max<int>(tileX, border);
+		const int y0 = std::max<int>(tileY, border);
+		const int x1 = std::min<int>(tileX+tileSize, _width-border);
+		const int y1 = std::min<int>(tileY+tileSize, _height-border);
+		if(x0 >= x1 || y0 >= y1)
+			return;
+
+		// Corner scores with one pixel margin for the non maximum suppression
+		const int w = x1-x0+2;
+		const int h = y1-y0+2;
+		thread_local std::vector<int> scores;
+		scores.assign(w*h, 0);
+
+		const int t = _info.fastThreshold;
+		const int stride = _width;
+		int offsets[16];
+		for(int i=0; i<16; i++)
+			offsets[i] = circleY[i]*stride + circleX[i];
+
+		for(int y=y0-1; y<y1+1; y++)
+		{
+			const uint8_t* row = &_gray[size_t(y)*stride];
+			for(int x=x0-1; x<x1+1; x++)
+			{
+				const uint8_t* p = row+x;
+				const int center = *p;
+				const int hi = center+t;
+				const int lo = center-t;
+
+				// Fast rejection: a 9 arc contains at least two of the pixels 0,4,8,12
+				int qtyBright = 0, qtyDark = 0;
+				for(int k=0; k<16; k+=4)
+				{
+					const int v = p[offsets[k]];
+					qtyBright += v > hi;
+					qtyDark += v < lo;
+				}
+				if(qtyBright < 2 && qtyDark < 2)
+					continue;
+
+				uint32_t bright = 0, dark = 0;
+				int sumBright = 0, sumDark = 0;
+				for(int k=0; k<16; k++)
+				{
+					const int v = p[offsets[k]];
+					if(v > hi)
+					{
+						bright |= 1u<<k;
+						sumBright += v-hi;
+					}
+					else if(v < lo)
+					{
+						dark |= 1u<<k;
+						sumDark += lo-v;
+					}
+				}
+
+				int score = 0;
+				if(hasArc9(bright))
+					score = sumBright;
+				if(hasArc9(dark))
+					score = std::max(score, sumDark);
+				scores[(y-y0+1)*w + (x-x0+1)] = score;
+			}
+		}
+
+		// 3x3 non maximum suppression
+		for(int y=1; y<h-1; y++)
+			for(int x=1; x<w-1; x++)
+			{
+				const int* s = &scores[y*w+x];
+				const int v = *s;
+				if(v == 0)
+					continue;
+				// Ties are broken by the scan order
+				if(v < s[-w-1] || v < s[-w] || v < s[-w+1] || v < s[-1] ||
+						v <= s[1] || v <= s[w-1] || v <= s[w] || v <= s[w+1])
+					continue;
+				out.push_back({vec2i(x0+x-1, y0+y-1), float(v), 0.0f});
+			}
+
+		if(out.size() > maxPerTile)
+		{
+			std::nth_element(out.begin(), out.begin()+maxPerTile, out.end(),
+					[](const Keypoint& a, const Keypoint& b){ return a.score > b.score; });
+			out.resize(maxPerTile);
+		}
+	}
+
+	float ORB::orientation(int x, int y) const
+	{
+		// Intensity centroid inside the circular patch
+		const int stride = _width;
+		const uint8_t* center = &_gray[size_t(y)*stride + x];
+		int m10 = 0, m01 = 0;
+		for(int u=-patchRadius; u<=patchRadius; u++)
+			m10 += u*center[u];
+		for(int v=1; v<=patchRadius; v++)
+		{
+			int sumV = 0;
+			const int d = _umax[v];
+			for(int u=-d; u<=d; u++)
+			{
+				const int valPlus = center[u + v*stride];
+				const int valMinus = center[u - v*stride];
+				sumV += valPlus-valMinus;
+				m10 += u*(valPlus+valMinus);
+			}
+			m01 += v*sumV;
+		}
+		return std::atan2(float(m01), float(m10));
+	}
+
+	int ORB::boxSum(int x, int y) const
+	{
+		// 5x5 window sum (smoothed intensity for the binary tests)
+		const size_t stride = _width+1;
+		const uint32_t* top = &_integral[size_t(y-2)*stride];
+		const uint32_t* bottom = &_integral[size_t(y+3)*stride];
+		return bottom[x+3] - bottom[x-2] - top[x+3] + top[x-2];
+	}
+
+	void ORB::describe(const Keypoint& keypoint, Descriptor& descriptor) const
+	{
+		float angle = keypoint.angle;
+		if(angle < 0)
+			angle += 2*M_PI;
+		const size_t a = size_t(std::round(angle*qtyAngles/(2*M_PI)))%qtyAngles;
+		const int8_t* pattern = _pattern[a].data();
+		const int x = keypoint.point.x;
+		const int y = keypoint.point.y;
+
+		for(size_t w=0; w<4; w++)
+		{
+			uint64_t word = 0;
+			for(size_t b=0; b<64; b++)
+			{
+				const int8_t* test = pattern + (w*64+b)*4;
+				const uint64_t bit = boxSum(x+test[0], y+test[1]) < boxSum(x+test[2], y+test[3]);
+				word |= bit<<b;
+			}
+			descriptor.bits[w] = word;
+		}
+	}
+}
@@ -52,8 +52,7 @@ namespace atta::linalg
 			// Interchange rows if necessary (moving pivot to diagonal)
 			if(k!=imax)
 			{
-				for(size_t c=0;c<n;c++)
-					std::swap(lu[imax][c], lu[k][c]);
+				lu.swapRows(imax, k);
 				d = -d;// Change parity
 				rs[imax] = rs[k];// Change implicit scale factor for row imax
 			}
@@ -62,14 +61,16 @@ namespace atta::linalg
 			if(lu[k][k]==0) lu[k][k]=TINY;
 
 			// For each row > k (lower triangular)
+			const float* luk = lu[k];
 			for(size_t i=k+1;i<n;i++)
 			{
+				float* lui = lu[i];
 				// αik = aik/βkk
-				temp = (lu[i][k]/=lu[k][k]);// Divide by pivot element (lower triangular)
+				temp = (lui[k]/=luk[k]);// Divide by pivot element (lower triangular)
 				// Reduce column > k
 				// βij -= Σαik*βkj
 				for(size_t j=k+1;j<n;j++)
-					lu[i][j] -= temp*lu[k][j];
+					lui[j] -= temp*luk[j];
 			}
 		}
 	}
@@ -61,27 +61,29 @@ namespace atta::linalg
 		//d[n-1] = R[n-1][n-1];
 		if(d[n-1]==0.0f) sing = true;
 		// Set Q^T as identity
-		for(size_t i=0;i<m;i++)
-		{
-			for(size_t j=0;j<m;j++) Qt[i][j] = 0.0;
-			Qt[i][i]=1.0f;
-		}
+		Qt.setIdentity();
 		// Multiply identity by P_0, P_1...P_(n-1)
+		vec sum(m);
 		for(size_t k=0;k<n;k++)
 		{
 			if(c[k]!=0.0f)
 			{
-				for(size_t j=0; j<m; j++)
+				// Distance of each Qt column to plane v_k (accumulated row by row to access Qt contiguously)
+				for(size_t j=0; j<m; j++) sum[j] = 0.0f;
+				for(size_t i=k;i<m;i++)
+				{
+					const float rik = R[i][k];
+					const float* qti = Qt[i];
+					for(size_t j=0; j<m; j++)
+						sum[j] += rik*qti[j];
+				}
+				// Reflect orthonormal base vectors to new orientation (adjusting distance with plane vector length)
+				for(size_t i=k;i<m;i++)
 				{
-					// Distance Qt column to plane v_i
-					float sum = 0.0f;
-					for(size_t i=k;i<m;i++)
-						sum += R[i][k]*Qt[i][j];
-					// Adjust distance with plane vector length
-					sum /= c[k];
-					// Reflect orthonormal base vector to new orientation
-					for(size_t i=k;i<m;i++)
-						Qt[i][j] -= sum*R[i][k];
+					const float rik = R[i][k]/c[k];
+					float* qti = Qt[i];
+					for(size_t j=0; j<m; j++)
+						qti[j] -= sum[j]*rik;
 				}
 			}
 		}
@@ -111,7 +113,7 @@ namespace atta::linalg
 		for(int i=n-1; i>=0; i--)
 		{
 			sum = b[i];
-			for(int j=i+1;j<m;j++) sum -= R[i][j]*x[j];
+			for(int j=i+1;j<(int)n;j++) sum -= R[i][j]*x[j];
 			x[i]=sum/R[i][i];
 		}
 	}
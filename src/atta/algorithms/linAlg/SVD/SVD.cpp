@@ -13,7 +13,7 @@ namespace atta::linalg
 	inline float SIGN(const float &a, const float &b)
 	{return b >= 0 ? (a >= 0 ? a : -a) : (a >= 0 ? -a : a);}
 
-	SVD::SVD(mat& A):
+	SVD::SVD(const mat& A):
 		m(A.nrows), n(A.ncols), 
 		U(A), V(n,n), S(n)
 	{
@@ -315,7 +315,7 @@ namespace atta::linalg
 
 	unsigned SVD::rank(float thresh)
 	{
-		unsigned nr;
+		unsigned nr = 0;
 		tsh = thresh>0.0f ? thresh : 0.5f*sqrt(m+n+1.0f)*S[0]*eps;
 		for(size_t i=0;i<n;i++) if(S[i]>tsh)nr++;
 		return nr;
@@ -323,7 +323,7 @@ namespace atta::linalg
 
 	unsigned SVD::nullity(float thresh)
 	{
-		unsigned nr;
+		unsigned nr = 0;
 		tsh = thresh>0.0f ? thresh : 0.5f*sqrt(m+n+1.0f)*S[0]*eps;
 		for(size_t i=0;i<n;i++) if(S[i]<=tsh)nr++;
 		return nr;
@@ -331,7 +331,7 @@ namespace atta::linalg
 
 	mat SVD::colSpace(float thresh)
 	{
-		size_t nr;
+		size_t nr = 0;
 		mat colSp(m,rank(thresh));
 		for(size_t i=0;i<n;i++) if(S[i]>tsh)
 		{
@@ -344,8 +344,8 @@ namespace atta::linalg
 
 	mat SVD::nullSpace(float thresh)
 	{
-		size_t nn;
-		mat nullSp(m,nullity(thresh));
+		size_t nn = 0;
+		mat nullSp(n,nullity(thresh));
 		for(size_t i=0;i<n;i++) if(S[i]<=tsh)
 		{
 			for(size_t j=0;j<n;j++) 
@@ -30,7 +30,8 @@ namespace atta
 		Scene::CreateInfo sceneInfo = 
 		{
 			.objects = _info.objects,
-			.robots = _info.robots
+			.robots = _info.robots,
+			.seed = _info.seed
 		};
 		_scene = std::make_shared<Scene>(sceneInfo);
 
@@ -70,7 +71,12 @@ namespace atta
 		ThreadManager::GeneralConfig config = {
 			.scene = _scene,
 			.dimensionMode = _info.dimensionMode,
-			.vkCore = vkCore,	
+			.vkCore = vkCore,
+			.deterministic = _info.deterministic,
+			.fixedDt = _info.fixedDt,
+			.stateHashFile = _info.stateHashFile,
+			.stateStreamPort = _info.stateStreamPort,
+			.sharedMemoryName = _info.sharedMemoryName
 		};
 
 		return config;
@@ -90,7 +96,8 @@ namespace atta
 
 			// Create physics engine
 			phy::PhysicsEngine::CreateInfo phyEngInfo = {
-				.accelerator = accelerator
+				.accelerator = accelerator,
+				.scene = _scene
 			};
 			std::shared_ptr<phy::PhysicsEngine> physicsEngine = std::make_shared<phy::PhysicsEngine>(phyEngInfo);
 
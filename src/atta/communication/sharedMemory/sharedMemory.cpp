@@ -0,0 +1,114 @@
+//--------------------------------------------------
+// Atta Project
+// sharedMemory.cpp
+// Date: 2021-07-10
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/communication/sharedMemory/sharedMemory.h>
+#include <atta/helpers/log.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace atta
+{
+	namespace
+	{
+		// shm_open names must start with a slash
+		std::string shmName(const std::string& name)
+		{
+			return name.empty() || name[0] != '/' ? "/"+name : name;
+		}
+	}
+
+	SharedMemory::SharedMemory():
+		_data(nullptr), _size(0), _owner(false)
+	{
+
+	}
+
+	SharedMemory::~SharedMemory()
+	{
+		close();
+	}
+
+	bool SharedMemory::create(const std::string& name, size_t size)
+	{
+		close();
+		_name = shmName(name);
+
+		shm_unlink(_name.c_str());
+		int fd = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		if(fd < 0)
+		{
+			Log::error("SharedMemory", "Failed to create segment $0 ($1)", _name, std::string(strerror(errno)));
+			return false;
+		}
+		if(ftruncate(fd, size) < 0)
+		{
+			Log::error("SharedMemory", "Failed to resize segment $0 to $1 bytes ($2)", _name, size, std::string(strerror(errno)));
+			::close(fd);
+			shm_unlink(_name.c_str());
+			return false;
+		}
+
+		// Populate now, no page faults when publishing data
+		void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+		::close(fd);
+		if(data == MAP_FAILED)
+		{
+			Log::error("SharedMemory", "Failed to map segment $0 ($1)", _name, std::string(strerror(errno)));
+			shm_unlink(_name.c_str());
+			return false;
+		}
+
+		_data = static_cast<uint8_t*>(data);
+		_size = size;
+		_owner = true;
+		return true;
+	}
+
+	bool SharedMemory::open(const std::string& name)
+	{
+		close();
+		_name = shmName(name);
+
+		int fd = shm_open(_name.c_str(), O_RDWR, 0600);
+		if(fd < 0)
+			return false;
+
+		struct stat st;
+		if(fstat(fd, &st) < 0 || st.st_size == 0)
+		{
+			::close(fd);
+			return false;
+		}
+
+		void* data = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+		::close(fd);
+		if(data == MAP_FAILED)
+		{
+			Log::error("SharedMemory", "Failed to map segment $0 ($1)", _name, std::string(strerror(errno)));
+			return false;
+		}
+
+		_data = static_cast<uint8_t*>(data);
+		_size = st.st_size;
+		_owner = false;
+		return true;
+	}
+
+	void SharedMemory::close()
+	{
+		if(_data)
+			munmap(_data, _size);
+		if(_owner)
+			shm_unlink(_name.c_str());
+		_data = nullptr;
+		_size = 0;
+		_owner = false;
+	}
+}
@@ -0,0 +1,83 @@
+//--------------------------------------------------
+// Atta Project
+// shmClient.cpp
+// Date: 2021-07-10
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/communication/sharedMemory/shmClient.h>
+#include <atta/helpers/log.h>
+
+namespace atta
+{
+	ShmClient::ShmClient(std::string name):
+		_name(name), _connected(false), _header(nullptr)
+	{
+
+	}
+
+	ShmClient::~ShmClient()
+	{
+		if(_connected)
+			_header->clientConnected.store(0, std::memory_order_relaxed);
+	}
+
+	void ShmClient::connectToServer()
+	{
+		_connected = false;
+		_snapshots.clear();
+		if(!_memory.open(_name))
+		{
+			Log::warning("ShmClient", "Failed to open shared memory $0!", _name);
+			return;
+		}
+
+		uint8_t* base = _memory.getData();
+		_header = reinterpret_cast<ShmHeader*>(base);
+		if(_memory.getSize() < ShmHeader::size || _header->magic != ShmHeader::magicValue ||
+				!_header->ready.load(std::memory_order_acquire) || _memory.getSize() < _header->totalSize())
+		{
+			Log::warning("ShmClient", "Shared memory $0 is not ready or invalid", _name);
+			_memory.close();
+			return;
+		}
+
+		_clientRing = SpscRing(base+_header->clientRingOffset(), _header->ringCapacity, false);
+		_serverRing = SpscRing(base+_header->serverRingOffset(), _header->ringCapacity, false);
+		for(size_t i=0; i<_header->qtySnapshots; i++)
+			_snapshots.emplace_back(base+_header->snapshotOffset(i), _header->snapshotCapacity, false);
+
+		_header->clientConnected.store(1, std::memory_order_relaxed);
+		_connected = true;
+		Log::success("ShmClient", "Connected to the server");
+	}
+
+	bool ShmClient::tryReadFromServer(std::string& message)
+	{
+		if(!_connected)
+			return false;
+		span<const uint8_t> data = _serverRing.front();
+		if(!data.data())
+			return false;
+		message.assign(reinterpret_cast<const char*>(data.data()), data.size());
+		_serverRing.pop();
+		return true;
+	}
+
+	std::string ShmClient::readFromServer()
+	{
+		std::string message;
+		// Spin for low latency, yield if the server takes longer
+		for(size_t i=0; !tryReadFromServer(message); i++)
+		{
+			if(!_connected || !_header->ready.load(std::memory_order_relaxed))
+			{
+				_connected = false;
+				Log::warning("ShmClient", "Server offline!");
+				return "";
+			}
+			if(i > 4096)
+				std::this_thread::yield();
+		}
+		return message;
+	}
+}
@@ -0,0 +1,50 @@
+//--------------------------------------------------
+// Atta Project
+// shmServer.cpp
+// Date: 2021-07-10
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/communication/sharedMemory/shmServer.h>
+#include <atta/helpers/log.h>
+
+namespace atta
+{
+	ShmServer::ShmServer(CreateInfo info):
+		_header(nullptr)
+	{
+		// Ring indices are masked, capacity must be power of two
+		size_t ringCapacity = 64;
+		while(ringCapacity < info.ringCapacity)
+			ringCapacity <<= 1;
+
+		ShmHeader layout = {};
+		layout.ringCapacity = ringCapacity;
+		layout.qtySnapshots = info.qtySnapshots;
+		layout.snapshotCapacity = info.snapshotCapacity;
+
+		if(!_memory.create(info.name, layout.totalSize()))
+			return;
+
+		uint8_t* base = _memory.getData();
+		_header = new(base) ShmHeader();
+		_header->magic = ShmHeader::magicValue;
+		_header->ringCapacity = layout.ringCapacity;
+		_header->qtySnapshots = layout.qtySnapshots;
+		_header->snapshotCapacity = layout.snapshotCapacity;
+		_header->clientConnected.store(0, std::memory_order_relaxed);
+
+		_clientRing = SpscRing(base+_header->clientRingOffset(), ringCapacity, true);
+		_serverRing = SpscRing(base+_header->serverRingOffset(), ringCapacity, true);
+		for(size_t i=0; i<info.qtySnapshots; i++)
+			_snapshots.emplace_back(base+_header->snapshotOffset(i), info.snapshotCapacity, true);
+
+		_header->ready.store(1, std::memory_order_release);
+		Log::info("ShmServer", "Shared memory $0 created ($1 MB)", _memory.getName(), _memory.getSize()/(1024.0f*1024.0f));
+	}
+
+	ShmServer::~ShmServer()
+	{
+		if(_header)
+			_header->ready.store(0, std::memory_order_release);
+	}
+}
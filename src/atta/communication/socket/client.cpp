@@ -6,28 +6,103 @@
 //--------------------------------------------------
 #include <atta/communication/socket/client.h>
 #include <atta/helpers/log.h>
+#include <netinet/tcp.h>
+#include <sys/uio.h>
+#include <algorithm>
+#include <cerrno>
 
 namespace atta
 {
+	namespace
+	{
+		// Read/write exactly size bytes (stream sockets may return partial data)
+		bool readAll(int fd, uint8_t* data, size_t size)
+		{
+			while(size > 0)
+			{
+				ssize_t result = read(fd, data, size);
+				if(result <= 0)
+				{
+					if(result < 0 && errno == EINTR)
+						continue;
+					return false;
+				}
+				data += result;
+				size -= result;
+			}
+			return true;
+		}
+
+		// Discard size bytes (keeps the stream aligned to the next frame header)
+		bool skipAll(int fd, size_t size)
+		{
+			uint8_t buffer[16*1024];
+			while(size > 0)
+			{
+				const size_t chunk = std::min(size, sizeof(buffer));
+				if(!readAll(fd, buffer, chunk))
+					return false;
+				size -= chunk;
+			}
+			return true;
+		}
+
+		// Write header and data with a single system call when possible
+		bool writeFrame(int fd, const uint8_t* header, size_t headerSize, const uint8_t* data, size_t size)
+		{
+			struct iovec iov[2] = {{const_cast<uint8_t*>(header), headerSize}, {const_cast<uint8_t*>(data), size}};
+			int first = 0;
+			while(first < 2)
+			{
+				struct msghdr msg = {};
+				msg.msg_iov = iov+first;
+				msg.msg_iovlen = 2-first;
+				ssize_t result = sendmsg(fd, &msg, MSG_NOSIGNAL);
+				if(result < 0)
+				{
+					if(errno == EINTR)
+						continue;
+					return false;
+				}
+				// Skip what was written
+				while(first < 2 && size_t(result) >= iov[first].iov_len)
+				{
+					result -= iov[first].iov_len;
+					first++;
+				}
+				if(first < 2)
+				{
+					iov[first].iov_base = (uint8_t*)iov[first].iov_base + result;
+					iov[first].iov_len -= result;
+				}
+			}
+			return true;
+		}
+	}
+
 	Client::Client(std::string serverIp, unsigned serverPort):
 		_connected(false),
-		_serverIp(serverIp), _serverPort(serverPort)
+		_serverIp(serverIp), _serverPort(serverPort), _clientFd(-1)
 	{
 
 	}
 
 	Client::~Client()
 	{
-
+		if(_clientFd >= 0)
+			close(_clientFd);
 	}
 
 	void Client::connectToServer()
 	{
 		// Create TCP socket(SOCK_STREAM) using ipv4(AF_INET)
+		if(_clientFd >= 0)
+			close(_clientFd);
 		if((_clientFd = socket(AF_INET, SOCK_STREAM, 0)) < 0)
 		{
 			Log::error("Client", "Socket creation error");
-			exit(1);
+			_connected = false;
+			return;
 		}
 
 		// Populate server address
@@ -38,7 +113,8 @@ namespace atta
 		if(inet_pton(AF_INET, _serverIp.c_str(), &_serverAddr.sin_addr)<=0)
 		{
 			Log::error("Client", "Invalid address / Address not supported.");
-			exit(1);
+			_connected = false;
+			return;
 		}
 
 		// Connect to server
@@ -51,26 +127,46 @@ namespace atta
 		{
 			Log::success("Client", "Connected to the server");
 			_connected = true;
+			int opt = 1;
+			setsockopt(_clientFd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
 		}
 	}
 
-	void Client::sendToServer(std::string data)
+	bool Client::sendToServer(span<const uint8_t> data)
 	{
-		send(_clientFd, data.c_str(), data.size(), 0); 
+		const uint32_t size = data.size();
+		const uint8_t header[4] = {uint8_t(size), uint8_t(size>>8), uint8_t(size>>16), uint8_t(size>>24)};
+		if(!writeFrame(_clientFd, header, 4, data.data(), data.size()))
+		{
+			_connected = false;
+			Log::warning("Client", "Server offline!");
+			return false;
+		}
+		return true;
 	}
 
 	std::string Client::readFromServer(unsigned maxSize)
 	{
-		char buffer[maxSize];
-		int size = read(_clientFd, buffer, maxSize);
-		buffer[size] = '\0';
-		
-		if(size <= 0)
+		uint8_t header[4];
+		if(readAll(_clientFd, header, 4))
 		{
-			_connected = false;
-			Log::warning("Client", "Server offline!");
+			const uint32_t size = uint32_t(header[0]) | uint32_t(header[1])<<8 | uint32_t(header[2])<<16 | uint32_t(header[3])<<24;
+			if(size > maxSize)
+			{
+				Log::warning("Client", "Message with $0 bytes is bigger than $1, discarding it", size, maxSize);
+				if(skipAll(_clientFd, size))
+					return "";
+			}
+			else
+			{
+				std::string message(size, '\0');
+				if(readAll(_clientFd, reinterpret_cast<uint8_t*>(message.data()), size))
+					return message;
+			}
 		}
 
-		return std::string(buffer);
+		_connected = false;
+		Log::warning("Client", "Server offline!");
+		return "";
 	}
 }
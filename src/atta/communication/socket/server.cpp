@@ -6,225 +6,513 @@
 //--------------------------------------------------
 #include <atta/communication/socket/server.h>
 #include <atta/helpers/log.h>
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
 
 namespace atta
 {
+	namespace
+	{
+		// epoll data for the non client file descriptors
+		constexpr uint64_t listenTag = ~uint64_t(0);
+		constexpr uint64_t wakeTag = ~uint64_t(0)-1;
+		constexpr size_t headerSize = 4;
+		constexpr size_t initialRxSize = 64*1024;
+		constexpr int maxIovecs = 64;
+
+		void encodeHeader(uint32_t size, uint8_t header[headerSize])
+		{
+			header[0] = size;
+			header[1] = size>>8;
+			header[2] = size>>16;
+			header[3] = size>>24;
+		}
+
+		uint32_t decodeHeader(const uint8_t* header)
+		{
+			return uint32_t(header[0]) | uint32_t(header[1])<<8 | uint32_t(header[2])<<16 | uint32_t(header[3])<<24;
+		}
+	}
+
 	Server::Server(CreateInfo info):
 		_maxClients(info.maxClients), _port(info.port), _domain(info.domain), _protocol(info.protocol),
-		_shouldFinish(false), _createClientThreads(info.createClientThreads), _clientReadCallback(info.clientReadCallback)
+		_maxMessageSize(info.maxMessageSize), _maxQueuedBytes(info.maxQueuedBytes),
+		_shouldFinish(false), _running(false), _serverFd(-1), _epollFd(-1), _wakeFd(-1), _qtyConnected(0),
+		_clientReadCallback(info.clientReadCallback),
+		_clientConnectCallback(info.clientConnectCallback),
+		_clientDisconnectCallback(info.clientDisconnectCallback)
 	{
-		_clientSockets.resize(_maxClients);
+		if(_maxClients > slotMask+1)
+		{
+			Log::warning("Server", "Max number of clients is $0", slotMask+1);
+			_maxClients = slotMask+1;
+		}
+		_connections.resize(_maxClients);
+		for(auto& connection : _connections)
+			connection = std::make_unique<Connection>();
+		// Lower slots are used first
+		for(unsigned i=0; i<_maxClients; i++)
+			_freeSlots.push_back(_maxClients-1-i);
+
+		if(!init())
+		{
+			if(_serverFd >= 0) close(_serverFd);
+			if(_epollFd >= 0) close(_epollFd);
+			if(_wakeFd >= 0) close(_wakeFd);
+			_serverFd = _epollFd = _wakeFd = -1;
+			return;
+		}
 
-		int domain, type;
+		_running = true;
+		_thread = std::thread([this](){ mainThreadLoop(); });
+	}
+
+	Server::~Server()
+	{
+		_shouldFinish = true;
+		if(_thread.joinable())
+		{
+			wakeUp();
+			_thread.join();
+		}
+
+		for(unsigned i=0; i<_connections.size(); i++)
+			if(_connections[i]->fd >= 0)
+				close(_connections[i]->fd);
+		if(_serverFd >= 0) close(_serverFd);
+		if(_epollFd >= 0) close(_epollFd);
+		if(_wakeFd >= 0) close(_wakeFd);
+	}
+
+	bool Server::init()
+	{
+		if(_protocol != TCP)
+		{
+			Log::error("Server", "Only TCP is supported");
+			return false;
+		}
 
 		// Select protocol family (communication domain)
-		if(_domain == IPV4)
-			domain = AF_INET;
-		else if(_domain == IPV6)
-			domain = AF_INET6;
-	
-		// Select protocol family type
-		if(_protocol == TCP)
-			type = SOCK_STREAM;
-		else if(_protocol == UDP)
-			type = SOCK_DGRAM;
+		int domain = _domain == IPV6 ? AF_INET6 : AF_INET;
 
-		_serverFd = socket(domain, type, 0);
-		if(_serverFd == 0)
+		_serverFd = socket(domain, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if(_serverFd < 0)
 		{
-			Log::error("Server", "Failed to create socket!");
-			exit(1);
+			Log::error("Server", "Failed to create socket! ($0)", std::string(strerror(errno)));
+			return false;
 		}
 
-		// Allow address reuse (good for multiple connections)
+		// Allow address reuse (restart without waiting TIME_WAIT)
 		int opt = 1;
-		if(setsockopt(_serverFd, SOL_SOCKET, SO_REUSEADDR, (char*)&opt, sizeof(opt)) < 0 ) 
-		{ 
-			Log::error("Server", "Failed to set socket options!");
-			exit(1); 
+		if(setsockopt(_serverFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0)
+		{
+			Log::error("Server", "Failed to set socket options! ($0)", std::string(strerror(errno)));
+			return false;
 		}
 
-		// Populate socket address
-		_address.sin_family = domain;
-		_address.sin_addr.s_addr = INADDR_ANY;
-		_address.sin_port = htons(_port);
-
 		// Bind the socket to port
-		if(bind(_serverFd, (struct sockaddr *)&_address, sizeof(_address))<0)
+		int result;
+		if(_domain == IPV6)
 		{
-			Log::error("Server", "Failed to bind socket!");
-			exit(1);
+			struct sockaddr_in6 address = {};
+			address.sin6_family = AF_INET6;
+			address.sin6_addr = in6addr_any;
+			address.sin6_port = htons(_port);
+			result = bind(_serverFd, (struct sockaddr*)&address, sizeof(address));
+		}
+		else
+		{
+			struct sockaddr_in address = {};
+			address.sin_family = AF_INET;
+			address.sin_addr.s_addr = INADDR_ANY;
+			address.sin_port = htons(_port);
+			result = bind(_serverFd, (struct sockaddr*)&address, sizeof(address));
+		}
+		if(result < 0)
+		{
+			Log::error("Server", "Failed to bind socket to port $0! ($1)", _port, std::string(strerror(errno)));
+			return false;
 		}
-		Log::info("Server", "Listening on port $0", _port);
 
-		// Set socket fd as a passive and specify maximum number of pending connections
-		if(listen(_serverFd, 3) < 0)
+		// Set socket fd as a passive (one process per robot may connect at the same time)
+		if(listen(_serverFd, SOMAXCONN) < 0)
 		{
-			Log::error("Server", "Failed to set listen!");
-			exit(1);
+			Log::error("Server", "Failed to set listen! ($0)", std::string(strerror(errno)));
+			return false;
 		}
 
-		createMainThread();
-	}
+		_epollFd = epoll_create1(EPOLL_CLOEXEC);
+		_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if(_epollFd < 0 || _wakeFd < 0)
+		{
+			Log::error("Server", "Failed to create epoll! ($0)", std::string(strerror(errno)));
+			return false;
+		}
 
-	Server::~Server()
-	{
-		_shouldFinish = true;
-		for(std::thread &t : _threads)
-			t.join();
+		struct epoll_event event = {};
+		event.events = EPOLLIN | EPOLLET;
+		event.data.u64 = listenTag;
+		if(epoll_ctl(_epollFd, EPOLL_CTL_ADD, _serverFd, &event) < 0)
+		{
+			Log::error("Server", "Failed to add socket to epoll! ($0)", std::string(strerror(errno)));
+			return false;
+		}
+		event.events = EPOLLIN;
+		event.data.u64 = wakeTag;
+		if(epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeFd, &event) < 0)
+		{
+			Log::error("Server", "Failed to add eventfd to epoll! ($0)", std::string(strerror(errno)));
+			return false;
+		}
+
+		Log::info("Server", "Listening on port $0", _port);
+		return true;
 	}
 
-	void Server::createMainThread()
+	void Server::wakeUp()
 	{
-		_threads.push_back(std::thread([&](){mainThreadLoop();}));
+		uint64_t one = 1;
+		if(write(_wakeFd, &one, sizeof(one)) < 0)
+			Log::warning("Server", "Failed to wake up server thread");
 	}
 
 	void Server::mainThreadLoop()
 	{
-		Log::debug("Server", "Main Thread Loop");
+		struct epoll_event events[64];
 		while(!_shouldFinish)
 		{
-			// Initialize file descriptor set with all bits as zero
-			FD_ZERO(&_fdSet); 
-
-			//---------- Add sockets to set ----------//
-			// Add master socket to set (enable bit)
-			FD_SET(_serverFd, &_fdSet); 
-			
-			// Maximum file descriptor number (used when searching for client sockets to write/read)
-			int maxFd = _serverFd;
-
-			// Add client file descriptors to set
-			for(ClientInfo ci : _clientSockets) 
-			{ 
-				int fd = ci.fd;
-				// If valid file descriptor, then add it to read list 
-				if(fd > 0) 
-					FD_SET(fd, &_fdSet); 
-					
-				// Highest file descriptor number, required for the select function 
-				if(fd > maxFd) 
-					maxFd = fd; 
-			} 
-
-			//---------- Wait ----------//
-			// Wait for a read activity on one of the sockets
-			// Timeout of 100ms (needed to step the thread if atta is closed)
-			struct timeval timeout = {
-				.tv_sec = 0,
-				.tv_usec = 100000
-			};
-
-			int numReady = 0;// Number of file descriptors ready to read
-			if((numReady=select(maxFd+1, &_fdSet, NULL, NULL, &timeout))<0)
+			int numReady = epoll_wait(_epollFd, events, 64, -1);
+			if(numReady < 0)
 			{
-				Log::error("Server", "Failed to select file descriptor");
-				exit(1);
+				if(errno == EINTR)
+					continue;
+				Log::error("Server", "Failed to wait epoll events ($0), stopping server", std::string(strerror(errno)));
+				break;
 			}
 
-			//---------- Check sockets ----------//
-			if(numReady>0)
+			for(int i=0; i<numReady; i++)
 			{
-				checkMasterSocket();
-				if(!_createClientThreads)
-					checkClientSockets();
+				const uint64_t tag = events[i].data.u64;
+				const uint32_t flags = events[i].events;
+				if(tag == wakeTag)
+					continue;
+				if(tag == listenTag)
+				{
+					acceptClients();
+					continue;
+				}
+
+				const unsigned slot = tag;
+				if(flags & (EPOLLERR | EPOLLHUP))
+				{
+					closeClient(slot);
+					continue;
+				}
+				if(flags & EPOLLOUT)
+					flushClient(slot);
+				if(flags & (EPOLLIN | EPOLLRDHUP))
+					readClient(slot);
 			}
 		}
+		_running = false;
 	}
 
-	void Server::checkMasterSocket()
+	void Server::acceptClients()
 	{
-		// Check if master file descriptor is ready to read (clients connected or disconnected)
-		if(FD_ISSET(_serverFd, &_fdSet)) 
-		{ 
-			if(_protocol == TCP)
+		// Edge triggered -> accept until the queue is empty
+		while(true)
+		{
+			struct sockaddr_storage clientAddress;
+			socklen_t addrLen = sizeof(clientAddress);
+			int fd = accept4(_serverFd, (struct sockaddr*)&clientAddress, &addrLen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if(fd < 0)
+			{
+				if(errno == EINTR)
+					continue;
+				if(errno != EAGAIN && errno != EWOULDBLOCK)
+					Log::warning("Server", "Failed to accept connection ($0)", std::string(strerror(errno)));
+				return;
+			}
+
+			char ipStr[INET6_ADDRSTRLEN] = "";
+			unsigned port = 0;
+			if(clientAddress.ss_family == AF_INET6)
+			{
+				auto addr = (struct sockaddr_in6*)&clientAddress;
+				inet_ntop(AF_INET6, &addr->sin6_addr, ipStr, sizeof(ipStr));
+				port = ntohs(addr->sin6_port);
+			}
+			else
 			{
-				int newSocketFd;
-				std::string newSocketIp;
-				unsigned newSocketPort;
-
-				struct sockaddr_in clientAddress;
-				int addrLen = sizeof(clientAddress);
-				// Extract first connectin request from the queue of pending connections
-				if((newSocketFd = accept(_serverFd, (struct sockaddr *)&clientAddress, (socklen_t*)&addrLen))<0) 
-				{ 
-					Log::error("Server", "Failed to accept connection"); 
-					exit(1); 
+				auto addr = (struct sockaddr_in*)&clientAddress;
+				inet_ntop(AF_INET, &addr->sin_addr, ipStr, sizeof(ipStr));
+				port = ntohs(addr->sin_port);
+			}
+
+			if(_freeSlots.empty())
+			{
+				Log::warning("Server", "Could not accept client $0:$1, max number of clients reached", std::string(ipStr), port);
+				close(fd);
+				continue;
+			}
+
+			// Small messages should not wait for more data
+			int opt = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+
+			// Each connection has its own slot (multiple processes from the same host are different clients)
+			const unsigned slot = _freeSlots.back();
+			_freeSlots.pop_back();
+			Connection& c = *_connections[slot];
+			unsigned clientId;
+			{
+				std::lock_guard<std::mutex> lock(c.mutex);
+				c.generation = (c.generation+1) & slotMask;
+				clientId = makeClientId(slot, c.generation);
+				c.fd = fd;
+				c.ip = ipStr;
+				c.port = port;
+				c.rxSize = 0;
+				if(c.rxBuffer.size() < initialRxSize)
+					c.rxBuffer.resize(initialRxSize);
+				c.txQueue.clear();
+				c.txOffset = 0;
+			}
+
+			struct epoll_event event = {};
+			event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+			event.data.u64 = slot;
+			if(epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+			{
+				Log::warning("Server", "Failed to add client to epoll ($0)", std::string(strerror(errno)));
+				closeClient(slot);
+				continue;
+			}
+			_qtyConnected++;
+
+			Log::info("Server", "New client connection -> id:$0 fd:$1 ip:$2:$3", clientId, fd, c.ip, port);
+			if(_clientConnectCallback)
+				_clientConnectCallback(clientId);
+		}
+	}
+
+	void Server::readClient(unsigned slot)
+	{
+		Connection& c = *_connections[slot];
+		if(c.fd < 0)
+			return;
+		const unsigned clientId = makeClientId(slot, c.generation);
+
+		// Edge triggered -> read until EAGAIN
+		bool closed = false;
+		while(true)
+		{
+			// Make room for the frame being received
+			if(c.rxSize == c.rxBuffer.size())
+			{
+				size_t needed = c.rxBuffer.size()*2;
+				if(c.rxSize >= headerSize)
+					needed = std::max<size_t>(needed, headerSize + decodeHeader(c.rxBuffer.data()));
+				c.rxBuffer.resize(std::min(needed, _maxMessageSize+headerSize));
+			}
+
+			ssize_t valread = read(c.fd, c.rxBuffer.data()+c.rxSize, c.rxBuffer.size()-c.rxSize);
+			if(valread < 0)
+			{
+				if(errno == EINTR)
+					continue;
+				if(errno != EAGAIN && errno != EWOULDBLOCK)
+				{
+					Log::warning("Server", "Error when reading from client $0 ($1)", clientId, std::string(strerror(errno)));
+					closed = true;
 				}
-				newSocketIp = std::string(inet_ntoa(clientAddress.sin_addr));
-				newSocketPort = ntohs(clientAddress.sin_port);
-
-				Log::info("Server", "New client connection -> fd:$0 ip:$1:$2", 
-						newSocketFd, newSocketIp, newSocketPort);
-					
-				// Add new socket to vector of sockets 
-				int newSocketId = -1;
-				for(unsigned i=0; i<_clientSockets.size(); i++) 
-				{ 
-					// If position is empty or same client
-					if(_clientSockets[i].fd == -1 || _clientSockets[i].ip == newSocketIp) 
-					{ 
-						_clientSockets[i].fd = newSocketFd; 
-						_clientSockets[i].ip = newSocketIp; 
-						_clientSockets[i].port = newSocketPort; 
-						newSocketId = i;
-						Log::info("Server", "Adding to list of client sockets at $0", i); 
-						break; 
-					} 
-				} 
-
-				if(newSocketId == -1)
-					Log::warning("Server", "Could not accept new client, max number of clients reached"); 
-				else
+				break;
+			}
+			if(valread == 0)
+			{
+				closed = true;
+				break;
+			}
+			c.rxSize += valread;
+
+			// Deliver complete frames directly from the receive buffer
+			size_t offset = 0;
+			while(c.rxSize-offset >= headerSize)
+			{
+				const uint32_t size = decodeHeader(c.rxBuffer.data()+offset);
+				if(size > _maxMessageSize)
 				{
-					// Send connection message
-					std::string connectionMessage = "Hi from the server! You are the client "+std::to_string(newSocketId); 
-					if(send(newSocketFd, connectionMessage.c_str(), connectionMessage.size(), 0) != (int)connectionMessage.size())
-						Log::error("Server", "Failed to send welcome message"); 
+					Log::warning("Server", "Client $0 sent message with $1 bytes (max $2), closing connection", clientId, size, _maxMessageSize);
+					closeClient(slot);
+					return;
 				}
+				if(c.rxSize-offset-headerSize < size)
+					break;
+				if(_clientReadCallback)
+					_clientReadCallback(clientId, span<const uint8_t>(c.rxBuffer.data()+offset+headerSize, size));
+				offset += headerSize+size;
+				// The callback may have closed the connection
+				if(c.fd < 0)
+					return;
+			}
+			// Keep partial frame at the buffer start
+			if(offset > 0)
+			{
+				std::memmove(c.rxBuffer.data(), c.rxBuffer.data()+offset, c.rxSize-offset);
+				c.rxSize -= offset;
+			}
+		}
+
+		if(closed)
+			closeClient(slot);
+	}
+
+	void Server::flushClient(unsigned slot)
+	{
+		Connection& c = *_connections[slot];
+		std::lock_guard<std::mutex> lock(c.mutex);
+		while(c.fd >= 0 && c.txOffset < c.txQueue.size())
+		{
+			ssize_t written = ::send(c.fd, c.txQueue.data()+c.txOffset, c.txQueue.size()-c.txOffset, MSG_NOSIGNAL);
+			if(written < 0)
+			{
+				if(errno == EINTR)
+					continue;
+				// EAGAIN -> wait next EPOLLOUT, other errors are handled by EPOLLERR/EPOLLHUP
+				break;
+			}
+			c.txOffset += written;
+		}
+		if(c.txOffset == c.txQueue.size())
+		{
+			c.txQueue.clear();
+			c.txOffset = 0;
+		}
+	}
+
+	void Server::closeClient(unsigned slot)
+	{
+		Connection& c = *_connections[slot];
+		unsigned clientId;
+		{
+			std::lock_guard<std::mutex> lock(c.mutex);
+			if(c.fd < 0)
+				return;
+			clientId = makeClientId(slot, c.generation);
+			epoll_ctl(_epollFd, EPOLL_CTL_DEL, c.fd, nullptr);
+			close(c.fd);
+			c.fd = -1;
+			c.rxSize = 0;
+			c.txQueue.clear();
+			c.txOffset = 0;
+		}
+		_freeSlots.push_back(slot);
+		_qtyConnected--;
+
+		Log::info("Server", "Client disconnected -> id:$0 ip:$1:$2", clientId, c.ip, c.port);
+		if(_clientDisconnectCallback)
+			_clientDisconnectCallback(clientId);
+	}
+
+	bool Server::send(unsigned clientId, span<const uint8_t> message)
+	{
+		return send(clientId, span<const span<const uint8_t>>(&message, 1));
+	}
+
+	bool Server::send(unsigned clientId, span<const span<const uint8_t>> parts)
+	{
+		const unsigned slot = getSlot(clientId);
+		if(slot >= _connections.size())
+			return false;
+
+		size_t size = 0;
+		for(const auto& part : parts)
+			size += part.size();
+		if(size > _maxMessageSize || parts.size()+1 > maxIovecs)
+		{
+			Log::warning("Server", "Invalid message to client $0 ($1 bytes, $2 parts)", clientId, size, parts.size());
+			return false;
+		}
+
+		uint8_t header[headerSize];
+		encodeHeader(size, header);
+
+		Connection& c = *_connections[slot];
+		std::lock_guard<std::mutex> lock(c.mutex);
+		if(c.fd < 0 || makeClientId(slot, c.generation) != clientId)
+			return false;
+
+		// Backpressure, the client is not reading fast enough
+		const size_t queued = c.txQueue.size()-c.txOffset;
+		if(queued+headerSize+size > _maxQueuedBytes)
+			return false;
+
+		// Nothing queued -> try to write directly from the caller buffers
+		size_t written = 0;
+		if(queued == 0)
+		{
+			struct iovec iov[maxIovecs];
+			iov[0] = {header, headerSize};
+			int qtyIov = 1;
+			for(const auto& part : parts)
+				if(!part.empty())
+					iov[qtyIov++] = {const_cast<uint8_t*>(part.data()), part.size()};
+
+			struct msghdr msg = {};
+			msg.msg_iov = iov;
+			msg.msg_iovlen = qtyIov;
+			ssize_t result;
+			do
+				result = sendmsg(c.fd, &msg, MSG_NOSIGNAL);
+			while(result < 0 && errno == EINTR);
+			if(result < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+				return false;
+			written = std::max<ssize_t>(result, 0);
+			if(written == headerSize+size)
+				return true;
+		}
+
+		// Queue what was not written (flushed on EPOLLOUT)
+		size_t skip = written;
+		auto enqueue = [&](const uint8_t* data, size_t len)
+		{
+			const size_t s = std::min(skip, len);
+			skip -= s;
+			c.txQueue.insert(c.txQueue.end(), data+s, data+len);
+		};
+		enqueue(header, headerSize);
+		for(const auto& part : parts)
+			enqueue(part.data(), part.size());
+		return true;
+	}
+
+	void Server::broadcast(span<const uint8_t> message)
+	{
+		for(unsigned slot=0; slot<_connections.size(); slot++)
+		{
+			unsigned clientId;
+			{
+				std::lock_guard<std::mutex> lock(_connections[slot]->mutex);
+				if(_connections[slot]->fd < 0)
+					continue;
+				clientId = makeClientId(slot, _connections[slot]->generation);
 			}
-		} 
+			send(clientId, message);
+		}
 	}
 
-	void Server::checkClientSockets()
+	bool Server::getConnected(unsigned clientId) const
 	{
-		char buffer[1024];
-		int valread;
-
-		// Check if data was received from clients
-		for(size_t i=0;i<_clientSockets.size();i++) 
-		{ 
-			int fd = _clientSockets[i].fd;
-			// Check if there is something to read from this client
-			if(FD_ISSET(fd, &_fdSet)) 
-			{ 
-				// Check if it was for closing, and also read the incoming message 
-				if((valread = read(fd, buffer, 1024)) <= 0)
-				{ 
-					if(valread != 0)
-						Log::warning("Server", "Error when reading: $0", valread);
-					if(valread == 0)
-					{
-						// Client disconnected, get his details and print 
-						int addrLen = sizeof(_address);
-						getpeername(fd, (struct sockaddr*)&_address, (socklen_t*)&addrLen); 
-						Log::info("Server", "Client disconnected -> fd:$0 ip:$1:$2", fd, 
-								std::string(inet_ntoa(_address.sin_addr)),
-								std::to_string(ntohs(_address.sin_port))
-								);
-							
-						// Close the socket and mark as 0 in list for reuse 
-						close(fd); 
-						_clientSockets[i].fd = -1;
-					}
-				} 
-				else
-				{ 
-					if(_clientReadCallback)
-						_clientReadCallback(i, std::vector<uint8_t>(buffer, buffer+valread));
-					//Log::info("Server", "Received from client -> fd:$0 size:$1 buffer:$2", fd, valread, buffer);
-				} 
-			} 
-		} 
+		const unsigned slot = getSlot(clientId);
+		if(slot >= _connections.size())
+			return false;
+		std::lock_guard<std::mutex> lock(_connections[slot]->mutex);
+		return _connections[slot]->fd >= 0 && makeClientId(slot, _connections[slot]->generation) == clientId;
 	}
 }
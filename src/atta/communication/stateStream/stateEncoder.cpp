@@ -0,0 +1,215 @@
+//--------------------------------------------------
+// Atta Project
+// stateEncoder.cpp
+// Date: 2021-07-12
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/communication/stateStream/stateEncoder.h>
+#include <cmath>
+#include <cstring>
+
+namespace atta
+{
+	namespace
+	{
+		int32_t quantizeValue(float value, float invPrecision)
+		{
+			const float q = std::round(value*invPrecision);
+			// Saturate instead of overflow
+			return q >= 2147483520.0f ? INT32_MAX : (q <= -2147483520.0f ? INT32_MIN : int32_t(q));
+		}
+	}
+
+	//---------------------------------//
+	//-------- Quantized state --------//
+	//---------------------------------//
+	void QuantizedState::quantize(const std::vector<ObjectState>& states, float positionPrecision, float velocityPrecision)
+	{
+		const size_t n = states.size();
+		ids.resize(n);
+		transforms.resize(n*transformStride);
+		velocities.resize(n*velocityStride);
+
+		const float invPos = 1.0f/positionPrecision;
+		const float invVel = 1.0f/velocityPrecision;
+		for(size_t i=0; i<n; i++)
+		{
+			const ObjectState& s = states[i];
+			ids[i] = s.id;
+
+			// q and -q are the same rotation, keep r positive so small changes give small deltas
+			const float sign = s.orientation.r < 0 ? -1.0f : 1.0f;
+			int32_t* t = &transforms[i*transformStride];
+			t[0] = quantizeValue(s.position.x, invPos);
+			t[1] = quantizeValue(s.position.y, invPos);
+			t[2] = quantizeValue(s.position.z, invPos);
+			t[3] = quantizeValue(sign*s.orientation.r, orientationScale);
+			t[4] = quantizeValue(sign*s.orientation.i, orientationScale);
+			t[5] = quantizeValue(sign*s.orientation.j, orientationScale);
+			t[6] = quantizeValue(sign*s.orientation.k, orientationScale);
+
+			int32_t* v = &velocities[i*velocityStride];
+			v[0] = quantizeValue(s.velocity.x, invVel);
+			v[1] = quantizeValue(s.velocity.y, invVel);
+			v[2] = quantizeValue(s.velocity.z, invVel);
+			v[3] = quantizeValue(s.angularVelocity.x, invVel);
+			v[4] = quantizeValue(s.angularVelocity.y, invVel);
+			v[5] = quantizeValue(s.angularVelocity.z, invVel);
+		}
+	}
+
+	void QuantizedState::dequantize(std::vector<ObjectState>& states, float positionPrecision, float velocityPrecision) const
+	{
+		const size_t n = ids.size();
+		states.resize(n);
+		for(size_t i=0; i<n; i++)
+		{
+			ObjectState& s = states[i];
+			const int32_t* t = &transforms[i*transformStride];
+			const int32_t* v = &velocities[i*velocityStride];
+			s.id = ids[i];
+			s.position = vec3(t[0], t[1], t[2])*positionPrecision;
+			s.orientation = quat(t[3]/orientationScale, t[4]/orientationScale, t[5]/orientationScale, t[6]/orientationScale);
+			s.orientation.normalize();
+			s.velocity = vec3(v[0], v[1], v[2])*velocityPrecision;
+			s.angularVelocity = vec3(v[3], v[4], v[5])*velocityPrecision;
+		}
+	}
+
+	//---------------------------------//
+	//------------ Encoding -----------//
+	//---------------------------------//
+	void StateEncoder::writeVarint(uint64_t value, std::vector<uint8_t>& out)
+	{
+		while(value >= 0x80)
+		{
+			out.push_back(uint8_t(value) | 0x80);
+			value >>= 7;
+		}
+		out.push_back(uint8_t(value));
+	}
+
+	void StateEncoder::writeFloat(float value, std::vector<uint8_t>& out)
+	{
+		uint8_t bytes[4];
+		std::memcpy(bytes, &value, 4);
+		out.insert(out.end(), bytes, bytes+4);
+	}
+
+	void StateEncoder::encodeSection(const int32_t* values, const int32_t* baseline, size_t qtyObjects, size_t stride, std::vector<uint8_t>& out)
+	{
+		// Bitmask of changed objects (static objects cost one bit)
+		const size_t maskStart = out.size();
+		out.resize(maskStart + (qtyObjects+7)/8, 0);
+		for(size_t i=0; i<qtyObjects; i++)
+		{
+			const int32_t* v = values + i*stride;
+			bool changed = false;
+			if(baseline)
+			{
+				const int32_t* b = baseline + i*stride;
+				for(size_t c=0; c<stride; c++)
+					changed |= v[c] != b[c];
+			}
+			else
+				for(size_t c=0; c<stride; c++)
+					changed |= v[c] != 0;
+			if(!changed)
+				continue;
+
+			out[maskStart + i/8] |= 1u<<(i%8);
+			for(size_t c=0; c<stride; c++)
+			{
+				// Wrapping difference (decoder wraps back)
+				const int32_t delta = baseline ? int32_t(uint32_t(v[c]) - uint32_t(baseline[i*stride+c])) : v[c];
+				writeVarint(zigzag(delta), out);
+			}
+		}
+	}
+
+	void StateEncoder::encodeSensors(const std::vector<SensorState>& sensors, std::vector<uint8_t>& out)
+	{
+		writeVarint(sensors.size(), out);
+		for(const SensorState& s : sensors)
+		{
+			writeVarint(zigzag(s.objectId), out);
+			writeVarint(s.type, out);
+			writeVarint(s.width, out);
+			writeVarint(s.height, out);
+			writeFloat(s.fov, out);
+		}
+	}
+
+	//---------------------------------//
+	//------------ Decoding -----------//
+	//---------------------------------//
+	bool StateEncoder::readVarint(const uint8_t*& data, const uint8_t* end, uint64_t& value)
+	{
+		value = 0;
+		for(unsigned shift=0; shift<64; shift+=7)
+		{
+			if(data >= end)
+				return false;
+			const uint8_t byte = *data++;
+			value |= uint64_t(byte & 0x7f) << shift;
+			if(!(byte & 0x80))
+				return true;
+		}
+		return false;
+	}
+
+	bool StateEncoder::readFloat(const uint8_t*& data, const uint8_t* end, float& value)
+	{
+		if(end-data < 4)
+			return false;
+		std::memcpy(&value, data, 4);
+		data += 4;
+		return true;
+	}
+
+	bool StateEncoder::decodeSection(const uint8_t*& data, const uint8_t* end, int32_t* values, size_t qtyObjects, size_t stride)
+	{
+		const size_t maskSize = (qtyObjects+7)/8;
+		if(size_t(end-data) < maskSize)
+			return false;
+		const uint8_t* mask = data;
+		data += maskSize;
+
+		for(size_t i=0; i<qtyObjects; i++)
+		{
+			if(!(mask[i/8] & (1u<<(i%8))))
+				continue;
+			int32_t* v = values + i*stride;
+			for(size_t c=0; c<stride; c++)
+			{
+				uint64_t delta;
+				if(!readVarint(data, end, delta))
+					return false;
+				v[c] = int32_t(uint32_t(v[c]) + uint32_t(unzigzag(delta)));
+			}
+		}
+		return true;
+	}
+
+	bool StateEncoder::decodeSensors(const uint8_t*& data, const uint8_t* end, std::vector<SensorState>& sensors)
+	{
+		uint64_t qty;
+		if(!readVarint(data, end, qty))
+			return false;
+		sensors.clear();
+		for(uint64_t i=0; i<qty; i++)
+		{
+			uint64_t id, type, width, height;
+			SensorState s;
+			if(!readVarint(data, end, id) || !readVarint(data, end, type) ||
+					!readVarint(data, end, width) || !readVarint(data, end, height) || !readFloat(data, end, s.fov))
+				return false;
+			s.objectId = unzigzag(id);
+			s.type = SensorState::Type(type);
+			s.width = width;
+			s.height = height;
+			sensors.push_back(s);
+		}
+		return true;
+	}
+}
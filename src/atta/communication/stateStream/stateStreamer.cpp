@@ -0,0 +1,248 @@
+//--------------------------------------------------
+// Atta Project
+// stateStreamer.cpp
+// Date: 2021-07-12
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/communication/stateStream/stateStreamer.h>
+#include <atta/objects/object.h>
+#include <atta/objects/sensors/camera/camera.h>
+#include <atta/helpers/log.h>
+#include <cstring>
+
+namespace atta
+{
+	StateStreamer::StateStreamer(CreateInfo info):
+		_info(info), _hasPending(false), _step(0), _shouldFinish(false),
+		_qtyReplacedSteps(0), _qtyDroppedFrames(0)
+	{
+		_subscribers.resize(_info.maxSubscribers);
+
+		Server::CreateInfo serverInfo;
+		serverInfo.maxClients = _info.maxSubscribers;
+		serverInfo.port = _info.port;
+		serverInfo.maxQueuedBytes = _info.maxQueuedBytes;
+		serverInfo.clientReadCallback = [this](unsigned clientId, span<const uint8_t> message){ onMessage(clientId, message); };
+		serverInfo.clientDisconnectCallback = [this](unsigned clientId)
+		{
+			std::lock_guard<std::mutex> lock(_subscribersMutex);
+			_subscribers[Server::getSlot(clientId)] = Subscriber();
+		};
+		_server = std::make_unique<Server>(serverInfo);
+
+		_thread = std::thread([this](){ threadLoop(); });
+	}
+
+	StateStreamer::~StateStreamer()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_pendingMutex);
+			_shouldFinish = true;
+		}
+		_pendingCv.notify_one();
+		_thread.join();
+		_server.reset();
+	}
+
+	size_t StateStreamer::getQtySubscribers() const
+	{
+		std::lock_guard<std::mutex> lock(_subscribersMutex);
+		size_t qty = 0;
+		for(const Subscriber& s : _subscribers)
+			qty += s.active;
+		return qty;
+	}
+
+	void StateStreamer::onMessage(unsigned clientId, span<const uint8_t> message)
+	{
+		const uint8_t* data = message.data();
+		const uint8_t* end = data+message.size();
+		uint64_t rate;
+		if(message.size() < 2 || data[0] != STATE_MESSAGE_SUBSCRIBE)
+		{
+			Log::warning("StateStreamer", "Invalid message from subscriber $0", clientId);
+			return;
+		}
+		const uint8_t topics = data[1] & STATE_TOPIC_ALL;
+		data += 2;
+		if(!StateEncoder::readVarint(data, end, rate))
+			rate = 1;
+
+		std::lock_guard<std::mutex> lock(_subscribersMutex);
+		Subscriber& s = _subscribers[Server::getSlot(clientId)];
+		s.clientId = clientId;
+		s.active = topics != 0;
+		s.topics = topics;
+		s.rateDivisor = std::max<uint64_t>(rate, 1);
+		s.needsKeyframe = true;
+	}
+
+	//---------------------------------//
+	//---- Simulation thread side -----//
+	//---------------------------------//
+	void StateStreamer::publish(const std::vector<std::shared_ptr<Object>>& objects)
+	{
+		std::vector<ObjectState>& states = _publishing.objects;
+		std::vector<SensorState>& sensors = _publishing.sensors;
+		states.resize(objects.size());
+		sensors.clear();
+		for(size_t i=0; i<objects.size(); i++)
+		{
+			const Object& object = *objects[i];
+			ObjectState& s = states[i];
+			s.id = object.getId();
+			s.position = object.getPosition();
+			s.orientation = object.getOrientation();
+			std::shared_ptr<phy::Body> body = object.getBodyPhysics();
+			s.velocity = body ? body->getVelocity() : vec3(0,0,0);
+			s.angularVelocity = body ? body->getRotation() : vec3(0,0,0);
+
+			if(object.getType() == "Camera")
+			{
+				const Camera& camera = static_cast<const Camera&>(object);
+				sensors.push_back({object.getId(), SensorState::CAMERA, camera.getWidth(), camera.getHeight(), camera.getFov()});
+			}
+		}
+		publishSnapshot();
+	}
+
+	void StateStreamer::publish(const std::vector<ObjectState>& objects, const std::vector<SensorState>& sensors)
+	{
+		_publishing.objects.assign(objects.begin(), objects.end());
+		_publishing.sensors.assign(sensors.begin(), sensors.end());
+		publishSnapshot();
+	}
+
+	void StateStreamer::publishSnapshot()
+	{
+		_publishing.step = _step++;
+		{
+			// Only swaps vectors (no allocation once the capacities are reached)
+			std::lock_guard<std::mutex> lock(_pendingMutex);
+			if(_hasPending)
+				_qtyReplacedSteps++;
+			std::swap(_publishing, _pending);
+			_hasPending = true;
+		}
+		_pendingCv.notify_one();
+	}
+
+	//---------------------------------//
+	//------ Streamer thread side -----//
+	//---------------------------------//
+	void StateStreamer::threadLoop()
+	{
+		while(true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(_pendingMutex);
+				_pendingCv.wait(lock, [this](){ return _hasPending || _shouldFinish; });
+				if(_shouldFinish)
+					return;
+				std::swap(_pending, _encoding);
+				_hasPending = false;
+			}
+			encodeAndSend(_encoding);
+		}
+	}
+
+	void StateStreamer::encodeAndSend(const Snapshot& snapshot)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_subscribersMutex);
+			_subscribersCopy = _subscribers;
+			for(Subscriber& s : _subscribers)
+				s.needsKeyframe = false;
+		}
+
+		// Update groups
+		for(auto& [rate, group] : _groups)
+			group.topics = 0;
+		for(const Subscriber& s : _subscribersCopy)
+		{
+			if(!s.active)
+				continue;
+			Group& group = _groups[s.rateDivisor];
+			group.topics |= s.topics;
+			group.forceKeyframe |= s.needsKeyframe;
+		}
+		for(auto it = _groups.begin(); it != _groups.end();)
+			it = it->second.topics ? std::next(it) : _groups.erase(it);
+		if(_groups.empty())
+			return;
+
+		_current.quantize(snapshot.objects, _info.positionPrecision, _info.velocityPrecision);
+		const size_t n = _current.size();
+
+		std::vector<span<const uint8_t>> parts;
+		std::vector<uint8_t> header;
+		for(auto& [rate, group] : _groups)
+		{
+			if(snapshot.step < group.nextStep)
+				continue;
+			group.nextStep = snapshot.step + rate;
+
+			// Deltas are only valid if all subscribers have the same object list as baseline
+			const bool keyframe = group.forceKeyframe || group.baseline.size() != n ||
+				std::memcmp(group.baseline.ids.data(), _current.ids.data(), n*sizeof(int32_t)) != 0 ||
+				group.qtyFrames % _info.keyframeInterval == 0;
+			group.forceKeyframe = false;
+			group.qtyFrames++;
+
+			//---------- Encode once per group ----------//
+			group.keyframeData.clear();
+			group.transforms.clear();
+			group.velocities.clear();
+			group.sensors.clear();
+			if(keyframe)
+			{
+				StateEncoder::writeFloat(_info.positionPrecision, group.keyframeData);
+				StateEncoder::writeFloat(_info.velocityPrecision, group.keyframeData);
+				for(size_t i=0; i<n; i++)
+					StateEncoder::writeVarint(StateEncoder::zigzag(_current.ids[i]), group.keyframeData);
+			}
+			if(group.topics & STATE_TOPIC_TRANSFORMS)
+				StateEncoder::encodeSection(_current.transforms.data(), keyframe ? nullptr : group.baseline.transforms.data(),
+						n, QuantizedState::transformStride, group.transforms);
+			if(group.topics & STATE_TOPIC_VELOCITIES)
+				StateEncoder::encodeSection(_current.velocities.data(), keyframe ? nullptr : group.baseline.velocities.data(),
+						n, QuantizedState::velocityStride, group.velocities);
+			if(keyframe && (group.topics & STATE_TOPIC_SENSORS))
+				StateEncoder::encodeSensors(snapshot.sensors, group.sensors);
+
+			//---------- Send topics selected by each subscriber (gathered, no copy) ----------//
+			for(const Subscriber& s : _subscribersCopy)
+			{
+				if(!s.active || s.rateDivisor != rate)
+					continue;
+
+				// Sensors are only sent with keyframes
+				const uint8_t topics = s.topics & (keyframe ? STATE_TOPIC_ALL : ~STATE_TOPIC_SENSORS);
+				header.clear();
+				header.push_back(STATE_MESSAGE_FRAME);
+				header.push_back(keyframe ? STATE_FRAME_KEYFRAME : 0);
+				header.push_back(topics);
+				StateEncoder::writeVarint(snapshot.step, header);
+				StateEncoder::writeVarint(n, header);
+
+				parts.clear();
+				parts.push_back(header);
+				if(keyframe) parts.push_back(group.keyframeData);
+				if(topics & STATE_TOPIC_TRANSFORMS) parts.push_back(group.transforms);
+				if(topics & STATE_TOPIC_VELOCITIES) parts.push_back(group.velocities);
+				if(topics & STATE_TOPIC_SENSORS) parts.push_back(group.sensors);
+
+				if(!_server->send(s.clientId, parts))
+				{
+					// Subscriber lost this delta, resynchronize the group with a keyframe
+					_qtyDroppedFrames++;
+					group.forceKeyframe = true;
+				}
+			}
+
+			group.baseline.ids = _current.ids;
+			group.baseline.transforms = _current.transforms;
+			group.baseline.velocities = _current.velocities;
+		}
+	}
+}
@@ -0,0 +1,102 @@
+//--------------------------------------------------
+// Atta Project
+// stateSubscriber.cpp
+// Date: 2021-07-12
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/communication/stateStream/stateSubscriber.h>
+#include <atta/helpers/log.h>
+#include <algorithm>
+
+namespace atta
+{
+	StateSubscriber::StateSubscriber(std::string serverIp, unsigned serverPort):
+		_client(serverIp, serverPort), _synchronized(false), _step(0), _topics(0),
+		_positionPrecision(1.0f), _velocityPrecision(1.0f)
+	{
+	}
+
+	bool StateSubscriber::subscribe(uint8_t topics, uint32_t rateDivisor)
+	{
+		std::vector<uint8_t> message = { STATE_MESSAGE_SUBSCRIBE, uint8_t(topics & STATE_TOPIC_ALL) };
+		StateEncoder::writeVarint(std::max(rateDivisor, 1u), message);
+		// The streamer answers with a keyframe
+		_synchronized = false;
+		return _client.sendToServer(message);
+	}
+
+	bool StateSubscriber::receive()
+	{
+		while(_client.getConnected())
+		{
+			std::string message = _client.readFromServer();
+			if(message.empty())
+				continue;
+
+			const uint8_t* data = reinterpret_cast<const uint8_t*>(message.data());
+			if(data[0] != STATE_MESSAGE_FRAME)
+				continue;
+			if(decode(data, data+message.size()))
+				return true;
+			if(_synchronized)
+			{
+				Log::warning("StateSubscriber", "Invalid frame, waiting for the next keyframe");
+				_synchronized = false;
+			}
+		}
+		return false;
+	}
+
+	bool StateSubscriber::decode(const uint8_t* data, const uint8_t* end)
+	{
+		uint64_t step, n;
+		if(end-data < 3)
+			return false;
+		const bool keyframe = data[1] & STATE_FRAME_KEYFRAME;
+		const uint8_t topics = data[2];
+		data += 3;
+		if(!StateEncoder::readVarint(data, end, step) || !StateEncoder::readVarint(data, end, n))
+			return false;
+
+		// Deltas before the first keyframe can not be applied
+		if(!keyframe && (!_synchronized || n != _state.size()))
+			return false;
+
+		if(keyframe)
+		{
+			if(!StateEncoder::readFloat(data, end, _positionPrecision) ||
+					!StateEncoder::readFloat(data, end, _velocityPrecision))
+				return false;
+			// Reject counts the message can not hold before allocating (each object has at least its id varint)
+			const uint64_t minObjectSize = 1;
+			if(n > uint64_t(end-data)/minObjectSize)
+				return false;
+			_state.ids.resize(n);
+			_state.transforms.assign(n*QuantizedState::transformStride, 0);
+			_state.velocities.assign(n*QuantizedState::velocityStride, 0);
+			for(size_t i=0; i<n; i++)
+			{
+				uint64_t id;
+				if(!StateEncoder::readVarint(data, end, id))
+					return false;
+				_state.ids[i] = StateEncoder::unzigzag(id);
+			}
+		}
+
+		if(topics & STATE_TOPIC_TRANSFORMS)
+			if(!StateEncoder::decodeSection(data, end, _state.transforms.data(), n, QuantizedState::transformStride))
+				return false;
+		if(topics & STATE_TOPIC_VELOCITIES)
+			if(!StateEncoder::decodeSection(data, end, _state.velocities.data(), n, QuantizedState::velocityStride))
+				return false;
+		if(topics & STATE_TOPIC_SENSORS)
+			if(!StateEncoder::decodeSensors(data, end, _sensors))
+				return false;
+
+		_synchronized = true;
+		_step = step;
+		_topics = topics;
+		_state.dequantize(_objects, _positionPrecision, _velocityPrecision);
+		return true;
+	}
+}
@@ -5,6 +5,7 @@
 // By Breno Cunha Queiroz
 //--------------------------------------------------
 #include <atta/core/accelerator.h>
+#include <algorithm>
 
 namespace atta
 {
@@ -18,4 +19,15 @@ namespace atta
 	{
 
 	}
+
+	void Accelerator::addObject(std::shared_ptr<Object> object)
+	{
+		_objects.push_back(object);
+	}
+
+	void Accelerator::removeObject(Object* object)
+	{
+		_objects.erase(std::remove_if(_objects.begin(), _objects.end(),
+					[object](const std::shared_ptr<Object>& o){ return o.get() == object; }), _objects.end());
+	}
 }
@@ -5,12 +5,33 @@
 // By Breno Cunha Queiroz
 //--------------------------------------------------
 #include <atta/core/scene.h>
+#include <atta/helpers/log.h>
+#include <algorithm>
 #include <queue>
+#include <unordered_set>
 
 namespace atta
 {
+	namespace
+	{
+		thread_local uint64_t requestOrder = 0;
+
+		// Stable, requests with the same order keep the order they were made
+		template<typename T>
+		std::vector<T> sortRequests(std::vector<std::pair<uint64_t, T>>& requests)
+		{
+			std::stable_sort(requests.begin(), requests.end(),
+					[](const std::pair<uint64_t, T>& a, const std::pair<uint64_t, T>& b){ return a.first < b.first; });
+			std::vector<T> sorted;
+			sorted.reserve(requests.size());
+			for(auto& request : requests)
+				sorted.push_back(request.second);
+			return sorted;
+		}
+	}
+
 	Scene::Scene(CreateInfo info):
-		_objects(info.objects), _robots(info.robots)
+		_objects(info.objects), _robots(info.robots), _version(0), _seed(info.seed), _qtyRobotStreams(0)
 	{
 		//---------- Create object lists ----------//
 		// Creating _objectsFlat
@@ -27,21 +48,248 @@ namespace atta
 				objects.pop();
 
 				// Populate queue with its children
-				std::vector<std::shared_ptr<Object>> children = object->getChildren();
-				for(auto& child : children)
+				for(auto& child : object->getChildren())
 					objects.push(child);
 
 				_objectsFlat.push_back(object);
+				_registry.create(object);
 
 				// Populate light objects
 				if(object->isLight())
 					_lights.push_back(object);
 			}
 		}
+
+		_transformSystem = std::make_shared<TransformSystem>(_objects);
+
+		for(auto& robot : _robots)
+			assignRandomStream(robot.get());
 	}
 
 	Scene::~Scene()
 	{
 
 	}
+
+	//---------- Spawn/despawn ----------//
+	void Scene::spawn(std::shared_ptr<Object> object)
+	{
+		if(object == nullptr || object->getParent() != nullptr)
+		{
+			Log::warning("Scene", "Only root objects can be spawned");
+			return;
+		}
+		std::lock_guard<std::mutex> lock(_pendingMutex);
+		_pendingSpawn.push_back({requestOrder, object});
+	}
+
+	void Scene::despawn(ObjectHandle handle)
+	{
+		// Checked again when applied (the object may be despawned twice in the same frame)
+		Object* object = _registry.get(handle);
+		if(object == nullptr)
+		{
+			Log::warning("Scene", "Trying to despawn an object that is not alive");
+			return;
+		}
+		despawn(object);
+	}
+
+	void Scene::despawn(Object* object)
+	{
+		if(object == nullptr || object->getParent() != nullptr)
+		{
+			Log::warning("Scene", "Only root objects can be despawned");
+			return;
+		}
+		std::lock_guard<std::mutex> lock(_pendingMutex);
+		_pendingDespawn.push_back({requestOrder, object});
+	}
+
+	void Scene::spawnRobot(std::shared_ptr<Robot> robot)
+	{
+		if(robot == nullptr)
+			return;
+		{
+			std::lock_guard<std::mutex> lock(_pendingMutex);
+			_pendingSpawnRobots.push_back({requestOrder, robot});
+		}
+		spawn(robot->getRootObject());
+	}
+
+	void Scene::despawnRobot(Robot* robot)
+	{
+		if(robot == nullptr)
+			return;
+		{
+			std::lock_guard<std::mutex> lock(_pendingMutex);
+			_pendingDespawnRobots.push_back({requestOrder, robot});
+		}
+		despawn(robot->getRootObject().get());
+	}
+
+	void Scene::setRequestOrder(uint64_t order)
+	{
+		requestOrder = order;
+	}
+
+	Scene::Changes Scene::applyChanges()
+	{
+		std::vector<std::shared_ptr<Object>> pendingSpawn;
+		std::vector<Object*> pendingDespawn;
+		std::vector<std::shared_ptr<Robot>> pendingSpawnRobots;
+		std::vector<Robot*> pendingDespawnRobots;
+		{
+			std::lock_guard<std::mutex> lock(_pendingMutex);
+			pendingSpawn = sortRequests(_pendingSpawn);
+			pendingDespawn = sortRequests(_pendingDespawn);
+			pendingSpawnRobots = sortRequests(_pendingSpawnRobots);
+			pendingDespawnRobots = sortRequests(_pendingDespawnRobots);
+			_pendingSpawn.clear();
+			_pendingDespawn.clear();
+			_pendingSpawnRobots.clear();
+			_pendingDespawnRobots.clear();
+		}
+
+		Changes changes;
+		if(pendingSpawn.empty() && pendingDespawn.empty())
+			return changes;
+
+		//---------- Despawn ----------//
+		for(Object* object : pendingDespawn)
+		{
+			auto it = std::find_if(_objects.begin(), _objects.end(),
+					[object](const std::shared_ptr<Object>& o){ return o.get() == object; });
+			if(it == _objects.end())
+				continue;// Already despawned
+			changes.despawnedRoots.push_back(*it);
+			_objects.erase(it);
+		}
+
+		for(auto& root : changes.despawnedRoots)
+		{
+			std::queue<std::shared_ptr<Object>> objects;
+			objects.push(root);
+			while(!objects.empty())
+			{
+				std::shared_ptr<Object> object = objects.front();
+				objects.pop();
+				for(auto& child : object->getChildren())
+					objects.push(child);
+
+				_registry.destroy(object->getHandle());
+				changes.despawned.push_back(object);
+			}
+		}
+
+		if(!changes.despawned.empty())
+		{
+			std::unordered_set<Object*> despawned;
+			for(auto& object : changes.despawned)
+				despawned.insert(object.get());
+			auto isDespawned = [&despawned](const std::shared_ptr<Object>& o){ return despawned.count(o.get()) > 0; };
+			_objectsFlat.erase(std::remove_if(_objectsFlat.begin(), _objectsFlat.end(), isDespawned), _objectsFlat.end());
+			_lights.erase(std::remove_if(_lights.begin(), _lights.end(), isDespawned), _lights.end());
+		}
+
+		//---------- Spawn ----------//
+		for(auto& root : pendingSpawn)
+		{
+			if(std::find(_objects.begin(), _objects.end(), root) != _objects.end())
+			{
+				Log::warning("Scene", "Object [w]$0[] was already spawned", root->getName());
+				continue;
+			}
+			_objects.push_back(root);
+			changes.spawnedRoots.push_back(root);
+
+			std::queue<std::shared_ptr<Object>> objects;
+			objects.push(root);
+			while(!objects.empty())
+			{
+				std::shared_ptr<Object> object = objects.front();
+				objects.pop();
+				for(auto& child : object->getChildren())
+					objects.push(child);
+
+				_objectsFlat.push_back(object);
+				_registry.create(object);
+				changes.spawned.push_back(object);
+				if(object->isLight())
+					_lights.push_back(object);
+			}
+		}
+
+		//---------- Robots ----------//
+		for(Robot* robot : pendingDespawnRobots)
+			_robots.erase(std::remove_if(_robots.begin(), _robots.end(),
+						[robot](const std::shared_ptr<Robot>& r){ return r.get() == robot; }), _robots.end());
+		for(auto& robot : pendingSpawnRobots)
+			if(std::find(_robots.begin(), _robots.end(), robot) == _robots.end())
+			{
+				_robots.push_back(robot);
+				assignRandomStream(robot.get());
+			}
+
+		if(!changes.empty())
+		{
+			_transformSystem->rebuild(_objects);
+			_version++;
+		}
+		return changes;
+	}
+
+	//---------- Deterministic runs ----------//
+	void Scene::assignRandomStream(Robot* robot)
+	{
+		// High bit set, never the same as a system stream in practice
+		robot->setRandom(RandomStream(_seed, (uint64_t(1)<<63) | _qtyRobotStreams++));
+	}
+
+	RandomStream Scene::createRandomStream(const std::string& system) const
+	{
+		return RandomStream(_seed, RandomStream::streamFromName(system) & ~(uint64_t(1)<<63));
+	}
+
+	uint64_t Scene::computeStateHash() const
+	{
+		// FNV-1a over the bits of the state (the same bits are only produced by the same simulation)
+		uint64_t hash = 0xCBF29CE484222325ull;
+		auto add = [&hash](const void* data, size_t size)
+		{
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+			for(size_t i=0; i<size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= 0x100000001B3ull;
+			}
+		};
+
+		const uint64_t qtyObjects = _objectsFlat.size();
+		add(&qtyObjects, sizeof(qtyObjects));
+		for(auto& object : _objectsFlat)
+		{
+			const vec3 position = object->getPosition();
+			const quat orientation = object->getOrientation();
+			const vec3 scale = object->getScale();
+			add(&position, sizeof(vec3));
+			add(orientation.data, sizeof(orientation.data));
+			add(&scale, sizeof(vec3));
+
+			std::shared_ptr<phy::Body> body = object->getBodyPhysics();
+			if(body != nullptr)
+			{
+				const vec3 velocity = body->getVelocity();
+				const vec3 rotation = body->getRotation();
+				add(&velocity, sizeof(vec3));
+				add(&rotation, sizeof(vec3));
+			}
+		}
+		for(auto& robot : _robots)
+		{
+			const uint64_t counter = robot->getRandom().getCounter();
+			add(&counter, sizeof(counter));
+		}
+		return hash;
+	}
 }
@@ -0,0 +1,100 @@
+//--------------------------------------------------
+// Atta Robot Simulator
+// sceneRegistry.cpp
+// Date: 2021-07-25
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/core/sceneRegistry.h>
+#include <atta/helpers/log.h>
+
+namespace atta
+{
+	SceneRegistry::SceneRegistry()
+	{
+
+	}
+
+	SceneRegistry::~SceneRegistry()
+	{
+		for(auto object : _objects)
+			object->_handle = {};
+	}
+
+	ObjectHandle SceneRegistry::create(std::shared_ptr<Object> object)
+	{
+		if(object->_handle.isValid())
+		{
+			Log::warning("SceneRegistry", "Object [w]$0[] is already registered", object->getName());
+			return object->_handle;
+		}
+
+		//---------- Slot ----------//
+		ObjectHandle handle;
+		if(!_freeSlots.empty())
+		{
+			handle.index = _freeSlots.back();
+			_freeSlots.pop_back();
+		}
+		else
+		{
+			handle.index = _slots.size();
+			_slots.push_back({});
+		}
+		handle.generation = _slots[handle.index].generation;
+		_slots[handle.index].dense = _objects.size();
+
+		_objects.push_back(object.get());
+		_handles.push_back(handle);
+		_owners.push_back(object);
+		object->_handle = handle;
+
+		//---------- Components ----------//
+		if(object->getBodyPhysics() != nullptr && !object->isLight() && object->getParent() == nullptr)
+			_bodies.add(handle, object.get(), object->getBodyPhysics().get());
+		if(object->getModel() != nullptr)
+			_models.add(handle, object.get(), object->getModel().get());
+		if(object->getType() == "Camera")
+			_sensors.add(handle, object.get(), object.get());
+
+		return handle;
+	}
+
+	void SceneRegistry::destroy(ObjectHandle handle)
+	{
+		if(!isAlive(handle))
+			return;
+
+		_bodies.remove(handle);
+		_models.remove(handle);
+		_sensors.remove(handle);
+
+		// Swap remove from the dense arrays
+		const uint32_t i = _slots[handle.index].dense;
+		const uint32_t last = _objects.size()-1;
+		_objects[i]->_handle = {};
+		_objects[i] = _objects[last];
+		_handles[i] = _handles[last];
+		_owners[i] = std::move(_owners[last]);
+		_slots[_handles[i].index].dense = i;
+		_objects.pop_back();
+		_handles.pop_back();
+		_owners.pop_back();
+
+		// Handles to this slot are no longer valid
+		_slots[handle.index].dense = UINT32_MAX;
+		_slots[handle.index].generation++;
+		_freeSlots.push_back(handle.index);
+	}
+
+	bool SceneRegistry::isAlive(ObjectHandle handle) const
+	{
+		return handle.index < _slots.size() && 
+			_slots[handle.index].generation == handle.generation &&
+			_slots[handle.index].dense != UINT32_MAX;
+	}
+
+	Object* SceneRegistry::get(ObjectHandle handle) const
+	{
+		return isAlive(handle) ? _objects[_slots[handle.index].dense] : nullptr;
+	}
+}
@@ -0,0 +1,207 @@
+//--------------------------------------------------
+// Atta Robot Simulator
+// transformSystem.cpp
+// Date: 2021-07-24
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/core/transformSystem.h>
+#include <atta/math/batch.h>
+#include <algorithm>
+#include <thread>
+
+namespace atta
+{
+	namespace
+	{
+		// Waking the workers costs more than updating small levels
+		const size_t minObjectsPerThread = 2048;
+	}
+
+	TransformSystem::TransformSystem(const std::vector<std::shared_ptr<Object>>& rootObjects):
+		_qtyThreads(std::max(1u, std::thread::hardware_concurrency())),
+		_job(0), _jobBegin(0), _jobEnd(0), _jobChunk(0), _jobQtyThreads(0), _qtyPending(0), _stop(false)
+	{
+		rebuild(rootObjects);
+	}
+
+	TransformSystem::~TransformSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stop = true;
+		}
+		_startCv.notify_all();
+		for(auto& worker : _workers)
+			worker.join();
+
+		// Objects may outlive the scene
+		for(auto object : _objects)
+			object->_transformSystem = nullptr;
+	}
+
+	void TransformSystem::rebuild(const std::vector<std::shared_ptr<Object>>& rootObjects)
+	{
+		for(auto object : _objects)
+			object->_transformSystem = nullptr;
+		_objects.clear();
+		_parents.clear();
+		_levels.clear();
+
+		//---------- Order by depth ----------//
+		for(auto& root : rootObjects)
+		{
+			_objects.push_back(root.get());
+			_parents.push_back(-1);
+		}
+		_levels.push_back(0);
+		while(_levels.back() < _objects.size())
+		{
+			const size_t begin = _levels.back();
+			const size_t end = _objects.size();
+			for(size_t i=begin; i<end; i++)
+				for(auto& child : _objects[i]->getChildren())
+				{
+					_objects.push_back(child.get());
+					_parents.push_back(i);
+				}
+			_levels.push_back(end);
+		}
+
+		for(size_t i=0; i<_objects.size(); i++)
+		{
+			_objects[i]->_transformSystem = this;
+			_objects[i]->_transformIndex = i;
+			_objects[i]->_transformDirty = true;
+		}
+
+		_local.assign(_objects.size(), mat4(1));
+		_world.assign(_objects.size(), mat4(1));
+		_changed.assign(_objects.size(), 0);
+		update();
+	}
+
+	void TransformSystem::update()
+	{
+		for(size_t level=0; level+1<_levels.size(); level++)
+		{
+			const size_t begin = _levels[level];
+			const size_t end = _levels[level+1];
+			const size_t qtyThreads = std::min<size_t>(_qtyThreads, (end-begin)/minObjectsPerThread);
+			if(qtyThreads <= 1)
+			{
+				updateRange(begin, end);
+				continue;
+			}
+
+			// Contiguous ranges, the calling thread updates the first one
+			while(_workers.size()+1 < qtyThreads)
+				_workers.emplace_back(&TransformSystem::workerLoop, this, unsigned(_workers.size()));
+			const size_t chunk = (end-begin+qtyThreads-1)/qtyThreads;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_jobBegin = begin;
+				_jobEnd = end;
+				_jobChunk = chunk;
+				_jobQtyThreads = qtyThreads;
+				_qtyPending = qtyThreads-1;
+				_job++;
+			}
+			_startCv.notify_all();
+			updateRange(begin, std::min(end, begin+chunk));
+
+			std::unique_lock<std::mutex> lock(_mutex);
+			_doneCv.wait(lock, [this]{ return _qtyPending == 0; });
+		}
+	}
+
+	void TransformSystem::workerLoop(unsigned index)
+	{
+		const size_t range = index+1;
+		uint64_t lastJob = 0;
+		while(true)
+		{
+			size_t begin, end;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_startCv.wait(lock, [&]{ return _stop || _job != lastJob; });
+				if(_stop)
+					return;
+				lastJob = _job;
+				// Workers not needed by this level do not take part
+				if(range >= _jobQtyThreads)
+					continue;
+				begin = std::min(_jobEnd, _jobBegin+range*_jobChunk);
+				end = std::min(_jobEnd, _jobBegin+(range+1)*_jobChunk);
+			}
+
+			updateRange(begin, end);
+
+			std::lock_guard<std::mutex> lock(_mutex);
+			if(--_qtyPending == 0)
+				_doneCv.notify_one();
+		}
+	}
+
+	void TransformSystem::updateRange(size_t begin, size_t end)
+	{
+		//---------- Local matrices ----------//
+		// The dirty objects are gathered in chunks (structure of arrays) for the batch kernels
+		const size_t chunkSize = 64;
+		float position[3][chunkSize];
+		float orientation[4][chunkSize];
+		float scale[3][chunkSize];
+		mat4 locals[chunkSize];
+		size_t indices[chunkSize];
+		size_t qtyDirty = 0;
+		auto buildLocals = [&]()
+		{
+			batch::posOriScale(qtyDirty, {position[0], position[1], position[2]},
+					{orientation[0], orientation[1], orientation[2], orientation[3]}, {scale[0], scale[1], scale[2]}, locals);
+			for(size_t c=0; c<qtyDirty; c++)
+				_local[indices[c]] = locals[c];
+			qtyDirty = 0;
+		};
+
+		for(size_t i=begin; i<end; i++)
+		{
+			Object* object = _objects[i];
+			bool changed = object->_transformDirty;
+			if(changed)
+			{
+				object->_transformDirty = false;
+				position[0][qtyDirty] = object->_position.x;
+				position[1][qtyDirty] = object->_position.y;
+				position[2][qtyDirty] = object->_position.z;
+				scale[0][qtyDirty] = object->_scale.x;
+				scale[1][qtyDirty] = object->_scale.y;
+				scale[2][qtyDirty] = object->_scale.z;
+				for(int c=0; c<4; c++)
+					orientation[c][qtyDirty] = object->_orientation.data[c];
+				indices[qtyDirty++] = i;
+				if(qtyDirty == chunkSize)
+					buildLocals();
+			}
+
+			const int parent = _parents[i];
+			_changed[i] = changed || (parent >= 0 && _changed[parent]);
+		}
+		buildLocals();
+
+		//---------- World matrices ----------//
+		// Consecutive changed objects are composed with their parents in one call
+		size_t i = begin;
+		while(i < end)
+		{
+			if(!_changed[i])
+			{
+				i++;
+				continue;
+			}
+			size_t runEnd = i+1;
+			while(runEnd < end && _changed[runEnd])
+				runEnd++;
+			batch::compose(runEnd-i, _world.data(), &_parents[i], &_local[i], &_world[i]);
+			i = runEnd;
+		}
+	}
+}
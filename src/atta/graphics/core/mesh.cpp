@@ -4,21 +4,30 @@
 // Date: 2021-01-08
 // By Breno Cunha Queiroz
 //--------------------------------------------------
-#include <unordered_map>
 #include <atta/graphics/core/mesh.h>
-#include <atta/extern/tinyObjLoader.h>
+#include <atta/graphics/core/meshCache.h>
+#include <atta/graphics/core/meshOptimizer.h>
+#include <atta/graphics/core/meshSimplifier.h>
+#include <atta/graphics/core/objParser.h>
 #include <atta/helpers/evaluator.h>
 #include <atta/helpers/log.h>
+#include <algorithm>
+#include <cmath>
 
 namespace atta
 {
 	std::vector<Mesh*> Mesh::allMeshes = {};
+	std::mutex Mesh::allMeshesMutex;
 
 	Mesh::Mesh(std::string meshName):
 		_meshName(meshName)
 	{
-		_index = allMeshes.size();
-		allMeshes.push_back(this);
+		{
+			// Objects can be created by the robots (parallel)
+			std::lock_guard<std::mutex> lock(allMeshesMutex);
+			_index = allMeshes.size();
+			allMeshes.push_back(this);
+		}
 		if(meshName.find("atta::") == std::string::npos)
 		{
 			// Load from file
@@ -43,12 +52,39 @@ namespace atta
 			{
 				generateSphereMesh();
 			}
+			MeshData::computeBounds(_vertices, _boundsMin, _boundsMax);
+			MeshSimplifier::generateLods(_vertices, _indices, _lods, _lodIndices);
 		}
 	}
 
 	Mesh::~Mesh()
 	{
+		// Released when all objects using it are despawned (the index is not reused)
+		std::lock_guard<std::mutex> lock(allMeshesMutex);
+		allMeshes[_index] = nullptr;
+	}
 
+	unsigned Mesh::selectLod(const mat4& modelMat, vec3 cameraPosition, float projectionScale, float maxPixelError) const
+	{
+		if(_lods.empty() || projectionScale <= 0.0f)
+			return 0;
+
+		// Bounding sphere in world space (largest axis scale)
+		const vec3 center = modelMat*((_boundsMin+_boundsMax)*0.5f);
+		const float scale = std::sqrt(std::max({
+				modelMat.data[0]*modelMat.data[0] + modelMat.data[4]*modelMat.data[4] + modelMat.data[8]*modelMat.data[8],
+				modelMat.data[1]*modelMat.data[1] + modelMat.data[5]*modelMat.data[5] + modelMat.data[9]*modelMat.data[9],
+				modelMat.data[2]*modelMat.data[2] + modelMat.data[6]*modelMat.data[6] + modelMat.data[10]*modelMat.data[10]}));
+		const float radius = (_boundsMax-_boundsMin).length()*0.5f*scale;
+		const float distance = (center-cameraPosition).length() - radius;
+		if(distance <= 0.0f)
+			return 0;
+
+		const float pixelsPerUnit = projectionScale/distance;
+		for(unsigned lod=_lods.size(); lod>0; lod--)
+			if(_lods[lod-1].error*scale*pixelsPerUnit <= maxPixelError)
+				return lod;
+		return 0;
 	}
 
 	void Mesh::loadMesh()
@@ -56,103 +92,49 @@ namespace atta
 		LocalEvaluator eval;
 		std::string objPath = _meshName;
 
-		//---------- Parse file ----------//
-		tinyobj::ObjReader objReader;
-		if(!objReader.ParseFromFile(objPath))
-		{
-			Log::error("Mesh", "Failed to load model [w]$0[]: $1", objPath, objReader.Error());
-			exit(1);
-		}
-
-		if(!objReader.Warning().empty())
-		{
-			Log::warning("Mesh", "Warning while parsing [w]$0[]: $1", objPath, objReader.Warning());
-		}
-		//---------- Materials ----------//
-		for(const auto& material : objReader.GetMaterials())
-		{
-			Log::info("Mesh", "Found material: $0", material.name);
-			_materialNames.push_back(material.name);
-		}
-
-		//---------- Geometry ----------//
-		const auto& objAttrib = objReader.GetAttrib();
-
-		std::unordered_map<Vertex, uint32_t> uniqueVertices(objAttrib.vertices.size());
-		for(const auto& shape : objReader.GetShapes())
+		//---------- Load from cache or import ----------//
+		MeshData data;
+		bool cached = MeshCache::load(objPath, data);
+		if(!cached)
 		{
-			const auto& mesh = shape.mesh;
-			size_t faceId = 0;
-			for (const auto& index : mesh.indices)
+			ObjParser parser({.fileName = objPath});
+			if(!parser.parse(data))
 			{
-				Vertex vertex = {};
-				vertex.pos =
-				{
-					objAttrib.vertices[3 * index.vertex_index + 0],
-					objAttrib.vertices[3 * index.vertex_index + 1],
-					objAttrib.vertices[3 * index.vertex_index + 2],
-				};
-
-				if(!objAttrib.normals.empty())
-				{
-					vertex.normal =
-					{
-						objAttrib.normals[3 * index.normal_index + 0],
-						objAttrib.normals[3 * index.normal_index + 1],
-						objAttrib.normals[3 * index.normal_index + 2]
-					};
-				}
-
-				if(!objAttrib.texcoords.empty())
-				{
-					vertex.texCoord =
-					{
-						objAttrib.texcoords[2 * index.texcoord_index + 0],
-						1 - objAttrib.texcoords[2 * index.texcoord_index + 1]
-					};
-				}
-
-				vertex.materialIndex = std::max(0, mesh.material_ids[faceId++ / 3]);
-
-				if(uniqueVertices.count(vertex) == 0)
-				{
-					uniqueVertices[vertex] = static_cast<uint32_t>(_vertices.size());
-					_vertices.push_back(vertex);
-				}
-
-				_indices.push_back(uniqueVertices[vertex]);
+				Log::error("Mesh", "Failed to load model [w]$0[]: $1", objPath, parser.getError());
+				exit(1);
 			}
-		}
 
-		// If the model did not specify normals, then create smooth normals that conserve the same number of vertices.
-		// Using flat normals would mean creating more vertices than we currently have, 
-		// so for simplicity and better visuals we don't do it.
-		// See https://stackoverflow.com/questions/12139840/obj-file-averaging-normals.
-		if(objAttrib.normals.empty())
-		{
-			std::vector<vec3> normals(_vertices.size());
-			
-			for(size_t i = 0; i < _indices.size(); i += 3)
+			if(!parser.getWarning().empty())
 			{
-				const auto normal = atta::normalize(atta::cross(
-					vec3(_vertices[_indices[i + 1]].pos) - vec3(_vertices[_indices[i]].pos),
-					vec3(_vertices[_indices[i + 2]].pos) - vec3(_vertices[_indices[i]].pos)));
-
-				_vertices[_indices[i + 0]].normal += normal;
-				_vertices[_indices[i + 1]].normal += normal;
-				_vertices[_indices[i + 2]].normal += normal;			
+				Log::warning("Mesh", "Warning while parsing [w]$0[]: $1", objPath, parser.getWarning());
 			}
+			const float acmr = MeshOptimizer::computeAcmr(data.indices, data.vertices.size());
+			MeshOptimizer::optimize(data);
+			Log::debug("Mesh", "Optimized [w]$0[] - ACMR $1 -> $2", objPath, acmr, MeshOptimizer::computeAcmr(data.indices, data.vertices.size()));
+			MeshSimplifier::generateLods(data);
+			for(const MeshLod& lod : data.lods)
+				Log::debug("Mesh", "LOD of [w]$0[] - $1 triangles (error $2)", objPath, lod.qtyIndices/3, lod.error);
+			MeshCache::save(objPath, data);
+		}
 
-			for(auto& vertex : _vertices)
-			{
-				vertex.normal = atta::normalize(vertex.normal);
-			}
+		//---------- Materials ----------//
+		for(const auto& material : data.materialNames)
+		{
+			Log::info("Mesh", "Found material: $0", material);
 		}
 
+		_vertices = std::move(data.vertices);
+		_indices = std::move(data.indices);
+		_materialNames = std::move(data.materialNames);
+		_lods = std::move(data.lods);
+		_lodIndices = std::move(data.lodIndices);
+		_boundsMin = data.boundsMin;
+		_boundsMax = data.boundsMax;
+
 		//---------- Finished parsing ----------//
 		eval.stop();
-		Log::info("Mesh", "Finished loading [b]$0[] - [w]$1ms ($2 vertices, $3 indices)", 
-				_meshName, eval.getMs(), _vertices.size(), _indices.size());
+		Log::info("Mesh", "Finished loading [b]$0[]$1 - [w]$2ms ($3 vertices, $4 indices)",
+				_meshName, cached ? " (cached)" : "", eval.getMs(), _vertices.size(), _indices.size());
 	}
 
 	void Mesh::generateBoxMesh()
@@ -383,12 +365,12 @@ namespace atta
 			for(int i=0; i<qtyLong; i++)
 			{
 				_indices.push_back(j*qtyLong+i);
-				_indices.push_back(j*qtyLong+i+1);
+				_indices.push_back(j*qtyLong+(i+1)%qtyLong);
 				_indices.push_back((j+1)*qtyLong+i);
 
 				_indices.push_back((j+1)*qtyLong+i);
-				_indices.push_back((j+1)*qtyLong+i+1);
-				_indices.push_back(j*qtyLong+i+1);
+				_indices.push_back((j+1)*qtyLong+(i+1)%qtyLong);
+				_indices.push_back(j*qtyLong+(i+1)%qtyLong);
 			}
 		}
 
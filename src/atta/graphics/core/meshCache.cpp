@@ -0,0 +1,163 @@
+//--------------------------------------------------
+// Atta Graphics
+// meshCache.cpp
+// Date: 2021-07-15
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/graphics/core/meshCache.h>
+#include <atta/helpers/mappedFile.h>
+#include <atta/helpers/log.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <type_traits>
+
+namespace atta
+{
+	static_assert(std::is_trivially_copyable_v<Vertex>, "Vertex is copied directly to/from the mesh cache");
+
+	void MeshData::computeBounds(const std::vector<Vertex>& vertices, vec3& boundsMin, vec3& boundsMax)
+	{
+		if(vertices.empty())
+		{
+			boundsMin = boundsMax = vec3(0,0,0);
+			return;
+		}
+		const float inf = std::numeric_limits<float>::infinity();
+		boundsMin = vec3(inf, inf, inf);
+		boundsMax = vec3(-inf, -inf, -inf);
+		for(const Vertex& v : vertices)
+		{
+			boundsMin = vec3(std::min(boundsMin.x, v.pos.x), std::min(boundsMin.y, v.pos.y), std::min(boundsMin.z, v.pos.z));
+			boundsMax = vec3(std::max(boundsMax.x, v.pos.x), std::max(boundsMax.y, v.pos.y), std::max(boundsMax.z, v.pos.z));
+		}
+	}
+
+	bool MeshCache::load(const std::string& sourceFile, MeshData& data)
+	{
+		MappedFile source(sourceFile);
+		MappedFile cache(getCacheFileName(sourceFile));
+		if(!source.isValid() || !cache.isValid() || cache.getSize() < sizeof(Header))
+			return false;
+
+		Header header;
+		std::memcpy(&header, cache.getData(), sizeof(Header));
+		if(std::memcmp(header.magic, "ATTAMESH", 8) != 0 || header.version != version || header.vertexSize != sizeof(Vertex) ||
+				header.sourceSize != source.getSize() || header.sourceModificationTime != source.getModificationTime())
+			return false;
+
+		const size_t size = cache.getSize();
+		if(header.verticesOffset + header.qtyVertices*sizeof(Vertex) > size ||
+				header.indicesOffset + header.qtyIndices*sizeof(uint32_t) > size ||
+				header.lodsOffset + header.qtyLods*sizeof(MeshLod) > size ||
+				header.lodIndicesOffset + header.qtyLodIndices*sizeof(uint32_t) > size ||
+				header.materialsOffset > size)
+		{
+			Log::warning("MeshCache", "Corrupted cache file [w]$0[], importing again", getCacheFileName(sourceFile));
+			return false;
+		}
+
+		const uint8_t* bytes = cache.getData();
+		data.vertices.resize(header.qtyVertices);
+		std::memcpy(data.vertices.data(), bytes+header.verticesOffset, header.qtyVertices*sizeof(Vertex));
+		data.indices.resize(header.qtyIndices);
+		std::memcpy(data.indices.data(), bytes+header.indicesOffset, header.qtyIndices*sizeof(uint32_t));
+		data.lods.resize(header.qtyLods);
+		std::memcpy(data.lods.data(), bytes+header.lodsOffset, header.qtyLods*sizeof(MeshLod));
+		data.lodIndices.resize(header.qtyLodIndices);
+		std::memcpy(data.lodIndices.data(), bytes+header.lodIndicesOffset, header.qtyLodIndices*sizeof(uint32_t));
+		for(const MeshLod& lod : data.lods)
+			if(uint64_t(lod.indicesOffset) + lod.qtyIndices > header.qtyLodIndices)
+			{
+				Log::warning("MeshCache", "Corrupted cache file [w]$0[], importing again", getCacheFileName(sourceFile));
+				return false;
+			}
+
+		data.materialNames.clear();
+		size_t pos = header.materialsOffset;
+		for(uint64_t i=0; i<header.qtyMaterials; i++)
+		{
+			uint32_t length;
+			if(pos+4 > size)
+				return false;
+			std::memcpy(&length, bytes+pos, 4);
+			pos += 4;
+			if(pos+length > size)
+				return false;
+			data.materialNames.emplace_back(reinterpret_cast<const char*>(bytes+pos), length);
+			pos += length;
+		}
+
+		data.boundsMin = vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+		data.boundsMax = vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+		return true;
+	}
+
+	bool MeshCache::save(const std::string& sourceFile, const MeshData& data)
+	{
+		MappedFile source(sourceFile);
+		if(!source.isValid())
+			return false;
+
+		auto align = [](uint64_t offset){ return (offset+15) & ~uint64_t(15); };
+		Header header;
+		std::memcpy(header.magic, "ATTAMESH", 8);
+		header.version = version;
+		header.vertexSize = sizeof(Vertex);
+		header.sourceSize = source.getSize();
+		header.sourceModificationTime = source.getModificationTime();
+		header.qtyVertices = data.vertices.size();
+		header.qtyIndices = data.indices.size();
+		header.qtyMaterials = data.materialNames.size();
+		header.qtyLods = data.lods.size();
+		header.qtyLodIndices = data.lodIndices.size();
+		header.verticesOffset = align(sizeof(Header));
+		header.indicesOffset = align(header.verticesOffset + data.vertices.size()*sizeof(Vertex));
+		header.lodsOffset = header.indicesOffset + data.indices.size()*sizeof(uint32_t);
+		header.lodIndicesOffset = header.lodsOffset + data.lods.size()*sizeof(MeshLod);
+		header.materialsOffset = header.lodIndicesOffset + data.lodIndices.size()*sizeof(uint32_t);
+		header.boundsMin[0] = data.boundsMin.x; header.boundsMin[1] = data.boundsMin.y; header.boundsMin[2] = data.boundsMin.z;
+		header.boundsMax[0] = data.boundsMax.x; header.boundsMax[1] = data.boundsMax.y; header.boundsMax[2] = data.boundsMax.z;
+
+		// Written to a temporary file and renamed, a partially written cache is never loaded
+		const std::string fileName = getCacheFileName(sourceFile);
+		const std::string tempFileName = fileName+".tmp";
+		{
+			std::ofstream file(tempFileName, std::ios::binary);
+			if(!file.is_open())
+			{
+				Log::warning("MeshCache", "Could not create cache file [w]$0[]", fileName);
+				return false;
+			}
+			const char padding[16] = {};
+			file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+			file.write(padding, header.verticesOffset-sizeof(Header));
+			file.write(reinterpret_cast<const char*>(data.vertices.data()), data.vertices.size()*sizeof(Vertex));
+			file.write(padding, header.indicesOffset-(header.verticesOffset+data.vertices.size()*sizeof(Vertex)));
+			file.write(reinterpret_cast<const char*>(data.indices.data()), data.indices.size()*sizeof(uint32_t));
+			file.write(reinterpret_cast<const char*>(data.lods.data()), data.lods.size()*sizeof(MeshLod));
+			file.write(reinterpret_cast<const char*>(data.lodIndices.data()), data.lodIndices.size()*sizeof(uint32_t));
+			for(const std::string& name : data.materialNames)
+			{
+				const uint32_t length = name.size();
+				file.write(reinterpret_cast<const char*>(&length), 4);
+				file.write(name.data(), length);
+			}
+			if(!file.good())
+			{
+				Log::warning("MeshCache", "Could not write cache file [w]$0[]", fileName);
+				file.close();
+				std::remove(tempFileName.c_str());
+				return false;
+			}
+		}
+		if(std::rename(tempFileName.c_str(), fileName.c_str()) != 0)
+		{
+			std::remove(tempFileName.c_str());
+			return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,280 @@
+//--------------------------------------------------
+// Atta Graphics
+// meshOptimizer.cpp
+// Date: 2021-07-16
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/graphics/core/meshOptimizer.h>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace atta
+{
+	void MeshOptimizer::optimize(MeshData& data)
+	{
+		if(data.indices.size() < 3)
+			return;
+		optimizeVertexCache(data.indices, data.vertices.size());
+		optimizeOverdraw(data.indices, data.vertices);
+		optimizeVertexFetch(data.indices, data.vertices);
+	}
+
+	//---------------------------------//
+	//--------- Vertex cache ----------//
+	//---------------------------------//
+	namespace
+	{
+		constexpr unsigned maxValence = 32;// Valence score table size (higher valences use the last value)
+
+		struct ScoreTables
+		{
+			float cache[MeshOptimizer::cacheSize+3];
+			float valence[maxValence];
+
+			ScoreTables()
+			{
+				// https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+				const unsigned size = MeshOptimizer::cacheSize;
+				for(unsigned i=0; i<size+3; i++)
+				{
+					if(i < 3)
+						cache[i] = 0.75f;// Last triangle vertices (fixed to avoid using them in strip order)
+					else if(i < size)
+						cache[i] = std::pow(1.0f - float(i-3)/(size-3), 1.5f);
+					else
+						cache[i] = 0.0f;
+				}
+				valence[0] = 0.0f;
+				for(unsigned i=1; i<maxValence; i++)
+					valence[i] = 2.0f/std::sqrt(float(i));
+			}
+		};
+
+		float vertexScore(const ScoreTables& tables, int cachePosition, unsigned remaining)
+		{
+			if(remaining == 0)
+				return -1.0f;
+			const float cacheScore = cachePosition < 0 ? 0.0f : tables.cache[cachePosition];
+			return cacheScore + tables.valence[std::min(remaining, maxValence-1)];
+		}
+	}
+
+	void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, size_t qtyVertices)
+	{
+		static const ScoreTables tables;
+		const size_t qtyTriangles = indices.size()/3;
+		if(qtyTriangles == 0)
+			return;
+
+		//---------- Vertex -> triangles adjacency ----------//
+		std::vector<uint32_t> remaining(qtyVertices, 0);
+		for(uint32_t i : indices)
+			remaining[i]++;
+		std::vector<uint32_t> offsets(qtyVertices+1, 0);
+		for(size_t v=0; v<qtyVertices; v++)
+			offsets[v+1] = offsets[v] + remaining[v];
+		std::vector<uint32_t> adjacency(indices.size());
+		{
+			std::vector<uint32_t> fill(offsets.begin(), offsets.end()-1);
+			for(size_t t=0; t<qtyTriangles; t++)
+				for(int k=0; k<3; k++)
+					adjacency[fill[indices[3*t+k]]++] = t;
+		}
+
+		std::vector<float> vertexScores(qtyVertices);
+		for(size_t v=0; v<qtyVertices; v++)
+			vertexScores[v] = vertexScore(tables, -1, remaining[v]);
+		std::vector<float> triangleScores(qtyTriangles);
+		for(size_t t=0; t<qtyTriangles; t++)
+			triangleScores[t] = vertexScores[indices[3*t]] + vertexScores[indices[3*t+1]] + vertexScores[indices[3*t+2]];
+		std::vector<bool> emitted(qtyTriangles, false);
+
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+		uint32_t cache[cacheSize+3];
+		unsigned cacheCount = 0;
+		size_t inputCursor = 0;
+
+		// Initial triangle: best score
+		size_t best = std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin();
+		while(true)
+		{
+			//---------- Emit triangle and update the LRU cache ----------//
+			emitted[best] = true;
+			triangleScores[best] = -1.0f;
+			uint32_t newCache[cacheSize+3];
+			unsigned newCount = 0;
+			for(int k=0; k<3; k++)
+			{
+				const uint32_t v = indices[3*best+k];
+				result.push_back(v);
+				if(std::find(newCache, newCache+newCount, v) == newCache+newCount)
+					newCache[newCount++] = v;
+
+				// Remove the triangle from the vertex adjacency
+				uint32_t* begin = adjacency.data()+offsets[v];
+				uint32_t* end = begin+remaining[v];
+				*std::find(begin, end, uint32_t(best)) = end[-1];
+				remaining[v]--;
+			}
+			const unsigned qtyNew = newCount;
+			for(unsigned i=0; i<cacheCount; i++)
+				if(std::find(newCache, newCache+qtyNew, cache[i]) == newCache+qtyNew)
+					newCache[newCount++] = cache[i];
+			cacheCount = std::min(newCount, cacheSize);
+			std::copy(newCache, newCache+cacheCount, cache);
+
+			//---------- Update scores of the vertices that are/were in the cache ----------//
+			for(unsigned i=0; i<newCount; i++)
+			{
+				const uint32_t v = newCache[i];
+				const int position = i < cacheSize ? int(i) : -1;// Pushed out of the cache
+				const float score = vertexScore(tables, position, remaining[v]);
+				const float delta = score - vertexScores[v];
+				vertexScores[v] = score;
+				for(uint32_t j=offsets[v]; j<offsets[v]+remaining[v]; j++)
+					triangleScores[adjacency[j]] += delta;
+			}
+
+			//---------- Next triangle: best triangle using cached vertices ----------//
+			float bestScore = -1.0f;
+			best = qtyTriangles;
+			for(unsigned i=0; i<cacheCount; i++)
+			{
+				const uint32_t v = cache[i];
+				for(uint32_t j=offsets[v]; j<offsets[v]+remaining[v]; j++)
+				{
+					const uint32_t t = adjacency[j];
+					if(triangleScores[t] > bestScore)
+					{
+						bestScore = triangleScores[t];
+						best = t;
+					}
+				}
+			}
+			if(best == qtyTriangles)
+			{
+				// Cache is dead end, continue from the next triangle in input order
+				while(inputCursor < qtyTriangles && emitted[inputCursor])
+					inputCursor++;
+				if(inputCursor == qtyTriangles)
+					break;
+				best = inputCursor;
+			}
+		}
+		indices.swap(result);
+	}
+
+	//---------------------------------//
+	//----------- Overdraw ------------//
+	//---------------------------------//
+	void MeshOptimizer::optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices)
+	{
+		const size_t qtyTriangles = indices.size()/3;
+		if(qtyTriangles == 0)
+			return;
+
+		//---------- Clusters: split where all 3 vertices miss the FIFO cache ----------//
+		// Reordering whole clusters keeps almost the same cache efficiency
+		std::vector<size_t> clusters;
+		{
+			std::vector<uint32_t> timestamps(vertices.size(), 0);
+			uint32_t time = fifoSize+1;
+			for(size_t t=0; t<qtyTriangles; t++)
+			{
+				int misses = 0;
+				for(int k=0; k<3; k++)
+				{
+					const uint32_t v = indices[3*t+k];
+					if(time - timestamps[v] > fifoSize)
+					{
+						timestamps[v] = time++;
+						misses++;
+					}
+				}
+				if(misses == 3 || t == 0)
+					clusters.push_back(t);
+			}
+		}
+		const size_t qtyClusters = clusters.size();
+		clusters.push_back(qtyTriangles);
+		if(qtyClusters < 2)
+			return;
+
+		//---------- Sort clusters, outward facing first (occluders are drawn before what is behind them) ----------//
+		vec3 meshCentroid(0,0,0);
+		for(const Vertex& v : vertices)
+			meshCentroid += v.pos;
+		meshCentroid = meshCentroid/float(vertices.size());
+
+		std::vector<float> sortKeys(qtyClusters);
+		for(size_t c=0; c<qtyClusters; c++)
+		{
+			vec3 centroid(0,0,0);
+			vec3 normal(0,0,0);
+			float area = 0.0f;
+			for(size_t t=clusters[c]; t<clusters[c+1]; t++)
+			{
+				const vec3 p0 = vertices[indices[3*t]].pos;
+				const vec3 p1 = vertices[indices[3*t+1]].pos;
+				const vec3 p2 = vertices[indices[3*t+2]].pos;
+				const vec3 n = atta::cross(p1-p0, p2-p0);// Length is twice the area
+				const float a = n.length();
+				centroid += (p0+p1+p2)*(a/3.0f);
+				normal += n;
+				area += a;
+			}
+			centroid = area > 0.0f ? centroid/area : vertices[indices[3*clusters[c]]].pos;
+			const float normalLength = normal.length();
+			sortKeys[c] = normalLength > 0.0f ? atta::dot(centroid-meshCentroid, normal/normalLength) : 0.0f;
+		}
+
+		std::vector<uint32_t> order(qtyClusters);
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b){ return sortKeys[a] > sortKeys[b]; });
+
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+		for(uint32_t c : order)
+			result.insert(result.end(), indices.begin()+3*clusters[c], indices.begin()+3*clusters[c+1]);
+		indices.swap(result);
+	}
+
+	//---------------------------------//
+	//--------- Vertex fetch ----------//
+	//---------------------------------//
+	void MeshOptimizer::optimizeVertexFetch(std::vector<uint32_t>& indices, std::vector<Vertex>& vertices)
+	{
+		std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+		std::vector<Vertex> result;
+		result.reserve(vertices.size());
+		for(uint32_t& i : indices)
+		{
+			if(remap[i] == UINT32_MAX)
+			{
+				remap[i] = result.size();
+				result.push_back(vertices[i]);
+			}
+			i = remap[i];
+		}
+		// Unused vertices are removed
+		vertices.swap(result);
+	}
+
+	float MeshOptimizer::computeAcmr(const std::vector<uint32_t>& indices, size_t qtyVertices)
+	{
+		if(indices.size() < 3)
+			return 0.0f;
+		std::vector<uint32_t> timestamps(qtyVertices, 0);
+		uint32_t time = fifoSize+1;
+		size_t misses = 0;
+		for(uint32_t v : indices)
+			if(time - timestamps[v] > fifoSize)
+			{
+				timestamps[v] = time++;
+				misses++;
+			}
+		return float(misses)/(indices.size()/3);
+	}
+}
@@ -0,0 +1,323 @@
+//--------------------------------------------------
+// Atta Graphics
+// meshSimplifier.cpp
+// Date: 2021-07-17
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/graphics/core/meshSimplifier.h>
+#include <atta/graphics/core/meshOptimizer.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace atta
+{
+	namespace
+	{
+		// Symmetric 4x4 matrix of the squared distance to a set of planes
+		struct Quadric
+		{
+			double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+			double b0 = 0, b1 = 0, b2 = 0;
+			double c = 0;
+			double weight = 0;
+
+			void addPlane(double nx, double ny, double nz, double d, double w)
+			{
+				a00 += w*nx*nx; a01 += w*nx*ny; a02 += w*nx*nz;
+				a11 += w*ny*ny; a12 += w*ny*nz; a22 += w*nz*nz;
+				b0 += w*nx*d; b1 += w*ny*d; b2 += w*nz*d;
+				c += w*d*d;
+				weight += w;
+			}
+
+			void operator+=(const Quadric& o)
+			{
+				a00 += o.a00; a01 += o.a01; a02 += o.a02;
+				a11 += o.a11; a12 += o.a12; a22 += o.a22;
+				b0 += o.b0; b1 += o.b1; b2 += o.b2;
+				c += o.c;
+				weight += o.weight;
+			}
+
+			// Weighted mean of the squared distances
+			double evaluate(const vec3& p) const
+			{
+				if(weight == 0)
+					return 0;
+				const double x = p.x, y = p.y, z = p.z;
+				const double result = a00*x*x + 2*a01*x*y + 2*a02*x*z + a11*y*y + 2*a12*y*z + a22*z*z +
+					2*(b0*x + b1*y + b2*z) + c;
+				return std::max(result/weight, 0.0);
+			}
+		};
+
+		struct Collapse
+		{
+			uint32_t from;
+			uint32_t to;
+			float cost;
+		};
+
+		constexpr double borderWeight = 10.0;
+	}
+
+	void MeshSimplifier::generateLods(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+			std::vector<MeshLod>& lods, std::vector<uint32_t>& lodIndices)
+	{
+		lods.clear();
+		lodIndices.clear();
+
+		std::vector<uint32_t> current = indices;
+		float error = 0.0f;
+		while(lods.size() < maxLods && current.size()/3 > minTriangles)
+		{
+			float levelError;
+			std::vector<uint32_t> level = simplify(vertices, current, (current.size()/6)*3, levelError);
+			// Stop when most of the mesh is locked (borders), the level would not be worth its memory
+			if(level.size() > current.size()*4/5 || level.empty())
+				break;
+
+			// The error of each level is measured against the previous one
+			error += levelError;
+			MeshOptimizer::optimizeVertexCache(level, vertices.size());
+			lods.push_back({uint32_t(lodIndices.size()), uint32_t(level.size()), error});
+			lodIndices.insert(lodIndices.end(), level.begin(), level.end());
+			current.swap(level);
+		}
+	}
+
+	std::vector<uint32_t> MeshSimplifier::simplify(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+			size_t targetIndexCount, float& error)
+	{
+		const size_t qtyVertices = vertices.size();
+		std::vector<uint32_t> result = indices;
+		error = 0.0f;
+		if(result.size() <= targetIndexCount)
+			return result;
+
+		//---------- Weld vertices with the same position ----------//
+		// position[v] is the first vertex with the same position, wedges holds the vertices of each position
+		std::vector<uint32_t> position(qtyVertices);
+		{
+			struct PosHash
+			{
+				size_t operator()(const vec3& p) const
+				{
+					// +0.0f turns -0.0f into 0.0f (equal positions must have the same hash)
+					const float xyz[3] = { p.x+0.0f, p.y+0.0f, p.z+0.0f };
+					uint32_t bits[3];
+					std::memcpy(bits, xyz, sizeof(bits));
+					return (bits[0]*73856093u) ^ (bits[1]*19349663u) ^ (bits[2]*83492791u);
+				}
+			};
+			struct PosEqual
+			{
+				bool operator()(const vec3& a, const vec3& b) const { return a.x == b.x && a.y == b.y && a.z == b.z; }
+			};
+			std::unordered_map<vec3, uint32_t, PosHash, PosEqual> positions;
+			positions.reserve(qtyVertices);
+			for(uint32_t v=0; v<qtyVertices; v++)
+				position[v] = positions.emplace(vertices[v].pos, v).first->second;
+		}
+		std::vector<uint32_t> wedgeOffsets(qtyVertices+1, 0);
+		std::vector<uint32_t> wedges(qtyVertices);
+		{
+			for(uint32_t v=0; v<qtyVertices; v++)
+				wedgeOffsets[position[v]+1]++;
+			for(size_t v=0; v<qtyVertices; v++)
+				wedgeOffsets[v+1] += wedgeOffsets[v];
+			std::vector<uint32_t> fill(wedgeOffsets.begin(), wedgeOffsets.end()-1);
+			for(uint32_t v=0; v<qtyVertices; v++)
+				wedges[fill[position[v]]++] = v;
+		}
+		// Vertex of position p with the attributes closest to v
+		auto chooseWedge = [&](uint32_t v, uint32_t p)
+		{
+			const Vertex& from = vertices[v];
+			uint32_t best = p;
+			float bestScore = -1e30f;
+			for(uint32_t i=wedgeOffsets[p]; i<wedgeOffsets[p+1]; i++)
+			{
+				const Vertex& to = vertices[wedges[i]];
+				const vec2 dt = to.texCoord-from.texCoord;
+				float score = atta::dot(to.normal, from.normal) - (dt.x*dt.x + dt.y*dt.y);
+				if(to.materialIndex != from.materialIndex)
+					score -= 10.0f;
+				if(score > bestScore)
+				{
+					bestScore = score;
+					best = wedges[i];
+				}
+			}
+			return best;
+		};
+
+		//---------- Quadrics and locked (border) positions ----------//
+		std::vector<Quadric> quadrics(qtyVertices);
+		std::vector<bool> locked(qtyVertices, false);
+		{
+			// Triangles of each edge (the winding is ignored, the generated meshes are not consistent)
+			auto edgeKey = [](uint32_t a, uint32_t b){ return a < b ? (uint64_t(a)<<32) | b : (uint64_t(b)<<32) | a; };
+			std::unordered_map<uint64_t, uint32_t> edges;
+			edges.reserve(result.size());
+			for(size_t i=0; i<result.size(); i++)
+				edges[edgeKey(position[result[i]], position[result[i - i%3 + (i+1)%3]])]++;
+
+			for(size_t t=0; t<result.size()/3; t++)
+			{
+				const uint32_t p[3] = { position[result[3*t]], position[result[3*t+1]], position[result[3*t+2]] };
+				const vec3 p0 = vertices[p[0]].pos;
+				vec3 n = atta::cross(vertices[p[1]].pos-p0, vertices[p[2]].pos-p0);
+				const float length = n.length();
+				if(length == 0.0f)
+					continue;
+				n = n/length;
+				const double d = -atta::dot(n, p0);
+				for(int k=0; k<3; k++)
+					quadrics[p[k]].addPlane(n.x, n.y, n.z, d, 1.0);
+
+				// Border edges: plane perpendicular to the triangle keeps the border in place
+				for(int k=0; k<3; k++)
+				{
+					const uint32_t a = p[k];
+					const uint32_t b = p[(k+1)%3];
+					if(edges[edgeKey(a, b)] != 1)
+						continue;
+					locked[a] = locked[b] = true;
+					const vec3 edge = vertices[b].pos-vertices[a].pos;
+					vec3 bn = atta::cross(edge, n);
+					const float bl = bn.length();
+					if(bl == 0.0f)
+						continue;
+					bn = bn/bl;
+					const double bd = -atta::dot(bn, vertices[a].pos);
+					quadrics[a].addPlane(bn.x, bn.y, bn.z, bd, borderWeight);
+					quadrics[b].addPlane(bn.x, bn.y, bn.z, bd, borderWeight);
+				}
+			}
+		}
+
+		//---------- Collapse passes ----------//
+		// Each pass collapses the cheapest independent edges (no shared neighborhood) until the target is reached
+		std::vector<uint32_t> adjacencyOffsets(qtyVertices+1);
+		std::vector<uint32_t> adjacency;
+		std::vector<bool> dirty(qtyVertices);
+		std::vector<Collapse> collapses;
+		double maxCost = 0.0;
+		while(result.size() > targetIndexCount)
+		{
+			const size_t qtyTriangles = result.size()/3;
+
+			// Position -> triangles
+			std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+			for(uint32_t i : result)
+				adjacencyOffsets[position[i]+1]++;
+			for(size_t v=0; v<qtyVertices; v++)
+				adjacencyOffsets[v+1] += adjacencyOffsets[v];
+			adjacency.resize(result.size());
+			{
+				std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end()-1);
+				for(size_t i=0; i<result.size(); i++)
+					adjacency[fill[position[result[i]]]++] = i/3;
+			}
+
+			// Candidates in both directions
+			collapses.clear();
+			for(size_t t=0; t<qtyTriangles; t++)
+				for(int k=0; k<3; k++)
+				{
+					const uint32_t a = position[result[3*t+k]];
+					const uint32_t b = position[result[3*t+(k+1)%3]];
+					if(a == b)
+						continue;
+					Quadric q = quadrics[a];
+					q += quadrics[b];
+					if(!locked[a])
+						collapses.push_back({a, b, float(q.evaluate(vertices[b].pos))});
+					if(!locked[b])
+						collapses.push_back({b, a, float(q.evaluate(vertices[a].pos))});
+				}
+			if(collapses.empty())
+				break;
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y)
+					{
+						if(x.cost != y.cost) return x.cost < y.cost;
+						if(x.from != y.from) return x.from < y.from;
+						return x.to < y.to;
+					});
+
+			// Apply
+			std::fill(dirty.begin(), dirty.end(), false);
+			size_t removedTriangles = 0;
+			const size_t maxRemoved = qtyTriangles - targetIndexCount/3;
+			for(const Collapse& c : collapses)
+			{
+				if(removedTriangles >= maxRemoved)
+					break;
+				if(dirty[c.from] || dirty[c.to])
+					continue;
+
+				// Reject collapses that flip triangles (or make them degenerate without removing them)
+				bool valid = true;
+				size_t removes = 0;
+				for(uint32_t j=adjacencyOffsets[c.from]; j<adjacencyOffsets[c.from+1] && valid; j++)
+				{
+					const uint32_t t = adjacency[j];
+					uint32_t p[3] = { position[result[3*t]], position[result[3*t+1]], position[result[3*t+2]] };
+					if(p[0] == c.to || p[1] == c.to || p[2] == c.to)
+					{
+						removes++;
+						continue;
+					}
+					const vec3 oldNormal = atta::cross(vertices[p[1]].pos-vertices[p[0]].pos, vertices[p[2]].pos-vertices[p[0]].pos);
+					for(int k=0; k<3; k++)
+						if(p[k] == c.from)
+							p[k] = c.to;
+					const vec3 newNormal = atta::cross(vertices[p[1]].pos-vertices[p[0]].pos, vertices[p[2]].pos-vertices[p[0]].pos);
+					if(atta::dot(oldNormal, newNormal) <= 0.25f*oldNormal.length()*newNormal.length())
+						valid = false;
+				}
+				if(!valid)
+					continue;
+
+				// Collapse, the neighborhood can not change again in this pass
+				for(uint32_t j=adjacencyOffsets[c.from]; j<adjacencyOffsets[c.from+1]; j++)
+				{
+					const uint32_t t = adjacency[j];
+					for(int k=0; k<3; k++)
+					{
+						uint32_t& v = result[3*t+k];
+						dirty[position[v]] = true;
+						if(position[v] == c.from)
+							v = chooseWedge(v, c.to);
+					}
+				}
+				quadrics[c.to] += quadrics[c.from];
+				maxCost = std::max(maxCost, double(c.cost));
+				removedTriangles += removes;
+			}
+			if(removedTriangles == 0)
+				break;
+
+			// Remove degenerate triangles
+			size_t write = 0;
+			for(size_t t=0; t<qtyTriangles; t++)
+			{
+				const uint32_t a = position[result[3*t]];
+				const uint32_t b = position[result[3*t+1]];
+				const uint32_t c = position[result[3*t+2]];
+				if(a == b || b == c || a == c)
+					continue;
+				result[write++] = result[3*t];
+				result[write++] = result[3*t+1];
+				result[write++] = result[3*t+2];
+			}
+			result.resize(write);
+		}
+
+		error = std::sqrt(maxCost);
+		return result;
+	}
+}
@@ -10,9 +10,10 @@
 namespace atta
 {
 	std::map<std::string, std::weak_ptr<Mesh>> Model::allMeshes = {};
+	std::mutex Model::allMeshesMutex;
 
 	Model::Model(CreateInfo info):
-		_meshName(info.meshName), _materialOffset(0)
+		_meshName(info.meshName), _materialOffset(-1)
 	{
 		if(_meshName == "atta::empty")
 		{
@@ -21,18 +22,22 @@ namespace atta
 		}
 
 		//----- Load mesh if necessary -----//
-		if(allMeshes.find(_meshName) != allMeshes.end())// Already loaded to memory
+		// Locked while loading, two threads creating the same mesh share it
+		std::unique_lock<std::mutex> lock(allMeshesMutex);
+		auto loadedMesh = allMeshes.find(_meshName);
+		if(loadedMesh != allMeshes.end() && !loadedMesh->second.expired())// Already loaded to memory
 		{
 			// Get loaded mesh from memory
-			_mesh = allMeshes[_meshName].lock();
+			_mesh = loadedMesh->second.lock();
 		}
-		else// Need to load into memory
+		else// Need to load into memory (or all objects using it were despawned)
 		{
 			// Create mesh
 			_mesh = std::make_shared<Mesh>(_meshName);
 			// Save mesh for future reference if another object uses this mesh
 			allMeshes[_meshName] = _mesh;
 		}
+		lock.unlock();
 
 		//----- Populate model materials -----//
 		if(info.material.type[0] != Material::MATERIAL_TYPE_NONE)
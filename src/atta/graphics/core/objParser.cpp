@@ -0,0 +1,556 @@
+//--------------------------------------------------
+// Atta Graphics
+// objParser.cpp
+// Date: 2021-07-15
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/graphics/core/objParser.h>
+#include <atta/helpers/mappedFile.h>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+
+namespace atta
+{
+	namespace
+	{
+		constexpr size_t minChunkSize = 1<<20;
+
+		bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+		bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+		const char* skipSpaces(const char* p, const char* end)
+		{
+			while(p < end && isSpace(*p)) p++;
+			return p;
+		}
+
+		// Locale independent, returns nullptr if there is no number
+		const char* parseFloat(const char* p, const char* end, float& value)
+		{
+			static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+			p = skipSpaces(p, end);
+			bool negative = false;
+			if(p < end && (*p == '-' || *p == '+'))
+				negative = *p++ == '-';
+
+			uint64_t mantissa = 0;
+			int exponent = 0;
+			int digits = 0;
+			bool any = false;
+			for(; p < end && isDigit(*p); p++, any = true)
+				if(digits < 19)
+				{
+					mantissa = mantissa*10 + (*p-'0');
+					digits += mantissa != 0;
+				}
+				else
+					exponent++;
+			if(p < end && *p == '.')
+				for(p++; p < end && isDigit(*p); p++, any = true)
+					if(digits < 19)
+					{
+						mantissa = mantissa*10 + (*p-'0');
+						digits += mantissa != 0;
+						exponent--;
+					}
+			if(!any)
+				return nullptr;
+			if(p < end && (*p == 'e' || *p == 'E'))
+			{
+				const char* q = p+1;
+				bool negativeExp = false;
+				if(q < end && (*q == '-' || *q == '+'))
+					negativeExp = *q++ == '-';
+				if(q < end && isDigit(*q))
+				{
+					int e = 0;
+					for(; q < end && isDigit(*q); q++)
+						e = std::min(e*10 + (*q-'0'), 10000);
+					exponent += negativeExp ? -e : e;
+					p = q;
+				}
+			}
+
+			double result = double(mantissa);
+			if(exponent < 0)
+				result = exponent >= -22 ? result/powers[-exponent] : result*std::pow(10.0, exponent);
+			else if(exponent > 0)
+				result = exponent <= 22 ? result*powers[exponent] : result*std::pow(10.0, exponent);
+			value = float(negative ? -result : result);
+			return p;
+		}
+
+		const char* parseInt(const char* p, const char* end, int64_t& value)
+		{
+			bool negative = false;
+			if(p < end && (*p == '-' || *p == '+'))
+				negative = *p++ == '-';
+			if(p >= end || !isDigit(*p))
+				return nullptr;
+			value = 0;
+			for(; p < end && isDigit(*p); p++)
+				value = std::min<int64_t>(value*10 + (*p-'0'), INT32_MAX);
+			if(negative)
+				value = -value;
+			return p;
+		}
+
+		bool startsWith(const char* p, const char* end, const char* keyword)
+		{
+			const size_t size = std::strlen(keyword);
+			return size_t(end-p) > size && std::memcmp(p, keyword, size) == 0 && isSpace(p[size]);
+		}
+
+		// Rest of the line without surrounding spaces
+		std::string getArgument(const char* p, const char* end)
+		{
+			p = skipSpaces(p, end);
+			while(end > p && isSpace(end[-1])) end--;
+			return std::string(p, end);
+		}
+	}
+
+	ObjParser::ObjParser(CreateInfo info):
+		_info(info)
+	{
+		_qtyThreads = _info.qtyThreads ? _info.qtyThreads : std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	void ObjParser::runParallel(unsigned qtyTasks, const std::function<void(unsigned)>& task)
+	{
+		// Tasks are taken in order by the threads (the calling thread also works)
+		std::atomic<unsigned> next(0);
+		auto worker = [&]()
+		{
+			for(unsigned i = next++; i < qtyTasks; i = next++)
+				task(i);
+		};
+		std::vector<std::thread> threads;
+		for(unsigned i=1; i<std::min(_qtyThreads, qtyTasks); i++)
+			threads.emplace_back(worker);
+		worker();
+		for(std::thread& t : threads)
+			t.join();
+	}
+
+	uint64_t ObjParser::hash(const Corner& c)
+	{
+		uint64_t a = (uint64_t(uint32_t(c.position)) | uint64_t(uint32_t(c.normal))<<32) * 0x9e3779b97f4a7c15ull;
+		uint64_t b = (uint64_t(uint32_t(c.texCoord)) | uint64_t(uint32_t(c.material))<<32) * 0xc2b2ae3d27d4eb4full;
+		uint64_t h = a ^ (b>>31) ^ (b<<33);
+		h ^= h>>29;
+		h *= 0xbf58476d1ce4e5b9ull;
+		return h ^ (h>>32);
+	}
+
+	//---------------------------------//
+	//------------- Parse -------------//
+	//---------------------------------//
+	void ObjParser::parseChunk(Chunk& chunk, const char* begin, const char* end)
+	{
+		std::unordered_map<std::string, int32_t> materialSlots;
+		std::vector<Corner> face;
+		std::vector<uint8_t> faceRelative;
+		int32_t material = -1;
+
+		// Indices are 1 based, negative indices are relative to the last element (resolved when merging)
+		auto resolve = [](int64_t value, size_t qty, uint8_t flag, uint8_t& relative) -> int32_t
+		{
+			if(value > 0)
+				return int32_t(value-1);
+			relative |= flag;
+			return int32_t(int64_t(qty) + value);
+		};
+
+		for(const char* line = begin; line < end;)
+		{
+			const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', end-line));
+			if(lineEnd == nullptr)
+				lineEnd = end;
+			const char* p = skipSpaces(line, lineEnd);
+			line = lineEnd+1;
+			if(p+1 >= lineEnd)
+				continue;
+
+			if(p[0] == 'v' && isSpace(p[1]))
+			{
+				float v[3] = {0,0,0};
+				p += 2;
+				for(int i=0; i<3 && p; i++)
+					p = parseFloat(p, lineEnd, v[i]);
+				if(p == nullptr)
+				{
+					chunk.error = "Invalid vertex";
+					return;
+				}
+				chunk.positions.insert(chunk.positions.end(), v, v+3);
+			}
+			else if(p+2 < lineEnd && p[0] == 'v' && p[1] == 'n' && isSpace(p[2]))
+			{
+				float v[3] = {0,0,0};
+				p += 3;
+				for(int i=0; i<3 && p; i++)
+					p = parseFloat(p, lineEnd, v[i]);
+				if(p == nullptr)
+				{
+					chunk.error = "Invalid normal";
+					return;
+				}
+				chunk.normals.insert(chunk.normals.end(), v, v+3);
+			}
+			else if(p+2 < lineEnd && p[0] == 'v' && p[1] == 't' && isSpace(p[2]))
+			{
+				float v[2] = {0,0};
+				p += 3;
+				for(int i=0; i<2 && p; i++)
+					p = parseFloat(p, lineEnd, v[i]);
+				if(p == nullptr)
+				{
+					chunk.error = "Invalid texture coordinate";
+					return;
+				}
+				chunk.texCoords.insert(chunk.texCoords.end(), v, v+2);
+			}
+			else if(p[0] == 'f' && isSpace(p[1]))
+			{
+				face.clear();
+				faceRelative.clear();
+				p = skipSpaces(p+2, lineEnd);
+				while(p < lineEnd)
+				{
+					// v, v/vt, v//vn, v/vt/vn
+					Corner c = {noIndex, noIndex, noIndex, material};
+					uint8_t relative = 0;
+					int64_t value;
+					p = parseInt(p, lineEnd, value);
+					if(p == nullptr || value == 0)
+					{
+						chunk.error = "Invalid face";
+						return;
+					}
+					c.position = resolve(value, chunk.positions.size()/3, RELATIVE_POSITION, relative);
+					if(p < lineEnd && *p == '/')
+					{
+						p++;
+						if(p < lineEnd && *p != '/')
+						{
+							p = parseInt(p, lineEnd, value);
+							if(p == nullptr || value == 0)
+							{
+								chunk.error = "Invalid face texture coordinate";
+								return;
+							}
+							c.texCoord = resolve(value, chunk.texCoords.size()/2, RELATIVE_TEX_COORD, relative);
+						}
+						if(p < lineEnd && *p == '/')
+						{
+							p = parseInt(p+1, lineEnd, value);
+							if(p == nullptr || value == 0)
+							{
+								chunk.error = "Invalid face normal";
+								return;
+							}
+							c.normal = resolve(value, chunk.normals.size()/3, RELATIVE_NORMAL, relative);
+						}
+					}
+					face.push_back(c);
+					faceRelative.push_back(relative);
+					p = skipSpaces(p, lineEnd);
+				}
+
+				// Triangle fan
+				for(size_t i=1; i+1<face.size(); i++)
+				{
+					chunk.corners.push_back(face[0]);
+					chunk.corners.push_back(face[i]);
+					chunk.corners.push_back(face[i+1]);
+					chunk.relative.push_back(faceRelative[0]);
+					chunk.relative.push_back(faceRelative[i]);
+					chunk.relative.push_back(faceRelative[i+1]);
+				}
+			}
+			else if(startsWith(p, lineEnd, "usemtl"))
+			{
+				const std::string name = getArgument(p+6, lineEnd);
+				auto it = materialSlots.find(name);
+				if(it == materialSlots.end())
+				{
+					it = materialSlots.emplace(name, int32_t(chunk.materials.size())).first;
+					chunk.materials.push_back(name);
+				}
+				material = it->second;
+				chunk.lastMaterial = material;
+			}
+			else if(startsWith(p, lineEnd, "mtllib"))
+			{
+				// Names separated by spaces
+				const std::string libs = getArgument(p+6, lineEnd);
+				size_t pos = 0;
+				while(pos < libs.size())
+				{
+					size_t next = libs.find_first_of(" \t", pos);
+					if(next == std::string::npos)
+						next = libs.size();
+					if(next > pos)
+						chunk.materialLibs.push_back(libs.substr(pos, next-pos));
+					pos = next+1;
+				}
+			}
+			// Other statements (o, g, s, l, p, ...) are ignored
+		}
+	}
+
+	void ObjParser::loadMaterialNames(const std::vector<std::string>& libs, std::vector<std::string>& names)
+	{
+		const size_t slash = _info.fileName.find_last_of('/');
+		const std::string directory = slash == std::string::npos ? "" : _info.fileName.substr(0, slash+1);
+		for(const std::string& lib : libs)
+		{
+			MappedFile file(directory+lib);
+			if(!file.isValid())
+			{
+				_warning += "Material file "+lib+" not found. ";
+				continue;
+			}
+			const char* text = reinterpret_cast<const char*>(file.getData());
+			const char* end = text+file.getSize();
+			for(const char* line = text; line < end;)
+			{
+				const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', end-line));
+				if(lineEnd == nullptr)
+					lineEnd = end;
+				const char* p = skipSpaces(line, lineEnd);
+				if(startsWith(p, lineEnd, "newmtl"))
+					names.push_back(getArgument(p+6, lineEnd));
+				line = lineEnd+1;
+			}
+		}
+	}
+
+	bool ObjParser::parse(MeshData& data)
+	{
+		data = MeshData();
+		_error.clear();
+		_warning.clear();
+
+		MappedFile file(_info.fileName);
+		if(!file.isValid())
+		{
+			_error = "Could not open file";
+			return false;
+		}
+		const char* text = reinterpret_cast<const char*>(file.getData());
+		const size_t size = file.getSize();
+
+		//---------- Parse chunks ----------//
+		const unsigned qtyChunks = std::max<size_t>(1, std::min<size_t>(_qtyThreads, size/minChunkSize));
+		std::vector<Chunk> chunks(qtyChunks);
+		std::vector<const char*> bounds(qtyChunks+1);
+		bounds[0] = text;
+		bounds[qtyChunks] = text+size;
+		for(unsigned i=1; i<qtyChunks; i++)
+		{
+			// Start after the next line break
+			const char* p = std::max(text+size*i/qtyChunks, bounds[i-1]);
+			const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', text+size-p));
+			bounds[i] = lineEnd ? lineEnd+1 : text+size;
+		}
+		runParallel(qtyChunks, [&](unsigned i){ parseChunk(chunks[i], bounds[i], bounds[i+1]); });
+		for(const Chunk& chunk : chunks)
+			if(!chunk.error.empty())
+			{
+				_error = chunk.error;
+				return false;
+			}
+
+		//---------- Materials ----------//
+		std::vector<std::string> materialLibs;
+		for(const Chunk& chunk : chunks)
+			materialLibs.insert(materialLibs.end(), chunk.materialLibs.begin(), chunk.materialLibs.end());
+		loadMaterialNames(materialLibs, data.materialNames);
+		std::unordered_map<std::string, int32_t> materialIndices;
+		for(size_t i=0; i<data.materialNames.size(); i++)
+			materialIndices.emplace(data.materialNames[i], int32_t(i));
+
+		//---------- Merge offsets ----------//
+		size_t qtyPositions = 0, qtyNormals = 0, qtyTexCoords = 0, qtyCorners = 0;
+		int32_t currentMaterial = -1;
+		for(Chunk& chunk : chunks)
+		{
+			chunk.positionsOffset = qtyPositions;
+			chunk.normalsOffset = qtyNormals;
+			chunk.texCoordsOffset = qtyTexCoords;
+			chunk.cornersOffset = qtyCorners;
+			qtyPositions += chunk.positions.size()/3;
+			qtyNormals += chunk.normals.size()/3;
+			qtyTexCoords += chunk.texCoords.size()/2;
+			qtyCorners += chunk.corners.size();
+
+			// Faces before the first usemtl of the chunk use the last material of the previous chunks
+			chunk.inheritedMaterial = currentMaterial;
+			for(const std::string& name : chunk.materials)
+			{
+				auto it = materialIndices.find(name);
+				chunk.materialMap.push_back(it == materialIndices.end() ? -1 : it->second);
+			}
+			if(chunk.lastMaterial >= 0)
+				currentMaterial = chunk.materialMap[chunk.lastMaterial];
+		}
+		if(qtyCorners > UINT32_MAX)
+		{
+			_error = "Too many vertices";
+			return false;
+		}
+
+		//---------- Resolve indices, gather arrays and partition corners ----------//
+		std::vector<float> positions(qtyPositions*3);
+		std::vector<float> normals(qtyNormals*3);
+		std::vector<float> texCoords(qtyTexCoords*2);
+		std::vector<Corner> corners(qtyCorners);
+		std::vector<uint64_t> hashes(qtyCorners);
+		std::atomic<bool> invalidIndex(false);
+		runParallel(qtyChunks, [&](unsigned i)
+		{
+			Chunk& chunk = chunks[i];
+			std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin()+chunk.positionsOffset*3);
+			std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin()+chunk.normalsOffset*3);
+			std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), texCoords.begin()+chunk.texCoordsOffset*2);
+
+			for(size_t j=0; j<chunk.corners.size(); j++)
+			{
+				Corner c = chunk.corners[j];
+				const uint8_t relative = chunk.relative[j];
+				if(relative & RELATIVE_POSITION) c.position += chunk.positionsOffset;
+				if(relative & RELATIVE_NORMAL) c.normal += chunk.normalsOffset;
+				if(relative & RELATIVE_TEX_COORD) c.texCoord += chunk.texCoordsOffset;
+				c.material = std::max(0, c.material < 0 ? chunk.inheritedMaterial : chunk.materialMap[c.material]);
+
+				if(c.position < 0 || size_t(c.position) >= qtyPositions ||
+						(c.normal != noIndex && (c.normal < 0 || size_t(c.normal) >= qtyNormals)) ||
+						(c.texCoord != noIndex && (c.texCoord < 0 || size_t(c.texCoord) >= qtyTexCoords)))
+				{
+					invalidIndex = true;
+					return;
+				}
+				// Ignored if the file has no normals/texture coordinates (same as tinyobjloader)
+				if(qtyNormals == 0) c.normal = noIndex;
+				if(qtyTexCoords == 0) c.texCoord = noIndex;
+
+				const size_t id = chunk.cornersOffset+j;
+				corners[id] = c;
+				hashes[id] = hash(c);
+				chunk.partitions[hashes[id]>>(64-partitionBits)].push_back(id);
+			}
+			chunk.positions = std::vector<float>();
+			chunk.normals = std::vector<float>();
+			chunk.texCoords = std::vector<float>();
+			chunk.corners = std::vector<Corner>();
+			chunk.relative = std::vector<uint8_t>();
+		});
+		if(invalidIndex)
+		{
+			_error = "Face index out of range";
+			return false;
+		}
+
+		//---------- Deduplicate each partition ----------//
+		struct Entry
+		{
+			Corner key;
+			uint32_t id;// Unique vertex id in the partition + 1 (0 -> empty)
+		};
+		std::vector<uint32_t> cornerVertex(qtyCorners);// Id in the partition
+		std::array<std::vector<uint32_t>, qtyPartitions> uniqueCorners;// First corner of each unique vertex
+		runParallel(qtyPartitions, [&](unsigned p)
+		{
+			size_t count = 0;
+			for(const Chunk& chunk : chunks)
+				count += chunk.partitions[p].size();
+			size_t tableSize = 16;
+			while(tableSize < count*2)
+				tableSize *= 2;
+			const size_t mask = tableSize-1;
+			std::vector<Entry> table(tableSize, Entry{{0,0,0,0}, 0});
+
+			for(const Chunk& chunk : chunks)
+				for(uint32_t id : chunk.partitions[p])
+				{
+					size_t slot = hashes[id] & mask;
+					while(table[slot].id != 0 && !(table[slot].key == corners[id]))
+						slot = (slot+1) & mask;
+					if(table[slot].id == 0)
+					{
+						uniqueCorners[p].push_back(id);
+						table[slot] = {corners[id], uint32_t(uniqueCorners[p].size())};
+					}
+					cornerVertex[id] = table[slot].id-1;
+				}
+		});
+
+		// Number vertices by first use (deterministic, good locality for the index buffer)
+		std::array<size_t, qtyPartitions+1> partitionOffsets;
+		partitionOffsets[0] = 0;
+		for(unsigned p=0; p<qtyPartitions; p++)
+			partitionOffsets[p+1] = partitionOffsets[p] + uniqueCorners[p].size();
+		const size_t qtyVertices = partitionOffsets[qtyPartitions];
+
+		std::vector<uint32_t> remap(qtyVertices, UINT32_MAX);
+		data.indices.resize(qtyCorners);
+		uint32_t nextVertex = 0;
+		for(size_t i=0; i<qtyCorners; i++)
+		{
+			uint32_t& vertex = remap[partitionOffsets[hashes[i]>>(64-partitionBits)] + cornerVertex[i]];
+			if(vertex == UINT32_MAX)
+				vertex = nextVertex++;
+			data.indices[i] = vertex;
+		}
+
+		//---------- Create vertices ----------//
+		data.vertices.resize(qtyVertices);
+		runParallel(qtyPartitions, [&](unsigned p)
+		{
+			for(size_t j=0; j<uniqueCorners[p].size(); j++)
+			{
+				const Corner& c = corners[uniqueCorners[p][j]];
+				Vertex& vertex = data.vertices[remap[partitionOffsets[p]+j]];
+				vertex.pos = vec3(positions[3*c.position], positions[3*c.position+1], positions[3*c.position+2]);
+				vertex.normal = c.normal == noIndex ? vec3(0,0,0) :
+					vec3(normals[3*c.normal], normals[3*c.normal+1], normals[3*c.normal+2]);
+				vertex.texCoord = c.texCoord == noIndex ? vec2(0,0) :
+					vec2(texCoords[2*c.texCoord], 1-texCoords[2*c.texCoord+1]);
+				vertex.materialIndex = c.material;
+			}
+		});
+
+		// If the model did not specify normals, then create smooth normals that conserve the same number of vertices.
+		// Using flat normals would mean creating more vertices than we currently have,
+		// so for simplicity and better visuals we don't do it.
+		// See https://stackoverflow.com/questions/12139840/obj-file-averaging-normals.
+		if(qtyNormals == 0)
+		{
+			std::vector<Vertex>& vertices = data.vertices;
+			const std::vector<uint32_t>& indices = data.indices;
+			for(size_t i = 0; i+2 < indices.size(); i += 3)
+			{
+				const auto normal = atta::normalize(atta::cross(
+					vec3(vertices[indices[i + 1]].pos) - vec3(vertices[indices[i]].pos),
+					vec3(vertices[indices[i + 2]].pos) - vec3(vertices[indices[i]].pos)));
+
+				vertices[indices[i + 0]].normal += normal;
+				vertices[indices[i + 1]].normal += normal;
+				vertices[indices[i + 2]].normal += normal;
+			}
+
+			for(auto& vertex : vertices)
+				vertex.normal = atta::normalize(vertex.normal);
+		}
+
+		data.computeBounds();
+		return true;
+	}
+}
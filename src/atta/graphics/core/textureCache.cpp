@@ -0,0 +1,139 @@
+//--------------------------------------------------
+// Atta Graphics
+// textureCache.cpp
+// Date: 2021-07-18
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/graphics/core/textureCache.h>
+#include <atta/helpers/mappedFile.h>
+#include <atta/helpers/log.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace atta
+{
+	void TextureData::setLayout(Format format_, uint32_t width_, uint32_t height_)
+	{
+		format = format_;
+		width = width_;
+		height = height_;
+		levels.clear();
+		uint64_t offset = 0;
+		uint32_t w = width, h = height;
+		for(uint32_t i=0; i<qtyMipLevels(width, height); i++)
+		{
+			const uint64_t size = levelSize(format, w, h);
+			levels.push_back({w, h, offset, size});
+			offset = (offset+size+15) & ~uint64_t(15);
+			w = std::max(w/2, 1u);
+			h = std::max(h/2, 1u);
+		}
+	}
+
+	uint64_t TextureData::levelSize(Format format, uint32_t width, uint32_t height)
+	{
+		const uint64_t blocks = uint64_t((width+3)/4)*((height+3)/4);
+		switch(format)
+		{
+			case FORMAT_RGBA8_SRGB: return uint64_t(width)*height*4;
+			case FORMAT_BC1_SRGB: return blocks*8;
+			case FORMAT_BC3_SRGB: return blocks*16;
+			case FORMAT_RGBA32F: return uint64_t(width)*height*4*sizeof(float);
+			default: return 0;
+		}
+	}
+
+	uint32_t TextureData::qtyMipLevels(uint32_t width, uint32_t height)
+	{
+		uint32_t levels = 1;
+		while(std::max(width, height) > 1)
+		{
+			width = std::max(width/2, 1u);
+			height = std::max(height/2, 1u);
+			levels++;
+		}
+		return levels;
+	}
+
+	bool TextureCache::load(const std::string& sourceFile, TextureData::Format format, TextureData& data)
+	{
+		MappedFile source(sourceFile);
+		MappedFile cache(getCacheFileName(sourceFile));
+		if(!source.isValid() || !cache.isValid() || cache.getSize() < sizeof(Header))
+			return false;
+
+		Header header;
+		std::memcpy(&header, cache.getData(), sizeof(Header));
+		if(std::memcmp(header.magic, "ATTATEX", 8) != 0 || header.version != version || header.format != format ||
+				header.sourceSize != source.getSize() || header.sourceModificationTime != source.getModificationTime())
+			return false;
+
+		// The level index is recomputed from the dimensions and compared with the stored one
+		data.setLayout(format, header.width, header.height);
+		const size_t indexSize = data.levels.size()*sizeof(TextureData::Level);
+		const size_t dataOffset = (sizeof(Header)+indexSize+15) & ~size_t(15);
+		const uint64_t dataSize = data.levels.back().offset + data.levels.back().size;
+		if(header.qtyLevels != data.levels.size() || dataOffset+dataSize > cache.getSize() ||
+				std::memcmp(cache.getData()+sizeof(Header), data.levels.data(), indexSize) != 0)
+		{
+			Log::warning("TextureCache", "Corrupted cache file [w]$0[], importing again", getCacheFileName(sourceFile));
+			return false;
+		}
+
+		data.data.resize(dataSize);
+		std::memcpy(data.data.data(), cache.getData()+dataOffset, dataSize);
+		return true;
+	}
+
+	bool TextureCache::save(const std::string& sourceFile, const TextureData& data)
+	{
+		MappedFile source(sourceFile);
+		if(!source.isValid() || data.levels.empty())
+			return false;
+
+		Header header{};
+		std::memcpy(header.magic, "ATTATEX", 8);
+		header.version = version;
+		header.format = data.format;
+		header.width = data.width;
+		header.height = data.height;
+		header.qtyLevels = data.levels.size();
+		header.sourceSize = source.getSize();
+		header.sourceModificationTime = source.getModificationTime();
+
+		const size_t indexSize = data.levels.size()*sizeof(TextureData::Level);
+		const size_t dataOffset = (sizeof(Header)+indexSize+15) & ~size_t(15);
+
+		// Written to a temporary file and renamed, a partially written cache is never loaded
+		const std::string fileName = getCacheFileName(sourceFile);
+		const std::string tempFileName = fileName+".tmp";
+		{
+			std::ofstream file(tempFileName, std::ios::binary);
+			if(!file.is_open())
+			{
+				Log::warning("TextureCache", "Could not create cache file [w]$0[]", fileName);
+				return false;
+			}
+			const char padding[16] = {};
+			file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+			file.write(reinterpret_cast<const char*>(data.levels.data()), indexSize);
+			file.write(padding, dataOffset-(sizeof(Header)+indexSize));
+			file.write(reinterpret_cast<const char*>(data.data.data()), data.data.size());
+			if(!file.good())
+			{
+				Log::warning("TextureCache", "Could not write cache file [w]$0[]", fileName);
+				file.close();
+				std::remove(tempFileName.c_str());
+				return false;
+			}
+		}
+		if(std::rename(tempFileName.c_str(), fileName.c_str()) != 0)
+		{
+			std::remove(tempFileName.c_str());
+			return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,409 @@
+//--------------------------------------------------
+// Atta Graphics
+// textureImporter.cpp
+// Date: 2021-07-18
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/graphics/core/textureImporter.h>
+#include <atta/extern/stbImage.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace atta
+{
+	namespace
+	{
+		bool isHdr(const std::string& fileName)
+		{
+			return fileName.find(".hdr") != std::string::npos;
+		}
+
+		//---------- sRGB <-> linear ----------//
+		struct SrgbTables
+		{
+			float toLinear[256];
+			uint8_t toSrgb[4096];// Indexed by linear*4095
+
+			SrgbTables()
+			{
+				for(int i=0; i<256; i++)
+				{
+					const float c = i/255.0f;
+					toLinear[i] = c <= 0.04045f ? c/12.92f : std::pow((c+0.055f)/1.055f, 2.4f);
+				}
+				for(int i=0; i<4096; i++)
+				{
+					const float l = i/4095.0f;
+					const float c = l <= 0.0031308f ? l*12.92f : 1.055f*std::pow(l, 1.0f/2.4f)-0.055f;
+					toSrgb[i] = uint8_t(std::clamp(c*255.0f+0.5f, 0.0f, 255.0f));
+				}
+			}
+		};
+
+		// Box filter, odd dimensions clamp the last texel
+		void downsampleSrgb(const uint8_t* src, uint32_t w, uint32_t h, uint8_t* dst, uint32_t dw, uint32_t dh)
+		{
+			static const SrgbTables tables;
+			for(uint32_t y=0; y<dh; y++)
+				for(uint32_t x=0; x<dw; x++)
+				{
+					const uint32_t x0 = std::min(2*x, w-1), x1 = std::min(2*x+1, w-1);
+					const uint32_t y0 = std::min(2*y, h-1), y1 = std::min(2*y+1, h-1);
+					const uint8_t* p[4] = { src+4*(y0*w+x0), src+4*(y0*w+x1), src+4*(y1*w+x0), src+4*(y1*w+x1) };
+					uint8_t* out = dst+4*(y*dw+x);
+					for(int c=0; c<3; c++)
+					{
+						const float l = (tables.toLinear[p[0][c]] + tables.toLinear[p[1][c]] + tables.toLinear[p[2][c]] + tables.toLinear[p[3][c]])*0.25f;
+						out[c] = tables.toSrgb[int(l*4095.0f+0.5f)];
+					}
+					out[3] = uint8_t((p[0][3] + p[1][3] + p[2][3] + p[3][3] + 2)/4);
+				}
+		}
+
+		void downsampleFloat(const float* src, uint32_t w, uint32_t h, float* dst, uint32_t dw, uint32_t dh)
+		{
+			for(uint32_t y=0; y<dh; y++)
+				for(uint32_t x=0; x<dw; x++)
+				{
+					const uint32_t x0 = std::min(2*x, w-1), x1 = std::min(2*x+1, w-1);
+					const uint32_t y0 = std::min(2*y, h-1), y1 = std::min(2*y+1, h-1);
+					for(int c=0; c<4; c++)
+						dst[4*(y*dw+x)+c] = (src[4*(y0*w+x0)+c] + src[4*(y0*w+x1)+c] + src[4*(y1*w+x0)+c] + src[4*(y1*w+x1)+c])*0.25f;
+				}
+		}
+
+		// Blocks of one level, texels outside the level are clamped
+		template <typename Encode>
+		void encodeLevel(const uint8_t* rgba, uint32_t w, uint32_t h, uint8_t* out, size_t blockSize, Encode encode)
+		{
+			uint8_t texels[64];
+			for(uint32_t by=0; by<(h+3)/4; by++)
+				for(uint32_t bx=0; bx<(w+3)/4; bx++)
+				{
+					for(uint32_t i=0; i<16; i++)
+					{
+						const uint32_t x = std::min(bx*4+i%4, w-1);
+						const uint32_t y = std::min(by*4+i/4, h-1);
+						std::memcpy(texels+4*i, rgba+4*(y*w+x), 4);
+					}
+					encode(texels, out);
+					out += blockSize;
+				}
+		}
+
+		//---------- BC1 color block ----------//
+		uint16_t to565(const float c[3])
+		{
+			const int r = std::clamp(int(c[0]*31.0f/255.0f+0.5f), 0, 31);
+			const int g = std::clamp(int(c[1]*63.0f/255.0f+0.5f), 0, 63);
+			const int b = std::clamp(int(c[2]*31.0f/255.0f+0.5f), 0, 31);
+			return uint16_t((r<<11) | (g<<5) | b);
+		}
+
+		void from565(uint16_t c, int out[3])
+		{
+			const int r = (c>>11)&31, g = (c>>5)&63, b = c&31;
+			out[0] = (r<<3) | (r>>2);
+			out[1] = (g<<2) | (g>>4);
+			out[2] = (b<<3) | (b>>2);
+		}
+
+		// Palette indices of the 16 texels, returns the squared error
+		int selectIndices(const uint8_t rgba[64], uint16_t c0, uint16_t c1, uint32_t& indices)
+		{
+			int palette[4][3];
+			from565(c0, palette[0]);
+			from565(c1, palette[1]);
+			for(int c=0; c<3; c++)
+			{
+				palette[2][c] = (2*palette[0][c] + palette[1][c])/3;
+				palette[3][c] = (palette[0][c] + 2*palette[1][c])/3;
+			}
+			int error = 0;
+			indices = 0;
+			for(int i=0; i<16; i++)
+			{
+				int best = 0, bestDist = INT32_MAX;
+				for(int k=0; k<4; k++)
+				{
+					const int dr = rgba[4*i]-palette[k][0], dg = rgba[4*i+1]-palette[k][1], db = rgba[4*i+2]-palette[k][2];
+					const int dist = dr*dr + dg*dg + db*db;
+					if(dist < bestDist)
+					{
+						bestDist = dist;
+						best = k;
+					}
+				}
+				indices |= uint32_t(best) << (2*i);
+				error += bestDist;
+			}
+			return error;
+		}
+
+		// Always four color mode (c0 > c1), as required by BC3 color blocks
+		void encodeColorBlock(const uint8_t rgba[64], uint8_t block[8])
+		{
+			//---------- Endpoints on the principal axis ----------//
+			float mean[3] = {0, 0, 0};
+			for(int i=0; i<16; i++)
+				for(int c=0; c<3; c++)
+					mean[c] += rgba[4*i+c]/16.0f;
+			float cov[6] = {0, 0, 0, 0, 0, 0};
+			for(int i=0; i<16; i++)
+			{
+				const float r = rgba[4*i]-mean[0], g = rgba[4*i+1]-mean[1], b = rgba[4*i+2]-mean[2];
+				cov[0] += r*r; cov[1] += r*g; cov[2] += r*b;
+				cov[3] += g*g; cov[4] += g*b; cov[5] += b*b;
+			}
+			float axis[3] = {1, 1, 1};
+			for(int it=0; it<8; it++)
+			{
+				const float x = cov[0]*axis[0] + cov[1]*axis[1] + cov[2]*axis[2];
+				const float y = cov[1]*axis[0] + cov[3]*axis[1] + cov[4]*axis[2];
+				const float z = cov[2]*axis[0] + cov[4]*axis[1] + cov[5]*axis[2];
+				const float length = std::max({std::fabs(x), std::fabs(y), std::fabs(z)});
+				if(length == 0.0f)
+					break;
+				axis[0] = x/length; axis[1] = y/length; axis[2] = z/length;
+			}
+			const float axisLength2 = axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2];
+			float tMin = 0.0f, tMax = 0.0f;
+			for(int i=0; i<16; i++)
+			{
+				const float t = ((rgba[4*i]-mean[0])*axis[0] + (rgba[4*i+1]-mean[1])*axis[1] + (rgba[4*i+2]-mean[2])*axis[2])/axisLength2;
+				tMin = std::min(tMin, t);
+				tMax = std::max(tMax, t);
+			}
+			float e0[3], e1[3];
+			for(int c=0; c<3; c++)
+			{
+				e0[c] = std::clamp(mean[c] + axis[c]*tMax, 0.0f, 255.0f);
+				e1[c] = std::clamp(mean[c] + axis[c]*tMin, 0.0f, 255.0f);
+			}
+			uint16_t c0 = to565(e0), c1 = to565(e1);
+			uint32_t indices;
+			int error = selectIndices(rgba, std::max(c0, c1), std::min(c0, c1), indices);
+
+			//---------- Least squares refinement of the endpoints ----------//
+			{
+				const float weights[4] = {1.0f, 0.0f, 2.0f/3.0f, 1.0f/3.0f};// Weight of endpoint 0 for each index
+				float aa = 0, bb = 0, ab = 0, ax[3] = {0, 0, 0}, bx[3] = {0, 0, 0};
+				for(int i=0; i<16; i++)
+				{
+					const float a = weights[(indices>>(2*i))&3], b = 1.0f-a;
+					aa += a*a; bb += b*b; ab += a*b;
+					for(int c=0; c<3; c++)
+					{
+						ax[c] += a*rgba[4*i+c];
+						bx[c] += b*rgba[4*i+c];
+					}
+				}
+				const float det = aa*bb - ab*ab;
+				if(std::fabs(det) > 1e-6f)
+				{
+					float r0[3], r1[3];
+					for(int c=0; c<3; c++)
+					{
+						r0[c] = std::clamp((ax[c]*bb - bx[c]*ab)/det, 0.0f, 255.0f);
+						r1[c] = std::clamp((bx[c]*aa - ax[c]*ab)/det, 0.0f, 255.0f);
+					}
+					const uint16_t rc0 = to565(r0), rc1 = to565(r1);
+					uint32_t refinedIndices;
+					const int refinedError = selectIndices(rgba, std::max(rc0, rc1), std::min(rc0, rc1), refinedIndices);
+					if(refinedError < error)
+					{
+						c0 = rc0; c1 = rc1;
+						indices = refinedIndices;
+						error = refinedError;
+					}
+				}
+			}
+
+			if(c0 < c1)
+				std::swap(c0, c1);
+			if(c0 == c1)
+				indices = 0;// Single color
+
+			block[0] = c0 & 0xFF; block[1] = c0 >> 8;
+			block[2] = c1 & 0xFF; block[3] = c1 >> 8;
+			std::memcpy(block+4, &indices, 4);
+		}
+
+		//---------- BC3 alpha block ----------//
+		void encodeAlphaBlock(const uint8_t rgba[64], uint8_t block[8])
+		{
+			int a0 = 0, a1 = 255;
+			for(int i=0; i<16; i++)
+			{
+				a0 = std::max(a0, int(rgba[4*i+3]));
+				a1 = std::min(a1, int(rgba[4*i+3]));
+			}
+			block[0] = a0;
+			block[1] = a1;
+			uint64_t indices = 0;
+			if(a0 != a1)
+			{
+				// Eight values mode (a0 > a1)
+				int palette[8] = {a0, a1};
+				for(int k=2; k<8; k++)
+					palette[k] = ((8-k)*a0 + (k-1)*a1)/7;
+				for(int i=0; i<16; i++)
+				{
+					int best = 0, bestDist = 256;
+					for(int k=0; k<8; k++)
+					{
+						const int dist = std::abs(rgba[4*i+3]-palette[k]);
+						if(dist < bestDist)
+						{
+							bestDist = dist;
+							best = k;
+						}
+					}
+					indices |= uint64_t(best) << (3*i);
+				}
+			}
+			for(int i=0; i<6; i++)
+				block[2+i] = (indices >> (8*i)) & 0xFF;
+		}
+	}
+
+	void TextureImporter::encodeBC1(const uint8_t rgba[64], uint8_t block[8])
+	{
+		encodeColorBlock(rgba, block);
+	}
+
+	void TextureImporter::encodeBC3(const uint8_t rgba[64], uint8_t block[16])
+	{
+		encodeAlphaBlock(rgba, block);
+		encodeColorBlock(rgba, block+8);
+	}
+
+	bool TextureImporter::readInfo(const std::string& fileName, bool compress, TextureData::Format& format, uint32_t& width, uint32_t& height)
+	{
+		int w, h, channels;
+		if(!stbi_info(fileName.c_str(), &w, &h, &channels))
+			return false;
+		width = w;
+		height = h;
+		if(isHdr(fileName))
+			format = TextureData::FORMAT_RGBA32F;
+		else if(!compress)
+			format = TextureData::FORMAT_RGBA8_SRGB;
+		else
+			format = (channels == 2 || channels == 4) ? TextureData::FORMAT_BC3_SRGB : TextureData::FORMAT_BC1_SRGB;
+		return true;
+	}
+
+	bool TextureImporter::import(const std::string& fileName, bool compress, TextureData& data, std::string& error)
+	{
+		TextureData::Format format;
+		uint32_t width, height;
+		if(!readInfo(fileName, compress, format, width, height))
+		{
+			error = stbi_failure_reason() ? stbi_failure_reason() : "unknown format";
+			return false;
+		}
+		int w, h, channels;
+
+		if(format == TextureData::FORMAT_RGBA32F)
+		{
+			//---------- HDR: float mip chain ----------//
+			float* pixels = stbi_loadf(fileName.c_str(), &w, &h, &channels, STBI_rgb_alpha);
+			if(!pixels)
+			{
+				error = stbi_failure_reason() ? stbi_failure_reason() : "decoding failed";
+				return false;
+			}
+			data.setLayout(format, w, h);
+			data.data.resize(data.levels.back().offset + data.levels.back().size);
+			std::memcpy(data.data.data(), pixels, data.levels[0].size);
+			stbi_image_free(pixels);
+			for(size_t i=1; i<data.levels.size(); i++)
+			{
+				const TextureData::Level& src = data.levels[i-1];
+				const TextureData::Level& dst = data.levels[i];
+				downsampleFloat(reinterpret_cast<const float*>(data.data.data()+src.offset), src.width, src.height,
+						reinterpret_cast<float*>(data.data.data()+dst.offset), dst.width, dst.height);
+			}
+			return true;
+		}
+
+		//---------- LDR: sRGB mip chain ----------//
+		uint8_t* pixels = stbi_load(fileName.c_str(), &w, &h, &channels, STBI_rgb_alpha);
+		if(!pixels)
+		{
+			error = stbi_failure_reason() ? stbi_failure_reason() : "decoding failed";
+			return false;
+		}
+		TextureData rgba;
+		rgba.setLayout(TextureData::FORMAT_RGBA8_SRGB, w, h);
+		rgba.data.resize(rgba.levels.back().offset + rgba.levels.back().size);
+		std::memcpy(rgba.data.data(), pixels, rgba.levels[0].size);
+		stbi_image_free(pixels);
+		for(size_t i=1; i<rgba.levels.size(); i++)
+		{
+			const TextureData::Level& src = rgba.levels[i-1];
+			const TextureData::Level& dst = rgba.levels[i];
+			downsampleSrgb(rgba.data.data()+src.offset, src.width, src.height, rgba.data.data()+dst.offset, dst.width, dst.height);
+		}
+		if(format == TextureData::FORMAT_RGBA8_SRGB)
+		{
+			data = std::move(rgba);
+			return true;
+		}
+
+		//---------- Block compression ----------//
+		data.setLayout(format, w, h);
+		data.data.resize(data.levels.back().offset + data.levels.back().size);
+		for(size_t i=0; i<data.levels.size(); i++)
+		{
+			const TextureData::Level& src = rgba.levels[i];
+			uint8_t* out = data.data.data()+data.levels[i].offset;
+			if(format == TextureData::FORMAT_BC1_SRGB)
+				encodeLevel(rgba.data.data()+src.offset, src.width, src.height, out, 8, encodeBC1);
+			else
+				encodeLevel(rgba.data.data()+src.offset, src.width, src.height, out, 16, encodeBC3);
+		}
+		return true;
+	}
+
+	std::vector<uint8_t> TextureImporter::createPlaceholderTile(TextureData::Format format, uint32_t tileSize, const uint8_t color[4])
+	{
+		std::vector<uint8_t> tile(TextureData::levelSize(format, tileSize, tileSize));
+		std::vector<uint8_t> unit;// Repeated over the tile (one texel or one block)
+		switch(format)
+		{
+			case TextureData::FORMAT_RGBA8_SRGB:
+				unit.assign(color, color+4);
+				break;
+			case TextureData::FORMAT_RGBA32F:
+				{
+					float texel[4];
+					for(int c=0; c<4; c++)
+						texel[c] = color[c]/255.0f;
+					unit.resize(sizeof(texel));
+					std::memcpy(unit.data(), texel, sizeof(texel));
+				}
+				break;
+			case TextureData::FORMAT_BC1_SRGB:
+			case TextureData::FORMAT_BC3_SRGB:
+				{
+					uint8_t texels[64];
+					for(int i=0; i<16; i++)
+						std::memcpy(texels+4*i, color, 4);
+					unit.resize(format == TextureData::FORMAT_BC1_SRGB ? 8 : 16);
+					if(format == TextureData::FORMAT_BC1_SRGB)
+						encodeBC1(texels, unit.data());
+					else
+						encodeBC3(texels, unit.data());
+				}
+				break;
+			default:
+				return {};
+		}
+		for(size_t offset=0; offset+unit.size()<=tile.size(); offset+=unit.size())
+			std::memcpy(tile.data()+offset, unit.data(), unit.size());
+		return tile;
+	}
+}
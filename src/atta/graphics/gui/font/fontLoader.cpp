@@ -5,182 +5,301 @@
 // By Breno Cunha Queiroz
 //--------------------------------------------------
 #include <atta/graphics/gui/font/fontLoader.h>
+#include <atta/graphics/vulkan/stagingBuffer.h>
 #include <atta/helpers/log.h>
-#include <iostream>
+#include <cstring>
 
 namespace guib {
 	FontLoader::FontLoader(std::shared_ptr<atta::vk::Device> device, std::shared_ptr<atta::vk::CommandPool> commandPool, std::string filename):
-		_filename(filename), _baseHeight(13),
+		_glyphAtlas(1024, 1024), _baseHeight(13), _glyphSize(32), _oversample(4), _spread(4), _generation(1), _atlasFullWarned(false), _stop(false),
 		_device(device), _commandPool(commandPool)
 	{
-		FT_Error error;
-
 		// Create instance of FreeType2 library
-		error = FT_Init_FreeType(&_library);
-		if(error)
+		if(FT_Init_FreeType(&_library))
 		{
 			Log::error("FontLoader", "Failed to init FreeType!");
 		}
 
+		addFont(filename);
+
+		// Empty atlas, the glyph regions are uploaded by update()
+		_atlas.width = _glyphAtlas.getWidth();
+		_atlas.height = _glyphAtlas.getHeight();
+		std::vector<uint8_t> data(_atlas.width*_atlas.height);
+		_texture = std::make_shared<atta::vk::Texture>(
+				_device, 
+				_commandPool, 
+				data.data(), 
+				(VkExtent2D){_atlas.width, _atlas.height},
+				atta::Texture::FORMAT_R_UBYTE,
+				true, false);// Editable, no mipmaps
+
+		_thread = std::thread(&FontLoader::generateThread, this);
+
+		// Printable characters of the default font are generated in advance
+		for(unsigned letter=32; letter<127; letter++)
+			request(toKey(0, letter));
+	}
+
+	FontLoader::~FontLoader()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stop = true;
+		}
+		_cv.notify_all();
+		_thread.join();
+
+		// Clear FreeType resources
+		for(auto& font : _fonts)
+			if(font.face)
+				FT_Done_Face(font.face);
+		FT_Done_FreeType(_library);
+	}
+
+	unsigned FontLoader::addFont(std::string filename)
+	{
+		std::lock_guard<std::mutex> lock(_freeTypeMutex);
+		Font font;
+		font.filename = filename;
+
 		// Create face (load font file)
-		error = FT_New_Face(_library, filename.c_str(), 0, &_face);
+		FT_Error error = FT_New_Face(_library, filename.c_str(), 0, &font.face);
 		if(error == FT_Err_Unknown_File_Format)
 		{
 			Log::error("FontLoader", "This font format is unsupported! [w]"+filename);
+			font.face = nullptr;
 		}
-		else if (error)
+		else if(error)
 		{
 			Log::error("FontLoader", "Error when loading font file! [w]"+filename);
+			font.face = nullptr;
 		}
 		else
-		{
 			Log::verbose("FontLoader", "Font file \"$0\" loaded successfully.", filename);
-			//Log::verbose("FontLoader", "Qty glyphs: $0", _face->num_glyphs);
-			//Log::success("FontLoader", "Flags: $0", _face->face_flags);
-		}
 
-		// Set character size
-		error = FT_Set_Pixel_Sizes( _face,// handle to face object
-                            0,  		 // pixel_width
-                            _baseHeight);// pixel_height
-		if(error)
+		// Glyphs are rasterized with oversampling to calculate the distance field
+		if(font.face && FT_Set_Pixel_Sizes(font.face, 0, _glyphSize*_oversample))
 		{
 			Log::error("FontLoader", "Error when setting char size!");
+			FT_Done_Face(font.face);
+			font.face = nullptr;
 		}
 
-		// Create font texture
-		_fontTexture.atlas.width = 1024; _fontTexture.atlas.height = 1024;
-		_fontTexture.padding = 10;
-
-		// Allocate font texture buffer
-		unsigned size = _fontTexture.atlas.width*_fontTexture.atlas.height;
-		_fontTexture.atlas.data = new unsigned char[size];
-		for(int i=0; i<size; i++) 
-			_fontTexture.atlas.data[i] = 0;
+		// Advances are needed for the layout before the glyphs are generated
+		for(unsigned letter=0; letter<256; letter++)
+		{
+			Glyph& glyph = font.glyphs[letter];
+			FT_UInt glyphIndex = font.face ? FT_Get_Char_Index(font.face, letter) : 0;
+			if(glyphIndex == 0 || FT_Load_Glyph(font.face, glyphIndex, FT_LOAD_NO_HINTING | FT_LOAD_NO_AUTOHINT | FT_LOAD_NO_BITMAP))
+			{
+				glyph.state = GLYPH_STATE_EMPTY;
+				continue;
+			}
+			glyph.info.advance = (font.face->glyph->advance.x/64.0f)/_oversample;
+		}
 
-		loadGlyphs();
-		//testFontTerminal("test");
-		
-		// Load texture
-		_texture = std::make_shared<atta::vk::Texture>(
-				_device, 
-				_commandPool, 
-				_fontTexture.atlas.data, 
-				(VkExtent2D){_fontTexture.atlas.width, _fontTexture.atlas.height},
-				atta::Texture::FORMAT_R_UBYTE);
+		_fonts.push_back(std::move(font));
+		return _fonts.size()-1;
+	}
 
-		// Clear FreeType resources
-		FT_Done_Face(_face);
-		FT_Done_FreeType(_library);
+	const GlyphInfo& FontLoader::getGlyph(unsigned char letter, unsigned font)
+	{
+		Glyph& glyph = _fonts[font].glyphs[letter];
+		if(glyph.state == GLYPH_STATE_NOT_REQUESTED)
+			request(toKey(font, letter));
+		else if(glyph.state == GLYPH_STATE_GENERATED)
+		{
+			if(glyph.info.resident)
+				_glyphAtlas.use(glyph.shelf, _generation);
+			else if(!glyph.toPack)
+			{
+				glyph.toPack = true;
+				_toPack.push_back(toKey(font, letter));
+			}
+		}
+		return glyph.info;
 	}
 
-	FontLoader::~FontLoader()
+	float FontLoader::getAdvance(unsigned char letter, float textSize, unsigned font) const
 	{
-		delete _fontTexture.atlas.data;
+		return _fonts[font].glyphs[letter].info.advance*textSize/_glyphSize;
 	}
 
-	void FontLoader::loadGlyphs()
+	void FontLoader::request(uint32_t key)
 	{
-    	FT_Int32 flags = FT_LOAD_RENDER | FT_LOAD_NO_HINTING | FT_LOAD_NO_AUTOHINT;
-		FT_Error error;
+		Glyph& glyph = _fonts[key>>8].glyphs[key&0xFF];
+		if(glyph.state != GLYPH_STATE_NOT_REQUESTED)
+			return;
+		glyph.state = GLYPH_STATE_GENERATING;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_requests.push_back(key);
+		}
+		_cv.notify_one();
+	}
 
-		// Region in atlas to copy
-		unsigned int currX = 0;
-		unsigned int currY = 0;
-		unsigned int maxY = 0;// Maximum y in the last line of caracters
+	//----------------------------------------//
+	//------------ Atlas update --------------//
+	//----------------------------------------//
+	bool FontLoader::update()
+	{
+		std::vector<GeneratedGlyph> generated;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			generated.swap(_generated);
+		}
 
-		// Try to load all characters
-		for(unsigned char i = 0; i<255; i++)
+		for(auto& generatedGlyph : generated)
 		{
-			// Load current character
-			int glyphIndex = FT_Get_Char_Index(_face, i);
-			if(glyphIndex == 0)// Check if there is this character in the font
+			Glyph& glyph = _fonts[generatedGlyph.key>>8].glyphs[generatedGlyph.key&0xFF];
+			if(generatedGlyph.sdf.empty())
+			{
+				// Nothing to draw or failed to load, keep the advance loaded with the font
+				glyph.state = GLYPH_STATE_EMPTY;
 				continue;
-
-			error = FT_Load_Glyph(_face, glyphIndex, flags);
-			if(error)
+			}
+			glyph.info = generatedGlyph.info;
+			glyph.sdf = std::move(generatedGlyph.sdf);
+			glyph.state = GLYPH_STATE_GENERATED;
+			if(!glyph.toPack)
 			{
-				Log::warning("FontLoader", "Error loading glyph: '"+std::to_string(i)+"'!");
-				return;
+				glyph.toPack = true;
+				_toPack.push_back(generatedGlyph.key);
 			}
+		}
 
-			// Get glyph info
-			FT_GlyphSlot slot = _face->glyph;
-			FT_Bitmap bitmap = slot->bitmap;
-			int glyphTop  = slot->bitmap_top;
-			int glyphLeft  = slot->bitmap_left;
-			int glyphAdvance  = slot->advance.x;
+		if(_toPack.empty())
+			return false;
 
-			// Check possible atlas region
-			if(currX+bitmap.width>=_fontTexture.atlas.width)
-			{
-				currX = 0;
-				currY = maxY;
-
-				if(currY+bitmap.rows>_fontTexture.atlas.height)
-				{
-					Log::error("FontLoader", "Not enough space to fill font atlas glyph!");
-					exit(1);
-				}
-			}
+		std::vector<uint8_t> upload;
+		std::vector<VkBufferImageCopy> regions;
+		for(uint32_t key : _toPack)
+		{
+			_fonts[key>>8].glyphs[key&0xFF].toPack = false;
+			packGlyph(key, upload, regions);
+		}
+		_toPack.clear();
+		if(regions.empty())
+			return false;
+
+		// Only the new glyph regions are copied, the rest of the atlas is kept
+		atta::vk::StagingBuffer stagingBuffer(_device, upload.data(), upload.size());
+		_texture->lock();
+		_texture->updateRegions(_commandPool, stagingBuffer.handle(), regions);
+		_texture->unlock();
+		return true;
+	}
 
-			// Copy from bitmap to atlas
-    		unsigned char *srcPtr = bitmap.buffer;
-    		unsigned char *dstPtr = _fontTexture.atlas.data + (currY*_fontTexture.atlas.width + currX);
-			for(int j=0;j<bitmap.rows;j++)
+	void FontLoader::packGlyph(uint32_t key, std::vector<uint8_t>& upload, std::vector<VkBufferImageCopy>& regions)
+	{
+		Glyph& glyph = _fonts[key>>8].glyphs[key&0xFF];
+		if(glyph.state != GLYPH_STATE_GENERATED || glyph.info.resident)
+			return;
+
+		// One empty texel around the distance field, the linear filter never reads other glyphs
+		const unsigned sdfWidth = glyph.info.width;
+		const unsigned sdfHeight = glyph.info.height;
+		const unsigned width = sdfWidth+2;
+		const unsigned height = sdfHeight+2;
+
+		GlyphAtlas::Region region;
+		std::vector<uint32_t> evicted;
+		if(!_glyphAtlas.allocate(key, width, height, _generation, region, evicted))
+		{
+			// Requested again in the next frames, warn only once
+			if(!_atlasFullWarned)
+				Log::warning("FontLoader", "Glyph atlas is full, some glyphs will not be rendered");
+			_atlasFullWarned = true;
+			return;
+		}
+		for(uint32_t evictedKey : evicted)
+			_fonts[evictedKey>>8].glyphs[evictedKey&0xFF].info.resident = false;
+
+		glyph.info.x = region.x+1;
+		glyph.info.y = region.y+1;
+		glyph.info.resident = true;
+		glyph.shelf = region.shelf;
+
+		// Buffer offsets aligned to 4 bytes
+		const size_t offset = (upload.size()+3) & ~size_t(3);
+		upload.resize(offset+width*height, 0);
+		for(unsigned y=0; y<sdfHeight; y++)
+			std::memcpy(&upload[offset+(y+1)*width+1], &glyph.sdf[y*sdfWidth], sdfWidth);
+
+		VkBufferImageCopy copy{};
+		copy.bufferOffset = offset;
+		copy.bufferRowLength = 0;
+		copy.bufferImageHeight = 0;
+		copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		copy.imageSubresource.mipLevel = 0;
+		copy.imageSubresource.baseArrayLayer = 0;
+		copy.imageSubresource.layerCount = 1;
+		copy.imageOffset = {int32_t(region.x), int32_t(region.y), 0};
+		copy.imageExtent = {width, height, 1};
+		regions.push_back(copy);
+	}
+
+	//----------------------------------------//
+	//---------- Glyph generation ------------//
+	//----------------------------------------//
+	void FontLoader::generateThread()
+	{
+		while(true)
+		{
+			GeneratedGlyph glyph;
 			{
-				memcpy(dstPtr, srcPtr, bitmap.width);
-				dstPtr += _fontTexture.atlas.width;
-				srcPtr += bitmap.pitch;
+				std::unique_lock<std::mutex> lock(_mutex);
+				_cv.wait(lock, [this](){ return _stop || !_requests.empty(); });
+				if(_stop)
+					return;
+				glyph.key = _requests.front();
+				_requests.pop_front();
 			}
 
-			// Save glyph info
-			_fontTexture.glyphsInfo[i] = {
-				.width = bitmap.width,
-				.height = bitmap.rows,
-				.x =	currX,
-				.y =	currY,
-				.left =	glyphLeft,
-				.top =	glyphTop,
-				.advance = (glyphAdvance>>6),
-			};
-			//Log::debug("FontLoader", "Letter: $0 wh($1,$2), xy($3,$4) lt($5,$6) ad $7", char(i), 
-			//		_fontTexture.glyphsInfo[i].width, _fontTexture.glyphsInfo[i].height, 
-			//		_fontTexture.glyphsInfo[i].x, _fontTexture.glyphsInfo[i].y, 
-			//		_fontTexture.glyphsInfo[i].left, _fontTexture.glyphsInfo[i].top, 
-			//		_fontTexture.glyphsInfo[i].advance);
-
-			// Move currX currY
-			currX += bitmap.width+_fontTexture.padding;
-			maxY = std::max(maxY, currY+bitmap.rows+_fontTexture.padding);
+			generateGlyph(glyph);
 
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_generated.push_back(std::move(glyph));
+			}
 		}
 	}
 
-	void FontLoader::testFontTerminal(std::string text)
+	void FontLoader::generateGlyph(GeneratedGlyph& glyph)
 	{
-		for(auto letter : text)
+		const unsigned char letter = glyph.key&0xFF;
+		std::vector<uint8_t> coverage;
+		int width, height, left, top;
 		{
-			GlyphInfo gInfo = _fontTexture.glyphsInfo[letter];
-
-			unsigned w = _fontTexture.atlas.width;
-			unsigned h = _fontTexture.atlas.height;
-    		unsigned char *ptr = _fontTexture.atlas.data+int(gInfo.x)+int(gInfo.y*w);
-			for(int i=0; i<gInfo.height; i++)
+			std::lock_guard<std::mutex> lock(_freeTypeMutex);
+			FT_Face face = _fonts[glyph.key>>8].face;
+			if(FT_Load_Glyph(face, FT_Get_Char_Index(face, letter), FT_LOAD_RENDER | FT_LOAD_NO_HINTING | FT_LOAD_NO_AUTOHINT))
 			{
-				for(int j=0; j<gInfo.width;j++)
-				{
-					char c = 'o';
-					if(ptr[j]==0)
-						c = ' ';
-					else if(ptr[j]<=127)
-						c = '*';
-					std::cout << c;
-				}
-				ptr+=w;
-				std::cout << std::endl;
+				Log::warning("FontLoader", "Error loading glyph: '"+std::to_string(letter)+"'!");
+				return;
 			}
-			std::cout << std::endl;
+
+			FT_GlyphSlot slot = face->glyph;
+			FT_Bitmap& bitmap = slot->bitmap;
+			glyph.info.advance = (slot->advance.x/64.0f)/_oversample;
+			width = bitmap.width;
+			height = bitmap.rows;
+			left = slot->bitmap_left;
+			top = slot->bitmap_top;
+			coverage.resize(width*height);
+			for(int y=0; y<height; y++)
+				std::memcpy(&coverage[y*width], bitmap.buffer+y*bitmap.pitch, width);
 		}
+
+		if(width == 0 || height == 0)
+			return;// Nothing to draw (space)
+
+		int sdfWidth, sdfHeight;
+		GlyphAtlas::generateSdf(coverage.data(), width, height, width, _oversample, _spread, glyph.sdf, sdfWidth, sdfHeight);
+		glyph.info.width = sdfWidth;
+		glyph.info.height = sdfHeight;
+		glyph.info.left = left/float(_oversample)-_spread;
+		glyph.info.top = top/float(_oversample)+_spread;
 	}
 }
@@ -0,0 +1,169 @@
+//--------------------------------------------------
+// GuiB
+// glyphAtlas.cpp
+// Date: 2021-07-23
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/graphics/gui/font/glyphAtlas.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace guib {
+	GlyphAtlas::GlyphAtlas(unsigned width, unsigned height):
+		_width(width), _height(height), _nextShelfY(0)
+	{
+	}
+
+	bool GlyphAtlas::allocate(uint32_t key, unsigned width, unsigned height, unsigned generation, Region& region, std::vector<uint32_t>& evicted)
+	{
+		if(width > _width || height > _height)
+			return false;
+
+		// Best fit shelf with space
+		int best = -1;
+		for(size_t i=0; i<_shelves.size(); i++)
+			if(_shelves[i].height >= height && _shelves[i].x+width <= _width &&
+					(best == -1 || _shelves[i].height < _shelves[best].height))
+				best = i;
+
+		// Shelves are 4 pixel multiples to be reused by glyphs with similar height
+		const unsigned shelfHeight = std::min((height+3) & ~3u, _height);
+		if((best == -1 || _shelves[best].height > shelfHeight*3/2) && _nextShelfY+shelfHeight <= _height)
+		{
+			_shelves.push_back({_nextShelfY, shelfHeight, 0, generation, {}});
+			_nextShelfY += shelfHeight;
+			best = _shelves.size()-1;
+		}
+
+		// Evict the least recently used shelf
+		if(best == -1)
+		{
+			for(size_t i=0; i<_shelves.size(); i++)
+				if(_shelves[i].height >= height && _shelves[i].lastUse < generation &&
+						(best == -1 || _shelves[i].lastUse < _shelves[best].lastUse))
+					best = i;
+			if(best == -1)
+				return false;
+
+			Shelf& shelf = _shelves[best];
+			evicted.insert(evicted.end(), shelf.keys.begin(), shelf.keys.end());
+			shelf.keys.clear();
+			shelf.x = 0;
+		}
+
+		Shelf& shelf = _shelves[best];
+		region = {shelf.x, shelf.y, unsigned(best)};
+		shelf.x += width;
+		shelf.lastUse = std::max(shelf.lastUse, generation);
+		shelf.keys.push_back(key);
+		return true;
+	}
+
+	void GlyphAtlas::use(unsigned shelf, unsigned generation)
+	{
+		_shelves[shelf].lastUse = std::max(_shelves[shelf].lastUse, generation);
+	}
+
+	//---------------------------------------------//
+	//------------ Signed distance field ----------//
+	//---------------------------------------------//
+	// Squared euclidean distance transform of a sampled function (Felzenszwalb and Huttenlocher)
+	static void distanceTransform1D(const float* f, float* d, int n, int* v, float* z)
+	{
+		int k = 0;
+		v[0] = 0;
+		z[0] = -std::numeric_limits<float>::infinity();
+		z[1] = std::numeric_limits<float>::infinity();
+		for(int q=1; q<n; q++)
+		{
+			float s = ((f[q]+q*q)-(f[v[k]]+v[k]*v[k]))/(2*q-2*v[k]);
+			while(s <= z[k])
+			{
+				k--;
+				s = ((f[q]+q*q)-(f[v[k]]+v[k]*v[k]))/(2*q-2*v[k]);
+			}
+			k++;
+			v[k] = q;
+			z[k] = s;
+			z[k+1] = std::numeric_limits<float>::infinity();
+		}
+
+		k = 0;
+		for(int q=0; q<n; q++)
+		{
+			while(z[k+1] < q)
+				k++;
+			d[q] = (q-v[k])*(q-v[k])+f[v[k]];
+		}
+	}
+
+	static void distanceTransform2D(std::vector<float>& grid, int width, int height)
+	{
+		const int n = std::max(width, height);
+		std::vector<float> f(n), d(n), z(n+1);
+		std::vector<int> v(n);
+
+		for(int x=0; x<width; x++)
+		{
+			for(int y=0; y<height; y++)
+				f[y] = grid[y*width+x];
+			distanceTransform1D(f.data(), d.data(), height, v.data(), z.data());
+			for(int y=0; y<height; y++)
+				grid[y*width+x] = d[y];
+		}
+
+		for(int y=0; y<height; y++)
+		{
+			distanceTransform1D(&grid[y*width], d.data(), width, v.data(), z.data());
+			std::copy(d.begin(), d.begin()+width, grid.begin()+y*width);
+		}
+	}
+
+	void GlyphAtlas::generateSdf(const uint8_t* coverage, int width, int height, int pitch, int oversample, int spread,
+			std::vector<uint8_t>& sdf, int& sdfWidth, int& sdfHeight)
+	{
+		// Oversampled grid with border, multiple of oversample
+		sdfWidth = (width+oversample-1)/oversample+2*spread;
+		sdfHeight = (height+oversample-1)/oversample+2*spread;
+		const int border = spread*oversample;
+		const int gridWidth = sdfWidth*oversample;
+		const int gridHeight = sdfHeight*oversample;
+
+		// Squared distances to the closest inside/outside texel
+		const float inf = 1e20f;
+		std::vector<float> toInside(gridWidth*gridHeight, inf);
+		std::vector<float> toOutside(gridWidth*gridHeight, 0.0f);
+		for(int y=0; y<height; y++)
+			for(int x=0; x<width; x++)
+				if(coverage[y*pitch+x] >= 128)
+				{
+					const int i = (y+border)*gridWidth+x+border;
+					toInside[i] = 0.0f;
+					toOutside[i] = inf;
+				}
+		distanceTransform2D(toInside, gridWidth, gridHeight);
+		distanceTransform2D(toOutside, gridWidth, gridHeight);
+
+		// Average of the oversampled signed distances (the edge is half texel from the texel centers)
+		sdf.resize(sdfWidth*sdfHeight);
+		const float scale = 1.0f/(oversample*oversample);
+		for(int y=0; y<sdfHeight; y++)
+			for(int x=0; x<sdfWidth; x++)
+			{
+				float distance = 0.0f;
+				for(int j=0; j<oversample; j++)
+					for(int i=0; i<oversample; i++)
+					{
+						const int index = (y*oversample+j)*gridWidth+x*oversample+i;
+						if(toOutside[index] > 0.0f)
+							distance += std::sqrt(toOutside[index])-0.5f;// Inside
+						else
+							distance -= std::sqrt(toInside[index])-0.5f;// Outside
+					}
+				distance *= scale/oversample;// Output texels
+				const float value = 0.5f+0.5f*distance/spread;
+				sdf[y*sdfWidth+x] = uint8_t(std::clamp(value, 0.0f, 1.0f)*255.0f+0.5f);
+			}
+	}
+}
@@ -0,0 +1,76 @@
+//--------------------------------------------------
+// Guib
+// guiBatch.cpp
+// Date: 2021-07-20
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/graphics/gui/guiBatch.h>
+#include <algorithm>
+#include <cstring>
+
+namespace guib
+{
+	GuiBatch::GuiBatch(std::shared_ptr<atta::vk::Device> device):
+		_device(device), _version(1)
+	{
+		_nonUniformIndexing = _device->getPhysicalDevice()->getSupport().sampledImageNonUniformIndexingFeature;
+		_quads.reserve(1024);
+	}
+
+	GuiBatch::~GuiBatch()
+	{
+		for(auto& frame : _frames)
+			if(frame.buffer)
+				frame.buffer->unmapMemory();
+	}
+
+	void GuiBatch::clear()
+	{
+		_quads.clear();
+		_version++;
+	}
+
+	void GuiBatch::flush(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+	{
+		if(_quads.empty())
+			return;
+
+		// The buffer of this swapchain image is not being used by the GPU (its command buffer is being recorded)
+		if(frameIndex >= _frames.size())
+			_frames.resize(frameIndex+1);
+		FrameBuffer& frame = _frames[frameIndex];
+		if(_quads.size() > frame.capacity)
+		{
+			if(frame.buffer)
+				frame.buffer->unmapMemory();
+			frame.capacity = std::max(_quads.size(), 2*frame.capacity);
+			frame.buffer = std::make_shared<atta::vk::Buffer>(_device, frame.capacity*sizeof(GuiObjectInfo),
+					VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			frame.data = frame.buffer->mapMemory(0, frame.capacity*sizeof(GuiObjectInfo));
+			frame.version = 0;
+		}
+		if(frame.version != _version)
+		{
+			std::memcpy(frame.data, _quads.data(), _quads.size()*sizeof(GuiObjectInfo));
+			frame.version = _version;
+		}
+
+		VkBuffer vertexBuffers[] = {frame.buffer->handle()};
+		VkDeviceSize offsets[] = {0};
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+		if(_nonUniformIndexing)
+		{
+			vkCmdDraw(commandBuffer, 6, static_cast<uint32_t>(_quads.size()), 0, 0);
+			return;
+		}
+
+		// The texture index must be the same for all instances of a draw
+		uint32_t first = 0;
+		for(uint32_t i=1; i<=_quads.size(); i++)
+			if(i == _quads.size() || _quads[i].textureIndex != _quads[first].textureIndex)
+			{
+				vkCmdDraw(commandBuffer, 6, i-first, 0, first);
+				first = i;
+			}
+	}
+}
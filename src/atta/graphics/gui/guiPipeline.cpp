@@ -6,6 +6,7 @@
 //--------------------------------------------------
 #include <atta/graphics/gui/guiPipeline.h>
 #include <atta/graphics/gui/guiVertex.h>
+#include <atta/graphics/gui/guiStructs.h>
 #include <atta/graphics/gui/guiState.h>
 #include <atta/helpers/log.h>
 
@@ -47,7 +48,11 @@ namespace atta
 
 		//---------- Shaders ----------//
 		_vertShaderModule = std::make_shared<vk::ShaderModule>(_device, "/usr/include/atta/assets/shaders/gui/guiShader.vert.spv");
-		_fragShaderModule = std::make_shared<vk::ShaderModule>(_device, "/usr/include/atta/assets/shaders/gui/guiShader.frag.spv");
+		// Without non uniform indexing the batch draws one texture per draw (see guib::GuiBatch)
+		if(_device->getPhysicalDevice()->getSupport().sampledImageNonUniformIndexingFeature)
+			_fragShaderModule = std::make_shared<vk::ShaderModule>(_device, "/usr/include/atta/assets/shaders/gui/guiShader.frag.spv");
+		else
+			_fragShaderModule = std::make_shared<vk::ShaderModule>(_device, "/usr/include/atta/assets/shaders/gui/guiShaderUniform.frag.spv");
 
 		// Vert shader
 		VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
@@ -66,16 +71,16 @@ namespace atta
 		VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
 
 		//---------- Fixed functions ----------//
-		// Vertex input
-		auto bindingDescription = GuiVertex::getBindingDescription();
-		auto attributeDescriptions = GuiVertex::getAttributeDescriptions();
+		// Vertex input (one instance per quad, the quad vertices are generated in the vertex shader)
+		auto bindingDescription = GuiObjectInfo::getBindingDescription();
+		auto attributeDescriptions = GuiObjectInfo::getAttributeDescriptions();
 
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertexInputInfo.vertexBindingDescriptionCount = 0;
-		//vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-		vertexInputInfo.vertexAttributeDescriptionCount = 0;//static_cast<uint32_t>(attributeDescriptions.size());
-		//vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+		vertexInputInfo.vertexBindingDescriptionCount = 1;
+		vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+		vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
 		// Input assembly
 		VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
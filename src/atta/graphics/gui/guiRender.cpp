@@ -11,13 +11,14 @@
 
 namespace guib
 {
-	GuiRender::GuiRender(VkExtent2D imageExtent, std::shared_ptr<atta::GuiPipelineLayout> pipelineLayout, GLFWwindow* glfwWindow, std::shared_ptr<guib::FontLoader> fontLoader):
-		_imageExtent(imageExtent), _pipelineLayout(pipelineLayout), _glfwWindow(glfwWindow),
-		_root(nullptr)
+	GuiRender::GuiRender(std::shared_ptr<atta::vk::Device> device, VkExtent2D imageExtent, std::shared_ptr<atta::GuiPipelineLayout> pipelineLayout, GLFWwindow* glfwWindow, std::shared_ptr<guib::FontLoader> fontLoader):
+		_pipelineLayout(pipelineLayout), _batch(device), _quadsVersion(0), _quadsFocusedWidget(nullptr),
+		_indexVersion(0), _imageExtent(imageExtent), _glfwWindow(glfwWindow), _root(nullptr)
 	{
 		state::guiRender = this;
 		state::screenSize = {imageExtent.width, imageExtent.height};
 		state::fontLoader = fontLoader.get();
+		state::invalidate();
 
 		//---------- GLFW setup ----------//
 		_cursor = glfwCreateStandardCursor(GLFW_ARROW_CURSOR);
@@ -33,6 +34,7 @@ namespace guib
 	{
 		_root = root;
 		root->treePreProcess();
+		state::invalidate();
 	}
 
 	void GuiRender::setWindowWidgets(std::vector<guib::Window*> windows)
@@ -40,28 +42,64 @@ namespace guib
 		_windows = windows; 
 		for(auto window : _windows)
 			window->treePreProcess();
+		state::invalidate();
 	}
 
-	void GuiRender::render(VkCommandBuffer commandBuffer)//, guib::Widget* root, std::vector<guib::Window*> windows)
+	void GuiRender::render(VkCommandBuffer commandBuffer, uint32_t frameIndex)
 	{
-		_commandBuffer = commandBuffer;// Widgets access this commandBuffer when necessary (box, text, ...)
+		_commandBuffer = commandBuffer;
 
-		// Render from root
-		if(_root!=nullptr)
-			_root->render();
+		// New glyphs in the font atlas -> render the text again
+		if(state::fontLoader->update())
+			state::invalidate();
 
-		// Render each window
-		for(auto& window : _windows)
-			window->render();
-
-		// Render focused widget (menus, popups, ...)
-		if(state::focusedWidget != nullptr)
+		// Nothing changed -> draw the same quads (the instance buffers are not even copied)
+		if(_quadsVersion != state::version || _quadsFocusedWidget != state::focusedWidget)
 		{
-			float buttonRenderDepth = state::renderDepth;
-			state::renderDepth = 0.1;// Focus render depth
-			state::focusedWidget->render();
-			state::renderDepth = buttonRenderDepth;
+			_batch.clear();// Widgets add their quads to the batch (box, text, ...)
+			state::fontLoader->beginGlyphUse();
+
+			// Render from root
+			if(_root!=nullptr)
+				_root->render();
+
+			// Render each window
+			for(auto& window : _windows)
+				window->render();
+
+			// Render focused widget (menus, popups, ...)
+			if(state::focusedWidget != nullptr)
+			{
+				float buttonRenderDepth = state::renderDepth;
+				state::renderDepth = 0.1;// Focus render depth
+				state::focusedWidget->render();
+				state::renderDepth = buttonRenderDepth;
+			}
+
+			_quadsVersion = state::version;
+			_quadsFocusedWidget = state::focusedWidget;
 		}
+
+		_batch.flush(_commandBuffer, frameIndex);
+	}
+
+	void GuiRender::updateSpatialIndex()
+	{
+		if(_indexVersion == state::version)
+			return;
+		_indexVersion = state::version;
+
+		_clickIndex.clear();
+		for(auto& clickArea : state::clickableAreas)
+			_clickIndex.insert(clickArea.offset, clickArea.size);
+
+		_dragIndex.clear();
+		for(auto draggable : state::draggables)
+			_dragIndex.insert(draggable->getWidgetToHover()->getOffset(), draggable->getWidgetToHover()->getSize());
+
+		_scrollIndex.clear();
+		for(auto scrollable : state::scrollables)
+			_scrollIndex.insert(scrollable->getOffset(), scrollable->getSize());
 	}
 
 	//----------------------------------------//
@@ -71,6 +109,7 @@ namespace guib
 	{
 		_imageExtent = { width, height };
 		state::screenSize = {width, height};
+		state::invalidate();
 	}
 
 	void GuiRender::onKey(int key, int scancode, int action, int mods)
@@ -127,23 +166,18 @@ namespace guib
 		else
 		{
 			//---------- Change cursor hover clickArea ----------//
-			for(int i=(int)state::clickableAreas.size()-1; i>=0; i--)
+			updateSpatialIndex();
+			int i = _clickIndex.find(state::cursorPos);
+			if(i >= 0)
 			{
 				guib::ClickDetectorArea &clickArea = state::clickableAreas[i];
-				if(state::cursorPos.x>=clickArea.offset.x &&
-					state::cursorPos.y>=clickArea.offset.y &&
-					state::cursorPos.x<=clickArea.offset.x+clickArea.size.width &&
-					state::cursorPos.y<=clickArea.offset.y+clickArea.size.height)
+				state::currClickArea.first = clickArea;
+				state::currClickArea.second = true;
+				if(!clickArea.clickDetector->getHovering())
 				{
-					state::currClickArea.first = clickArea;
-					state::currClickArea.second = true;
-					if(!clickArea.clickDetector->getHovering());
-					{
-						clickArea.clickDetector->setHovering(true);
-						if(clickArea.clickDetector->getOnHover())
-							clickArea.clickDetector->getOnHover()();
-					}
-					break;
+					clickArea.clickDetector->setHovering(true);
+					if(clickArea.clickDetector->getOnHover())
+						clickArea.clickDetector->getOnHover()();
 				}
 			}
 		}
@@ -158,20 +192,9 @@ namespace guib
 		//---------- Check hovering draggable area ----------//
 		{
 			// Check draggable
-			guib::Draggable* draggable = nullptr;
-			for(int i=(int)state::draggables.size()-1; i>=0; i--)
-			{
-				guib::Offset dragOffset = state::draggables[i]->getWidgetToHover()->getOffset();
-				guib::Size dragSize = state::draggables[i]->getWidgetToHover()->getSize();
-				if(state::cursorPos.x>=dragOffset.x &&
-					state::cursorPos.y>=dragOffset.y &&
-					state::cursorPos.x<=dragOffset.x+dragSize.width &&
-					state::cursorPos.y<=dragOffset.y+dragSize.height)
-				{
-					draggable = state::draggables[i];
-					break;
-				}
-			}
+			updateSpatialIndex();
+			int i = _dragIndex.find(state::cursorPos);
+			guib::Draggable* draggable = i>=0 ? state::draggables[i] : nullptr;
 
 			if(draggable != nullptr && draggable->getActive())
 			{
@@ -231,36 +254,29 @@ namespace guib
 		else
 		{
 			//---------- Search for click in click detector ----------//
-			for(int i=(int)state::clickableAreas.size()-1; i>=0; i--)
+			updateSpatialIndex();
+			int i = _clickIndex.find(state::cursorPos);
+			if(i >= 0)
 			{
-				guib::ClickDetectorArea clickArea = state::clickableAreas[i];
-				if(state::cursorPos.x>=clickArea.offset.x &&
-					state::cursorPos.y>=clickArea.offset.y &&
-					state::cursorPos.x<=clickArea.offset.x+clickArea.size.width &&
-					state::cursorPos.y<=clickArea.offset.y+clickArea.size.height)
-				{
-					// Found click in click detector
-					state::currClickArea.first = clickArea;
-					state::currClickArea.second = true;
+				// Found click in click detector
+				state::currClickArea.first = state::clickableAreas[i];
+				state::currClickArea.second = true;
 
-					// First click
-					if(action == GLFW_PRESS)
+				// First click
+				if(action == GLFW_PRESS)
+				{
+					if(button == GLFW_MOUSE_BUTTON_LEFT)
 					{
-						if(button == GLFW_MOUSE_BUTTON_LEFT)
-						{
-							state::currClickArea.first.clickDetector->setClicking(true);
-							if(state::currClickArea.first.clickDetector->getOnClick())
-								state::currClickArea.first.clickDetector->getOnClick()();
-						}
-						else if(button == GLFW_MOUSE_BUTTON_RIGHT)
-						{
-							state::currClickArea.first.clickDetector->setRightClicking(true);
-							if(state::currClickArea.first.clickDetector->getOnRightClick())
-								state::currClickArea.first.clickDetector->getOnRightClick()();
-						}
+						state::currClickArea.first.clickDetector->setClicking(true);
+						if(state::currClickArea.first.clickDetector->getOnClick())
+							state::currClickArea.first.clickDetector->getOnClick()();
+					}
+					else if(button == GLFW_MOUSE_BUTTON_RIGHT)
+					{
+						state::currClickArea.first.clickDetector->setRightClicking(true);
+						if(state::currClickArea.first.clickDetector->getOnRightClick())
+							state::currClickArea.first.clickDetector->getOnRightClick()();
 					}
-
-					break;
 				}
 			}
 		}
@@ -287,20 +303,9 @@ namespace guib
 			if(action == GLFW_PRESS)
 			{
 				// Check if some draggable was pressed
-				guib::Draggable* draggable = nullptr;
-				for(int i=(int)state::draggables.size()-1; i>=0; i--)
-				{
-					guib::Offset dragOffset = state::draggables[i]->getWidgetToHover()->getOffset();
-					guib::Size dragSize = state::draggables[i]->getWidgetToHover()->getSize();
-					if(state::cursorPos.x>=dragOffset.x &&
-						state::cursorPos.y>=dragOffset.y &&
-						state::cursorPos.x<=dragOffset.x+dragSize.width &&
-						state::cursorPos.y<=dragOffset.y+dragSize.height)
-					{
-						draggable = state::draggables[i];
-						break;
-					}
-				}
+				updateSpatialIndex();
+				int i = _dragIndex.find(state::cursorPos);
+				guib::Draggable* draggable = i>=0 ? state::draggables[i] : nullptr;
 
 				if(draggable != nullptr && draggable->getActive())
 				{
@@ -317,7 +322,10 @@ namespace guib
 
 	void GuiRender::onScroll(double xoffset, double yoffset)
 	{
-
+		updateSpatialIndex();
+		int i = _scrollIndex.find(state::cursorPos);
+		if(i >= 0)
+			state::scrollables[i]->scroll(-3*yoffset);
 	}
 
 	void GuiRender::updateCursor(CursorType cursorType)
@@ -0,0 +1,62 @@
+//--------------------------------------------------
+// Guib
+// guiSpatialIndex.cpp
+// Date: 2021-07-21
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/graphics/gui/guiSpatialIndex.h>
+#include <algorithm>
+
+namespace guib
+{
+	GuiSpatialIndex::GuiSpatialIndex(unsigned gridSize):
+		_gridSize(std::max(gridSize, 1u))
+	{
+		_cells.resize(_gridSize*_gridSize);
+	}
+
+	void GuiSpatialIndex::clear()
+	{
+		_areas.clear();
+		for(auto& cell : _cells)
+			cell.clear();
+	}
+
+	void GuiSpatialIndex::insert(Offset offset, Size size)
+	{
+		const unsigned index = _areas.size();
+		_areas.push_back({offset, size});
+
+		const unsigned x0 = cellCoord(offset.x);
+		const unsigned y0 = cellCoord(offset.y);
+		const unsigned x1 = cellCoord(offset.x+size.width);
+		const unsigned y1 = cellCoord(offset.y+size.height);
+		for(unsigned y=y0; y<=y1; y++)
+			for(unsigned x=x0; x<=x1; x++)
+				_cells[y*_gridSize+x].push_back(index);
+	}
+
+	int GuiSpatialIndex::find(Offset point) const
+	{
+		const std::vector<unsigned>& cell = _cells[cellCoord(point.y)*_gridSize+cellCoord(point.x)];
+		for(int i=(int)cell.size()-1; i>=0; i--)
+		{
+			const Area& area = _areas[cell[i]];
+			if(point.x>=area.offset.x &&
+				point.y>=area.offset.y &&
+				point.x<=area.offset.x+area.size.width &&
+				point.y<=area.offset.y+area.size.height)
+				return cell[i];
+		}
+		return -1;
+	}
+
+	unsigned GuiSpatialIndex::cellCoord(float value) const
+	{
+		if(!(value > 0.0f))// Also handles NaN
+			return 0;
+		if(value >= 1.0f)
+			return _gridSize-1;
+		return std::min(unsigned(value*_gridSize), _gridSize-1);
+	}
+}
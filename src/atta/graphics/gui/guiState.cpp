@@ -22,6 +22,10 @@ namespace guib::state
 	float renderDepth = 0.99;
 	guib::Widget* focusedWidget = nullptr;// Last one to render to apply right transparency 
 
+	//---------- GuiB retained rendering ----------//
+	unsigned version = 0;
+	void invalidate() { version++; }
+
 	//---------- GuiB special widget handler ----------//
 	// Handling ClickDetector
 	std::vector<ClickDetectorArea> clickableAreas;
@@ -30,6 +34,8 @@ namespace guib::state
 	std::vector<guib::Draggable*> draggables;
 	Draggable* currDragging = nullptr;
 	Offset lastDraggingCursorPos;
+	// Handling scroll (ListView)
+	std::vector<guib::ListView*> scrollables;
 
 	//---------- GuiB font render ----------//
 	FontLoader* fontLoader;
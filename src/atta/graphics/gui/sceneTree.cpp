@@ -0,0 +1,185 @@
+//--------------------------------------------------
+// Robot Simulator
+// sceneTree.cpp
+// Date: 2021-07-22
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/graphics/gui/sceneTree.h>
+#include <algorithm>
+#include <numeric>
+#include <cctype>
+
+namespace atta
+{
+	static std::string toLower(std::string str)
+	{
+		std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c){ return std::tolower(c); });
+		return str;
+	}
+
+	SceneTree::SceneTree(std::shared_ptr<Scene> scene):
+		_scene(scene), _searchPos(0), _sceneVersion(0)
+	{
+		rebuild();
+	}
+
+	void SceneTree::rebuild()
+	{
+		_sceneVersion = _scene->getVersion();
+		_objectsFlat = _scene->getObjectsFlat();
+		_names.resize(_objectsFlat.size());
+		_objectIndex.clear();
+		for(size_t i=0; i<_objectsFlat.size(); i++)
+		{
+			_names[i] = toLower(_objectsFlat[i]->getName());
+			_objectIndex[_objectsFlat[i].get()] = i;
+		}
+
+		_children.assign(_objectsFlat.size(), {});
+		for(size_t i=0; i<_objectsFlat.size(); i++)
+			for(auto& child : _objectsFlat[i]->getChildren())
+				_children[i].push_back(_objectIndex[child.get()]);
+
+		// Keep expanded objects that still exist
+		std::unordered_set<Object*> expanded;
+		for(auto& object : _objectsFlat)
+			if(_expanded.find(object.get()) != _expanded.end())
+				expanded.insert(object.get());
+		_expanded = expanded;
+
+		_rows.clear();
+		for(auto& root : _scene->getObjects())
+		{
+			size_t index = _objectIndex[root.get()];
+			_rows.push_back({index, 0});
+			addChildrenRows(index, 1, _rows);
+		}
+
+		if(_selected && _objectIndex.find(_selected.get()) == _objectIndex.end())
+			_selected = nullptr;
+
+		// Restart the search
+		std::string filter = _filter;
+		_filter.clear();
+		setFilter(filter);
+	}
+
+	void SceneTree::setFilter(std::string filter)
+	{
+		filter = toLower(filter);
+		if(filter == _filter)
+			return;
+
+		if(filter.empty())
+		{
+			_searchSource.clear();
+			_matches.clear();
+		}
+		else if(!_filter.empty() && filter.find(_filter) != std::string::npos)
+		{
+			// Narrowing: only the previous matches and the objects not checked yet can match
+			std::vector<size_t> source = _matches;
+			source.insert(source.end(), _searchSource.begin()+_searchPos, _searchSource.end());
+			_searchSource = std::move(source);
+		}
+		else
+		{
+			_searchSource.resize(_objectsFlat.size());
+			std::iota(_searchSource.begin(), _searchSource.end(), 0);
+		}
+
+		_filter = filter;
+		_searchPos = 0;
+		_matches.clear();
+	}
+
+	bool SceneTree::update(size_t maxObjects)
+	{
+		// Objects spawned/despawned
+		bool changed = false;
+		if(_scene->getVersion() != _sceneVersion)
+		{
+			rebuild();
+			changed = true;
+		}
+
+		if(!isSearching())
+			return changed;
+
+		const size_t qtyMatches = _matches.size();
+		const size_t end = std::min(_searchSource.size(), _searchPos+maxObjects);
+		for(; _searchPos<end; _searchPos++)
+		{
+			size_t object = _searchSource[_searchPos];
+			if(_names[object].find(_filter) != std::string::npos)
+				_matches.push_back(object);
+		}
+		return changed || _matches.size() != qtyMatches;
+	}
+
+	size_t SceneTree::getQtyRows() const
+	{
+		return _filter.empty() ? _rows.size() : _matches.size();
+	}
+
+	size_t SceneTree::getObjectIndex(size_t row) const
+	{
+		return _filter.empty() ? _rows[row].object : _matches[row];
+	}
+
+	guib::ListViewRow SceneTree::getRow(size_t row) const
+	{
+		guib::ListViewRow rowInfo;
+		size_t object = getObjectIndex(row);
+		rowInfo.text = _objectsFlat[object]->getName();
+		rowInfo.selected = _objectsFlat[object] == _selected;
+		if(_filter.empty())
+		{
+			rowInfo.depth = _rows[row].depth;
+			rowInfo.hasChildren = !_children[object].empty();
+			rowInfo.expanded = _expanded.find(_objectsFlat[object].get()) != _expanded.end();
+		}
+		return rowInfo;
+	}
+
+	void SceneTree::toggle(size_t row)
+	{
+		if(!_filter.empty() || row >= _rows.size())
+			return;
+
+		const Row parent = _rows[row];
+		if(_expanded.erase(_objectsFlat[parent.object].get()))
+		{
+			// Collapse: remove the descendant rows
+			size_t end = row+1;
+			while(end < _rows.size() && _rows[end].depth > parent.depth)
+				end++;
+			_rows.erase(_rows.begin()+row+1, _rows.begin()+end);
+		}
+		else if(!_children[parent.object].empty())
+		{
+			// Expand: insert the child rows (and the rows of the children that were expanded)
+			_expanded.insert(_objectsFlat[parent.object].get());
+			std::vector<Row> rows;
+			addChildrenRows(parent.object, parent.depth+1, rows);
+			_rows.insert(_rows.begin()+row+1, rows.begin(), rows.end());
+		}
+	}
+
+	void SceneTree::select(size_t row)
+	{
+		if(row < getQtyRows())
+			_selected = _objectsFlat[getObjectIndex(row)];
+	}
+
+	void SceneTree::addChildrenRows(size_t object, unsigned depth, std::vector<Row>& rows) const
+	{
+		if(_expanded.find(_objectsFlat[object].get()) == _expanded.end())
+			return;
+		for(size_t child : _children[object])
+		{
+			rows.push_back({child, depth});
+			addChildrenRows(child, depth+1, rows);
+		}
+	}
+}
@@ -8,6 +8,8 @@
 #include <atta/graphics/gui/guiState.h>
 #include <atta/helpers/log.h>
 #include <atta/graphics/vulkan/imageMemoryBarrier.h>
+#include <cstdio>
+#include <cctype>
 
 namespace atta
 {
@@ -18,7 +20,8 @@ namespace atta
 		_swapChain(info.swapChain),
 		// Toggle variables
 		_rootWidget(nullptr),
-		_shouldClose(false)
+		_shouldClose(false),
+		_sceneTreeView(nullptr), _sceneTreeSearchText(nullptr)
 	{
 		//---------- Create gui objects ----------//
 		_guiCommandPool = std::make_shared<vk::CommandPool>(_device, vk::CommandPool::DEVICE_QUEUE_FAMILY_GRAPHICS, vk::CommandPool::QUEUE_GUI, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
@@ -38,11 +41,13 @@ namespace atta
 		createTextures();
 		_guiPipeline = std::make_shared<GuiPipeline>(_device, _window, _swapChain, _guiUniformBuffer, _fontLoader);
 		_guiRender = std::make_shared<guib::GuiRender>(
+				_device,
 				(VkExtent2D){_window->getWidth(),_window->getHeight()}, 
 				_guiPipeline->getPipelineLayout(), 
 				_window->handle(), 
 				_fontLoader);
 
+		_sceneTree = std::make_shared<SceneTree>(_scene);
 		createWidgetTree();
 	}
 
@@ -53,6 +58,31 @@ namespace atta
 
 	void UserInterface::createWidgetTree()
 	{
+		//---------- Scene tree/inspector ----------//
+		// Only the visible scene tree rows are rendered (the scene can have many objects)
+		const int inspectorLineHeight = 16;
+		const int qtyInspectorLines = 8;
+		_sceneTreeSearchText = new guib::Text({.color = {1,1,1,1}, .text = "Search: ", .textSize = 10});
+		_sceneTreeView = new guib::ListView({
+				.color = guib::state::palette["lightDark"],
+				.selectColor = guib::state::palette["bright"],
+				.getQtyRows = [this](){ return _sceneTree->getQtyRows(); },
+				.getRow = [this](size_t row){ return _sceneTree->getRow(row); },
+				.onClickRow = [this](size_t row){ _sceneTree->select(row); _lastInspectorUpdate = {}; },
+				.onToggleRow = [this](size_t row){ _sceneTree->toggle(row); _sceneTreeView->refresh(); },
+				.size = {1, guib::state::screenSize.height-26-20-3-qtyInspectorLines*inspectorLineHeight-3, guib::UNIT_PERCENT, guib::UNIT_PIXEL},
+			});
+		std::vector<guib::Widget*> inspectorRows;
+		for(int i=0; i<qtyInspectorLines; i++)
+		{
+			_inspectorTexts.push_back(new guib::Text({.color = {1,1,1,1}, .text = "", .textSize = 10}));
+			inspectorRows.push_back(new guib::Box({
+					.color = guib::state::palette["lightDark"],
+					.size = {1, inspectorLineHeight, guib::UNIT_PERCENT, guib::UNIT_PIXEL},
+					.child = _inspectorTexts.back()
+				}));
+		}
+
 		_rootWidget = 
 			new guib::Column(
 			{
@@ -180,12 +210,22 @@ namespace atta
 									}),
 								}),
 								new guib::Box({.color = guib::state::palette["background"], .size={3,1,guib::UNIT_PIXEL,guib::UNIT_PERCENT}}),
-								// Left scene tree
+								// Right scene tree and inspector
 								new guib::Box({
 										.color = guib::state::palette["background"],
 										.size={250,1,guib::UNIT_PIXEL,guib::UNIT_PERCENT},
 										.child = new guib::Column({
-
+											.children = {
+												new guib::Box({
+													.color = guib::state::palette["lightDark"],
+													.size = {1, 20, guib::UNIT_PERCENT, guib::UNIT_PIXEL},
+													.child = _sceneTreeSearchText
+												}),
+												new guib::Box({.color = guib::state::palette["background"], .size={1,3,guib::UNIT_PERCENT,guib::UNIT_PIXEL}}),
+												_sceneTreeView,
+												new guib::Box({.color = guib::state::palette["background"], .size={1,3,guib::UNIT_PERCENT,guib::UNIT_PIXEL}}),
+												new guib::Column({.children = inspectorRows}),
+											}
 										}),
 								}),
 								new guib::Box({.color = guib::state::palette["background"], .size={3,1,guib::UNIT_PIXEL,guib::UNIT_PERCENT}}),
@@ -195,27 +235,6 @@ namespace atta
 				}
 			}); 
 
-		std::vector<guib::Widget*> sceneTreeWidgets;
-		for(auto object : _scene->getObjects())
-		{
-			sceneTreeWidgets.push_back(
-				new guib::Button(
-				{
-					.onClick = [&](){
-					},
-					.size = {1, 20, guib::UNIT_PERCENT, guib::UNIT_PIXEL},
-					.child = new guib::Padding({
-						.child = new guib::Text(
-						{
-							.color = {1,1,1,1},
-							.text = object->getName(),
-							.textSize = 10
-						})
-					})
-				})
-			);
-		}
-
 		//_windows.push_back(
 		//	new guib::Window(
 		//	{
@@ -277,7 +296,7 @@ namespace atta
 		VkCommandBuffer commandBuffer = _guiCommandBuffers->begin(0);
 		{
 			_guiPipeline->beginRender(commandBuffer, imageIndex);
-			_guiRender->render(commandBuffer);
+			_guiRender->render(commandBuffer, imageIndex);
 			_guiPipeline->endRender(commandBuffer);
 		}
 		_guiCommandBuffers->end(0);
@@ -293,15 +312,68 @@ namespace atta
 					guib::state::screenSize.height-26-22-3);
 			firstResize = false;
 		}
+		updateSceneTree();
 
 		_renderers.begin()->second->render(commandBuffer);
 
 		copyRendererImage(commandBuffer, imageIndex, _renderers.begin()->first, {35+2*3,26+22});
 		_guiPipeline->beginRender(commandBuffer, imageIndex);
-		_guiRender->render(commandBuffer);
+		_guiRender->render(commandBuffer, imageIndex);
 		_guiPipeline->endRender(commandBuffer);
 	}
 
+	void UserInterface::updateSceneTree()
+	{
+		// Limited number of objects checked per frame, large scenes do not block the gui thread
+		if(_sceneTree->update())
+			_sceneTreeView->refresh();
+
+		// The inspector values are sampled at 10Hz (the texts only invalidate the gui if they changed)
+		auto now = std::chrono::steady_clock::now();
+		if(now-_lastInspectorUpdate >= std::chrono::milliseconds(100))
+		{
+			_lastInspectorUpdate = now;
+			updateInspector();
+		}
+	}
+
+	void UserInterface::updateInspector()
+	{
+		auto toString = [](vec3 v) {
+			char str[64];
+			snprintf(str, sizeof(str), "%.3f %.3f %.3f", v.x, v.y, v.z);
+			return std::string(str);
+		};
+
+		std::vector<std::string> lines(_inspectorTexts.size());
+		std::shared_ptr<Object> object = _sceneTree->getSelected();
+		if(object)
+		{
+			quat q = object->getOrientation();
+			char orientation[64];
+			snprintf(orientation, sizeof(orientation), "%.3f %.3f %.3f %.3f", q.r, q.i, q.j, q.k);
+			lines = {
+				"Name: "+object->getName(),
+				"Type: "+object->getType(),
+				"Position: "+toString(object->getPosition()),
+				"Orientation: "+std::string(orientation),
+				"Scale: "+toString(object->getScale()),
+			};
+			std::shared_ptr<phy::Body> body = object->getBodyPhysics();
+			if(body)
+			{
+				lines.push_back("Velocity: "+toString(body->getVelocity()));
+				lines.push_back("Mass: "+(body->getInverseMass()<=0 ? std::string("infinite") : std::to_string(body->getMass())));
+				lines.push_back(std::string("Awake: ")+(body->getIsAwake()?"true":"false"));
+			}
+		}
+		else
+			lines[0] = "No object selected";
+
+		for(size_t i=0; i<_inspectorTexts.size(); i++)
+			_inspectorTexts[i]->setText(i<lines.size() ? lines[i] : "");
+	}
+
 	void UserInterface::copyRendererImage(VkCommandBuffer commandBuffer, int imageIndex, std::string rendererName, VkOffset2D dstOffset)
 	{
 		VkImageSubresourceRange subresourceRange;
@@ -358,6 +430,35 @@ namespace atta
 	void UserInterface::onKey(int key, int scancode, int action, int mods)
 	{
 		_guiRender->onKey(key, scancode, action, mods);
+
+		//---------- Scene tree search ----------//
+		// Typing while the cursor is over the scene tree changes the filter
+		guib::Offset treeOffset = _sceneTreeView->getOffset();
+		guib::Size treeSize = _sceneTreeView->getSize();
+		if((action == GLFW_PRESS || action == GLFW_REPEAT) &&
+			guib::state::cursorPos.x>=treeOffset.x &&
+			guib::state::cursorPos.y>=treeOffset.y &&
+			guib::state::cursorPos.x<=treeOffset.x+treeSize.width &&
+			guib::state::cursorPos.y<=treeOffset.y+treeSize.height)
+		{
+			std::string filter = _sceneTree->getFilter();
+			if((key >= GLFW_KEY_A && key <= GLFW_KEY_Z) || (key >= GLFW_KEY_0 && key <= GLFW_KEY_9) || key == GLFW_KEY_SPACE)
+				filter += (char)std::tolower(key);
+			else if(key == GLFW_KEY_MINUS)
+				filter += (mods & GLFW_MOD_SHIFT) ? '_' : '-';
+			else if(key == GLFW_KEY_BACKSPACE && !filter.empty())
+				filter.pop_back();
+			else
+				return;
+
+			_sceneTree->setFilter(filter);
+			{
+				std::lock_guard<std::mutex> lock(_scene->getMutex());
+				_sceneTree->update();
+			}
+			_sceneTreeSearchText->setText("Search: "+filter);
+			_sceneTreeView->refresh();
+		}
 	}
 
 	void UserInterface::onCursorPosition(double xpos, double ypos)
@@ -37,15 +37,7 @@ namespace guib
 
 		//Log::debug("Box", "Render [w]$0[] with [w]$1 []--[w] $2 and radius:$3", _type, _size.toString(), _offset.toString(), objectInfo.radius);
 
-		vkCmdPushConstants(
-				state::guiRender->getCommandBuffer(),
-				state::guiRender->getPipelineLayout()->handle(),
-				VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-				0,
-				sizeof(GuiObjectInfo),
-				&objectInfo);
-
-		vkCmdDraw(state::guiRender->getCommandBuffer(), 6, 1, 0, 0);
+		state::guiRender->addQuad(objectInfo);
 
 		if(_child)
 			_child->render();
@@ -8,6 +8,7 @@
 #include <atta/graphics/gui/widgets/widgets.h>
 #include <atta/graphics/gui/guiState.h>
 #include <atta/graphics/gui/font/fontLoader.h>
+#include <cmath>
 
 namespace guib
 {
@@ -38,18 +39,18 @@ namespace guib
 
 	Size ButtonText::calculateButtonSize(std::string text)
 	{
-		unsigned textWidth = 0;
+		float textWidth = 0;
 		unsigned textSize = state::fontLoader->getBaseHeight();
 		_paddingH = 10;
 		_paddingV = 3;
 		size_t i=0;
-		for(auto letter : text)
+		for(unsigned char letter : text)
 		{
-			textWidth += state::fontLoader->getFontTexture().glyphsInfo[(size_t)letter].advance;
+			textWidth += state::fontLoader->getAdvance(letter, textSize);
 			i++;
 		}
 
-		return {textWidth+_paddingH*2,textSize+_paddingV*2, UNIT_PIXEL, UNIT_PIXEL};
+		return {std::ceil(textWidth)+_paddingH*2,textSize+_paddingV*2, UNIT_PIXEL, UNIT_PIXEL};
 	}
 }
 
@@ -0,0 +1,153 @@
+//--------------------------------------------------
+// GuiB
+// listView.cpp
+// Date: 2021-07-22
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/graphics/gui/widgets/listView.h>
+#include <atta/graphics/gui/widgets/clickDetector.h>
+#include <atta/graphics/gui/widgets/text.h>
+#include <atta/graphics/gui/guiStructs.h>
+#include <atta/graphics/gui/guiState.h>
+#include <atta/graphics/gui/guiRender.h>
+#include <algorithm>
+#include <cmath>
+
+namespace guib
+{
+	ListView::ListView(ListViewInfo info):
+		Widget({.offset = info.offset, .size = info.size}),
+		_selectColor(info.selectColor), _textColor(info.textColor),
+		_rowHeight(info.rowHeight), _textSize(info.textSize), _indent(info.indent),
+		_getQtyRows(info.getQtyRows), _getRow(info.getRow),
+		_onClickRow(info.onClickRow), _onToggleRow(info.onToggleRow),
+		_firstRow(0)
+	{
+		Widget::setType("ListView");
+
+		_background = new guib::Box(
+				{
+					.color = info.color,
+					.size  = {1,1},
+				});
+
+		// One click area for the whole list, the row is calculated from the cursor position
+		Widget::setChild(new guib::ClickDetector(
+			{
+				.onClick = [&](){ onClick(); },
+				.child = _background
+			})
+		);
+	}
+
+	void ListView::preProcess()
+	{
+		state::scrollables.push_back(this);
+	}
+
+	void ListView::render()
+	{
+		// Background
+		Widget::render();
+
+		const size_t qtyRows = _getQtyRows ? _getQtyRows() : 0;
+		const float rowHeight = getRowHeight();
+		const float indentWidth = _indent/float(state::screenSize.width);
+		const size_t lastRow = std::min(qtyRows, _firstRow+getQtyVisibleRows());
+		for(size_t i=_firstRow; i<lastRow; i++)
+		{
+			ListViewRow row = _getRow(i);
+			Offset rowOffset = {_offset.x, _offset.y+(i-_firstRow)*rowHeight, UNIT_SCREEN, UNIT_SCREEN};
+
+			if(row.selected)
+			{
+				GuiObjectInfo objectInfo;
+				objectInfo.position = atta::vec4(rowOffset.x, rowOffset.y, (float)state::renderDepth, 1.0f);
+				objectInfo.size = atta::vec2(_size.width, rowHeight);
+				objectInfo.color = atta::vec4(_selectColor.r, _selectColor.g, _selectColor.b, _selectColor.a);
+				objectInfo.isLetter = 0;
+				objectInfo.textureIndex = -1;
+				state::guiRender->addQuad(objectInfo);
+			}
+
+			// Arrow + text
+			Offset textOffset = {rowOffset.x+row.depth*indentWidth, rowOffset.y, UNIT_SCREEN, UNIT_SCREEN};
+			if(row.hasChildren)
+				Text::renderText(row.expanded ? "v" : ">", textOffset, rowHeight, _textSize, _textColor);
+			textOffset.x += indentWidth;
+			float maxWidth = _offset.x+_size.width-textOffset.x;
+			if(maxWidth > 0)
+				Text::renderText(row.text, textOffset, rowHeight, _textSize, _textColor, maxWidth);
+		}
+	}
+
+	void ListView::onClick()
+	{
+		const size_t qtyRows = _getQtyRows ? _getQtyRows() : 0;
+		const float rowPos = (state::cursorPos.y-_offset.y)/getRowHeight();
+		if(rowPos < 0)
+			return;
+		const size_t row = _firstRow+size_t(rowPos);
+		if(row >= qtyRows)
+			return;
+
+		// Arrow column of the row
+		ListViewRow rowInfo = _getRow(row);
+		const float indentWidth = _indent/float(state::screenSize.width);
+		const float arrowX = _offset.x+rowInfo.depth*indentWidth;
+		if(rowInfo.hasChildren && state::cursorPos.x >= arrowX && state::cursorPos.x < arrowX+indentWidth)
+		{
+			if(_onToggleRow)
+				_onToggleRow(row);
+		}
+		else if(_onClickRow)
+			_onClickRow(row);
+		invalidate();
+	}
+
+	void ListView::scroll(float qtyRows)
+	{
+		const long long firstRow = std::llround((double)_firstRow+qtyRows);
+		const size_t newFirstRow = std::min((size_t)std::max(firstRow, 0ll), getMaxFirstRow());
+		if(newFirstRow != _firstRow)
+		{
+			_firstRow = newFirstRow;
+			invalidate();
+		}
+	}
+
+	void ListView::refresh()
+	{
+		_firstRow = std::min(_firstRow, getMaxFirstRow());
+		invalidate();
+	}
+
+	void ListView::scrollTo(size_t row)
+	{
+		if(row < _firstRow)
+			_firstRow = row;
+		else if(row >= _firstRow+getQtyVisibleRows())
+			_firstRow = row+1-getQtyVisibleRows();
+		else
+			return;
+		_firstRow = std::min(_firstRow, getMaxFirstRow());
+		invalidate();
+	}
+
+	size_t ListView::getQtyVisibleRows() const
+	{
+		return std::max(size_t(_size.height/getRowHeight()), size_t(1));
+	}
+
+	float ListView::getRowHeight() const
+	{
+		return _rowHeight/float(state::screenSize.height);
+	}
+
+	size_t ListView::getMaxFirstRow() const
+	{
+		const size_t qtyRows = _getQtyRows ? _getQtyRows() : 0;
+		const size_t qtyVisible = getQtyVisibleRows();
+		return qtyRows > qtyVisible ? qtyRows-qtyVisible : 0;
+	}
+}
@@ -27,27 +27,23 @@ namespace guib
 
 	void Text::render()
 	{
-		guib::Color color = _color;
-		float atlasHeight = state::fontLoader->getFontTexture().atlas.height;
-		float atlasWidth = state::fontLoader->getFontTexture().atlas.width;
-		float sizeTransform = _textSize/state::fontLoader->getBaseHeight();// Scale glyph pixels to desired pixel size
+		renderText(_text, _offset, _size.height, _textSize, _color);
+	}
+
+	void Text::renderText(const std::string& text, Offset offset, float height, int textSize, Color color, float maxWidth)
+	{
+		float atlasHeight = state::fontLoader->getAtlas().height;
+		float atlasWidth = state::fontLoader->getAtlas().width;
+		float sizeTransform = textSize/float(state::fontLoader->getGlyphSize());// Scale glyph pixels to desired pixel size
 
 		// {currX, currY} is the glyph origin
-		float currX = _offset.x;
-		float currY = _offset.y;
-		currY += _size.height/2.0f+_textSize*0.75f/float(state::screenSize.height*2);// Center vertically
+		float currX = offset.x;
+		float currY = offset.y;
+		currY += height/2.0f+textSize*0.75f/float(state::screenSize.height*2);// Center vertically
 
-		float totalWidth=0;
-		for(auto letter : _text)
+		for(unsigned char letter : text)
 		{
-			guib::GlyphInfo gInfo = state::fontLoader->getFontTexture().glyphsInfo[letter];
-			totalWidth += gInfo.width/state::screenSize.width;
-		}
-		//currX += _size.width/2.0f-totalWidth/2.0f;// Center horizontally
-		
-		for(auto letter : _text)
-		{
-			guib::GlyphInfo gInfo = state::fontLoader->getFontTexture().glyphsInfo[letter];
+			const guib::GlyphInfo& gInfo = state::fontLoader->getGlyph(letter);
 			double tw = gInfo.width/atlasWidth;
 			double th = gInfo.height/atlasHeight;
 			double tx = gInfo.x/atlasWidth;
@@ -56,14 +52,17 @@ namespace guib
 			double heightPercent = gInfo.height/state::screenSize.height;
 			double leftPercent = gInfo.left/state::screenSize.width;
 			double topPercent = gInfo.top/state::screenSize.height;
-			double advancePercent = gInfo.advance/state::screenSize.width;
+			double advancePercent = state::fontLoader->getAdvance(letter, textSize)/state::screenSize.width;
 
 			heightPercent *= sizeTransform;
 			leftPercent *= sizeTransform;
 			topPercent *= sizeTransform;
-			advancePercent *= sizeTransform;
 
-			if(letter==' ')
+			if(currX+advancePercent > offset.x+maxWidth)
+				break;
+
+			// Space or glyph still being generated (the gui is rendered again when it is ready)
+			if(!gInfo.resident)
 			{
 				currX += advancePercent;
 				continue;
@@ -81,15 +80,7 @@ namespace guib
 			objectInfo.offsetLetter = atta::vec2(tx, ty);
 			objectInfo.sizeLetter = atta::vec2(tw, th);
 
-			vkCmdPushConstants(
-					state::guiRender->getCommandBuffer(),
-					state::guiRender->getPipelineLayout()->handle(),
-					VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-					0,
-					sizeof(GuiObjectInfo),
-					&objectInfo);
-
-			vkCmdDraw(state::guiRender->getCommandBuffer(), 6, 1, 0, 0);
+			state::guiRender->addQuad(objectInfo);
 
 			//currX += (gInfo.width/gInfo.height)*heightPercent;
 			currX += advancePercent;
@@ -98,12 +89,12 @@ namespace guib
 
 	Size Text::calculateTextSize(std::string text, unsigned textSize)
 	{
-		unsigned textWidth = 0;
-		for(auto letter : text)
+		float textWidth = 0;
+		for(unsigned char letter : text)
 		{
-			textWidth += state::fontLoader->getFontTexture().glyphsInfo[(size_t)letter].advance;
+			textWidth += state::fontLoader->getAdvance(letter, textSize);
 		}
 
-		return {textWidth, textSize, UNIT_PIXEL, UNIT_PIXEL};
+		return {std::ceil(textWidth), textSize, UNIT_PIXEL, UNIT_PIXEL};
 	}
 }
@@ -158,9 +158,17 @@ namespace guib
 			_child->update();
 	}
 
+	void Widget::invalidate()
+	{
+		state::invalidate();
+	}
+
 	void Widget::addOffsetTree(Offset offset)
 	{
+		if(offset.x == 0 && offset.y == 0)
+			return;
 		_offset += offset;
+		invalidate();
 		//Log::debug("Widget", "AddOff [y]$0[] with [w]$1", _type, _offset.toString());
 		if(_child)
 			_child->addOffsetTree(offset);
@@ -16,7 +16,8 @@ namespace atta::vk
 			std::vector<std::shared_ptr<ImageView>> imageViews, 
 			std::vector<std::shared_ptr<UniformBuffer>> uniformBuffers, 
 			std::shared_ptr<Scene> scene):
-		Pipeline(vkCore, imageViews, scene)
+		Pipeline(vkCore, imageViews, scene),
+		_cameraPosition(0,0,0), _projectionScale(0.0f)
 	{
 		_imageExtent = extent;
 		_imageFormat = format;
@@ -245,17 +246,27 @@ namespace atta::vk
 		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
 		vkCmdBindIndexBuffer(commandBuffer, _vkCore->getIndexBuffer()->handle(), 0, VK_INDEX_TYPE_UINT32);
 
-		for(auto object : _scene->getObjects())
-			renderObjectAndChildren(commandBuffer, object);
+		// Linear walk over the objects with models
+		const ComponentArray<Model*>& models = _scene->getRegistry().getModels();
+		for(size_t i=0; i<models.size(); i++)
+			renderObject(commandBuffer, models.getObjects()[i], models.getComponents()[i]);
 	}
 
-	void GraphicsPipeline::renderObjectAndChildren(VkCommandBuffer commandBuffer, std::shared_ptr<Object> object)
+	void GraphicsPipeline::setLodView(vec3 cameraPosition, float projectionScale)
 	{
-		auto model = object->getModel();
-		if(model==nullptr) return;
+		_cameraPosition = cameraPosition;
+		_projectionScale = projectionScale;
+	}
+
+	void GraphicsPipeline::renderObject(VkCommandBuffer commandBuffer, const Object* object, const Model* model)
+	{
+		// Mesh/materials not uploaded (no space in the GPU buffers)
+		if(model->getMaterialOffset() < 0)
+			return;
 
 		ObjectInfo objectInfo;
-		objectInfo.transform = transpose(object->getModelMat());
+		const mat4 modelMat = object->getModelMat();
+		objectInfo.transform = transpose(modelMat);
 		objectInfo.materialOffset = model->getMaterialOffset();
 		//Log::error("RastGraphicsPipeline", "model: $0 $1", object->getModelMat().toString(), object->getOrientation().toString());
 
@@ -268,15 +279,14 @@ namespace atta::vk
 				&objectInfo);
 
 		//const uint32_t vertexCount = model->getVerticesSize();
-		const uint32_t indexCount = model->getMesh()->getIndicesSize();
-		const uint32_t vertexOffset = model->getMesh()->getVerticesOffset();
-		const uint32_t indexOffset = model->getMesh()->getIndicesOffset();
+		const Mesh* mesh = model->getMesh().get();
+		const unsigned lod = mesh->selectLod(modelMat, _cameraPosition, _projectionScale);
+		const uint32_t indexCount = mesh->getLodIndicesSize(lod);
+		const uint32_t vertexOffset = mesh->getVerticesOffset();
+		const uint32_t indexOffset = mesh->getLodIndicesOffset(lod);
 
 		//Log::debug("GraphicsPipeline", "ind $0 - verto $1 - indo $2", indexCount, vertexOffset, indexOffset);
 
 		vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
-
-		for(auto child : object->getChildren())
-			renderObjectAndChildren(commandBuffer, child);
 	}
 }
@@ -216,6 +216,6 @@ namespace atta::vk
 		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline);
 		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->handle(), 0, 1, &_descriptorSetManager->getDescriptorSets()->handle()[imageIndex], 0, nullptr);
 
-		vkCmdDraw(commandBuffer, Drawer::getCurrNumberOfLines()*2, 1, 0, 0);
+		vkCmdDraw(commandBuffer, Drawer::getCurrNumberOfLinesMemory()*2, 1, 0, 0);
 	}
 }
@@ -6,6 +6,7 @@
 //--------------------------------------------------
 #include <atta/graphics/renderers/rastRenderer/rastRenderer.h>
 #include <atta/helpers/log.h>
+#include <cmath>
 //#include "glm.h"
 
 namespace atta
@@ -32,6 +33,7 @@ namespace atta
 		createRenderPass();
 		createFrameBuffers();
 		createPipelines();
+		updateLodView();
 	}
 
 	RastRenderer::~RastRenderer()
@@ -135,8 +137,19 @@ namespace atta
 		vkCmdEndRenderPass(commandBuffer);
 	}
 
+	void RastRenderer::updateLodView()
+	{
+		// Low resolution views (camera sensors) select coarser levels of detail
+		const vec3 cameraPosition = vec3(atta::inverse(_viewMatrix).col(3));
+		const float projectionScale = _extent.height/(2.0f*std::tan(atta::radians(_fov)*0.5f));
+		_graphicsPipeline->setLodView(cameraPosition, projectionScale);
+	}
+
 	void RastRenderer::updateCameraMatrix(mat4 viewMatrix)
 	{
+		_viewMatrix = viewMatrix;
+		updateLodView();
+
 		vk::UniformBufferObject ubo = _uniformBuffer->getValue();
 		ubo.viewMat = atta::transpose(viewMatrix);
 		ubo.viewMatInverse = atta::inverse(ubo.viewMat);
@@ -161,6 +174,7 @@ namespace atta
 		createRenderPass();
 		createFrameBuffers();
 		createPipelines();
+		updateLodView();
 
 		// Update uniform buffer projection matrix
 		vk::UniformBufferObject ubo  = _uniformBuffer->getValue();
@@ -7,6 +7,7 @@
 #include <atta/graphics/renderers/rayTracing/rayTracingVulkan/rayTracing.h>
 #include <chrono>
 #include <atta/graphics/core/vertex.h>
+#include <atta/graphics/core/objectInfo.h>
 #include <atta/graphics/vulkan/imageMemoryBarrier.h>
 #include <atta/graphics/vulkan/stagingBuffer.h>
 #include <atta/helpers/log.h>
@@ -15,7 +16,7 @@
 namespace atta::rt::vk
 {
 	RayTracing::RayTracing(CreateInfo info):
-		Renderer({info.vkCore, info.commandPool, info.width, info.height, info.viewMat, RENDERER_TYPE_RAY_TRACING_VULKAN, VK_IMAGE_USAGE_STORAGE_BIT}), _scene(info.scene)
+		Renderer({info.vkCore, info.commandPool, info.width, info.height, info.viewMat, RENDERER_TYPE_RAY_TRACING_VULKAN, VK_IMAGE_USAGE_STORAGE_BIT}), _scene(info.scene), _sceneVersion(info.scene->getVersion())
 	{
 		_device = _vkCore->getDevice();
 
@@ -94,7 +95,7 @@ namespace atta::rt::vk
 	{
 		_rayTracingPipeline = std::make_shared<RayTracingPipeline>(
 				_device, _deviceProcedures, 
-				_tlas[0], _accumulationImageView, _imageView, _uniformBuffer, _vkCore);
+				_tlas[0], _objectInfoBuffer, _accumulationImageView, _imageView, _uniformBuffer, _vkCore);
 
 		const std::vector<ShaderBindingTable::Entry> rayGenPrograms = { {_rayTracingPipeline->getRayGenShaderIndex(), {}} };
 		const std::vector<ShaderBindingTable::Entry> missPrograms = { {_rayTracingPipeline->getMissShaderIndex(), {}}, {_rayTracingPipeline->getMissShadowShaderIndex(), {}} };
@@ -106,6 +107,9 @@ namespace atta::rt::vk
 
 	void RayTracing::render(VkCommandBuffer commandBuffer)
 	{
+		if(_scene->getVersion() != _sceneVersion)
+			updateSceneStructures();
+
 		// Increate total number of samples
 		rt::vk::UniformBufferObject ubo = _uniformBuffer->getValue();
 		ubo.nAccSamples += ubo.samplesPerPixel;
@@ -165,13 +169,18 @@ namespace atta::rt::vk
 		// Bottom level acceleration structure
 		// Triangles via vertex buffers 
 
-		// Create blas object for each model
-		for(Mesh* mesh : Mesh::allMeshes)
+		// Create blas object for each mesh used by the objects (and not created yet)
+		std::vector<std::shared_ptr<BottomLevelAccelerationStructure>> newBlas;
+		for(const std::shared_ptr<Object>& object : _scene->getObjectsFlat())
 		{
-			static unsigned vertexOffset = 0;
-			static unsigned indexOffset = 0;
-
-			if(mesh==nullptr)
+			std::shared_ptr<Model> model = object->getModel();
+			// Mesh not uploaded to the vulkan core buffers
+			if(model==nullptr || model->getMaterialOffset() < 0)
+				continue;
+			Mesh* mesh = model->getMesh().get();
+			if(mesh->getIndex() >= _meshBlas.size())
+				_meshBlas.resize(mesh->getIndex()+1, -1);
+			if(_meshBlas[mesh->getIndex()] >= 0)
 				continue;
 
 			const uint32_t vertexCount = mesh->getVerticesSize();
@@ -179,22 +188,24 @@ namespace atta::rt::vk
 
 			std::shared_ptr<BottomLevelGeometry> geometries = std::make_shared<BottomLevelGeometry>();
 
+			// Mesh offsets in the vulkan core buffers
 			geometries->addGeometry(
 					_vkCore, 
-					vertexOffset, vertexCount, 
-					indexOffset, indexCount, true);
+					mesh->getVerticesOffset()*sizeof(Vertex), vertexCount, 
+					mesh->getIndicesOffset()*sizeof(uint32_t), indexCount, true);
 
 			std::shared_ptr<BottomLevelAccelerationStructure> blas = std::make_shared<BottomLevelAccelerationStructure>(_deviceProcedures, _rayTracingProperties, geometries);
+			_meshBlas[mesh->getIndex()] = _blas.size();
 			_blas.push_back(blas);
-
-			vertexOffset += vertexCount*sizeof(Vertex);
-			indexOffset += indexCount*sizeof(uint32_t);
+			newBlas.push_back(blas);
 		}
+		if(newBlas.empty())
+			return;
 
 		// Calculate total memory size to allocate
-		VkAccelerationStructureBuildSizesInfoKHR total = getTotalRequirements(_blas);
+		VkAccelerationStructureBuildSizesInfoKHR total = getTotalRequirements(newBlas);
 
-		_bottomBuffer = std::make_shared<atta::vk::Buffer>(
+		std::shared_ptr<atta::vk::Buffer> bottomBuffer = std::make_shared<atta::vk::Buffer>(
 				_device, total.accelerationStructureSize>0?total.accelerationStructureSize:1, 
 				VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR, 
 				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
@@ -209,12 +220,13 @@ namespace atta::rt::vk
 		VkDeviceSize resultOffset = 0;
 		VkDeviceSize scratchOffset = 0;
 
-		for(size_t i = 0; i < _blas.size(); i++)
+		for(size_t i = 0; i < newBlas.size(); i++)
 		{
-			_blas[i]->generate(commandBuffer, _bottomBuffer, resultOffset, _bottomScratchBuffer, scratchOffset);
-			resultOffset += _blas[i]->getBuildSizes().accelerationStructureSize;
-			scratchOffset += _blas[i]->getBuildSizes().buildScratchSize;
+			newBlas[i]->generate(commandBuffer, bottomBuffer, resultOffset, _bottomScratchBuffer, scratchOffset);
+			resultOffset += newBlas[i]->getBuildSizes().accelerationStructureSize;
+			scratchOffset += newBlas[i]->getBuildSizes().buildScratchSize;
 		}
+		_bottomBuffers.push_back(bottomBuffer);
 		// TODO after generating the BLAS it is possible to reduce the memory usage using a more fitted buffer
 	}
 
@@ -222,23 +234,37 @@ namespace atta::rt::vk
 	{
 		// Top level acceleration structure
 		std::vector<VkAccelerationStructureInstanceKHR> instances;
+		std::vector<ObjectInfo> objectInfos;
 
 		// Hit group 0: triangles
 		// Hit group 1: procedurals
-		for(std::shared_ptr<Object> object : _scene->getObjects())
+		unsigned instanceId = 0;
+		for(const std::shared_ptr<Object>& object : _scene->getObjectsFlat())
 		{
-			static unsigned _instanceId = 0;
-
 			std::shared_ptr<Model> model = object->getModel();
-			if(model==nullptr) continue;
-			//if(model == nullptr)
-			//	continue;
+			if(model==nullptr || model->getMaterialOffset() < 0 || model->getMeshIndex() >= _meshBlas.size() || _meshBlas[model->getMeshIndex()] < 0)
+				continue;
 
-			//_blas[model->getModelIndex()]->getDevice();
-			//std::cout << "INDEX: " << model->getMeshIndex() << std::endl;
-			//std::cout << "Size: " << _blas.size() << std::endl;
 			instances.push_back(TopLevelAccelerationStructure::createInstance(
-				_blas[model->getMeshIndex()], object->getModelMat(), _instanceId++, 0/*procedural?*/));
+				_blas[_meshBlas[model->getMeshIndex()]], object->getModelMat(), instanceId++, 0/*procedural?*/));
+
+			ObjectInfo obji;
+			obji.indexOffset = model->getMesh()->getIndicesOffset();
+			obji.vertexOffset = model->getMesh()->getVerticesOffset();
+			obji.materialOffset = model->getMaterialOffset();
+			obji.transform = transpose(object->getModelMat());
+			objectInfos.push_back(obji);
+		}
+
+		// Object info of each instance (read by the closest hit shader)
+		const size_t objectInfosSize = objectInfos.size()*sizeof(ObjectInfo);
+		_objectInfoBuffer = std::make_shared<atta::vk::Buffer>(_device, objectInfosSize>0?objectInfosSize:sizeof(ObjectInfo),
+				VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		if(objectInfosSize>0)
+		{
+			atta::vk::StagingBuffer stagingBuffer(_device, objectInfos.data(), objectInfosSize);
+			_objectInfoBuffer->copyFrom(_commandPool, stagingBuffer.handle(), objectInfosSize);
 		}
 
 		size_t size = instances.size()*sizeof(VkAccelerationStructureInstanceKHR);
@@ -257,6 +283,7 @@ namespace atta::rt::vk
 		AccelerationStructure::memoryBarrier(commandBuffer);
 
 		std::shared_ptr<TopLevelAccelerationStructure> tlas = std::make_shared<TopLevelAccelerationStructure>(_deviceProcedures, _rayTracingProperties, _instancesBuffer->getDeviceAddress(), instances.size());
+		_tlas.clear();
 		_tlas.push_back(tlas);
 
 		// Calculate total memory size to allocate
@@ -274,6 +301,38 @@ namespace atta::rt::vk
 		_tlas[0]->generate(commandBuffer, _topBuffer, 0, _topScratchBuffer, 0);
 	}
 
+	void RayTracing::updateSceneStructures()
+	{
+		LocalEvaluator eval;
+
+		// The command buffers in flight still use the current structures and descriptor set
+		{
+			VkQueue queue = _device->getGraphicsQueueGUI();
+			std::lock_guard<std::recursive_mutex> lock(_device->getQueueMutex(queue));
+			vkQueueWaitIdle(queue);
+		}
+
+		// New meshes get a bottom level structure (the other ones are kept), the top level is built again
+		VkCommandBuffer commandBuffer = _commandPool->beginSingleTimeCommands();
+		{
+			createBottomLevelStructures(commandBuffer);
+			createTopLevelStructures(commandBuffer);
+		}
+		_commandPool->endSingleTimeCommands(commandBuffer);
+		_bottomScratchBuffer.reset();
+
+		_rayTracingPipeline->updateScene(_tlas[0], _objectInfoBuffer);
+		_sceneVersion = _scene->getVersion();
+
+		// Restart the accumulation
+		rt::vk::UniformBufferObject ubo = _uniformBuffer->getValue();
+		ubo.nAccSamples = 0;
+		_uniformBuffer->setValue(ubo);
+
+		eval.stop();
+		Log::verbose("rt::vk::RayTracing", "Acceleration structures updated ($0 meshes): [w]$1ms", _blas.size(), eval.getMs());
+	}
+
 	void RayTracing::recreateTLAS()
 	{
 		// Called every time some object changes
@@ -17,6 +17,7 @@ namespace atta::rt::vk
 		std::shared_ptr<atta::vk::Device> device,
 		std::shared_ptr<DeviceProcedures> deviceProcedures,
 		std::shared_ptr<TopLevelAccelerationStructure> accelerationStructure,
+		std::shared_ptr<atta::vk::Buffer> objectInfoBuffer,
 		std::shared_ptr<atta::vk::ImageView> accumulationImageView,
 		std::shared_ptr<atta::vk::ImageView> outputImageView,
 		std::shared_ptr<rt::vk::UniformBuffer> uniformBuffer,
@@ -94,7 +95,7 @@ namespace atta::rt::vk
 
 		// Object info buffer
 		VkDescriptorBufferInfo objInfoBufferInfo = {};
-		objInfoBufferInfo.buffer = _vkCore->getObjectInfoBuffer()->handle();
+		objInfoBufferInfo.buffer = objectInfoBuffer->handle();
 		objInfoBufferInfo.range = VK_WHOLE_SIZE;
 
 		// Light buffer
@@ -231,6 +232,29 @@ namespace atta::rt::vk
 		}
 	}
 
+	void RayTracingPipeline::updateScene(std::shared_ptr<TopLevelAccelerationStructure> accelerationStructure, std::shared_ptr<atta::vk::Buffer> objectInfoBuffer)
+	{
+		std::shared_ptr<atta::vk::DescriptorSets> descriptorSets = _descriptorSetManager->getDescriptorSets();
+
+		const auto accelerationStructureHandle = accelerationStructure->handle();
+		VkWriteDescriptorSetAccelerationStructureKHR structureInfo = {};
+		structureInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
+		structureInfo.pNext = nullptr;
+		structureInfo.accelerationStructureCount = 1;
+		structureInfo.pAccelerationStructures = &accelerationStructureHandle;
+
+		VkDescriptorBufferInfo objInfoBufferInfo = {};
+		objInfoBufferInfo.buffer = objectInfoBuffer->handle();
+		objInfoBufferInfo.range = VK_WHOLE_SIZE;
+
+		const std::vector<VkWriteDescriptorSet> descriptorWrites =
+		{
+			descriptorSets->bind(0, 0, structureInfo),
+			descriptorSets->bind(0, 7, objInfoBufferInfo),
+		};
+		descriptorSets->updateDescriptors(0, descriptorWrites);
+	}
+
 	VkDescriptorSet RayTracingPipeline::getDescriptorSet(const uint32_t index) const
 	{
 		return _descriptorSetManager->getDescriptorSets()->handle()[index];
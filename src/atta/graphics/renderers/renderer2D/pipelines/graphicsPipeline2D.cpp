@@ -227,8 +227,10 @@ namespace atta
 		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
 		vkCmdBindIndexBuffer(commandBuffer, _vkCore->getIndexBuffer()->handle(), 0, VK_INDEX_TYPE_UINT32);
 
-		for(auto object : _scene->getObjects())
-			renderObjectAndChildren(commandBuffer, object);
+		// Linear walk over the objects with models
+		const ComponentArray<Model*>& models = _scene->getRegistry().getModels();
+		for(size_t i=0; i<models.size(); i++)
+			renderObject(commandBuffer, models.getObjects()[i], models.getComponents()[i]);
 
 		//for(auto object : _scene->getObjects())
 		//{
@@ -257,10 +259,11 @@ namespace atta
 		//}
 	}
 
-	void GraphicsPipeline2D::renderObjectAndChildren(VkCommandBuffer commandBuffer, std::shared_ptr<Object> object)
+	void GraphicsPipeline2D::renderObject(VkCommandBuffer commandBuffer, const Object* object, const Model* model)
 	{
-		auto model = object->getModel();
-		if(model==nullptr) return;
+		// Mesh/materials not uploaded (no space in the GPU buffers)
+		if(model->getMaterialOffset() < 0)
+			return;
 
 		ObjectInfo objectInfo;
 		objectInfo.transform = transpose(object->getModelMat());
@@ -283,8 +286,5 @@ namespace atta
 		//Log::debug("GraphicsPipeline", "ind $0 - verto $1 - indo $2", indexCount, vertexOffset, indexOffset);
 
 		vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
-
-		for(auto child : object->getChildren())
-			renderObjectAndChildren(commandBuffer, child);
 	}
 }
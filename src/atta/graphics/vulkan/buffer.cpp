@@ -92,6 +92,18 @@ namespace atta::vk
 
 	void Buffer::copyFrom(std::shared_ptr<CommandPool> commandPool, VkBuffer srcBuffer, VkDeviceSize size)
 	{
+		VkBufferCopy copyRegion{};
+		copyRegion.srcOffset = 0;
+		copyRegion.dstOffset = 0;
+		copyRegion.size = size;
+		copyFrom(commandPool, srcBuffer, std::vector<VkBufferCopy>{copyRegion});
+	}
+
+	void Buffer::copyFrom(std::shared_ptr<CommandPool> commandPool, VkBuffer srcBuffer, const std::vector<VkBufferCopy>& regions)
+	{
+		if(regions.empty())
+			return;
+
 		VkCommandBufferAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
@@ -107,11 +119,7 @@ namespace atta::vk
 
 		vkBeginCommandBuffer(commandBuffer, &beginInfo);
 		{
-			VkBufferCopy copyRegion{};
-			copyRegion.srcOffset = 0; // Optional
-			copyRegion.dstOffset = 0; // Optional
-			copyRegion.size = size;
-			vkCmdCopyBuffer(commandBuffer, srcBuffer, _buffer, 1, &copyRegion);
+			vkCmdCopyBuffer(commandBuffer, srcBuffer, _buffer, regions.size(), regions.data());
 		}
 		vkEndCommandBuffer(commandBuffer);
 
@@ -122,8 +130,11 @@ namespace atta::vk
 
 		const auto graphicsQueue = _device->getGraphicsQueue();
 
-		vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(graphicsQueue);
+		{
+			std::lock_guard<std::recursive_mutex> lock(_device->getQueueMutex(graphicsQueue));
+			vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+			vkQueueWaitIdle(graphicsQueue);
+		}
 
 		vkFreeCommandBuffers(_device->handle(), commandPool->handle(), 1, &commandBuffer);
 	}
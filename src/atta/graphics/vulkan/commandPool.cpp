@@ -108,8 +108,11 @@ namespace atta::vk
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &commandBuffer;
 
-		vkQueueSubmit(_submitQueue, 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(_submitQueue);
+		{
+			std::lock_guard<std::recursive_mutex> lock(_device->getQueueMutex(_submitQueue));
+			vkQueueSubmit(_submitQueue, 1, &submitInfo, VK_NULL_HANDLE);
+			vkQueueWaitIdle(_submitQueue);
+		}
 
 		vkFreeCommandBuffers(_device->handle(), _commandPool, 1, &commandBuffer);
 	}
@@ -118,6 +121,7 @@ namespace atta::vk
 	{
 		// Useful to call before starting to destroy objects to avoid trying to destroy some
 		// object that is in use by a command buffer
+		std::lock_guard<std::recursive_mutex> lock(_device->getQueueMutex(_submitQueue));
 		vkQueueWaitIdle(_submitQueue);
 	}
 }
@@ -39,6 +39,8 @@ namespace atta::vk
 			deviceFeatures.samplerAnisotropy = VK_TRUE;
 		if(_physicalDevice->getSupport().fillModeNonSolidFeature)
 			deviceFeatures.fillModeNonSolid = VK_TRUE;
+		if(_physicalDevice->getSupport().textureCompressionBCFeature)
+			deviceFeatures.textureCompressionBC = VK_TRUE;
 		//deviceFeatures.wideLines = VK_TRUE;
 		//deviceFeatures.largePoints = VK_TRUE;
 
@@ -75,6 +77,8 @@ namespace atta::vk
 		VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures = {};
 		indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
 		indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+		if(_physicalDevice->getSupport().sampledImageNonUniformIndexingFeature)
+			indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;// GUI texture index is per instance
 		indexingFeatures.pNext = &bufferAddressFeatures;
 
 		//---------- Create logical device ----------//
@@ -119,6 +123,10 @@ namespace atta::vk
 		vkGetDeviceQueue(_device, indices.graphicsFamily.value(), 1, &_graphicsQueueGUI);	
 		vkGetDeviceQueue(_device, indices.presentFamily.value(), 1, &_presentQueueGUI);
 		vkGetDeviceQueue(_device, indices.transferFamily.value(), 1, &_transferQueueGUI);
+
+		for(VkQueue queue : {_graphicsQueue, _transferQueue, _computeQueue, _graphicsQueueGUI, _presentQueueGUI, _transferQueueGUI})
+			if(_queueMutexes.find(queue) == _queueMutexes.end())
+				_queueMutexes[queue] = std::make_unique<std::recursive_mutex>();
 	}
 
 	Device::~Device()
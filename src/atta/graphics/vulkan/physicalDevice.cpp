@@ -69,6 +69,8 @@ namespace atta::vk
 			_support.differentQueuesThreadManagerGUI = _queueFamilyIndices.graphicsFamily.value() != _queueFamilyIndices.transferFamily.value();
 			_support.samplerAnisotropyFeature = true;
 			_support.fillModeNonSolidFeature = true;
+			_support.textureCompressionBCFeature = true;
+			_support.sampledImageNonUniformIndexingFeature = true;
 			for(const auto& info : supportInfo)
 			{
 				switch(info)
@@ -80,9 +82,19 @@ namespace atta::vk
 					case WARN_NO_SAMPLER_ANISOTROPY_FEATURE_SUPPORT:
 						Log::warning("PhysicalDevice", "The selected GPU does not support sampler anisotropy");
 						_support.samplerAnisotropyFeature = false;
+						break;
 					case WARN_NO_FILL_MODE_NON_SOLID_FEATURE_SUPPORT:
 						Log::warning("PhysicalDevice", "The selected GPU does not support fill mode non solid");
 						_support.fillModeNonSolidFeature = false;
+						break;
+					case WARN_NO_TEXTURE_COMPRESSION_BC_FEATURE_SUPPORT:
+						Log::warning("PhysicalDevice", "The selected GPU does not support BC texture compression, textures will be uncompressed");
+						_support.textureCompressionBCFeature = false;
+						break;
+					case WARN_NO_SAMPLED_IMAGE_NON_UNIFORM_INDEXING_FEATURE_SUPPORT:
+						Log::warning("PhysicalDevice", "The selected GPU does not support non uniform sampled image indexing, the GUI will split its draws by texture");
+						_support.sampledImageNonUniformIndexingFeature = false;
+						break;
 					default:
 						break;
 				}
@@ -163,6 +175,20 @@ namespace atta::vk
 		if(!supportedFeatures.fillModeNonSolid)
 			supportInfo.push_back(WARN_NO_FILL_MODE_NON_SOLID_FEATURE_SUPPORT);
 
+		if(!supportedFeatures.textureCompressionBC)
+			supportInfo.push_back(WARN_NO_TEXTURE_COMPRESSION_BC_FEATURE_SUPPORT);
+
+		// Descriptor indexing features (Vulkan 1.2)
+		VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures{};
+		indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+		VkPhysicalDeviceFeatures2 supportedFeatures2{};
+		supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		supportedFeatures2.pNext = &indexingFeatures;
+		vkGetPhysicalDeviceFeatures2(device, &supportedFeatures2);
+
+		if(!indexingFeatures.shaderSampledImageArrayNonUniformIndexing)
+			supportInfo.push_back(WARN_NO_SAMPLED_IMAGE_NON_UNIFORM_INDEXING_FEATURE_SUPPORT);
+
 		return supportInfo;
 	}
 
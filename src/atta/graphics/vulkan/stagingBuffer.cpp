@@ -9,7 +9,8 @@
 namespace atta::vk
 {
 	StagingBuffer::StagingBuffer(std::shared_ptr<Device> device, void* dataToMap, VkDeviceSize size):
-		Buffer(device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+		Buffer(device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+		_data(nullptr)
 	{
 		void* data;
 		vkMapMemory(_device->handle(), _bufferMemory, 0, _bufferInfo.size, 0, &data);
@@ -27,9 +28,16 @@ namespace atta::vk
 	//	vkUnmapMemory(_device->handle(), _bufferMemory);
 	//}
 
-	StagingBuffer::~StagingBuffer()
+	StagingBuffer::StagingBuffer(std::shared_ptr<Device> device, VkDeviceSize size):
+		Buffer(device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
 	{
+		_data = mapMemory(0, size);
+	}
 
+	StagingBuffer::~StagingBuffer()
+	{
+		if(_data != nullptr)
+			unmapMemory();
 	}
 
 	void StagingBuffer::mapFromData(std::shared_ptr<Device> device, void* dataToMap, VkDeviceSize size)
@@ -9,6 +9,7 @@
 #include <atta/graphics/vulkan/commandPool.h>
 #include <atta/extern/stbImage.h>
 #include <atta/graphics/vulkan/imageMemoryBarrier.h>
+#include <atta/graphics/core/textureImporter.h>
 #include <atta/helpers/log.h>
 
 namespace atta::vk
@@ -140,7 +141,7 @@ namespace atta::vk
 	//----------------------------------------//
 	//-------------- From buffer -------------//
 	//----------------------------------------//
-	Texture::Texture(std::shared_ptr<Device> device, std::shared_ptr<CommandPool> commandPool, void* buffer,  VkExtent2D size, atta::Texture::Format format, bool editable):
+	Texture::Texture(std::shared_ptr<Device> device, std::shared_ptr<CommandPool> commandPool, void* buffer,  VkExtent2D size, atta::Texture::Format format, bool editable, bool mipmaps):
 		_device(device), _commandPool(commandPool), _arrayLayers(1), _editable(editable)
 	{
 		if(format == atta::Texture::FORMAT_NONE)
@@ -151,7 +152,7 @@ namespace atta::vk
 
 		_width = size.width;
 		_height = size.height;
-		_mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(_width, _height)))) + 1;
+		_mipLevels = mipmaps ? static_cast<uint32_t>(std::floor(std::log2(std::max(_width, _height)))) + 1 : 1;
 		_size = _width * _height * atta::Texture::sizeInBytes(format);
 
 		StagingBuffer* stagingBuffer = new StagingBuffer(_device, buffer, _size);
@@ -177,6 +178,65 @@ namespace atta::vk
 		_sampler = std::make_shared<Sampler>(_device, _mipLevels);
 	}
 
+	//----------------------------------------//
+	//--------------- Streamed ---------------//
+	//----------------------------------------//
+	Texture::Texture(std::shared_ptr<Device> device, std::shared_ptr<CommandPool> commandPool, TextureData::Format format, VkExtent2D size):
+		_device(device), _commandPool(commandPool), _arrayLayers(1), _editable(true)// Locked while the streamer runs the loaded callbacks
+	{
+		_width = size.width;
+		_height = size.height;
+		_mipLevels = TextureData::qtyMipLevels(_width, _height);
+		_size = TextureData::levelSize(format, _width, _height);
+
+		// HDR textures are also used as storage images by the texture processes
+		VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		if(format == TextureData::FORMAT_RGBA32F)
+			usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+
+		VkFormat vulkanFormat = toVulkan(format);
+		_image = std::make_shared<Image>(_device, _width, _height, vulkanFormat, VK_IMAGE_TILING_OPTIMAL, usage,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _mipLevels);
+
+		//---------- Placeholder ----------//
+		// Same tile copied over every mip level (clear commands can not be used with compressed formats)
+		const uint32_t tileSize = 128;
+		const uint8_t color[4] = {128, 128, 128, 255};
+		std::vector<uint8_t> tile = TextureImporter::createPlaceholderTile(format, tileSize, color);
+		StagingBuffer* stagingBuffer = new StagingBuffer(_device, tile.data(), tile.size());
+
+		std::vector<VkBufferImageCopy> regions;
+		TextureData layout;
+		layout.setLayout(format, _width, _height);
+		for(uint32_t level=0; level<layout.levels.size(); level++)
+			for(uint32_t y=0; y<layout.levels[level].height; y+=tileSize)
+				for(uint32_t x=0; x<layout.levels[level].width; x+=tileSize)
+				{
+					VkBufferImageCopy region{};
+					region.bufferOffset = 0;
+					region.bufferRowLength = tileSize;
+					region.bufferImageHeight = tileSize;
+					region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+					region.imageSubresource.mipLevel = level;
+					region.imageSubresource.baseArrayLayer = 0;
+					region.imageSubresource.layerCount = 1;
+					region.imageOffset = {int32_t(x), int32_t(y), 0};
+					region.imageExtent = {
+						std::min(tileSize, layout.levels[level].width-x),
+						std::min(tileSize, layout.levels[level].height-y),
+						1
+					};
+					regions.push_back(region);
+				}
+		copyLevels(_commandPool, stagingBuffer->handle(), regions);
+
+		delete stagingBuffer;
+		stagingBuffer = nullptr;
+
+		_imageView = std::make_shared<ImageView>(_device, _image->handle(), vulkanFormat, VK_IMAGE_ASPECT_COLOR_BIT, _mipLevels);
+		_sampler = std::make_shared<Sampler>(_device, _mipLevels);
+	}
+
 	//----------------------------------------//
 	//------------- Update image -------------//
 	//----------------------------------------//
@@ -230,6 +290,159 @@ namespace atta::vk
 	{
 	}
 
+	void Texture::recordUploadLevels(VkCommandBuffer commandBuffer, VkBuffer buffer, const TextureData& data, uint32_t srcQueueFamily, uint32_t dstQueueFamily)
+	{
+		std::vector<VkBufferImageCopy> regions;
+		for(uint32_t level=0; level<data.levels.size() && level<_mipLevels; level++)
+		{
+			VkBufferImageCopy region{};
+			region.bufferOffset = data.levels[level].offset;
+			region.bufferRowLength = 0;
+			region.bufferImageHeight = 0;
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = level;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+			region.imageOffset = {0, 0, 0};
+			region.imageExtent = {data.levels[level].width, data.levels[level].height, 1};
+			regions.push_back(region);
+		}
+
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = _image->handle();
+		barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, _mipLevels, 0, _arrayLayers};
+
+		// The content is discarded, so the image does not need to be acquired from the graphics queue family
+		// (the previous reads are waited by the semaphores of the submission)
+		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+			0, nullptr,
+			0, nullptr,
+			1, &barrier);
+
+		vkCmdCopyBufferToImage(commandBuffer, buffer, _image->handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regions.size(), regions.data());
+
+		// Release (same layout transition as the acquire)
+		barrier.srcQueueFamilyIndex = srcQueueFamily;
+		barrier.dstQueueFamilyIndex = dstQueueFamily;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = 0;
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+			0, nullptr,
+			0, nullptr,
+			1, &barrier);
+		_image->setImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}
+
+	void Texture::recordAcquire(VkCommandBuffer commandBuffer, uint32_t srcQueueFamily, uint32_t dstQueueFamily)
+	{
+		if(srcQueueFamily == dstQueueFamily)
+		{
+			// No ownership transfer, the layout was already transitioned by the copy command buffer
+			VkMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer,
+				VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+				1, &barrier,
+				0, nullptr,
+				0, nullptr);
+			return;
+		}
+
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcQueueFamilyIndex = srcQueueFamily;
+		barrier.dstQueueFamilyIndex = dstQueueFamily;
+		barrier.image = _image->handle();
+		barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, _mipLevels, 0, _arrayLayers};
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		// All stages: the later submissions of this queue can not sample the texture before the acquire
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+			0, nullptr,
+			0, nullptr,
+			1, &barrier);
+	}
+
+	void Texture::updateRegions(std::shared_ptr<CommandPool> commandPool, VkBuffer buffer, const std::vector<VkBufferImageCopy>& regions)
+	{
+		copyLevels(commandPool, buffer, regions, true);
+	}
+
+	void Texture::copyLevels(std::shared_ptr<CommandPool> commandPool, VkBuffer buffer, const std::vector<VkBufferImageCopy>& regions, bool keepContent)
+	{
+		VkImageSubresourceRange subresourceRange;
+		subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		subresourceRange.baseMipLevel = 0;
+		subresourceRange.levelCount = _mipLevels;
+		subresourceRange.baseArrayLayer = 0;
+		subresourceRange.layerCount = _arrayLayers;
+
+		// The copy is waited before returning (single time commands)
+		VkCommandBuffer commandBuffer = commandPool->beginSingleTimeCommands();
+		{
+			VkImageMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = _image->handle();
+			barrier.subresourceRange = subresourceRange;
+
+			// Previous content is discarded when all levels are replaced
+			barrier.oldLayout = keepContent ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(commandBuffer,
+				// Kept content: wait for the previous frames sampling it (graphics queue)
+				keepContent ? VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+				0, nullptr,
+				0, nullptr,
+				1, &barrier);
+
+			vkCmdCopyBufferToImage(commandBuffer, buffer, _image->handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regions.size(), regions.data());
+
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = 0;
+			vkCmdPipelineBarrier(commandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+				0, nullptr,
+				0, nullptr,
+				1, &barrier);
+		}
+		commandPool->endSingleTimeCommands(commandBuffer);
+		_image->setImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}
+
+	VkFormat Texture::toVulkan(TextureData::Format format)
+	{
+		switch(format)
+		{
+			case TextureData::FORMAT_RGBA8_SRGB: return VK_FORMAT_R8G8B8A8_SRGB;
+			case TextureData::FORMAT_BC1_SRGB: return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+			case TextureData::FORMAT_BC3_SRGB: return VK_FORMAT_BC3_SRGB_BLOCK;
+			case TextureData::FORMAT_RGBA32F: return VK_FORMAT_R32G32B32A32_SFLOAT;
+			default: return VK_FORMAT_UNDEFINED;
+		}
+	}
+
 	void Texture::transitionImageLayout(VkImageLayout newLayout)
 	{
 		// TODO also being used in depth buffer
@@ -0,0 +1,344 @@
+//--------------------------------------------------
+// Atta Graphics
+// textureStreamer.cpp
+// Date: 2021-07-18
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/graphics/vulkan/textureStreamer.h>
+#include <atta/graphics/core/textureImporter.h>
+#include <atta/helpers/log.h>
+#include <algorithm>
+#include <cstring>
+
+namespace atta::vk
+{
+	TextureStreamer::TextureStreamer(CreateInfo info):
+		_device(info.device), _stop(false), _stagingSize(0)
+	{
+		_compress = _device->getPhysicalDevice()->getSupport().textureCompressionBCFeature;
+
+		//---------- Upload synchronization ----------//
+		QueueFamilyIndices indices = _device->getPhysicalDevice()->getQueueFamilyIndices();
+		_graphicsFamily = indices.graphicsFamily.value();
+		_transferFamily = indices.transferFamily.value();
+		_transferCommandPool = std::make_shared<CommandPool>(_device, CommandPool::DEVICE_QUEUE_FAMILY_TRANSFER, CommandPool::QUEUE_THREAD_MANAGER, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+		_guiCommandPool = std::make_shared<CommandPool>(_device, CommandPool::DEVICE_QUEUE_FAMILY_GRAPHICS, CommandPool::QUEUE_GUI, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+		_graphicsCommandPool = std::make_shared<CommandPool>(_device, CommandPool::DEVICE_QUEUE_FAMILY_GRAPHICS, CommandPool::QUEUE_THREAD_MANAGER);
+		_transferCommandBuffer = createCommandBuffer(_transferCommandPool);
+		_guiCommandBuffer = createCommandBuffer(_guiCommandPool);
+		_guiBarrier = createCommandBuffer(_guiCommandPool);
+		_graphicsBarrier = createCommandBuffer(_graphicsCommandPool);
+
+		// The barriers only order the work submitted before and after them, they are recorded once
+		for(VkCommandBuffer commandBuffer : {_guiBarrier, _graphicsBarrier})
+		{
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+			vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+			VkMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer,
+				VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+				1, &barrier,
+				0, nullptr,
+				0, nullptr);
+			vkEndCommandBuffer(commandBuffer);
+		}
+
+		_guiIdle = std::make_unique<Semaphore>(_device);
+		_graphicsIdle = std::make_unique<Semaphore>(_device);
+		_uploaded = std::make_unique<Semaphore>(_device);
+		_acquired = std::make_unique<Semaphore>(_device);
+		_guiFence = std::make_unique<Fence>(_device);
+		_graphicsFence = std::make_unique<Fence>(_device);
+
+		//---------- Threads ----------//
+		unsigned qtyDecodeThreads = info.qtyDecodeThreads;
+		if(qtyDecodeThreads == 0)
+			qtyDecodeThreads = std::max(std::thread::hardware_concurrency(), 2u)-1;
+		for(unsigned i=0; i<qtyDecodeThreads; i++)
+			_decodeThreads.emplace_back(&TextureStreamer::decodeThread, this);
+		_uploadThread = std::thread(&TextureStreamer::uploadThread, this);
+	}
+
+	TextureStreamer::~TextureStreamer()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stop = true;
+		}
+		_decodeCv.notify_all();
+		_uploadCv.notify_all();
+		for(auto& thread : _decodeThreads)
+			thread.join();
+		_uploadThread.join();// The current upload is waited by the upload thread
+
+		// Cancel the jobs that were not uploaded (the placeholder is kept)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_decodeJobs.clear();
+			_uploadJobs.clear();
+			_callbacks.clear();
+			_streaming.clear();
+		}
+		_idleCv.notify_all();
+	}
+
+	std::shared_ptr<Texture> TextureStreamer::load(std::shared_ptr<CommandPool> commandPool, const std::string& fileName)
+	{
+		// Only the file header is read here
+		TextureData::Format format;
+		uint32_t width, height;
+		if(!TextureImporter::readInfo(fileName, _compress, format, width, height))
+		{
+			Log::error("TextureStreamer", "Failed to load texture image! (Path: [w]$0[])", fileName);
+			exit(1);
+		}
+
+		std::shared_ptr<Texture> texture = std::make_shared<Texture>(_device, commandPool, format, (VkExtent2D){width, height});
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_decodeJobs.push_back({texture, fileName, format, {}});
+			_streaming.insert(texture.get());
+		}
+		_decodeCv.notify_one();
+		return texture;
+	}
+
+	void TextureStreamer::addLoadedCallback(std::shared_ptr<Texture> texture, std::function<void()> callback)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if(_streaming.find(texture.get()) != _streaming.end())
+			{
+				_callbacks[texture.get()].push_back(callback);
+				return;
+			}
+		}
+		callback();
+	}
+
+	void TextureStreamer::waitIdle()
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_idleCv.wait(lock, [this]{ return _streaming.empty(); });
+	}
+
+	void TextureStreamer::decodeThread()
+	{
+		while(true)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_decodeCv.wait(lock, [this]{ return _stop || !_decodeJobs.empty(); });
+				if(_stop)
+					return;
+				job = std::move(_decodeJobs.front());
+				_decodeJobs.pop_front();
+			}
+
+			if(TextureCache::load(job.fileName, job.format, job.data))
+				Log::verbose("TextureStreamer", "$0 loaded from cache: $1 x $2", job.fileName, job.data.width, job.data.height);
+			else
+			{
+				std::string error;
+				if(TextureImporter::import(job.fileName, _compress, job.data, error))
+				{
+					TextureCache::save(job.fileName, job.data);
+					Log::verbose("TextureStreamer", "$0 imported: $1 x $2", job.fileName, job.data.width, job.data.height);
+				}
+				else
+				{
+					// The placeholder is kept
+					Log::warning("TextureStreamer", "Failed to import texture [w]$0[] (Error: $1)", job.fileName, error);
+					job.data = TextureData();
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_uploadJobs.push_back(std::move(job));
+			}
+			_uploadCv.notify_one();
+		}
+	}
+
+	void TextureStreamer::uploadThread()
+	{
+		while(true)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_uploadCv.wait(lock, [this]{ return _stop || !_uploadJobs.empty(); });
+				if(_stop)
+					return;
+				job = std::move(_uploadJobs.front());
+				_uploadJobs.pop_front();
+			}
+
+			upload(job);
+			_idleCv.notify_all();
+		}
+	}
+
+	void TextureStreamer::upload(Job& job)
+	{
+		// Data with other size/format (file changed after load()) is not uploaded
+		const bool valid = !job.data.levels.empty() && job.data.format == job.format &&
+			job.data.width == uint32_t(job.texture->getImage()->getExtent().width) &&
+			job.data.height == uint32_t(job.texture->getImage()->getExtent().height);
+		if(!valid)
+		{
+			finish(job);
+			return;
+		}
+
+		// The previous upload was waited, the staging buffer and command buffers can be reused
+		if(job.data.data.size() > _stagingSize)
+		{
+			_stagingBuffer.reset();
+			_stagingSize = job.data.data.size();
+			_stagingBuffer = std::make_unique<StagingBuffer>(_device, _stagingSize);
+		}
+		std::memcpy(_stagingBuffer->getData(), job.data.data.data(), job.data.data.size());
+
+		//---------- Record ----------//
+		const bool ownershipTransfer = _transferFamily != _graphicsFamily;
+		const uint32_t srcFamily = ownershipTransfer ? _transferFamily : VK_QUEUE_FAMILY_IGNORED;
+		const uint32_t dstFamily = ownershipTransfer ? _graphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		vkResetCommandBuffer(_transferCommandBuffer, 0);
+		vkBeginCommandBuffer(_transferCommandBuffer, &beginInfo);
+		job.texture->recordUploadLevels(_transferCommandBuffer, _stagingBuffer->handle(), job.data, srcFamily, dstFamily);
+		vkEndCommandBuffer(_transferCommandBuffer);
+
+		vkResetCommandBuffer(_guiCommandBuffer, 0);
+		vkBeginCommandBuffer(_guiCommandBuffer, &beginInfo);
+		job.texture->recordAcquire(_guiCommandBuffer, srcFamily, dstFamily);
+		vkEndCommandBuffer(_guiCommandBuffer);
+
+		//---------- Submit ----------//
+		VkQueue guiQueue = _device->getGraphicsQueueGUI();
+		VkQueue graphicsQueue = _device->getGraphicsQueue();
+		VkQueue transferQueue = _device->getTransferQueue();
+		const bool sameGraphicsQueue = guiQueue == graphicsQueue;
+
+		VkSemaphore idle[] = { _guiIdle->handle(), _graphicsIdle->handle() };
+		VkSemaphore uploaded = _uploaded->handle();
+		VkSemaphore acquired = _acquired->handle();
+		VkPipelineStageFlags idleStages[] = { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT };
+		VkPipelineStageFlags allStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+		_guiFence->reset();
+		if(!sameGraphicsQueue)
+			_graphicsFence->reset();
+		{
+			// Held only while submitting, no other batch of the graphics queues can be between the idle and acquire batches
+			std::scoped_lock lock(_device->getQueueMutex(guiQueue), _device->getQueueMutex(graphicsQueue), _device->getQueueMutex(transferQueue));
+
+			// Work already submitted to the graphics queues (may be sampling the placeholder) finishes before the copy
+			VkSubmitInfo submitInfo{};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &_guiBarrier;
+			submitInfo.signalSemaphoreCount = 1;
+			submitInfo.pSignalSemaphores = &idle[0];
+			vkQueueSubmit(guiQueue, 1, &submitInfo, VK_NULL_HANDLE);
+			if(!sameGraphicsQueue)
+			{
+				submitInfo.pCommandBuffers = &_graphicsBarrier;
+				submitInfo.pSignalSemaphores = &idle[1];
+				vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+			}
+
+			// Copy and release to the graphics queue family
+			submitInfo = {};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.waitSemaphoreCount = sameGraphicsQueue ? 1 : 2;
+			submitInfo.pWaitSemaphores = idle;
+			submitInfo.pWaitDstStageMask = idleStages;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &_transferCommandBuffer;
+			submitInfo.signalSemaphoreCount = 1;
+			submitInfo.pSignalSemaphores = &uploaded;
+			vkQueueSubmit(transferQueue, 1, &submitInfo, VK_NULL_HANDLE);
+
+			// Acquire on the GUI queue, the later GUI batches are ordered after it
+			submitInfo = {};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.waitSemaphoreCount = 1;
+			submitInfo.pWaitSemaphores = &uploaded;
+			submitInfo.pWaitDstStageMask = &allStages;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &_guiCommandBuffer;
+			submitInfo.signalSemaphoreCount = sameGraphicsQueue ? 0 : 1;
+			submitInfo.pSignalSemaphores = &acquired;
+			vkQueueSubmit(guiQueue, 1, &submitInfo, _guiFence->handle());
+
+			// The later thread manager batches are ordered after the acquire
+			if(!sameGraphicsQueue)
+			{
+				submitInfo = {};
+				submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+				submitInfo.waitSemaphoreCount = 1;
+				submitInfo.pWaitSemaphores = &acquired;
+				submitInfo.pWaitDstStageMask = &allStages;
+				submitInfo.commandBufferCount = 1;
+				submitInfo.pCommandBuffers = &_graphicsBarrier;
+				vkQueueSubmit(graphicsQueue, 1, &submitInfo, _graphicsFence->handle());
+			}
+		}
+
+		_guiFence->wait(UINT64_MAX);
+		if(!sameGraphicsQueue)
+			_graphicsFence->wait(UINT64_MAX);
+
+		finish(job);
+	}
+
+	void TextureStreamer::finish(Job& job)
+	{
+		std::vector<std::function<void()>> callbacks;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_streaming.erase(job.texture.get());
+			callbacks = std::move(_callbacks[job.texture.get()]);
+			_callbacks.erase(job.texture.get());
+		}
+
+		if(!callbacks.empty())
+		{
+			job.texture->lock();
+			for(auto& callback : callbacks)
+				callback();
+			job.texture->unlock();
+		}
+	}
+
+	VkCommandBuffer TextureStreamer::createCommandBuffer(std::shared_ptr<CommandPool> commandPool)
+	{
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = commandPool->handle();
+		allocInfo.commandBufferCount = 1;
+
+		VkCommandBuffer commandBuffer;
+		if(vkAllocateCommandBuffers(_device->handle(), &allocInfo, &commandBuffer) != VK_SUCCESS)
+		{
+			Log::error("TextureStreamer", "Failed to allocate command buffer!");
+			exit(1);
+		}
+		return commandBuffer;
+	}
+}
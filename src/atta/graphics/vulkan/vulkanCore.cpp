@@ -9,25 +9,30 @@
 #include <atta/helpers/drawer.h>
 #include <atta/graphics/core/model.h>
 #include <atta/graphics/core/material.h>
-#include <atta/graphics/core/objectInfo.h>
 #include <atta/graphics/vulkan/stagingBuffer.h>
 #include <atta/graphics/vulkan/compute/envIrradiance.h>
 #include <atta/objects/lights/lights.h>
 #include <queue>
+#include <algorithm>
 
 namespace atta::vk
 {
-	VulkanCore::VulkanCore()
+	VulkanCore::VulkanCore():
+		_qtyVertices(0), _vertexCapacity(0),
+		_qtyIndices(0), _indexCapacity(0),
+		_qtyMaterials(0), _materialCapacity(0)
 	{
 		_instance = std::make_shared<Instance>();
 		_debugMessenger = std::make_unique<DebugMessenger>(_instance);
 		_physicalDevice = std::make_shared<PhysicalDevice>(_instance);
 		_device = std::make_shared<Device>(_physicalDevice);
+		_textureStreamer = std::make_unique<TextureStreamer>(TextureStreamer::CreateInfo{.device = _device});
 	}
 
 	VulkanCore::~VulkanCore()
 	{
-
+		// Stop uploads before the textures are destroyed
+		_textureStreamer.reset();
 	}
 
 	void VulkanCore::createBuffers(std::shared_ptr<Scene> scene, std::shared_ptr<CommandPool> commandPool)
@@ -36,30 +41,21 @@ namespace atta::vk
 		std::vector<Vertex> vertices;
 		std::vector<uint32_t> indices;
 		std::vector<Material> materials;
-		std::vector<ObjectInfo> objectInfos;
 		std::vector<Light> lights;
 
 		// Populate vertices/indices
-		for(auto m : Model::allMeshes)
 		{
-			std::shared_ptr<Mesh> mesh = m.second.lock();
-
-			// Remember the vertex and index offsets
-			const uint32_t vertexOffset = static_cast<uint32_t>(vertices.size());
-			const uint32_t indexOffset = static_cast<uint32_t>(indices.size());
-			mesh->setVerticesOffset(vertexOffset);
-			mesh->setIndicesOffset(indexOffset);
-
-			// TODO vertex.materialIndex not supported yet
-			std::vector<Vertex> meshVertices = mesh->getVertices();
-			std::vector<uint32_t> meshIndices = mesh->getIndices();
-
-			vertices.insert(vertices.end(), meshVertices.begin(), meshVertices.end());
-			indices.insert(indices.end(), meshIndices.begin(), meshIndices.end());
+			std::lock_guard<std::mutex> lock(Model::allMeshesMutex);
+			for(auto m : Model::allMeshes)
+			{
+				std::shared_ptr<Mesh> mesh = m.second.lock();
+				if(mesh != nullptr)
+					addMesh(mesh.get(), vertices, indices);
+			}
 		}
 
-		// Populate materials/objectInfos
-		for(auto parentObject : scene->getObjects())
+		// Populate materials
+		for(auto& parentObject : scene->getObjects())
 		{
 			// Queue with object and its children
 			std::queue<std::shared_ptr<Object>> objects;
@@ -71,49 +67,19 @@ namespace atta::vk
 				objects.pop();
 
 				// Populate queue with its children
-				std::vector<std::shared_ptr<Object>> children = object->getChildren();
-				for(auto& child : children)
+				for(auto& child : object->getChildren())
 					objects.push(child);
 
 				// Get object materials and set materialOffset
-				static int materialOffset = 0;
 				std::shared_ptr<Model> model = object->getModel();
 				if(model==nullptr)
 					continue;
+				const uint32_t materialOffset = materials.size();
 				model->setMaterialOffset(materialOffset);
 
-				int qtyMaterials;
-				auto modelMaterialMap = model->getMaterials();
-				// Only one material
-				if(modelMaterialMap.count("atta::material"))
-				{
-					qtyMaterials = 1;
-					materials.push_back(modelMaterialMap["atta::material"]);
-				}
-				// Multiple materials
-				else
-				{
-					qtyMaterials = model->getMesh()->getMaterialNames().size();
-					// For each material name in the .mtl file (loaded by mesh), 
-					// try to push one material (if material with name not defined, load default material)
-					for(const auto& materialName : model->getMesh()->getMaterialNames())
-					{
-						Log::debug("VulkanCore", "Material($0): $1", materialName, modelMaterialMap[materialName].toString());
-						if(modelMaterialMap.count(materialName))
-							materials.push_back(modelMaterialMap[materialName]);
-						else
-							materials.push_back(Material::diffuse({}));
-					}
-				}
-
-				ObjectInfo obji;
-				obji.indexOffset = model->getMesh()->getIndicesOffset();
-				obji.vertexOffset = model->getMesh()->getVerticesOffset();
-				obji.materialOffset = materialOffset;
-				obji.transform = transpose(object->getModelMat());
-				objectInfos.push_back(obji);
-
-				materialOffset+=qtyMaterials;
+				std::vector<Material> modelMaterials = getModelMaterials(model.get());
+				materials.insert(materials.end(), modelMaterials.begin(), modelMaterials.end());
+				_materialRanges[model.get()] = {materialOffset, static_cast<uint32_t>(modelMaterials.size())};
 			}
 		}
 
@@ -158,19 +124,29 @@ namespace atta::vk
 		}
 
 		//---------- Create device buffers ----------//
+		// Vertices, indices and materials have free space for the objects spawned at runtime (the buffers are
+		// bound to descriptor sets and can not be recreated)
+		_qtyVertices = vertices.size();
+		_qtyIndices = indices.size();
+		_qtyMaterials = materials.size();
+		_vertexCapacity = std::max<size_t>(vertices.size()*2, minVertexCapacity);
+		_indexCapacity = std::max<size_t>(indices.size()*2, minIndexCapacity);
+		_materialCapacity = std::max<size_t>(materials.size()*2, minMaterialCapacity);
 		_vertexBuffer = createBufferMemory(commandPool,
 				VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, 
-				vertices);
+				vertices, _vertexCapacity);
 		_indexBuffer = createBufferMemory(commandPool,
 				VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, 
-				indices);
-		_materialBuffer = createBufferMemory(commandPool,VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, materials);
-		_objectInfoBuffer = createBufferMemory(commandPool,VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, objectInfos);
+				indices, _indexCapacity);
+		_materialBuffer = createBufferMemory(commandPool,VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, materials, _materialCapacity);
 		_lightBuffer = createBufferMemory(commandPool,VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, lights);
 
 		// Aux/Debug buffers
-		_lineBuffer = createBufferMemory(commandPool,VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Drawer::getLines());
-		_pointBuffer = createBufferMemory(commandPool,VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Drawer::getPoints());
+		// Filled by the Drawer (only the changed ranges are uploaded)
+		_lineBuffer = std::make_shared<Buffer>(_device, Drawer::getMaxNumberOfLines()*sizeof(Drawer::Line),
+				VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		_pointBuffer = std::make_shared<Buffer>(_device, Drawer::getMaxNumberOfPoints()*sizeof(Drawer::Point),
+				VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
 		//---------- Create textures ----------//
 		// Create main texture
@@ -180,7 +156,8 @@ namespace atta::vk
 			{
 				case atta::Texture::TYPE_FILE:
 					{
-						_textures.push_back(std::make_shared<vk::Texture>(_device, commandPool, textureInfo.fileName));
+						// Placeholder until the texture streamer uploads the file
+						_textures.push_back(_textureStreamer->load(commandPool, textureInfo.fileName));
 						textureInfo.vkTexture = _textures.back();
 					}
 					break;
@@ -204,16 +181,18 @@ namespace atta::vk
 							case atta::Texture::PROCESS_ENV_IRRADIANCE:
 								{
 									// Compute env irradiance from another texture
+									// (computed by the texture streamer thread when the input is uploaded, with its own command pool)
+									std::shared_ptr<vk::Texture> input = atta::Texture::textureInfos()[textureInfo.process.second].vkTexture.lock();
 									compute::EnvIrradiance::CreateInfo envIrrInfo {
 										.device = _device,
-										.commandPool = commandPool,
-										.input = atta::Texture::textureInfos()[textureInfo.process.second].vkTexture.lock()
+										.commandPool = std::make_shared<CommandPool>(_device),
+										.input = input
 									};
-									compute::EnvIrradiance envIrr(envIrrInfo);
-									envIrr.compute();
+									std::shared_ptr<compute::EnvIrradiance> envIrr = std::make_shared<compute::EnvIrradiance>(envIrrInfo);
+									_textureStreamer->addLoadedCallback(input, [envIrr](){ envIrr->compute(); });
 
 									// Add to textures buffer
-									_textures.push_back(envIrr.getOutput());
+									_textures.push_back(envIrr->getOutput());
 									textureInfo.vkTexture = _textures.back();
 								}
 								break;
@@ -236,17 +215,173 @@ namespace atta::vk
 		}
 	}
 
-	void VulkanCore::updateBuffers(std::shared_ptr<Scene> scene, std::shared_ptr<CommandPool> commandPool)
+	void VulkanCore::updateBuffers(const Scene::Changes& changes, std::shared_ptr<CommandPool> commandPool)
 	{
+		//---------- Release despawned materials ----------//
+		// Only reused by the next changes (the command buffers in flight may still read them)
+		std::vector<MaterialRange> releasedMaterials;
+		for(auto& object : changes.despawned)
+		{
+			auto range = _materialRanges.find(object->getModel().get());
+			if(range == _materialRanges.end())
+				continue;
+			releasedMaterials.push_back(range->second);
+			_materialRanges.erase(range);
+		}
+
+		//---------- Spawned meshes/materials ----------//
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		std::vector<Material> materials;
+		std::vector<VkBufferCopy> materialRegions;
+		for(auto& object : changes.spawned)
+		{
+			if(object->isLight())
+				Log::warning("VulkanCore", "Light [w]$0[] spawned at runtime does not illuminate the scene (lights are created at start)", object->getName());
+
+			std::shared_ptr<Model> model = object->getModel();
+			if(model==nullptr || model->getMesh()==nullptr)
+				continue;
 
+			// Meshes already uploaded are not uploaded again (even if the mesh was released and loaded again)
+			Mesh* mesh = model->getMesh().get();
+			auto meshRange = _meshRanges.find(mesh->getMeshName());
+			if(meshRange != _meshRanges.end())
+			{
+				mesh->setVerticesOffset(meshRange->second.vertexOffset);
+				mesh->setIndicesOffset(meshRange->second.indexOffset);
+				mesh->setLodIndicesOffset(meshRange->second.lodIndicesOffset);
+			}
+			else if(_qtyVertices+vertices.size()+mesh->getVerticesSize() > _vertexCapacity ||
+					_qtyIndices+indices.size()+mesh->getIndicesSize()+mesh->getLodIndices().size() > _indexCapacity)
+			{
+				// Not rendered (material offset stays -1)
+				Log::error("VulkanCore", "No space in the vertex/index buffers for the mesh [w]$0[], object [w]$1[] will not be rendered", mesh->getMeshName(), object->getName());
+				continue;
+			}
+			else
+				addMesh(mesh, vertices, indices);
+
+			std::vector<Material> modelMaterials = getModelMaterials(model.get());
+			MaterialRange materialRange;
+			if(!allocateMaterials(modelMaterials.size(), materialRange))
+			{
+				Log::error("VulkanCore", "No space in the material buffer for the object [w]$0[]", object->getName());
+				continue;
+			}
+			model->setMaterialOffset(materialRange.offset);
+			_materialRanges[model.get()] = materialRange;
+
+			VkBufferCopy region{};
+			region.srcOffset = materials.size()*sizeof(Material);
+			region.dstOffset = materialRange.offset*sizeof(Material);
+			region.size = modelMaterials.size()*sizeof(Material);
+			materialRegions.push_back(region);
+			materials.insert(materials.end(), modelMaterials.begin(), modelMaterials.end());
+		}
+
+		//---------- Upload ----------//
+		// Only the new ranges are written (not used by the command buffers in flight)
+		if(!vertices.empty())
+			writeBufferMemory(commandPool, _vertexBuffer, vertices, {{0, _qtyVertices*sizeof(Vertex), vertices.size()*sizeof(Vertex)}});
+		if(!indices.empty())
+			writeBufferMemory(commandPool, _indexBuffer, indices, {{0, _qtyIndices*sizeof(uint32_t), indices.size()*sizeof(uint32_t)}});
+		if(!materials.empty())
+			writeBufferMemory(commandPool, _materialBuffer, materials, materialRegions);
+		_qtyVertices += vertices.size();
+		_qtyIndices += indices.size();
+		_freeMaterialRanges.insert(_freeMaterialRanges.end(), releasedMaterials.begin(), releasedMaterials.end());
+	}
+
+	void VulkanCore::addMesh(Mesh* mesh, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		// Remember the vertex and index offsets
+		MeshRange range;
+		range.vertexOffset = static_cast<uint32_t>(_qtyVertices+vertices.size());
+		range.indexOffset = static_cast<uint32_t>(_qtyIndices+indices.size());
+
+		// TODO vertex.materialIndex not supported yet
+		const std::vector<Vertex>& meshVertices = mesh->getVertices();
+		const std::vector<uint32_t>& meshIndices = mesh->getIndices();
+		vertices.insert(vertices.end(), meshVertices.begin(), meshVertices.end());
+		indices.insert(indices.end(), meshIndices.begin(), meshIndices.end());
+
+		// Level of detail indices (same vertices, after the full mesh indices)
+		range.lodIndicesOffset = static_cast<uint32_t>(_qtyIndices+indices.size());
+		const std::vector<uint32_t>& lodIndices = mesh->getLodIndices();
+		indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+
+		mesh->setVerticesOffset(range.vertexOffset);
+		mesh->setIndicesOffset(range.indexOffset);
+		mesh->setLodIndicesOffset(range.lodIndicesOffset);
+		_meshRanges[mesh->getMeshName()] = range;
+	}
+
+	std::vector<Material> VulkanCore::getModelMaterials(Model* model)
+	{
+		std::vector<Material> materials;
+		auto modelMaterialMap = model->getMaterials();
+		// Only one material
+		if(modelMaterialMap.count("atta::material"))
+			materials.push_back(modelMaterialMap["atta::material"]);
+		// Multiple materials
+		else
+		{
+			// For each material name in the .mtl file (loaded by mesh), 
+			// try to push one material (if material with name not defined, load default material)
+			for(const auto& materialName : model->getMesh()->getMaterialNames())
+			{
+				Log::debug("VulkanCore", "Material($0): $1", materialName, modelMaterialMap[materialName].toString());
+				if(modelMaterialMap.count(materialName))
+					materials.push_back(modelMaterialMap[materialName]);
+				else
+					materials.push_back(Material::diffuse({}));
+			}
+		}
+		return materials;
+	}
+
+	bool VulkanCore::allocateMaterials(uint32_t qtyMaterials, MaterialRange& range)
+	{
+		// First fit in the ranges released by despawned objects
+		for(size_t i=0; i<_freeMaterialRanges.size(); i++)
+		{
+			MaterialRange& freeRange = _freeMaterialRanges[i];
+			if(freeRange.qtyMaterials < qtyMaterials)
+				continue;
+			range = {freeRange.offset, qtyMaterials};
+			freeRange.offset += qtyMaterials;
+			freeRange.qtyMaterials -= qtyMaterials;
+			if(freeRange.qtyMaterials == 0)
+			{
+				freeRange = _freeMaterialRanges.back();
+				_freeMaterialRanges.pop_back();
+			}
+			return true;
+		}
+
+		if(_qtyMaterials+qtyMaterials > _materialCapacity)
+			return false;
+		range = {static_cast<uint32_t>(_qtyMaterials), qtyMaterials};
+		_qtyMaterials += qtyMaterials;
+		return true;
+	}
+
+	template <class T>
+	void VulkanCore::writeBufferMemory(std::shared_ptr<CommandPool> commandPool, std::shared_ptr<Buffer> buffer,
+			std::vector<T>& content, const std::vector<VkBufferCopy>& regions)
+	{
+		StagingBuffer stagingBuffer(_device, content.data(), sizeof(T)*content.size());
+		buffer->copyFrom(commandPool, stagingBuffer.handle(), regions);
 	}
 
 	template <class T>
 	std::shared_ptr<Buffer> VulkanCore::createBufferMemory(std::shared_ptr<CommandPool> commandPool,
 			const VkBufferUsageFlags usage, 
-			std::vector<T>& content)
+			std::vector<T>& content, size_t capacity)
 	{
 		int size = sizeof(T) * content.size();
+		const size_t bufferSize = std::max(sizeof(T)*std::max(capacity, content.size()), sizeof(T));
 
 		VkMemoryAllocateFlags allocateFlags = 0;
 		if(usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
@@ -255,7 +390,7 @@ namespace atta::vk
 		// Create buffer (local memory)
 		std::shared_ptr<Buffer> buffer = std::make_shared<Buffer>(
 				_device, 
-				size!=0?size:sizeof(T), 
+				bufferSize, 
 				VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, 
 				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 				allocateFlags);
@@ -7,86 +7,233 @@
 #include <atta/helpers/drawer.h>
 #include <atta/helpers/log.h>
 #include <atta/graphics/vulkan/stagingBuffer.h>
+#include <algorithm>
 
 namespace atta
 {
 	// Core impl
+	Drawer::GroupHandle Drawer::createGroupImpl(std::string name)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for(GroupHandle i=0; i<_groups.size(); i++)
+			if(_groups[i].name == name)
+				return i;
+		_groups.emplace_back();
+		_groups.back().name = name;
+		return _groups.size()-1;
+	}
+
 	void Drawer::clearImpl()
 	{
-		//Log::debug("Drawer", "Clear");
-		_currNumberOfLines = 0;
-		_currNumberOfPoints = 0;
-		_lineGroups.clear();
-		_linesChanged = true;
+		ThreadBuffer& buffer = getThreadBuffer();
+		for(auto& lines : buffer.lines)
+			lines.clear();
+		for(auto& points : buffer.points)
+			points.clear();
+		buffer.clearedGroups.clear();
+		buffer.clearAll = true;
 	}
 
-	void Drawer::updateBufferMemoryImpl(std::shared_ptr<vk::VulkanCore> vkCore, std::shared_ptr<vk::CommandPool> commandPool)
+	void Drawer::clearGroupImpl(GroupHandle group)
 	{
-		// Update point buffer
-		if(_currNumberOfPoints>0)
-		{
-			size_t size = _currNumberOfPoints*sizeof(Drawer::Point);
-			std::shared_ptr<vk::StagingBuffer> stagingBuffer = std::make_shared<vk::StagingBuffer>(vkCore->getDevice(), _points.data(), size);
-			vkCore->getPointBuffer()->copyFrom(commandPool, stagingBuffer->handle(), size);
-			_currNumberOfPointsMemory = _currNumberOfPoints;
-		}
+		ThreadBuffer& buffer = getThreadBuffer();
+		if(group < buffer.lines.size())
+			buffer.lines[group].clear();
+		if(group < buffer.points.size())
+			buffer.points[group].clear();
+		buffer.clearedGroups.push_back(group);
+	}
 
-		// Update line buffer
-		if(_currNumberOfLines>0 && _linesChanged)
+	Drawer::ThreadBuffer& Drawer::getThreadBuffer()
+	{
+		// Registered once per thread, after that adding data does not need synchronization
+		// (the thread local owner marks the buffer when the thread exits, its data is still merged)
+		struct Owner
+		{
+			ThreadBuffer* buffer = nullptr;
+			~Owner()
+			{
+				if(buffer == nullptr)
+					return;
+				Drawer& drawer = Drawer::get();
+				std::lock_guard<std::mutex> lock(drawer._mutex);
+				buffer->exited = true;
+			}
+		};
+		thread_local Owner owner;
+		if(owner.buffer == nullptr)
 		{
-			_lines.clear();
-			for(auto& lineGroup : _lineGroups)
-				_lines.insert(_lines.end(), lineGroup.second.begin(), lineGroup.second.end());
-
-			size_t size = _currNumberOfLines*sizeof(Drawer::Line);
-			std::shared_ptr<vk::StagingBuffer> stagingBuffer = std::make_shared<vk::StagingBuffer>(vkCore->getDevice(), _lines.data(), size);
-			vkCore->getLineBuffer()->copyFrom(commandPool, stagingBuffer->handle(), size);
-			_currNumberOfLinesMemory = _currNumberOfLines;
+			std::lock_guard<std::mutex> lock(_mutex);
+			_threadBuffers.push_back(std::make_unique<ThreadBuffer>());
+			owner.buffer = _threadBuffers.back().get();
 		}
+		return *owner.buffer;
 	}
 
-	// Line impl
-	void Drawer::addLineImpl(Line line)
+	bool Drawer::mergeThreadBuffers()
 	{
-		if(_currNumberOfLines<_maxNumberOfLines)
+		bool changed = false;
+		auto clearGroup = [&](Group& group)
+		{
+			if(!group.lines.empty())
+			{
+				group.lines.clear();
+				group.linesChanged = changed = true;
+			}
+			if(!group.points.empty())
+			{
+				group.points.clear();
+				group.pointsChanged = changed = true;
+			}
+		};
+
+		// Clear before appending the data of this frame
+		for(auto& buffer : _threadBuffers)
 		{
-			//_lines[_currNumberOfLines] = line;
-			_lineGroups["atta"].push_back(line);
-			_currNumberOfLines++;
-			_linesChanged = true;
+			if(buffer->clearAll)
+				for(Group& group : _groups)
+					clearGroup(group);
+			for(GroupHandle handle : buffer->clearedGroups)
+				if(handle < _groups.size())
+					clearGroup(_groups[handle]);
+			buffer->clearAll = false;
+			buffer->clearedGroups.clear();
 		}
-		else
+
+		auto append = [&](auto& dst, auto& src, bool& groupChanged)
+		{
+			// Swap when possible, the thread buffer reuses the old capacity
+			if(dst.empty())
+				dst.swap(src);
+			else
+				dst.insert(dst.end(), src.begin(), src.end());
+			src.clear();
+			groupChanged = changed = true;
+		};
+
+		for(auto& buffer : _threadBuffers)
 		{
-			Log::debug("Drawer", "Maximum number of lines reached! Not drawing new ones.");
+			for(GroupHandle handle=0; handle<buffer->lines.size(); handle++)
+				if(!buffer->lines[handle].empty())
+				{
+					if(handle < _groups.size())
+						append(_groups[handle].lines, buffer->lines[handle], _groups[handle].linesChanged);
+					else
+					{
+						Log::warning("Drawer", "Invalid group handle $0", handle);
+						buffer->lines[handle].clear();
+					}
+				}
+			for(GroupHandle handle=0; handle<buffer->points.size(); handle++)
+				if(!buffer->points[handle].empty())
+				{
+					if(handle < _groups.size())
+						append(_groups[handle].points, buffer->points[handle], _groups[handle].pointsChanged);
+					else
+					{
+						Log::warning("Drawer", "Invalid group handle $0", handle);
+						buffer->points[handle].clear();
+					}
+				}
 		}
+
+		// Buffers of threads that exited are not used anymore
+		_threadBuffers.erase(std::remove_if(_threadBuffers.begin(), _threadBuffers.end(),
+					[](const std::unique_ptr<ThreadBuffer>& buffer){ return buffer->exited; }), _threadBuffers.end());
+		return changed;
 	}
 
-	void Drawer::addLineImpl(std::string group, Line line)
+	template <typename T>
+	std::vector<VkBufferCopy> Drawer::stageGroups(std::vector<T> Group::*data, bool Group::*changed, unsigned Group::*offset,
+			unsigned maxNumber, unsigned& currNumber, Staging& staging, std::shared_ptr<vk::Device> device)
 	{
-		if(_currNumberOfLines<_maxNumberOfLines)
+		// Groups are contiguous in the device buffer, a group is uploaded if it changed or was moved
+		size_t stagingSize = 0;
+		size_t requested = 0;
+		unsigned total = 0;
+		for(Group& group : _groups)
 		{
-			_lineGroups[group].push_back(line);
-			_currNumberOfLines++;
-			_linesChanged = true;
+			const unsigned qty = std::min<size_t>((group.*data).size(), maxNumber-total);
+			if(group.*changed || group.*offset != total)
+				stagingSize += qty*sizeof(T);
+			total += qty;
+			requested += (group.*data).size();
 		}
-		else
+		if(requested > maxNumber)
+			Log::debug("Drawer", "Maximum number of elements reached ($0)! Not drawing new ones.", maxNumber);
+
+		std::vector<VkBufferCopy> regions;
+		if(stagingSize > staging.size)
 		{
-			Log::debug("Drawer", "Maximum number of lines reached! Not drawing new ones.");
+			staging.size = std::max(stagingSize, staging.size*2);
+			staging.buffer = std::make_shared<vk::StagingBuffer>(device, staging.size);
+			staging.data = staging.buffer->getData();
 		}
+
+		size_t stagingOffset = 0;
+		total = 0;
+		for(Group& group : _groups)
+		{
+			const unsigned qty = std::min<size_t>((group.*data).size(), maxNumber-total);
+			if((group.*changed || group.*offset != total) && qty > 0)
+			{
+				VkBufferCopy region{};
+				region.srcOffset = stagingOffset;
+				region.dstOffset = total*sizeof(T);
+				region.size = qty*sizeof(T);
+				memcpy((uint8_t*)staging.data + stagingOffset, (group.*data).data(), region.size);
+				regions.push_back(region);
+				stagingOffset += region.size;
+			}
+			group.*changed = false;
+			group.*offset = total;
+			total += qty;
+		}
+		currNumber = total;
+		return regions;
+	}
+
+	void Drawer::updateBufferMemoryImpl(std::shared_ptr<vk::VulkanCore> vkCore, std::shared_ptr<vk::CommandPool> commandPool)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(!mergeThreadBuffers())
+			return;
+
+		std::vector<VkBufferCopy> lineRegions = stageGroups(&Group::lines, &Group::linesChanged, &Group::lineOffset,
+				_maxNumberOfLines, _currNumberOfLinesMemory, _lineStaging, vkCore->getDevice());
+		if(!lineRegions.empty())
+			vkCore->getLineBuffer()->copyFrom(commandPool, _lineStaging.buffer->handle(), lineRegions);
+
+		std::vector<VkBufferCopy> pointRegions = stageGroups(&Group::points, &Group::pointsChanged, &Group::pointOffset,
+				_maxNumberOfPoints, _currNumberOfPointsMemory, _pointStaging, vkCore->getDevice());
+		if(!pointRegions.empty())
+			vkCore->getPointBuffer()->copyFrom(commandPool, _pointStaging.buffer->handle(), pointRegions);
+	}
+
+	// Line impl
+	void Drawer::addLineImpl(GroupHandle group, Line line)
+	{
+		ThreadBuffer& buffer = getThreadBuffer();
+		if(group >= buffer.lines.size())
+			buffer.lines.resize(group+1);
+		buffer.lines[group].push_back(line);
 	}
 
 	// Point impl
-	void Drawer::addPointImpl(Point point)
+	void Drawer::addPointImpl(GroupHandle group, Point point)
 	{
-		if(_currNumberOfPoints<_maxNumberOfPoints)
-		{
-			_points[_currNumberOfPoints] = point;
-			_currNumberOfPoints++;
-		}
-		else
-		{
-			Log::debug("Drawer", "Maximum number of points reached! Not drawing new ones.");
-		}
+		ThreadBuffer& buffer = getThreadBuffer();
+		if(group >= buffer.points.size())
+			buffer.points.resize(group+1);
+		buffer.points[group].push_back(point);
+	}
+
+	void Drawer::addPointsImpl(GroupHandle group, const std::vector<Point>& points)
+	{
+		ThreadBuffer& buffer = getThreadBuffer();
+		if(group >= buffer.points.size())
+			buffer.points.resize(group+1);
+		buffer.points[group].insert(buffer.points[group].end(), points.begin(), points.end());
 	}
 
 	//void Drawer::drawPhysicsShapes()
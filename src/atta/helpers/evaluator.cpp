@@ -6,41 +6,10 @@
 //--------------------------------------------------
 #include <atta/helpers/evaluator.h>
 #include <atta/helpers/log.h>
+#include <atta/helpers/profiler.h>
 
 namespace atta
 {
-	//------------------------------//
-	//---------- EVALUATOR ---------//
-	//------------------------------//
-
-	void Evaluator::reportCounterImpl(std::string name, int64_t val)
-	{
-		_counters[name]+=val;
-		//Log::debug("Eval", "counter[$0]=$1", name, _counters[name]);
-	}
-
-	void Evaluator::showReportsImpl()
-	{
-		std::string reportStr = "";
-		reportStr+="[*c]Counts:\n";
-		for(auto report : _counters)
-		{
-			std::string currReport("    [w]- [c]"+report.first+":");
-			while(currReport.size()<30)
-				currReport+=" ";
-			currReport += "[w]" + std::to_string(report.second)+"\n";
-
-			reportStr += currReport;
-		}
-
-		Log::info("Evaluator", "Report: \n"+reportStr);
-	}
-
-	void Evaluator::clearImpl()
-	{
-		_counters.clear();
-	}
-
 	//------------------------------//
 	//------- LOCAL EVALUATOR ------//
 	//------------------------------//
@@ -48,6 +17,9 @@ namespace atta
 		_description(description), _finished(false)
 	{
 		_startTime = std::chrono::high_resolution_clock::now();
+#ifdef ATTA_PROFILER
+		_profilerStart = Profiler::now();
+#endif
 	}
 
 	LocalEvaluator::~LocalEvaluator()
@@ -67,6 +39,11 @@ namespace atta
 		auto end = std::chrono::time_point_cast<std::chrono::nanoseconds>(endTime).time_since_epoch().count();
 		_duration = end-start;
 
+#ifdef ATTA_PROFILER
+		// Also shown in the profiler trace
+		const uint32_t zone = Profiler::registerZone(_description, Profiler::ZONE_TYPE_SCOPE);
+		Profiler::record(zone, _profilerStart, Profiler::now());
+#endif
 		_finished = true;
 	}
 
@@ -5,25 +5,776 @@
 // By Breno Cunha Queiroz
 //----------------------------------------
 #include <atta/helpers/log.h>
+#include <link.h>
 #include <stdio.h>
-#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
-void Log::replace(std::string& str, const std::string& oldStr, const std::string& newStr)
+namespace
 {
-	std::string::size_type pos = 0u;
-	while((pos = str.find(oldStr, pos)) != std::string::npos)
+	//---------------------------------//
+	//------------ Records ------------//
+	//---------------------------------//
+	// Record in the thread queue: [header][tag if not literal][text if not literal][arguments]
+	struct RecordHeader
 	{
-		str.replace(pos, oldStr.length(), newStr);
-		pos += newStr.length();
+		uint32_t size;// Multiple of 8 (wrapMarker -> continue from the queue start)
+		uint8_t level;
+		uint8_t tagLiteral;
+		uint8_t textLiteral;
+		uint8_t padding;
+		uint32_t tagSize;
+		uint32_t textSize;
+		uint32_t argsSize;
+		uint16_t qtyArgs;
+		uint64_t sequence;
+		uint64_t time;// Nanoseconds since epoch
+		const char* tag;
+		const char* text;
+	};
+	constexpr uint32_t wrapMarker = 0xffffffff;
+
+	// Binary log file: "ATTALOG1" followed by string and message entries
+	// String:  [uint8 BINARY_STRING][uint32 id][uint32 size][chars]
+	// Message: [uint8 BINARY_MESSAGE][uint64 sequence][uint64 time][uint8 level][uint32 tagId][uint32 textId]
+	//          [uint16 qtyArgs][uint32 argsSize][arguments (same encoding as the queue)]
+	constexpr char binaryMagic[8] = {'A','T','T','A','L','O','G','1'};
+	enum BinaryEntry : uint8_t {
+		BINARY_STRING = 1,
+		BINARY_MESSAGE = 2
+	};
+
+	const char* tagColors[] = {COLOR_BOLD_WHITE, COLOR_BOLD_BLUE, COLOR_BOLD_GREEN, COLOR_BOLD_CYAN, COLOR_BOLD_YELLOW, COLOR_BOLD_RED};
+	const char* textColors[] = {COLOR_WHITE, COLOR_BLUE, COLOR_GREEN, COLOR_CYAN, COLOR_YELLOW, COLOR_RED};
+
+	//---------------------------------//
+	//------------ Format -------------//
+	//---------------------------------//
+	// Same as Log::StringRef
+	struct TextRef
+	{
+		const char* data;
+		uint32_t size;
+		bool literal;
+	};
+
+	struct Segment
+	{
+		enum Type : uint8_t { TEXT, COLOR, DEFAULT_COLOR, ARG } type;
+		uint32_t begin;// TEXT: offset in the text, ARG: argument index
+		uint32_t size;
+		const char* color;
+	};
+
+	void parseFormat(std::string_view text, std::vector<Segment>& segments)
+	{
+		static const std::pair<const char*, const char*> colorCodes[] = {
+			{"[k]", COLOR_BLACK}, {"[r]", COLOR_RED}, {"[g]", COLOR_GREEN}, {"[y]", COLOR_YELLOW},
+			{"[b]", COLOR_BLUE}, {"[m]", COLOR_MAGENTA}, {"[c]", COLOR_CYAN}, {"[w]", COLOR_WHITE},
+			{"[*k]", COLOR_BOLD_BLACK}, {"[*r]", COLOR_BOLD_RED}, {"[*g]", COLOR_BOLD_GREEN}, {"[*y]", COLOR_BOLD_YELLOW},
+			{"[*b]", COLOR_BOLD_BLUE}, {"[*m]", COLOR_BOLD_MAGENTA}, {"[*c]", COLOR_BOLD_CYAN}, {"[*w]", COLOR_BOLD_WHITE}
+		};
+
+		segments.clear();
+		size_t textBegin = 0;
+		auto flushText = [&](size_t end)
+		{
+			if(end > textBegin)
+				segments.push_back({Segment::TEXT, uint32_t(textBegin), uint32_t(end-textBegin), nullptr});
+		};
+
+		for(size_t i=0; i<text.size(); i++)
+		{
+			if(text[i] == '[')
+			{
+				if(text.substr(i, 2) == "[]")
+				{
+					flushText(i);
+					segments.push_back({Segment::DEFAULT_COLOR, 0, 0, nullptr});
+					textBegin = i+2;
+					i++;
+					continue;
+				}
+				for(const auto& code : colorCodes)
+					if(text.substr(i, std::char_traits<char>::length(code.first)) == code.first)
+					{
+						flushText(i);
+						segments.push_back({Segment::COLOR, 0, 0, code.second});
+						i += std::char_traits<char>::length(code.first)-1;
+						textBegin = i+1;
+						break;
+					}
+			}
+			else if(text[i] == '$' && i+1 < text.size() && text[i+1] >= '0' && text[i+1] <= '9')
+			{
+				flushText(i);
+				uint32_t index = 0;
+				size_t j = i+1;
+				for(; j < text.size() && text[j] >= '0' && text[j] <= '9'; j++)
+					index = index*10 + (text[j]-'0');
+				segments.push_back({Segment::ARG, index, 0, nullptr});
+				i = j-1;
+				textBegin = j;
+			}
+		}
+		flushText(text.size());
+	}
+
+	// Append "[tag] text" with the arguments replaced
+	void formatMessage(std::string& out, uint8_t level, std::string_view tag, std::string_view text,
+			const std::vector<Segment>& segments, const uint8_t* args, uint16_t qtyArgs)
+	{
+		const char* textColor = textColors[std::min<uint8_t>(level, Log::LOG_LEVEL_ERROR)];
+		out += tagColors[std::min<uint8_t>(level, Log::LOG_LEVEL_ERROR)];
+		out += '[';
+		out += tag;
+		out += "] ";
+		out += textColor;
+
+		// Argument positions
+		const uint8_t* argPtrs[64];
+		const uint16_t qtyIndexed = std::min<uint16_t>(qtyArgs, 64);
+		for(uint16_t i=0; i<qtyIndexed; i++)
+		{
+			argPtrs[i] = args;
+			if(*args == 3)// ARG_TYPE_STRING
+			{
+				uint32_t size;
+				std::memcpy(&size, args+1, 4);
+				args += 1+4+size;
+			}
+			else
+				args += 1+8;
+		}
+
+		for(const Segment& s : segments)
+		{
+			switch(s.type)
+			{
+				case Segment::TEXT:
+					out += text.substr(s.begin, s.size);
+					break;
+				case Segment::COLOR:
+					out += s.color;
+					break;
+				case Segment::DEFAULT_COLOR:
+					out += textColor;
+					break;
+				case Segment::ARG:
+					{
+						if(s.begin >= qtyIndexed)
+						{
+							out += '$';
+							out += std::to_string(s.begin);
+							break;
+						}
+						const uint8_t* arg = argPtrs[s.begin];
+						int64_t i;
+						uint64_t u;
+						double d;
+						uint32_t size;
+						switch(arg[0])
+						{
+							case 0: std::memcpy(&i, arg+1, 8); out += std::to_string(i); break;
+							case 1: std::memcpy(&u, arg+1, 8); out += std::to_string(u); break;
+							case 2: std::memcpy(&d, arg+1, 8); out += std::to_string(d); break;
+							default:
+								std::memcpy(&size, arg+1, 4);
+								out.append(reinterpret_cast<const char*>(arg+5), size);
+						}
+					}
+					break;
+			}
+		}
+		out += COLOR_RESET;
+		out += '\n';
+	}
+
+	//---------------------------------//
+	//------------ Queue --------------//
+	//---------------------------------//
+	// Single producer (owner thread) single consumer (writer thread) byte queue
+	class LogQueue
+	{
+		public:
+			static constexpr size_t capacity = 1<<20;
+
+			LogQueue(): _data(new uint8_t[capacity]), _head(0), _tail(0), _reserved(0), _reservedSize(0), _retired(false) {}
+
+			uint8_t* reserve(size_t size)
+			{
+				const uint64_t head = _head.load(std::memory_order_relaxed);
+				const uint64_t tail = _tail.load(std::memory_order_acquire);
+				const size_t offset = head%capacity;
+				const size_t skip = offset+size > capacity ? capacity-offset : 0;
+				if(head+skip+size-tail > capacity)
+					return nullptr;
+				if(skip)
+					std::memcpy(_data.get()+offset, &wrapMarker, 4);
+				_reserved = head+skip;
+				_reservedSize = size;
+				return _data.get() + _reserved%capacity;
+			}
+			void commit() { _head.store(_reserved+_reservedSize, std::memory_order_release); }
+			// Owner thread exited (no more records, released after the writer consumes the remaining ones)
+			void retire() { _retired.store(true, std::memory_order_release); }
+
+			// Consumer
+			uint64_t getHead() const { return _head.load(std::memory_order_acquire); }
+			uint64_t getTail() const { return _tail.load(std::memory_order_relaxed); }
+			void setTail(uint64_t tail) { _tail.store(tail, std::memory_order_release); }
+			const uint8_t* at(uint64_t position) const { return _data.get() + position%capacity; }
+			bool getRetired() const { return _retired.load(std::memory_order_acquire); }
+
+		private:
+			std::unique_ptr<uint8_t[]> _data;
+			alignas(64) std::atomic<uint64_t> _head;
+			alignas(64) std::atomic<uint64_t> _tail;
+			uint64_t _reserved;
+			uint64_t _reservedSize;
+			std::atomic<bool> _retired;
+	};
+
+	//---------------------------------//
+	//----------- Backend -------------//
+	//---------------------------------//
+	class LogBackend
+	{
+		public:
+			// Never destroyed (objects may log in their destructors), stopped by atexit
+			static LogBackend& get()
+			{
+				static LogBackend* backend = new LogBackend();
+				return *backend;
+			}
+
+			uint8_t* beginRecord(Log::LogLevel level, TextRef tag, TextRef text, uint16_t qtyArgs, size_t argsSize);
+			void endRecord();
+			void flush();
+			void setTerminalOutput(bool enabled) { _terminalOutput = enabled; }
+			bool setBinaryFile(std::string fileName);
+
+		private:
+			struct Pending
+			{
+				const RecordHeader* header;
+				const uint8_t* data;
+			};
+
+			LogBackend();
+			LogQueue* getQueue();
+			void threadLoop();
+			// Write all committed records (called by the writer thread, or by the exit handler after it stopped)
+			size_t writeRecords();
+			void writeRecord(const RecordHeader& header, const uint8_t* data);
+			void writeBinary(const RecordHeader& header, const uint8_t* data);
+			uint32_t binaryString(const char* str, uint32_t size, bool literal);
+			static void shutdown();
+
+			std::atomic<uint64_t> _sequence;
+			std::atomic<uint64_t> _qtyWritten;
+			std::atomic<uint64_t> _qtyDropped;
+			std::atomic<bool> _stopped;
+			std::atomic<bool> _terminalOutput;
+
+			std::mutex _queuesMutex;
+			std::vector<std::unique_ptr<LogQueue>> _queues;
+
+			// Writer thread
+			std::thread _thread;
+			std::mutex _writeMutex;
+			std::condition_variable _writeCv;
+			std::atomic<bool> _sleeping;// Writer waiting for records, producers notify it
+			bool _shouldFinish;
+			std::vector<Pending> _pending;
+			std::vector<std::pair<LogQueue*, uint64_t>> _consumed;
+			std::unordered_map<const char*, std::vector<Segment>> _formats;
+			std::vector<Segment> _segments;
+			std::string _output;
+
+			// Binary file
+			std::ofstream _binaryFile;
+			std::unordered_map<const char*, uint32_t> _binaryIds;
+			uint32_t _nextBinaryId;
+			std::string _binaryBuffer;
+
+			// Records written by the calling thread (locked from beginRecord to endRecord)
+			std::mutex _syncMutex;
+			std::vector<uint8_t> _syncRecord;
+	};
+
+	// Only trivially destructible thread_locals are used by the log calls (objects may log in their destructors)
+	thread_local LogQueue* threadQueue = nullptr;
+	thread_local bool threadExited = false;
+	thread_local bool syncPending = false;
+
+	// Retire the thread queue when the thread exits
+	struct QueueOwner
+	{
+		~QueueOwner()
+		{
+			if(threadQueue != nullptr)
+				threadQueue->retire();
+			threadQueue = nullptr;
+			threadExited = true;
+		}
+	};
+	thread_local QueueOwner queueOwner;
+
+	LogBackend::LogBackend():
+		_sequence(0), _qtyWritten(0), _qtyDropped(0), _stopped(false), _terminalOutput(true),
+		_sleeping(false), _shouldFinish(false), _nextBinaryId(0)
+	{
+		_thread = std::thread([this](){ threadLoop(); });
+		std::atexit(shutdown);
+	}
+
+	LogQueue* LogBackend::getQueue()
+	{
+		if(threadQueue == nullptr)
+		{
+			(void)&queueOwner;// Constructed on first use, retires the queue at thread exit
+			std::lock_guard<std::mutex> lock(_queuesMutex);
+			_queues.push_back(std::make_unique<LogQueue>());
+			threadQueue = _queues.back().get();
+		}
+		return threadQueue;
+	}
+
+	uint8_t* LogBackend::beginRecord(Log::LogLevel level, TextRef tag, TextRef text, uint16_t qtyArgs, size_t argsSize)
+	{
+		size_t size = sizeof(RecordHeader) + argsSize;
+		if(!tag.literal) size += tag.size;
+		if(!text.literal) size += text.size;
+		size = (size+7) & ~size_t(7);
+
+		const bool queued = !_stopped.load(std::memory_order_relaxed) && !threadExited;
+		uint8_t* record = queued && size <= LogQueue::capacity/4 ? getQueue()->reserve(size) : nullptr;
+		if(record == nullptr)
+		{
+			// Errors are never dropped, they are written by this thread when the queue is full
+			if(queued && level != Log::LOG_LEVEL_ERROR)
+			{
+				_qtyDropped.fetch_add(1, std::memory_order_relaxed);
+				return nullptr;
+			}
+			_syncMutex.lock();
+			_syncRecord.resize(size);
+			record = _syncRecord.data();
+			syncPending = true;
+		}
+
+		RecordHeader header;
+		header.size = size;
+		header.level = level;
+		header.tagLiteral = tag.literal;
+		header.textLiteral = text.literal;
+		header.padding = 0;
+		header.tagSize = tag.size;
+		header.textSize = text.size;
+		header.argsSize = argsSize;
+		header.qtyArgs = qtyArgs;
+		header.sequence = _sequence.fetch_add(1, std::memory_order_relaxed);
+		header.time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		header.tag = tag.literal ? tag.data : nullptr;
+		header.text = text.literal ? text.data : nullptr;
+		std::memcpy(record, &header, sizeof(RecordHeader));
+
+		uint8_t* dst = record + sizeof(RecordHeader);
+		if(!tag.literal)
+		{
+			std::memcpy(dst, tag.data, tag.size);
+			dst += tag.size;
+		}
+		if(!text.literal)
+		{
+			std::memcpy(dst, text.data, text.size);
+			dst += text.size;
+		}
+		return dst;
+	}
+
+	void LogBackend::endRecord()
+	{
+		if(syncPending)
+		{
+			// Write now, after the records already in the queues
+			syncPending = false;
+			RecordHeader header;
+			std::memcpy(&header, _syncRecord.data(), sizeof(RecordHeader));
+			{
+				std::lock_guard<std::mutex> lock(_writeMutex);
+				writeRecords();
+				_output.clear();
+				writeRecord(header, _syncRecord.data());
+				fwrite(_output.data(), 1, _output.size(), stdout);
+				fflush(stdout);
+				_qtyWritten.fetch_add(1, std::memory_order_release);
+				if(_binaryFile.is_open())
+				{
+					_binaryFile.write(_binaryBuffer.data(), _binaryBuffer.size());
+					_binaryFile.flush();
+					_binaryBuffer.clear();
+				}
+			}
+			_syncMutex.unlock();
+			return;
+		}
+		threadQueue->commit();
+
+		// Wake up the writer if it is sleeping (the fence pairs with the one in threadLoop)
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(_sleeping.load(std::memory_order_relaxed) && _sleeping.exchange(false))
+		{
+			std::lock_guard<std::mutex> lock(_writeMutex);
+			_writeCv.notify_all();
+		}
+	}
+
+	//---------- Writer thread ----------//
+	void LogBackend::threadLoop()
+	{
+		std::unique_lock<std::mutex> lock(_writeMutex);
+		while(true)
+		{
+			const bool finish = _shouldFinish;
+			if(writeRecords() == 0)
+			{
+				if(finish)
+					break;
+				// Sleep until a producer commits a record (it only notifies while the writer is sleeping)
+				_sleeping.store(true);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if(writeRecords() == 0)
+					_writeCv.wait(lock, [&](){ return !_sleeping.load() || _shouldFinish; });
+				_sleeping.store(false);
+			}
+		}
+	}
+
+	size_t LogBackend::writeRecords()
+	{
+		// Collect committed records of all threads
+		_pending.clear();
+		_consumed.clear();
+		{
+			std::lock_guard<std::mutex> lock(_queuesMutex);
+			// Release the queues of exited threads after all their records were written
+			_queues.erase(std::remove_if(_queues.begin(), _queues.end(), [](const std::unique_ptr<LogQueue>& queue)
+				{ return queue->getRetired() && queue->getTail() == queue->getHead(); }), _queues.end());
+			for(auto& queue : _queues)
+			{
+				const uint64_t head = queue->getHead();
+				uint64_t position = queue->getTail();
+				while(position < head)
+				{
+					const RecordHeader* header = reinterpret_cast<const RecordHeader*>(queue->at(position));
+					if(header->size == wrapMarker)
+					{
+						position += LogQueue::capacity - position%LogQueue::capacity;
+						continue;
+					}
+					_pending.push_back({header, reinterpret_cast<const uint8_t*>(header)});
+					position += header->size;
+				}
+				_consumed.push_back({queue.get(), head});
+			}
+		}
+
+		const uint64_t qtyDropped = _qtyDropped.exchange(0, std::memory_order_relaxed);
+		if(_pending.empty() && qtyDropped == 0)
+			return 0;
+
+		// Order of the log calls (between threads)
+		std::sort(_pending.begin(), _pending.end(), [](const Pending& a, const Pending& b){ return a.header->sequence < b.header->sequence; });
+
+		_output.clear();
+		if(qtyDropped > 0)
+			_output += std::string(COLOR_BOLD_YELLOW) + "[Log] " + COLOR_YELLOW + std::to_string(qtyDropped) + " messages dropped (queue full)" + COLOR_RESET + "\n";
+		for(const Pending& p : _pending)
+			writeRecord(*p.header, p.data);
+
+		if(_terminalOutput && !_output.empty())
+		{
+			fwrite(_output.data(), 1, _output.size(), stdout);
+			fflush(stdout);
+		}
+		if(_binaryFile.is_open())
+		{
+			_binaryFile.write(_binaryBuffer.data(), _binaryBuffer.size());
+			_binaryFile.flush();
+			_binaryBuffer.clear();
+		}
+
+		for(auto& [queue, tail] : _consumed)
+			queue->setTail(tail);
+		_qtyWritten.fetch_add(_pending.size(), std::memory_order_release);
+		_writeCv.notify_all();
+		return _pending.size() + qtyDropped;
+	}
+
+	void LogBackend::writeRecord(const RecordHeader& header, const uint8_t* data)
+	{
+		const uint8_t* ptr = data + sizeof(RecordHeader);
+		std::string_view tag(header.tagLiteral ? header.tag : reinterpret_cast<const char*>(ptr), header.tagSize);
+		if(!header.tagLiteral)
+			ptr += header.tagSize;
+		std::string_view text(header.textLiteral ? header.text : reinterpret_cast<const char*>(ptr), header.textSize);
+		if(!header.textLiteral)
+			ptr += header.textSize;
+
+		// Literal formats are parsed only once
+		const std::vector<Segment>* segments = &_segments;
+		if(header.textLiteral)
+		{
+			auto it = _formats.find(header.text);
+			if(it == _formats.end())
+			{
+				it = _formats.emplace(header.text, std::vector<Segment>()).first;
+				parseFormat(text, it->second);
+			}
+			segments = &it->second;
+		}
+		else
+			parseFormat(text, _segments);
+
+		if(_terminalOutput)
+			formatMessage(_output, header.level, tag, text, *segments, ptr, header.qtyArgs);
+		if(_binaryFile.is_open())
+			writeBinary(header, data);
+	}
+
+	//---------- Binary file ----------//
+	template <typename T>
+	void appendValue(std::string& out, T value)
+	{
+		out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	uint32_t LogBackend::binaryString(const char* str, uint32_t size, bool literal)
+	{
+		if(literal)
+		{
+			auto it = _binaryIds.find(str);
+			if(it != _binaryIds.end())
+				return it->second;
+		}
+		const uint32_t id = _nextBinaryId++;
+		if(literal)
+			_binaryIds[str] = id;
+		appendValue<uint8_t>(_binaryBuffer, BINARY_STRING);
+		appendValue<uint32_t>(_binaryBuffer, id);
+		appendValue<uint32_t>(_binaryBuffer, size);
+		_binaryBuffer.append(str, size);
+		return id;
+	}
+
+	void LogBackend::writeBinary(const RecordHeader& header, const uint8_t* data)
+	{
+		const char* ptr = reinterpret_cast<const char*>(data + sizeof(RecordHeader));
+		const uint32_t tagId = binaryString(header.tagLiteral ? header.tag : ptr, header.tagSize, header.tagLiteral);
+		if(!header.tagLiteral)
+			ptr += header.tagSize;
+		const uint32_t textId = binaryString(header.textLiteral ? header.text : ptr, header.textSize, header.textLiteral);
+		if(!header.textLiteral)
+			ptr += header.textSize;
+
+		appendValue<uint8_t>(_binaryBuffer, BINARY_MESSAGE);
+		appendValue<uint64_t>(_binaryBuffer, header.sequence);
+		appendValue<uint64_t>(_binaryBuffer, header.time);
+		appendValue<uint8_t>(_binaryBuffer, header.level);
+		appendValue<uint32_t>(_binaryBuffer, tagId);
+		appendValue<uint32_t>(_binaryBuffer, textId);
+		appendValue<uint16_t>(_binaryBuffer, header.qtyArgs);
+		appendValue<uint32_t>(_binaryBuffer, header.argsSize);
+		_binaryBuffer.append(ptr, header.argsSize);
+	}
+
+	bool LogBackend::setBinaryFile(std::string fileName)
+	{
+		flush();
+		std::lock_guard<std::mutex> lock(_writeMutex);
+		if(_binaryFile.is_open())
+			_binaryFile.close();
+		_binaryIds.clear();
+		_nextBinaryId = 0;
+		_binaryBuffer.clear();
+		if(fileName.empty())
+			return true;
+
+		_binaryFile.open(fileName, std::ios::binary);
+		if(!_binaryFile.is_open())
+			return false;
+		_binaryFile.write(binaryMagic, sizeof(binaryMagic));
+		return true;
+	}
+
+	//---------- Flush/exit ----------//
+	void LogBackend::flush()
+	{
+		if(_stopped)
+		{
+			fflush(stdout);
+			return;
+		}
+		// Wait for the messages that were committed before this call
+		const uint64_t target = _sequence.load(std::memory_order_relaxed);
+		std::unique_lock<std::mutex> lock(_writeMutex);
+		_sleeping.store(false);
+		_writeCv.notify_all();
+		_writeCv.wait_for(lock, std::chrono::seconds(1), [&](){ return _qtyWritten.load(std::memory_order_acquire) >= target; });
+	}
+
+	void LogBackend::shutdown()
+	{
+		LogBackend& backend = get();
+		{
+			std::lock_guard<std::mutex> lock(backend._writeMutex);
+			backend._shouldFinish = true;
+		}
+		backend._writeCv.notify_all();
+		backend._thread.join();
+
+		// Messages logged from now on are written synchronously
+		backend._stopped = true;
+		std::lock_guard<std::mutex> lock(backend._writeMutex);
+		backend.writeRecords();
+		if(backend._binaryFile.is_open())
+			backend._binaryFile.close();
 	}
 }
 
-std::string Log::toString(const char* str)
+//---------------------------------//
+//-------------- Log --------------//
+//---------------------------------//
+uint8_t* Log::beginRecord(LogLevel level, StringRef tag, StringRef text, uint16_t qtyArgs, size_t argsSize)
 {
-	return std::string(str);
+	return LogBackend::get().beginRecord(level, {tag.data, tag.size, tag.literal}, {text.data, text.size, text.literal}, qtyArgs, argsSize);
 }
 
-std::string Log::toString(std::string str)
+void Log::endRecord(LogLevel level)
 {
-	return str;
+	LogBackend::get().endRecord();
+	// Errors are usually followed by exit() or a crash
+	if(level == LOG_LEVEL_ERROR)
+		LogBackend::get().flush();
+}
+
+bool Log::isReadOnlyImage(const void* data)
+{
+	// Read-only segments of the executable and of the libraries loaded before the first call
+	// (arrays of libraries loaded later are copied)
+	static const std::vector<std::pair<uintptr_t, uintptr_t>> ranges = []()
+	{
+		std::vector<std::pair<uintptr_t, uintptr_t>> result;
+		dl_iterate_phdr([](dl_phdr_info* info, size_t, void* user)
+		{
+			auto& result = *static_cast<std::vector<std::pair<uintptr_t, uintptr_t>>*>(user);
+			for(int i=0; i<info->dlpi_phnum; i++)
+			{
+				const ElfW(Phdr)& ph = info->dlpi_phdr[i];
+				if(ph.p_type == PT_LOAD && !(ph.p_flags & PF_W))
+					result.push_back({info->dlpi_addr+ph.p_vaddr, info->dlpi_addr+ph.p_vaddr+ph.p_memsz});
+			}
+			return 0;
+		}, &result);
+		std::sort(result.begin(), result.end());
+		return result;
+	}();
+
+	// Last range that begins before the address
+	const uintptr_t address = reinterpret_cast<uintptr_t>(data);
+	auto it = std::upper_bound(ranges.begin(), ranges.end(), std::make_pair(address, UINTPTR_MAX));
+	return it != ranges.begin() && address < std::prev(it)->second;
+}
+
+void Log::flush()
+{
+	LogBackend::get().flush();
+}
+
+void Log::setTerminalOutput(bool enabled)
+{
+	LogBackend::get().setTerminalOutput(enabled);
+}
+
+bool Log::setBinaryFile(std::string fileName)
+{
+	if(!LogBackend::get().setBinaryFile(fileName))
+	{
+		Log::error("Log", "Could not open binary log file $0", fileName);
+		return false;
+	}
+	return true;
+}
+
+bool Log::printBinaryFile(std::string fileName)
+{
+	std::ifstream file(fileName, std::ios::binary);
+	std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if(!file.is_open() || data.size() < sizeof(binaryMagic) || data.compare(0, sizeof(binaryMagic), binaryMagic, sizeof(binaryMagic)) != 0)
+	{
+		Log::error("Log", "Invalid binary log file $0", fileName);
+		return false;
+	}
+
+	std::unordered_map<uint32_t, std::string> strings;
+	std::vector<Segment> segments;
+	std::string output;
+	size_t pos = sizeof(binaryMagic);
+	auto read = [&](auto& value)
+	{
+		if(pos + sizeof(value) > data.size())
+			return false;
+		std::memcpy(&value, data.data()+pos, sizeof(value));
+		pos += sizeof(value);
+		return true;
+	};
+
+	while(pos < data.size())
+	{
+		uint8_t type;
+		if(!read(type))
+			break;
+		if(type == BINARY_STRING)
+		{
+			uint32_t id, size;
+			if(!read(id) || !read(size) || pos+size > data.size())
+				break;
+			strings[id] = data.substr(pos, size);
+			pos += size;
+		}
+		else if(type == BINARY_MESSAGE)
+		{
+			uint64_t sequence, time;
+			uint8_t level;
+			uint32_t tagId, textId, argsSize;
+			uint16_t qtyArgs;
+			if(!read(sequence) || !read(time) || !read(level) || !read(tagId) || !read(textId) ||
+					!read(qtyArgs) || !read(argsSize) || pos+argsSize > data.size())
+				break;
+			const std::string& text = strings[textId];
+			parseFormat(text, segments);
+			formatMessage(output, level, strings[tagId], text, segments, reinterpret_cast<const uint8_t*>(data.data()+pos), qtyArgs);
+			pos += argsSize;
+		}
+		else
+			break;
+	}
+
+	fwrite(output.data(), 1, output.size(), stdout);
+	fflush(stdout);
+	if(pos != data.size())
+	{
+		Log::warning("Log", "Binary log file $0 is truncated", fileName);
+		return false;
+	}
+	return true;
 }
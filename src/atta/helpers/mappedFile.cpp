@@ -0,0 +1,51 @@
+//--------------------------------------------------
+// Atta Helpers
+// mappedFile.cpp
+// Date: 2021-07-15
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/helpers/mappedFile.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace atta
+{
+	MappedFile::MappedFile(std::string fileName):
+		_data(nullptr), _size(0), _valid(false), _modificationTime(0)
+	{
+		int fd = open(fileName.c_str(), O_RDONLY);
+		if(fd < 0)
+			return;
+
+		struct stat st;
+		if(fstat(fd, &st) == 0)
+		{
+			_size = st.st_size;
+			_modificationTime = int64_t(st.st_mtim.tv_sec)*1000000000 + st.st_mtim.tv_nsec;
+			if(_size == 0)
+				_valid = true;
+			else
+			{
+				void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if(data != MAP_FAILED)
+				{
+					_data = static_cast<const uint8_t*>(data);
+					_valid = true;
+					madvise(data, _size, MADV_SEQUENTIAL);
+				}
+				else
+					_size = 0;
+			}
+		}
+		// The mapping stays valid after closing the file
+		close(fd);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if(_data != nullptr)
+			munmap(const_cast<uint8_t*>(_data), _size);
+	}
+}
@@ -0,0 +1,76 @@
+//--------------------------------------------------
+// Atta Helpers
+// pool.cpp
+// Date: 2021-07-26
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/helpers/pool.h>
+#include <algorithm>
+
+namespace atta
+{
+	Pool::Pool(size_t blockSize, size_t blockAlign, size_t qtyBlocksPerChunk):
+		_blockAlign(std::max(blockAlign, alignof(FreeBlock))), _qtyBlocksPerChunk(qtyBlocksPerChunk),
+		_free(nullptr), _qtyAllocated(0)
+	{
+		// Free blocks store the next free block pointer
+		_blockSize = std::max(blockSize, sizeof(FreeBlock));
+		_blockSize = (_blockSize+_blockAlign-1)/_blockAlign*_blockAlign;
+	}
+
+	Pool::~Pool()
+	{
+		for(void* chunk : _chunks)
+			::operator delete(chunk, std::align_val_t(_blockAlign));
+	}
+
+	void* Pool::allocate()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(_free == nullptr)
+			addChunk();
+
+		FreeBlock* block = _free;
+		_free = block->next;
+		_qtyAllocated++;
+		return block;
+	}
+
+	void Pool::deallocate(void* block)
+	{
+		if(block == nullptr)
+			return;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+		freeBlock->next = _free;
+		_free = freeBlock;
+		_qtyAllocated--;
+	}
+
+	size_t Pool::getQtyAllocated() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _qtyAllocated;
+	}
+
+	size_t Pool::getCapacity() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _chunks.size()*_qtyBlocksPerChunk;
+	}
+
+	void Pool::addChunk()
+	{
+		uint8_t* chunk = static_cast<uint8_t*>(::operator new(_blockSize*_qtyBlocksPerChunk, std::align_val_t(_blockAlign)));
+		_chunks.push_back(chunk);
+
+		// Blocks in address order in the free list
+		for(size_t i=_qtyBlocksPerChunk; i>0; i--)
+		{
+			FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk+(i-1)*_blockSize);
+			block->next = _free;
+			_free = block;
+		}
+	}
+}
@@ -0,0 +1,238 @@
+//--------------------------------------------------
+// Atta Profiler
+// profiler.cpp
+// Date: 2021-07-14
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/helpers/profiler.h>
+#include <atta/helpers/log.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace atta
+{
+	Profiler::Profiler():
+		_qtyZones(1)
+	{
+		// Zone 0 is used when there are too many zones
+		_zones[0] = {"Unknown", ZONE_TYPE_SCOPE};
+		_startTicks = now();
+		_startTime = std::chrono::steady_clock::now();
+	}
+
+	uint32_t Profiler::registerZoneImpl(const char* name, ZoneType type)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return addZone(name, type);
+	}
+
+	uint32_t Profiler::registerZoneImpl(const std::string& name, ZoneType type)
+	{
+		// Reuse the zone if it was already registered
+		std::lock_guard<std::mutex> lock(_mutex);
+		for(uint32_t i=0; i<_qtyZones; i++)
+			if(_zones[i].type == type && name == _zones[i].name)
+				return i;
+		_runtimeNames.push_back(name);
+		return addZone(_runtimeNames.back().c_str(), type);
+	}
+
+	uint32_t Profiler::addZone(const char* name, ZoneType type)
+	{
+		const uint32_t id = _qtyZones;
+		if(id == maxZones)
+		{
+			Log::warning("Profiler", "Maximum number of zones reached ($0), $1 will be reported as Unknown", maxZones, std::string(name));
+			return 0;
+		}
+		_zones[id] = {name, type};
+		_qtyZones.store(id+1, std::memory_order_release);
+		return id;
+	}
+
+	Profiler::ThreadData* Profiler::registerThread()
+	{
+		std::unique_ptr<ThreadData> data = std::make_unique<ThreadData>();
+		data->head = 0;
+		data->tail = 0;
+		data->events = std::make_unique<Event[]>(eventsPerThread);
+		data->stats = std::make_unique<ZoneStats[]>(maxZones);
+		for(uint32_t i=0; i<maxZones; i++)
+		{
+			data->stats[i].count = 0;
+			data->stats[i].ticks = 0;
+			data->stats[i].maxTicks = 0;
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		data->name = "Thread " + std::to_string(_threads.size());
+		_threads.push_back(std::move(data));
+		return _threads.back().get();
+	}
+
+	void Profiler::setThreadNameImpl(std::string name)
+	{
+		ThreadData& data = getThreadData();
+		std::lock_guard<std::mutex> lock(_mutex);
+		data.name = name;
+	}
+
+	//---------------------------------//
+	//------------ Writing ------------//
+	//---------------------------------//
+	void Profiler::record(ThreadData& data, uint32_t zone, uint64_t begin, uint64_t end)
+	{
+		// Only this thread writes, relaxed loads/stores are enough for the statistics
+		ZoneStats& stats = data.stats[zone];
+		const uint64_t ticks = end-begin;
+		stats.count.store(stats.count.load(std::memory_order_relaxed)+1, std::memory_order_relaxed);
+		stats.ticks.store(stats.ticks.load(std::memory_order_relaxed)+ticks, std::memory_order_relaxed);
+		if(ticks > stats.maxTicks.load(std::memory_order_relaxed))
+			stats.maxTicks.store(ticks, std::memory_order_relaxed);
+
+		// Publish the event after writing it
+		const uint64_t head = data.head.load(std::memory_order_relaxed);
+		data.events[head%eventsPerThread] = {begin, end, zone, data.depth};
+		data.head.store(head+1, std::memory_order_release);
+	}
+
+	void Profiler::addCounter(uint32_t zone, int64_t value)
+	{
+		ZoneStats& stats = getThreadData().stats[zone];
+		stats.count.store(stats.count.load(std::memory_order_relaxed)+value, std::memory_order_relaxed);
+	}
+
+	//---------------------------------//
+	//------------ Reading ------------//
+	//---------------------------------//
+	double Profiler::getTicksPerMs()
+	{
+		const uint64_t ticks = now()-_startTicks;
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-_startTime).count();
+		return ms > 0 ? ticks/ms : 1e6;
+	}
+
+	std::vector<Profiler::ZoneReport> Profiler::getReportsImpl()
+	{
+		const double msPerTick = 1.0/getTicksPerMs();
+		const uint32_t qtyZones = _qtyZones.load(std::memory_order_acquire);
+
+		std::vector<ZoneReport> reports(qtyZones);
+		std::lock_guard<std::mutex> lock(_mutex);
+		for(uint32_t i=0; i<qtyZones; i++)
+			reports[i] = {_zones[i].name, _zones[i].type, 0, 0.0, 0.0};
+		for(auto& thread : _threads)
+			for(uint32_t i=0; i<qtyZones; i++)
+			{
+				const ZoneStats& stats = thread->stats[i];
+				reports[i].count += stats.count.load(std::memory_order_relaxed);
+				reports[i].totalMs += stats.ticks.load(std::memory_order_relaxed)*msPerTick;
+				reports[i].maxMs = std::max(reports[i].maxMs, stats.maxTicks.load(std::memory_order_relaxed)*msPerTick);
+			}
+
+		// Remove zones that were not executed
+		reports.erase(std::remove_if(reports.begin(), reports.end(), [](const ZoneReport& r){ return r.count == 0; }), reports.end());
+		return reports;
+	}
+
+	void Profiler::showReportsImpl()
+	{
+		std::string reportStr = "";
+		for(const ZoneReport& report : getReportsImpl())
+		{
+			std::string currReport("    [w]- [c]"+report.name+":");
+			while(currReport.size()<40)
+				currReport+=" ";
+			if(report.type == ZONE_TYPE_COUNTER)
+				currReport += "[w]" + std::to_string(report.count) + "\n";
+			else
+				currReport += "[w]" + std::to_string(report.count) + " calls, " +
+					std::to_string(report.totalMs/report.count) + "ms avg, " +
+					std::to_string(report.maxMs) + "ms max, " +
+					std::to_string(report.totalMs) + "ms total\n";
+			reportStr += currReport;
+		}
+
+		Log::info("Profiler", "Report: \n"+reportStr);
+	}
+
+	bool Profiler::exportChromeTraceImpl(std::string fileName)
+	{
+		std::ofstream file(fileName);
+		if(!file.is_open())
+		{
+			Log::error("Profiler", "Could not create trace file $0", fileName);
+			return false;
+		}
+
+		auto escape = [](const std::string& str)
+		{
+			std::string result;
+			for(char c : str)
+			{
+				if(c == '"' || c == '\\')
+					result += '\\';
+				result += c;
+			}
+			return result;
+		};
+
+		const double usPerTick = 1000.0/getTicksPerMs();
+		std::vector<Event> events;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		std::vector<std::string> zoneNames(_qtyZones);
+		for(uint32_t i=0; i<zoneNames.size(); i++)
+			zoneNames[i] = escape(_zones[i].name);
+
+		file << "{\"traceEvents\":[\n";
+		bool first = true;
+		for(size_t tid=0; tid<_threads.size(); tid++)
+		{
+			ThreadData& thread = *_threads[tid];
+			file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << tid
+				<< ",\"args\":{\"name\":\"" << escape(thread.name) << "\"}}";
+			first = false;
+
+			// Copy the ring buffer, then discard what may have been overwritten while copying
+			const uint64_t head = thread.head.load(std::memory_order_acquire);
+			const uint64_t begin = std::max(thread.tail.load(std::memory_order_relaxed), head > eventsPerThread ? head-eventsPerThread : 0);
+			events.resize(head-begin);
+			for(uint64_t i=begin; i<head; i++)
+				events[i-begin] = thread.events[i%eventsPerThread];
+			const uint64_t newHead = thread.head.load(std::memory_order_acquire);
+			const uint64_t valid = newHead > eventsPerThread ? newHead-eventsPerThread : 0;
+			const size_t skip = valid > begin ? std::min<uint64_t>(valid-begin, events.size()) : 0;
+
+			for(size_t i=skip; i<events.size(); i++)
+			{
+				const Event& e = events[i];
+				file << ",\n{\"name\":\"" << zoneNames[e.zone] << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << tid
+					<< ",\"ts\":" << std::to_string((int64_t(e.begin-_startTicks))*usPerTick)
+					<< ",\"dur\":" << std::to_string((e.end-e.begin)*usPerTick) << "}";
+			}
+		}
+		file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+		Log::success("Profiler", "Trace exported to $0", fileName);
+		return true;
+	}
+
+	void Profiler::clearImpl()
+	{
+		// The statistics are reset while the threads may be writing (values of running zones can be lost)
+		std::lock_guard<std::mutex> lock(_mutex);
+		for(auto& thread : _threads)
+		{
+			thread->tail.store(thread->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+			for(uint32_t i=0; i<maxZones; i++)
+			{
+				thread->stats[i].count.store(0, std::memory_order_relaxed);
+				thread->stats[i].ticks.store(0, std::memory_order_relaxed);
+				thread->stats[i].maxTicks.store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+}
@@ -0,0 +1,96 @@
+//--------------------------------------------------
+// Atta Helpers
+// random.cpp
+// Date: 2021-07-29
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/helpers/random.h>
+#include <cmath>
+
+namespace atta
+{
+	namespace
+	{
+		// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3")
+		void philox(uint64_t seed, uint64_t stream, uint64_t block, uint32_t out[4])
+		{
+			uint32_t c[4] = {uint32_t(block), uint32_t(block>>32), uint32_t(stream), uint32_t(stream>>32)};
+			uint32_t k[2] = {uint32_t(seed), uint32_t(seed>>32)};
+			for(int round=0; round<10; round++)
+			{
+				const uint64_t p0 = uint64_t(0xD2511F53u)*c[0];
+				const uint64_t p1 = uint64_t(0xCD9E8D57u)*c[2];
+				const uint32_t n0 = uint32_t(p1>>32)^c[1]^k[0];
+				const uint32_t n2 = uint32_t(p0>>32)^c[3]^k[1];
+				c[0] = n0;
+				c[1] = uint32_t(p1);
+				c[2] = n2;
+				c[3] = uint32_t(p0);
+				k[0] += 0x9E3779B9u;
+				k[1] += 0xBB67AE85u;
+			}
+			for(int i=0; i<4; i++)
+				out[i] = c[i];
+		}
+	}
+
+	RandomStream::RandomStream(uint64_t seed, uint64_t stream):
+		_seed(seed), _stream(stream), _counter(0), _cachedBlock(~uint64_t(0))
+	{
+	}
+
+	uint32_t RandomStream::next()
+	{
+		const uint64_t block = _counter>>2;
+		if(block != _cachedBlock)
+		{
+			philox(_seed, _stream, block, _cached);
+			_cachedBlock = block;
+		}
+		return _cached[_counter++ & 3];
+	}
+
+	float RandomStream::uniform()
+	{
+		// 24 bits, exactly representable
+		return (next()>>8)*(1.0f/16777216.0f);
+	}
+
+	float RandomStream::uniform(float min, float max)
+	{
+		return min + (max-min)*uniform();
+	}
+
+	uint32_t RandomStream::uniformInt(uint32_t qty)
+	{
+		// Multiply-shift (no modulo bias for small ranges)
+		return uint32_t((uint64_t(next())*qty)>>32);
+	}
+
+	float RandomStream::normal()
+	{
+		// Box-Muller (always draws two values)
+		const float u1 = 1.0f-uniform();// (0, 1]
+		const float u2 = uniform();
+		return std::sqrt(-2.0f*std::log(u1))*std::cos(2.0f*float(M_PI)*u2);
+	}
+
+	uint32_t RandomStream::generate(uint64_t seed, uint64_t stream, uint64_t index)
+	{
+		uint32_t block[4];
+		philox(seed, stream, index>>2, block);
+		return block[index & 3];
+	}
+
+	uint64_t RandomStream::streamFromName(const std::string& name)
+	{
+		// FNV-1a
+		uint64_t hash = 0xCBF29CE484222325ull;
+		for(char c : name)
+		{
+			hash ^= uint8_t(c);
+			hash *= 0x100000001B3ull;
+		}
+		return hash;
+	}
+}
@@ -0,0 +1,179 @@
+//--------------------------------------------------
+// Atta Math
+// batch.cpp
+// Date: 2021-07-28
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/math/batch.h>
+#include <atta/math/batchKernels.h>
+#include <atta/helpers/log.h>
+
+namespace atta::batch
+{
+	namespace detail
+	{
+		namespace
+		{
+#ifdef ATTA_SIMD
+			struct Float4Lanes
+			{
+				using type = simd::float4;
+				using mask = simd::float4;
+				static constexpr size_t width = 4;
+
+				static type load(const float* p) { return simd::loadu(p); }
+				static void store(float* p, type v) { simd::storeu(p, v); }
+				static type splat(float v) { return simd::splat(v); }
+				static type add(type a, type b) { return simd::add(a, b); }
+				static type sub(type a, type b) { return simd::sub(a, b); }
+				static type mul(type a, type b) { return simd::mul(a, b); }
+				static type div(type a, type b) { return simd::div(a, b); }
+				static type sqrt(type a) { return simd::sqrt(a); }
+				static type madd(type a, type b, type c) { return simd::madd(a, b, c); }
+				static mask less(type a, type b) { return simd::less(a, b); }
+				static type select(mask m, type a, type b) { return simd::select(m, a, b); }
+				static void loadRows(const mat4* m, int row, type e[4])
+				{
+					e[0] = simd::load(m[0].data+row*4);
+					e[1] = simd::load(m[1].data+row*4);
+					e[2] = simd::load(m[2].data+row*4);
+					e[3] = simd::load(m[3].data+row*4);
+					simd::transpose(e[0], e[1], e[2], e[3]);
+				}
+				static void storeRows(mat4* m, int row, const type e[4])
+				{
+					type r0 = e[0], r1 = e[1], r2 = e[2], r3 = e[3];
+					simd::transpose(r0, r1, r2, r3);
+					simd::store(m[0].data+row*4, r0);
+					simd::store(m[1].data+row*4, r1);
+					simd::store(m[2].data+row*4, r2);
+					simd::store(m[3].data+row*4, r3);
+				}
+			};
+			using BaselineLanes = Float4Lanes;
+#else
+			using BaselineLanes = ScalarLanes;
+#endif
+
+			void compose(size_t n, const mat4* parents, const int* parentIndices, const mat4* locals, mat4* out)
+			{
+				for(size_t i=0; i<n; i++)
+				{
+					if(parentIndices[i] < 0)
+						out[i] = locals[i];
+					else
+						out[i] = parents[parentIndices[i]]*locals[i];
+				}
+			}
+
+			Target bestTarget()
+			{
+#ifdef ATTA_BATCH_X86
+				__builtin_cpu_init();
+				if(__builtin_cpu_supports("avx512f"))
+					return TARGET_AVX512;
+				if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+					return TARGET_AVX2;
+#endif
+				return TARGET_BASELINE;
+			}
+
+			struct Dispatch
+			{
+				Target target;
+				Kernels kernels;
+
+				Dispatch() { select(bestTarget()); }
+
+				void select(Target t)
+				{
+					target = t;
+					switch(target)
+					{
+#ifdef ATTA_BATCH_X86
+						case TARGET_AVX512:
+							kernels = avx512Kernels();
+							break;
+						case TARGET_AVX2:
+							kernels = avx2Kernels();
+							break;
+#endif
+						default:
+							target = TARGET_BASELINE;
+							kernels = baselineKernels();
+					}
+				}
+			};
+
+			Dispatch& dispatch()
+			{
+				static Dispatch d;
+				return d;
+			}
+		}
+
+		Kernels baselineKernels()
+		{
+			return makeKernels<BaselineLanes>(compose);
+		}
+	}
+
+	//---------- Kernels ----------//
+	void transformPoints(size_t n, const mat4* matrices, Vec3Arrays points)
+	{
+		detail::dispatch().kernels.transformPoints(n, matrices, points);
+	}
+
+	void compose(size_t n, const mat4* parents, const int* parentIndices, const mat4* locals, mat4* out)
+	{
+		detail::dispatch().kernels.compose(n, parents, parentIndices, locals, out);
+	}
+
+	void integrateOrientations(size_t n, QuatArrays orientations, Vec3Arrays angularVelocities, float dt)
+	{
+		detail::dispatch().kernels.integrateOrientations(n, orientations, angularVelocities, dt);
+	}
+
+	void posOriScale(size_t n, Vec3Arrays positions, QuatArrays orientations, Vec3Arrays scales, mat4* out)
+	{
+		detail::dispatch().kernels.posOriScale(n, positions, orientations, scales, out);
+	}
+
+	//---------- Target ----------//
+	Target getTarget()
+	{
+		return detail::dispatch().target;
+	}
+
+	bool isTargetSupported(Target target)
+	{
+		return target <= detail::bestTarget();
+	}
+
+	void setTarget(Target target)
+	{
+		if(!isTargetSupported(target))
+		{
+			Log::warning("Batch", "Target [w]$0[] is not supported by this CPU", getTargetName(target));
+			return;
+		}
+		detail::dispatch().select(target);
+	}
+
+	const char* getTargetName(Target target)
+	{
+		switch(target)
+		{
+			case TARGET_AVX2: return "AVX2";
+			case TARGET_AVX512: return "AVX-512";
+			default:
+#if defined(ATTA_SIMD_SSE)
+				return "SSE";
+#elif defined(ATTA_SIMD_NEON)
+				return "NEON";
+#else
+				return "scalar";
+#endif
+		}
+	}
+}
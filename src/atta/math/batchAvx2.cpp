@@ -0,0 +1,111 @@
+//--------------------------------------------------
+// Atta Math
+// batchAvx2.cpp
+// Date: 2021-07-28
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/math/batch.h>
+#include <cfloat>
+#include <cmath>
+
+// Only functions defined after the pragma use AVX2 (they are only called if the CPU supports it)
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__) && !defined(ATTA_SIMD_DISABLED)
+#pragma GCC target("avx2,fma")
+#include <immintrin.h>
+#include <atta/math/batchKernels.h>
+
+namespace atta::batch::detail
+{
+	namespace
+	{
+		// Rows to columns inside each 128 bit lane
+		inline void transpose(__m256& a, __m256& b, __m256& c, __m256& d)
+		{
+			const __m256 t0 = _mm256_unpacklo_ps(a, b);
+			const __m256 t1 = _mm256_unpackhi_ps(a, b);
+			const __m256 t2 = _mm256_unpacklo_ps(c, d);
+			const __m256 t3 = _mm256_unpackhi_ps(c, d);
+			a = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+			b = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+			c = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+			d = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+		}
+
+		struct Avx2Lanes
+		{
+			using type = __m256;
+			using mask = __m256;
+			static constexpr size_t width = 8;
+
+			static type load(const float* p) { return _mm256_loadu_ps(p); }
+			static void store(float* p, type v) { _mm256_storeu_ps(p, v); }
+			static type splat(float v) { return _mm256_set1_ps(v); }
+			static type add(type a, type b) { return _mm256_add_ps(a, b); }
+			static type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+			static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+			static type div(type a, type b) { return _mm256_div_ps(a, b); }
+			static type sqrt(type a) { return _mm256_sqrt_ps(a); }
+			static type madd(type a, type b, type c) { return _mm256_fmadd_ps(a, b, c); }
+			static mask less(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+			static type select(mask m, type a, type b) { return _mm256_blendv_ps(b, a, m); }
+			// Matrices l and l+4 share a register (low and high lanes), the columns are in the order 0..7
+			static void loadRows(const mat4* m, int row, type e[4])
+			{
+				for(int l=0; l<4; l++)
+					e[l] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(m[l].data+row*4)),
+							_mm_load_ps(m[l+4].data+row*4), 1);
+				transpose(e[0], e[1], e[2], e[3]);
+			}
+			static void storeRows(mat4* m, int row, const type e[4])
+			{
+				type r[4] = {e[0], e[1], e[2], e[3]};
+				transpose(r[0], r[1], r[2], r[3]);
+				for(int l=0; l<4; l++)
+				{
+					_mm_store_ps(m[l].data+row*4, _mm256_castps256_ps128(r[l]));
+					_mm_store_ps(m[l+4].data+row*4, _mm256_extractf128_ps(r[l], 1));
+				}
+			}
+		};
+
+		// Two rows of the result per register: each row of the parent weights the local rows
+		void compose(size_t n, const mat4* parents, const int* parentIndices, const mat4* locals, mat4* out)
+		{
+			for(size_t i=0; i<n; i++)
+			{
+				const float* b = locals[i].data;
+				if(parentIndices[i] < 0)
+				{
+					const __m256 b01 = _mm256_loadu_ps(b);
+					const __m256 b23 = _mm256_loadu_ps(b+8);
+					_mm256_storeu_ps(out[i].data, b01);
+					_mm256_storeu_ps(out[i].data+8, b23);
+					continue;
+				}
+				const float* a = parents[parentIndices[i]].data;
+				const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b));
+				const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b+4));
+				const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b+8));
+				const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b+12));
+				const __m256 a01 = _mm256_loadu_ps(a);
+				const __m256 a23 = _mm256_loadu_ps(a+8);
+				__m256 r01 = _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x00), b0);
+				__m256 r23 = _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x00), b0);
+				r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(a01, a01, 0x55), b1, r01);
+				r23 = _mm256_fmadd_ps(_mm256_shuffle_ps(a23, a23, 0x55), b1, r23);
+				r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(a01, a01, 0xAA), b2, r01);
+				r23 = _mm256_fmadd_ps(_mm256_shuffle_ps(a23, a23, 0xAA), b2, r23);
+				r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(a01, a01, 0xFF), b3, r01);
+				r23 = _mm256_fmadd_ps(_mm256_shuffle_ps(a23, a23, 0xFF), b3, r23);
+				_mm256_storeu_ps(out[i].data, r01);
+				_mm256_storeu_ps(out[i].data+8, r23);
+			}
+		}
+	}
+
+	Kernels avx2Kernels()
+	{
+		return makeKernels<Avx2Lanes>(compose);
+	}
+}
+#endif
@@ -0,0 +1,105 @@
+//--------------------------------------------------
+// Atta Math
+// batchAvx512.cpp
+// Date: 2021-07-28
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/math/batch.h>
+#include <cfloat>
+#include <cmath>
+
+// Only functions defined after the pragma use AVX-512 (they are only called if the CPU supports it)
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__) && !defined(ATTA_SIMD_DISABLED)
+#pragma GCC target("avx512f")
+// GCC 12 avx512fintrin.h uses _mm512_undefined_ps for the masked forms (false positives)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#include <atta/math/batchKernels.h>
+
+namespace atta::batch::detail
+{
+	namespace
+	{
+		// Rows to columns inside each 128 bit lane
+		inline void transpose(__m512& a, __m512& b, __m512& c, __m512& d)
+		{
+			const __m512 t0 = _mm512_unpacklo_ps(a, b);
+			const __m512 t1 = _mm512_unpackhi_ps(a, b);
+			const __m512 t2 = _mm512_unpacklo_ps(c, d);
+			const __m512 t3 = _mm512_unpackhi_ps(c, d);
+			a = _mm512_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+			b = _mm512_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+			c = _mm512_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+			d = _mm512_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+		}
+
+		struct Avx512Lanes
+		{
+			using type = __m512;
+			using mask = __mmask16;
+			static constexpr size_t width = 16;
+
+			static type load(const float* p) { return _mm512_loadu_ps(p); }
+			static void store(float* p, type v) { _mm512_storeu_ps(p, v); }
+			static type splat(float v) { return _mm512_set1_ps(v); }
+			static type add(type a, type b) { return _mm512_add_ps(a, b); }
+			static type sub(type a, type b) { return _mm512_sub_ps(a, b); }
+			static type mul(type a, type b) { return _mm512_mul_ps(a, b); }
+			static type div(type a, type b) { return _mm512_div_ps(a, b); }
+			static type sqrt(type a) { return _mm512_sqrt_ps(a); }
+			static type madd(type a, type b, type c) { return _mm512_fmadd_ps(a, b, c); }
+			static mask less(type a, type b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+			static type select(mask m, type a, type b) { return _mm512_mask_blend_ps(m, b, a); }
+			// Matrices l, l+4, l+8 and l+12 share a register (128 bit lanes), the columns are in the order 0..15
+			static void loadRows(const mat4* m, int row, type e[4])
+			{
+				for(int l=0; l<4; l++)
+				{
+					type v = _mm512_castps128_ps512(_mm_load_ps(m[l].data+row*4));
+					v = _mm512_insertf32x4(v, _mm_load_ps(m[l+4].data+row*4), 1);
+					v = _mm512_insertf32x4(v, _mm_load_ps(m[l+8].data+row*4), 2);
+					e[l] = _mm512_insertf32x4(v, _mm_load_ps(m[l+12].data+row*4), 3);
+				}
+				transpose(e[0], e[1], e[2], e[3]);
+			}
+			static void storeRows(mat4* m, int row, const type e[4])
+			{
+				type r[4] = {e[0], e[1], e[2], e[3]};
+				transpose(r[0], r[1], r[2], r[3]);
+				for(int l=0; l<4; l++)
+				{
+					_mm_store_ps(m[l].data+row*4, _mm512_castps512_ps128(r[l]));
+					_mm_store_ps(m[l+4].data+row*4, _mm512_extractf32x4_ps(r[l], 1));
+					_mm_store_ps(m[l+8].data+row*4, _mm512_extractf32x4_ps(r[l], 2));
+					_mm_store_ps(m[l+12].data+row*4, _mm512_extractf32x4_ps(r[l], 3));
+				}
+			}
+		};
+
+		// The four rows of the result in one register: each row of the parent weights the local rows
+		void compose(size_t n, const mat4* parents, const int* parentIndices, const mat4* locals, mat4* out)
+		{
+			for(size_t i=0; i<n; i++)
+			{
+				const float* b = locals[i].data;
+				if(parentIndices[i] < 0)
+				{
+					_mm512_storeu_ps(out[i].data, _mm512_loadu_ps(b));
+					continue;
+				}
+				const __m512 a = _mm512_loadu_ps(parents[parentIndices[i]].data);
+				__m512 r = _mm512_mul_ps(_mm512_permute_ps(a, 0x00), _mm512_broadcast_f32x4(_mm_load_ps(b)));
+				r = _mm512_fmadd_ps(_mm512_permute_ps(a, 0x55), _mm512_broadcast_f32x4(_mm_load_ps(b+4)), r);
+				r = _mm512_fmadd_ps(_mm512_permute_ps(a, 0xAA), _mm512_broadcast_f32x4(_mm_load_ps(b+8)), r);
+				r = _mm512_fmadd_ps(_mm512_permute_ps(a, 0xFF), _mm512_broadcast_f32x4(_mm_load_ps(b+12)), r);
+				_mm512_storeu_ps(out[i].data, r);
+			}
+		}
+	}
+
+	Kernels avx512Kernels()
+	{
+		return makeKernels<Avx512Lanes>(compose);
+	}
+}
+#endif
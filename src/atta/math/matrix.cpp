@@ -8,6 +8,49 @@
 
 namespace atta
 {
+#ifdef ATTA_SIMD
+	namespace
+	{
+		// 2x2 row-major matrices in one register {m00, m01, m10, m11} (mat4 inverse by blocks)
+		inline simd::float4 mat2Mul(simd::float4 a, simd::float4 b)
+		{
+			return simd::add(simd::mul(a, simd::shuffle<0,3,0,3>(b, b)),
+					simd::mul(simd::shuffle<1,0,3,2>(a, a), simd::shuffle<2,1,2,1>(b, b)));
+		}
+
+		// adj(a)*b
+		inline simd::float4 mat2AdjMul(simd::float4 a, simd::float4 b)
+		{
+			return simd::sub(simd::mul(simd::shuffle<3,3,0,0>(a, a), b),
+					simd::mul(simd::shuffle<1,1,2,2>(a, a), simd::shuffle<2,3,0,1>(b, b)));
+		}
+
+		// a*adj(b)
+		inline simd::float4 mat2MulAdj(simd::float4 a, simd::float4 b)
+		{
+			return simd::sub(simd::mul(a, simd::shuffle<3,0,3,0>(b, b)),
+					simd::mul(simd::shuffle<1,0,3,2>(a, a), simd::shuffle<2,1,2,1>(b, b)));
+		}
+
+		// Rows of the rotation matrix of q (of its transpose if transposed), w=0
+		inline void rotationRows(const quat& q, bool transposed, simd::float4 rows[3])
+		{
+			const simd::float4 v = simd::load(q.data);// {r, i, j, k}
+			const simd::float4 v2 = simd::add(v, v);
+			const float s = transposed ? -1.0f : 1.0f;// Sign of the terms with r
+			const simd::float4 jir = simd::shuffle<2,1,0,0>(v, v);
+			const simd::float4 kri = simd::shuffle<3,0,1,0>(v, v);
+			const simd::float4 rkj = simd::shuffle<0,3,2,0>(v, v);
+			rows[0] = simd::madd(simd::splatLane<2>(v2), simd::mul(jir, simd::set(-1, 1, s, 0)),
+					simd::madd(simd::splatLane<3>(v2), simd::mul(kri, simd::set(-1, -s, 1, 0)), simd::set(1, 0, 0, 0)));
+			rows[1] = simd::madd(simd::splatLane<1>(v2), simd::mul(jir, simd::set(1, -1, -s, 0)),
+					simd::madd(simd::splatLane<3>(v2), simd::mul(rkj, simd::set(s, -1, 1, 0)), simd::set(0, 1, 0, 0)));
+			rows[2] = simd::madd(simd::splatLane<1>(v2), simd::mul(kri, simd::set(1, s, -1, 0)),
+					simd::madd(simd::splatLane<2>(v2), simd::mul(rkj, simd::set(-s, 1, -1, 0)), simd::set(0, 0, 1, 0)));
+		}
+	}
+#endif
+
 	//------------------------------------------------------------//
 	//--------------------------- mat4 ---------------------------//
 	//------------------------------------------------------------//
@@ -160,6 +203,10 @@ namespace atta
 
     void mat4::operator=(const mat4 &o)
 	{
+#ifdef ATTA_SIMD
+		for(int i=0; i<16; i+=4)
+			simd::store(data+i, simd::load(o.data+i));
+#else
 		data[0] = o.data[0];
 		data[1] = o.data[1];
 		data[2] = o.data[2];
@@ -176,10 +223,33 @@ namespace atta
 		data[13] = o.data[13];
 		data[14] = o.data[14];
 		data[15] = o.data[15];
+#endif
 	}
 
 	mat4 mat4::operator*(const mat4 &o) const
 	{
+#ifdef ATTA_SIMD
+		// Row i of the result is the rows of o weighted by the row i of this matrix
+		mat4 result;
+		const simd::float4 o0 = simd::load(o.data);
+		const simd::float4 o1 = simd::load(o.data+4);
+		const simd::float4 o2 = simd::load(o.data+8);
+		const simd::float4 o3 = simd::load(o.data+12);
+		auto multiplyRow = [&](int i)
+		{
+			simd::float4 row = simd::load(data+i);
+			simd::float4 res = simd::mul(simd::splatLane<0>(row), o0);
+			res = simd::madd(simd::splatLane<1>(row), o1, res);
+			res = simd::madd(simd::splatLane<2>(row), o2, res);
+			res = simd::madd(simd::splatLane<3>(row), o3, res);
+			simd::store(result.data+i, res);
+		};
+		multiplyRow(0);
+		multiplyRow(4);
+		multiplyRow(8);
+		multiplyRow(12);
+		return result;
+#else
 		mat4 result;
 		result.data[0] = (o.data[0]*data[0]) + (o.data[4]*data[1]) + (o.data[8]*data[2]) + (o.data[12]*data[3]);
 		result.data[4] = (o.data[0]*data[4]) + (o.data[4]*data[5]) + (o.data[8]*data[6]) + (o.data[12]*data[7]);
@@ -202,6 +272,7 @@ namespace atta
 		result.data[15] = (o.data[3]*data[12]) + (o.data[7]*data[13]) + (o.data[11]*data[14]) + (o.data[15]*data[15]);
 
 		return result;
+#endif
 	}
 
     mat4 mat4::operator()(const mat4 &o) const
@@ -211,6 +282,12 @@ namespace atta
 
 	mat4 mat4::operator+(const mat4 &o) const
 	{
+#ifdef ATTA_SIMD
+		mat4 result;
+		for(int i=0; i<16; i+=4)
+			simd::store(result.data+i, simd::add(simd::load(data+i), simd::load(o.data+i)));
+		return result;
+#else
 		mat4 result;
 		result.data[0] = data[0]+o.data[0];
 		result.data[1] = data[1]+o.data[1];
@@ -233,10 +310,18 @@ namespace atta
 		result.data[15] = data[15]+o.data[15];
 
 		return result;
+#endif
 	}
 
 	mat4 mat4::operator*(const float v) const
 	{
+#ifdef ATTA_SIMD
+		mat4 result;
+		const simd::float4 value = simd::splat(v);
+		for(int i=0; i<16; i+=4)
+			simd::store(result.data+i, simd::mul(simd::load(data+i), value));
+		return result;
+#else
 		mat4 result;
 		result.data[0] = data[0]*v;
 		result.data[1] = data[1]*v;
@@ -259,11 +344,18 @@ namespace atta
 		result.data[15] = data[15]*v;
 
 		return result;
+#endif
 	}
 
 	// Transform the vector by this matrix
 	vec3 mat4::operator*(const vec3 &vector) const
 	{
+#ifdef ATTA_SIMD
+		alignas(16) float res[4];
+		simd::store(res, simd::dot4x4(simd::load(data), simd::load(data+4), simd::load(data+8), simd::load(data+12),
+					simd::set(vector.x, vector.y, vector.z, 1.0f)));
+		return vec3(res[0], res[1], res[2]);
+#else
 		return vec3(
 			vector.x * data[0] +
 			vector.y * data[1] +
@@ -277,11 +369,18 @@ namespace atta
 			vector.y * data[9] +
 			vector.z * data[10] + data[11]
 		);
+#endif
 	}
 
 	// Transform the vector by this matrix
 	vec4 mat4::operator*(const vec4 &vector) const
 	{
+#ifdef ATTA_SIMD
+		vec4 result;
+		simd::store(&result.x, simd::dot4x4(simd::load(data), simd::load(data+4), simd::load(data+8), simd::load(data+12),
+					simd::load(&vector.x)));
+		return result;
+#else
 		return vec4(
 			vector.x * data[0] +
 			vector.y * data[1] +
@@ -303,6 +402,7 @@ namespace atta
 			vector.z * data[14] +
 			vector.w * data[15]
 		);
+#endif
 	}
 
 	// Transform the vector by this matrix
@@ -416,6 +516,14 @@ namespace atta
 	// the given quaternion.
     void mat4::setPosOri(const vec3 &pos, const quat &q)
 	{
+#ifdef ATTA_SIMD
+		simd::float4 rows[3];
+		rotationRows(q, false, rows);
+		simd::store(data, simd::add(rows[0], simd::set(0, 0, 0, pos.x)));
+		simd::store(data+4, simd::add(rows[1], simd::set(0, 0, 0, pos.y)));
+		simd::store(data+8, simd::add(rows[2], simd::set(0, 0, 0, pos.z)));
+		simd::store(data+12, simd::set(0, 0, 0, 1));
+#else
 		mat[0][0] = 1 - (2*q.j*q.j + 2*q.k*q.k);
 		mat[0][1] = 2*q.i*q.j - 2*q.k*q.r;
 		mat[0][2] = 2*q.i*q.k + 2*q.j*q.r;
@@ -435,10 +543,20 @@ namespace atta
 		mat[3][1] = 0;
 		mat[3][2] = 0;
 		mat[3][3] = 1;
+#endif
 	}
 
     void mat4::setPosOriScale(const vec3 &pos, const quat &q, const vec3 &scale)
 	{
+#ifdef ATTA_SIMD
+		simd::float4 rows[3];
+		rotationRows(q, true, rows);
+		const simd::float4 s = simd::set(scale.x, scale.y, scale.z, 0);
+		simd::store(data, simd::madd(rows[0], s, simd::set(0, 0, 0, pos.x)));
+		simd::store(data+4, simd::madd(rows[1], s, simd::set(0, 0, 0, pos.y)));
+		simd::store(data+8, simd::madd(rows[2], s, simd::set(0, 0, 0, pos.z)));
+		simd::store(data+12, simd::set(0, 0, 0, 1));
+#else
 		data[0] = (1 - (2*q.j*q.j + 2*q.k*q.k))*scale.x;
 		data[1] = (2*q.i*q.j + 2*q.k*q.r)*scale.y;
 		data[2] = (2*q.i*q.k - 2*q.j*q.r)*scale.z;
@@ -458,6 +576,7 @@ namespace atta
 		data[13] = 0;
 		data[14] = 0;
 		data[15] = 1;
+#endif
 	}
 
 
@@ -480,6 +599,55 @@ namespace atta
 
     void mat4::setInverse(const mat4 &m)
 	{
+#ifdef ATTA_SIMD
+		// Inverse by 2x2 blocks [A B; C D]
+		const simd::float4 r0 = simd::load(m.data);
+		const simd::float4 r1 = simd::load(m.data+4);
+		const simd::float4 r2 = simd::load(m.data+8);
+		const simd::float4 r3 = simd::load(m.data+12);
+		const simd::float4 A = simd::shuffle<0,1,0,1>(r0, r1);
+		const simd::float4 B = simd::shuffle<2,3,2,3>(r0, r1);
+		const simd::float4 C = simd::shuffle<0,1,0,1>(r2, r3);
+		const simd::float4 D = simd::shuffle<2,3,2,3>(r2, r3);
+
+		// {|A|, |B|, |C|, |D|}
+		const simd::float4 detSub = simd::sub(
+				simd::mul(simd::shuffle<0,2,0,2>(r0, r2), simd::shuffle<1,3,1,3>(r1, r3)),
+				simd::mul(simd::shuffle<1,3,1,3>(r0, r2), simd::shuffle<0,2,0,2>(r1, r3)));
+		const simd::float4 detA = simd::splatLane<0>(detSub);
+		const simd::float4 detB = simd::splatLane<1>(detSub);
+		const simd::float4 detC = simd::splatLane<2>(detSub);
+		const simd::float4 detD = simd::splatLane<3>(detSub);
+
+		const simd::float4 DC = mat2AdjMul(D, C);
+		const simd::float4 AB = mat2AdjMul(A, B);
+		simd::float4 X = simd::sub(simd::mul(detD, A), mat2Mul(B, DC));
+		simd::float4 W = simd::sub(simd::mul(detA, D), mat2Mul(C, AB));
+		simd::float4 Y = simd::sub(simd::mul(detB, C), mat2MulAdj(D, AB));
+		simd::float4 Z = simd::sub(simd::mul(detC, B), mat2MulAdj(A, DC));
+
+		// |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+		const simd::float4 tr = simd::mul(AB, simd::shuffle<0,2,1,3>(DC, DC));
+		const float det = simd::first(detA)*simd::first(detD) + simd::first(detB)*simd::first(detC) -
+			simd::first(simd::dot4(tr, simd::splat(1.0f)));
+
+		// Make sure the determinant is non-zero
+		if(det == 0)
+		{
+			//Log::warning("mat4", "Inverse not possible with zero determinant");
+			return;
+		}
+
+		const simd::float4 idet = simd::div(simd::set(1,-1,-1,1), simd::splat(det));
+		X = simd::mul(X, idet);
+		Y = simd::mul(Y, idet);
+		Z = simd::mul(Z, idet);
+		W = simd::mul(W, idet);
+		simd::store(data, simd::shuffle<3,1,3,1>(X, Y));
+		simd::store(data+4, simd::shuffle<2,0,2,0>(X, Y));
+		simd::store(data+8, simd::shuffle<3,1,3,1>(Z, W));
+		simd::store(data+12, simd::shuffle<2,0,2,0>(Z, W));
+#else
 		// Make sure the determinant is non-zero
 		float det = m.determinant();
 		if (det == 0)
@@ -600,6 +768,7 @@ namespace atta
 				  m.data[4] * m.data[2] * m.data[9] +
 				  m.data[8] * m.data[1] * m.data[6] -
 				  m.data[8] * m.data[2] * m.data[5])*idet;
+#endif
 	}
 
     vec3 mat4::rollPitchYaw()
@@ -793,6 +962,21 @@ namespace atta
 	// Multiply matrices
 	mat3 mat3::operator*(const mat3 &o) const
 	{
+#ifdef ATTA_SIMD
+		// Rows are loaded with 3 floats (mat3 is not padded)
+		mat3 result;
+		const simd::float4 o0 = simd::load3(o.data);
+		const simd::float4 o1 = simd::load3(o.data+3);
+		const simd::float4 o2 = simd::load3(o.data+6);
+		for(int i=0; i<9; i+=3)
+		{
+			simd::float4 res = simd::mul(simd::splat(data[i]), o0);
+			res = simd::madd(simd::splat(data[i+1]), o1, res);
+			res = simd::madd(simd::splat(data[i+2]), o2, res);
+			simd::store3(result.data+i, res);
+		}
+		return result;
+#else
 		return mat3(
 			data[0]*o.data[0] + data[1]*o.data[3] + data[2]*o.data[6],
 			data[0]*o.data[1] + data[1]*o.data[4] + data[2]*o.data[7],
@@ -806,6 +990,7 @@ namespace atta
 			data[6]*o.data[1] + data[7]*o.data[4] + data[8]*o.data[7],
 			data[6]*o.data[2] + data[7]*o.data[5] + data[8]*o.data[8]
 			);
+#endif
 	}
 
     mat3 mat3::operator()(const mat3 &o) const
@@ -815,17 +1000,7 @@ namespace atta
 
 	void mat3::operator*=(const mat3 &o)
 	{
-		data[0] = data[0]*o.data[0] + data[1]*o.data[3] + data[2]*o.data[6];
-		data[1] = data[0]*o.data[1] + data[1]*o.data[4] + data[2]*o.data[7];
-		data[2] = data[0]*o.data[2] + data[1]*o.data[5] + data[2]*o.data[8];
-
-		data[3] = data[3]*o.data[0] + data[4]*o.data[3] + data[5]*o.data[6];
-		data[4] = data[3]*o.data[1] + data[4]*o.data[4] + data[5]*o.data[7];
-		data[5] = data[3]*o.data[2] + data[4]*o.data[5] + data[5]*o.data[8];
-
-		data[6] = data[6]*o.data[0] + data[7]*o.data[3] + data[8]*o.data[6];
-		data[7] = data[6]*o.data[1] + data[7]*o.data[4] + data[8]*o.data[7];
-		data[8] = data[6]*o.data[2] + data[7]*o.data[5] + data[8]*o.data[8];
+		*this = (*this)*o;
 	}
 
 	// Multiply matrix with scalar
@@ -19,10 +19,10 @@ namespace atta
 			.meshName = "atta::box",
 			.material = info.material
 		};
-		_model = std::make_shared<Model>(modelInfo);
+		_model = makePooled<Model>(modelInfo);
 
 		//----- Physics -----//
-		_bodyPhysics->addShape(std::make_shared<phy::BoxShape>(vec3(), quat(), vec3(1,1,1)));
+		_bodyPhysics->addShape(makePooled<phy::BoxShape>(vec3(), quat(), vec3(1,1,1)));
 	}
 
 	Box::~Box()
@@ -20,10 +20,10 @@ namespace atta
 			.material = info.material
 		};
 
-		_model = std::make_shared<Model>(modelInfo);
+		_model = makePooled<Model>(modelInfo);
 
 		//----- Physics -----//
-		_bodyPhysics->addShape(std::make_shared<phy::CylinderShape>(vec3(), quat(), _scale));
+		_bodyPhysics->addShape(makePooled<phy::CylinderShape>(vec3(), quat(), _scale));
 	}
 
 	Cylinder::~Cylinder()
@@ -27,8 +27,8 @@ namespace atta
 			.material = info.material
 		};
 
-		_model = std::make_shared<Model>(modelInfo);
-		_bodyPhysics->addShape(std::make_shared<phy::HalfSpaceShape>(normal, info.offset));
+		_model = makePooled<Model>(modelInfo);
+		_bodyPhysics->addShape(makePooled<phy::HalfSpaceShape>(normal, info.offset));
 	}
 
 	HalfSpace::~HalfSpace()
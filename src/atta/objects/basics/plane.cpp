@@ -20,10 +20,10 @@ namespace atta
 			.material = info.material
 		};
 
-		_model = std::make_shared<Model>(modelInfo);
+		_model = makePooled<Model>(modelInfo);
 
 		//----- Physics -----//
-		_bodyPhysics->addShape(std::make_shared<phy::PlaneShape>(vec3(), quat(), info.size));
+		_bodyPhysics->addShape(makePooled<phy::PlaneShape>(vec3(), quat(), info.size));
 	}
 
 	Plane::~Plane()
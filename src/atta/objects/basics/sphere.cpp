@@ -19,8 +19,8 @@ namespace atta
 			.material = info.material
 		};
 
-		_model = std::make_shared<Model>(modelInfo);
-		_bodyPhysics->addShape(std::make_shared<phy::SphereShape>(vec3(), quat(), 1.0));
+		_model = makePooled<Model>(modelInfo);
+		_bodyPhysics->addShape(makePooled<phy::SphereShape>(vec3(), quat(), 1.0));
 	}
 
 	Sphere::~Sphere()
@@ -5,6 +5,7 @@
 // By Breno Cunha Queiroz
 //--------------------------------------------------
 #include <atta/objects/object.h>
+#include <atta/core/transformSystem.h>
 #include <iostream>
 
 namespace atta
@@ -14,6 +15,7 @@ namespace atta
 	Object::Object(CreateInfo info):
 		_type("Object"), _name(info.name), 
 		_isLight(false),
+		_transformDirty(true), _transformSystem(nullptr), _transformIndex(0),
 		_selection(ObjectSelection::UNSELECTED),
 		_parent(nullptr)
 	{
@@ -22,7 +24,7 @@ namespace atta
 		_orientation = atta::eulerToQuat(info.rotation);
 		_scale = info.scale;
 
-		_bodyPhysics = std::make_shared<phy::Body>(&_position, &_orientation, info.mass);
+		_bodyPhysics = makePooled<phy::Body>(&_position, &_orientation, info.mass, &_transformDirty);
 
 		for(auto child : info.children)
 		{
@@ -37,6 +39,13 @@ namespace atta
 
 	mat4 Object::getModelMat() const
 	{
+		// The cached world matrix is only valid if this object and its ancestors did not change after the last update
+		bool dirty = false;
+		for(const Object* object = this; object != nullptr && !dirty; object = object->_parent)
+			dirty = object->_transformDirty;
+		if(_transformSystem != nullptr && !dirty)
+			return _transformSystem->getWorldMat(_transformIndex);
+
 		mat4 res = mat4(1);
 		res.setPosOriScale(_position, _orientation, _scale);
 
@@ -27,7 +27,7 @@ namespace atta
 					}),
 		};
 		if(info.createModel)
-			_model = std::make_shared<Model>(modelInfo);
+			_model = makePooled<Model>(modelInfo);
 
 		//----- Physics -----//
 		_bodyPhysics = nullptr;
@@ -7,6 +7,7 @@
 #include <atta/parallel/threadManager.h>
 #include <atta/helpers/log.h>
 #include <atta/helpers/drawer.h>
+#include <atta/helpers/profiler.h>
 #include <atta/graphics/renderers/rastRenderer/rastRenderer.h>
 #include <atta/graphics/renderers/rayTracing/rayTracingVulkan/rayTracing.h>
 //#include "simulator/graphics/renderers/rayTracing/rayTracingVulkan/rayTracing.h"
@@ -36,6 +37,26 @@ namespace atta
 		_scene = pipelineSetup.generalConfig.scene;
 		_dimensionMode = pipelineSetup.generalConfig.dimensionMode;
 		_vkCore = pipelineSetup.generalConfig.vkCore;
+		_deterministic = pipelineSetup.generalConfig.deterministic;
+		_fixedDt = pipelineSetup.generalConfig.fixedDt;
+		_step = 0;
+		_stateHash = 0;
+		if(_deterministic && !pipelineSetup.generalConfig.stateHashFile.empty())
+		{
+			_stateHashFile.open(pipelineSetup.generalConfig.stateHashFile);
+			if(!_stateHashFile.is_open())
+				Log::warning("ThreadManager", "Could not create state hash file [w]$0[]", pipelineSetup.generalConfig.stateHashFile);
+		}
+		if(_deterministic)
+			Log::verbose("ThreadManager", "Deterministic mode (dt=$0, seed=$1)", _fixedDt, _scene->getSeed());
+		if(pipelineSetup.generalConfig.stateStreamPort != 0)
+		{
+			StateStreamer::CreateInfo streamerInfo;
+			streamerInfo.port = pipelineSetup.generalConfig.stateStreamPort;
+			_stateStreamer = std::make_unique<StateStreamer>(streamerInfo);
+			Log::verbose("ThreadManager", "Streaming state on port $0", streamerInfo.port);
+		}
+		_sharedMemoryName = pipelineSetup.generalConfig.sharedMemoryName;
 
 		//---------- Physics stage ----------//
 		_physicsEngine = pipelineSetup.physicsStage.physicsEngine;
@@ -48,6 +69,7 @@ namespace atta
 
 		//---------- Robot stage ----------//
 		_robotProcessing = pipelineSetup.robotStage.robotProcessing;
+		_robotDt = 0;
 		_runAfterRobots = pipelineSetup.robotStage.runAfterRobots;
 
 		//---------- UI config ----------//
@@ -98,11 +120,14 @@ namespace atta
 			.setupStageBarrier = _setupStageBarrier,
 			.physicsStageBarrier = _physicsStageBarrier,
 			.sensorStageBarrier = _sensorStageBarrier,
-			.robotStageBarrier = _robotStageBarrier
+			.robotStageBarrier = _robotStageBarrier,
+			.index = 1,
+			.runRobotStage = [this](unsigned index){ runRobots(index); }
 		};
 
 		for(unsigned i = 0; i < _qtyWorkersToCreate-1; i++)
 		{
+			info.index = i+1;
 			_workersGen.push_back(std::make_shared<WorkerGeneralist>(info));
 			_threads.push_back(std::thread(std::ref(*_workersGen[i])));
 		}
@@ -143,11 +168,11 @@ namespace atta
 
 	void ThreadManager::createRenderingObjects()
 	{
-		for(auto& object : _scene->getObjectsFlat())
+		for(Object* object : _scene->getRegistry().getSensors().getObjects())
 		{
 			if(object->getType() == "Camera")
 			{
-				std::shared_ptr<Camera> camera = std::static_pointer_cast<Camera>(object);
+				Camera* camera = static_cast<Camera*>(object);
 
 				// Create rasterization render
 				RastRenderer::CreateInfo rastRendInfo = {
@@ -161,14 +186,83 @@ namespace atta
 				};
 				std::shared_ptr<RastRenderer> rast = std::make_shared<RastRenderer>(rastRendInfo);
 				_cameraRenderers.push_back(std::static_pointer_cast<Renderer>(rast));
+				_cameraSnapshots.push_back(_cameras.size());
 				_cameras.push_back(camera);
 			}
 		}
+
+		// One snapshot per camera (RGBA)
+		if(!_sharedMemoryName.empty() && !_cameras.empty())
+		{
+			ShmServer::CreateInfo shmInfo;
+			shmInfo.name = _sharedMemoryName;
+			shmInfo.qtySnapshots = _cameras.size();
+			shmInfo.snapshotCapacity = 0;
+			for(Camera* camera : _cameras)
+				shmInfo.snapshotCapacity = std::max<size_t>(shmInfo.snapshotCapacity, camera->getWidth()*camera->getHeight()*4);
+			_shmServer = std::make_unique<ShmServer>(shmInfo);
+			if(!_shmServer->getValid())
+				_shmServer.reset();
+		}
+	}
+
+	void ThreadManager::applySceneChanges()
+	{
+		// The GUI thread reads the scene while recording its command buffers
+		std::lock_guard<std::mutex> lock(_scene->getMutex());
+		Scene::Changes changes = _scene->applyChanges();
+		if(changes.empty())
+			return;
+
+		if(_physicsEngine != nullptr)
+		{
+			for(auto& object : changes.despawnedRoots)
+				_physicsEngine->removeObject(object.get());
+			for(auto& object : changes.spawnedRoots)
+				_physicsEngine->addObject(object);
+		}
+
+		// Camera renderers are only created at start
+		for(auto& object : changes.despawned)
+			for(size_t i=0; i<_cameras.size(); i++)
+				if(_cameras[i] == object.get())
+				{
+					_cameras.erase(_cameras.begin()+i);
+					_cameraRenderers.erase(_cameraRenderers.begin()+i);
+					_cameraSnapshots.erase(_cameraSnapshots.begin()+i);
+					break;
+				}
+		for(auto& object : changes.spawned)
+			if(object->getType() == "Camera")
+				Log::warning("ThreadManager", "Camera [w]$0[] spawned at runtime will not be rendered", object->getName());
+
+		_vkCore->updateBuffers(changes, _commandPool);
+		Log::verbose("ThreadManager", "Scene changed: $0 objects spawned, $1 objects despawned", changes.spawned.size(), changes.despawned.size());
+	}
+
+	void ThreadManager::runRobots(unsigned threadIndex)
+	{
+		// Also called by the workers when the pipeline is finishing
+		if(_robotProcessing != ROBOT_PROCESSING_PARALLEL_CPU || _shouldFinish)
+			return;
+
+		// Fixed assignment, each robot only uses its objects and its random stream, so the result does not depend on
+		// the quantity of threads or on the scheduling
+		ATTA_PROFILE_ZONE("Robots (parallel)");
+		const std::vector<std::shared_ptr<Robot>>& robots = _scene->getRobots();
+		const unsigned qtyThreads = _workersGen.size()+1;
+		for(size_t i=threadIndex; i<robots.size(); i+=qtyThreads)
+		{
+			Scene::setRequestOrder(i+1);
+			robots[i]->run(_robotDt);
+		}
+		Scene::setRequestOrder(0);
 	}
 
 	void ThreadManager::run()
 	{
 		//------------------------- Setup -----------------------//
+		ATTA_PROFILE_THREAD("Main");
 		_setupStageBarrier->wait();
 
 		//-------------------- Pipeline stages ------------------//
@@ -176,61 +270,120 @@ namespace atta
 		auto currTime = std::chrono::high_resolution_clock::now();
 		while(!_shouldFinish)
 		{
+			ATTA_PROFILE_ZONE("Frame");
 			currTime = std::chrono::high_resolution_clock::now();
 			auto start = std::chrono::time_point_cast<std::chrono::microseconds>(lastTime).time_since_epoch().count();
 			auto end = std::chrono::time_point_cast<std::chrono::microseconds>(currTime).time_since_epoch().count();
 			float dt = (end-start)/1000000.0;
 			//dt/=20;
 			lastTime = currTime;
+			// Same steps independently of the frame time
+			if(_deterministic)
+				dt = _fixedDt;
+			_robotDt = dt;
+
+			{
+				ATTA_PROFILE_ZONE("Scene changes");
+				applySceneChanges();
+			}
 
 			//-------------------- Physics ----------------------//
 			if(_physicsEngine != nullptr)
+			{
+				ATTA_PROFILE_ZONE("Physics");
 				_physicsEngine->stepPhysics(dt);
+			}
+
+			{
+				// World matrices used by the sensors, the robots and the GUI in this frame
+				ATTA_PROFILE_ZONE("Transforms");
+				_scene->updateTransforms();
+			}
 
 			_physicsStageBarrier->wait();
 			//-------------------- Sensor --------------------//
 			{
+				ATTA_PROFILE_ZONE("Sensors");
 				// Update camera renderers view matrix
 				for(int i=0;i<_cameraRenderers.size();i++)
 					_cameraRenderers[i]->updateCameraMatrix(atta::inverse(_cameras[i]->getModelMat()));
 
 				// Render images
-				VkCommandBuffer commandBuffer = _commandPool->beginSingleTimeCommands();
 				{
-					for(int i=0;i<_cameraRenderers.size();i++)
-						_cameraRenderers[i]->render(commandBuffer);
+					ATTA_PROFILE_ZONE("Sensor render");
+					VkCommandBuffer commandBuffer = _commandPool->beginSingleTimeCommands();
+					{
+						for(int i=0;i<_cameraRenderers.size();i++)
+							_cameraRenderers[i]->render(commandBuffer);
+					}
+					_commandPool->endSingleTimeCommands(commandBuffer);
 				}
-				_commandPool->endSingleTimeCommands(commandBuffer);
 				// Copy image to buffer
-				for(int i=0;i<_cameras.size();i++)
 				{
-					auto buffer = _cameraRenderers[i]->getImage()->getBuffer(_commandPool);
-					_cameras[i]->setBuffer(buffer);
+					ATTA_PROFILE_ZONE("Sensor readback");
+					for(int i=0;i<_cameras.size();i++)
+					{
+						auto buffer = _cameraRenderers[i]->getImage()->getBuffer(_commandPool);
+						if(_shmServer)
+							_shmServer->publishSnapshot(_cameraSnapshots[i], buffer);
+						_cameras[i]->setBuffer(buffer);
+					}
 				}
 			}
 
 			_sensorStageBarrier->wait();
 			//--------------------- Robots ----------------------//
-			Drawer::updateBufferMemory(_vkCore, _commandPool);// Send drawer data to GPU
-			//Drawer::clear();// Clear drawer data to receive new lines/points
+			{
+				ATTA_PROFILE_ZONE("Robots");
+				switch(_robotProcessing)
+				{
+					case ROBOT_PROCESSING_SEQUENTIAL:
+					{
+						// Same request order as the parallel processing
+						const std::vector<std::shared_ptr<Robot>>& robots = _scene->getRobots();
+						for(size_t i=0; i<robots.size(); i++)
+						{
+							Scene::setRequestOrder(i+1);
+							robots[i]->run(dt);
+						}
+						Scene::setRequestOrder(0);
+						break;
+					}
+					case ROBOT_PROCESSING_PARALLEL_CPU:
+						// The workers run their robots after the sensor stage barrier
+						runRobots(0);
+						break;
+					case ROBOT_PROCESSING_PARALLEL_GPU:
+						break;
+				}
+			}
 
-			switch(_robotProcessing)
+			_robotStageBarrier->wait();
+
+			// Only after the barrier (the workers may be running robots before it)
 			{
-				case ROBOT_PROCESSING_SEQUENTIAL:
-					for(auto robot : _scene->getRobots())
-						robot->run(dt);
-					break;
-				case ROBOT_PROCESSING_PARALLEL_CPU:
-					// Populate work to the threads
-					break;
-				case ROBOT_PROCESSING_PARALLEL_GPU:
-					break;
+				ATTA_PROFILE_ZONE("Drawer upload");
+				Drawer::updateBufferMemory(_vkCore, _commandPool);// Send drawer data to GPU
 			}
+			//Drawer::clear();// Clear drawer data to receive new lines/points
 
 			if(_runAfterRobots)
 				_runAfterRobots();
 
-			_robotStageBarrier->wait();
+			if(_deterministic)
+			{
+				_stateHash = _scene->computeStateHash();
+				_step++;
+				if(_stateHashFile.is_open())
+					_stateHashFile << _step << " " << std::hex << _stateHash << std::dec << "\n";
+			}
+
+			// Only copies the state, encoding and sending happen in the streamer thread
+			if(_stateStreamer)
+			{
+				ATTA_PROFILE_ZONE("State stream");
+				_stateStreamer->publish(_scene->getObjectsFlat());
+			}
 
 			if(_workerGui->getShouldFinish())
 				_shouldFinish = true;
@@ -7,6 +7,7 @@
 #include <atta/parallel/workerGeneralist.h>
 #include <iostream>
 #include <atta/helpers/log.h>
+#include <atta/helpers/profiler.h>
 
 namespace atta
 {
@@ -14,7 +15,8 @@ namespace atta
 		_setupStageBarrier(createInfo.setupStageBarrier),
 		_physicsStageBarrier(createInfo.physicsStageBarrier),
 		_sensorStageBarrier(createInfo.sensorStageBarrier),
-		_robotStageBarrier(createInfo.robotStageBarrier)
+		_robotStageBarrier(createInfo.robotStageBarrier),
+		_index(createInfo.index), _runRobotStage(createInfo.runRobotStage)
 	{
 
 	}
@@ -26,6 +28,7 @@ namespace atta
 
 	void WorkerGeneralist::operator()()
 	{
+		ATTA_PROFILE_THREAD("Worker");
 		//std::cout << "Setup\n";
 		_setupStageBarrier->wait();
 
@@ -36,6 +39,8 @@ namespace atta
 			//std::cout << "Sensor\n";
 			_sensorStageBarrier->wait();
 			//std::cout << "Robot\n";
+			if(_runRobotStage)
+				_runRobotStage(_index);
 			_robotStageBarrier->wait();
 			//std::cout << "Evaluate\n";
 		}
@@ -9,6 +9,7 @@
 #include <atta/helpers/log.h>
 #include <atta/helpers/drawer.h>
 #include <atta/helpers/evaluator.h>
+#include <atta/helpers/profiler.h>
 #include <atta/graphics/vulkan/imageMemoryBarrier.h>
 #include <atta/graphics/renderers/rastRenderer/rastRenderer.h>
 #include <atta/graphics/renderers/rayTracing/rayTracingVulkan/rayTracing.h>
@@ -79,6 +80,7 @@ namespace atta
 
 	void WorkerGui::operator()()
 	{
+		ATTA_PROFILE_THREAD("GUI");
 		while(!_window->shouldClose() && !_shouldFinish && !_ui->shouldClose())
 		{
 			if(_runBeforeWorkerGuiRender)
@@ -154,7 +156,7 @@ namespace atta
 
 	void WorkerGui::render()
 	{
-		//LocalEvaluator eval("time per frame");
+		ATTA_PROFILE_ZONE("GUI render");
 
 		uint32_t imageIndex;
 		VkResult result = vkAcquireNextImageKHR(_vkCore->getDevice()->handle(), _swapChain->handle(), 
@@ -196,6 +198,8 @@ namespace atta
 		//---------- Record to command buffer ----------//
 		VkCommandBuffer commandBuffer = _commandBuffers->begin(imageIndex);
 		{
+			// Objects may be spawned/despawned by the thread manager
+			std::lock_guard<std::mutex> lock(_scene->getMutex());
 			recordCommands(commandBuffer, imageIndex);
 		}
 		_commandBuffers->end(imageIndex);
@@ -230,10 +234,14 @@ namespace atta
 			}
 		}
 
-		if(vkQueueSubmit(_vkCore->getDevice()->getGraphicsQueueGUI(), 1, &submitInfo, _inFlightFences[_currentFrame]->handle()) != VK_SUCCESS)
 		{
-			Log::error("WorkerGui", "Failed to submit draw command buffer!");
-			exit(1);
+			// The texture streamer submits its upload batches around the GUI batches with this mutex held
+			std::lock_guard<std::recursive_mutex> lock(_vkCore->getDevice()->getQueueMutex(_vkCore->getDevice()->getGraphicsQueueGUI()));
+			if(vkQueueSubmit(_vkCore->getDevice()->getGraphicsQueueGUI(), 1, &submitInfo, _inFlightFences[_currentFrame]->handle()) != VK_SUCCESS)
+			{
+				Log::error("WorkerGui", "Failed to submit draw command buffer!");
+				exit(1);
+			}
 		}
 
 		for(auto texture : Texture::textureInfos())
@@ -254,7 +262,10 @@ namespace atta
 		presentInfo.pSwapchains = swapChains;
 		presentInfo.pImageIndices = &imageIndex;
 
-		result = vkQueuePresentKHR(_vkCore->getDevice()->getPresentQueueGUI(), &presentInfo);
+		{
+			std::lock_guard<std::recursive_mutex> lock(_vkCore->getDevice()->getQueueMutex(_vkCore->getDevice()->getPresentQueueGUI()));
+			result = vkQueuePresentKHR(_vkCore->getDevice()->getPresentQueueGUI(), &presentInfo);
+		}
 		if(result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
 		{
 			// TODO update frameBufferResized variable
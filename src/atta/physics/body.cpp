@@ -9,9 +9,10 @@
 
 namespace atta::phy
 {
-	Body::Body(vec3* position, quat* orientation, float mass):
+	Body::Body(vec3* position, quat* orientation, float mass, bool* transformDirty):
 		_position(position), _orientation(orientation), 
-		_isAwake(mass>0), _canSleep(true), _motion(mass>0?2*phy::sleepEpsilon:0)
+		_isAwake(mass>0), _canSleep(true), _motion(mass>0?2*phy::sleepEpsilon:0),
+		_transformDirty(transformDirty)
 	{
 		if(mass > 0)
 			_inverseMass = 1.0f/mass;
@@ -20,6 +21,7 @@ namespace atta::phy
 
 		_damping = 0.95;
 		_angularDamping = 0.8;
+		_lastDt = -1;
 		_velocity = vec3(0,0,0);
 		_acceleration = vec3(0,0,0);
 		clearAccumulators();
@@ -87,6 +89,16 @@ namespace atta::phy
 	{
     	if(!_isAwake) return;
 
+		integrateVelocities(dt);
+
+		// Update angular position (the physics engine uses the batch kernel for all bodies)
+		*_orientation += _rotation*dt; 
+
+		finishIntegration();
+	}
+
+	void Body::integrateVelocities(float dt)
+	{
     	//----- Calculate accelerations -----//
     	// Calculate linear acceleration from force inputs.
 		_lastFrameAcceleration = _acceleration;
@@ -95,21 +107,32 @@ namespace atta::phy
 		// Calculate angular acceleration from torque inputs.
 		vec3 angularAcceleration = _inverseInertiaTensorWorld.transform(_torqueAccum);
 
+		// The step is almost always the same, powf is only called when it changes
+		if(dt != _lastDt)
+		{
+			_lastDt = dt;
+			_dampingDt = powf(_damping, dt);
+			_angularDampingDt = powf(_angularDamping, dt);
+			_motionBiasDt = powf(0.5, dt);
+		}
+
     	//----- Adjust velocities -----//
 		// Update linear velocity
 		_velocity += _lastFrameAcceleration*dt;
-		_velocity *= powf(_damping, dt);
+		_velocity *= _dampingDt;
 
 		// Update angular velocity
 		_rotation += angularAcceleration*dt;
-		_rotation *= powf(_angularDamping, dt);
+		_rotation *= _angularDampingDt;
 
     	//----- Adjust positions -----//
 		// Update linear position
 		*_position += _velocity*dt;
+	}
 
-		// Update angular position
-		*_orientation += _rotation*dt; 
+	void Body::finishIntegration()
+	{
+		markTransformDirty();
 
 		calculateDerivedData();
 		clearAccumulators();
@@ -120,7 +143,7 @@ namespace atta::phy
 		{
 			float currentMotion = dot(_velocity, _velocity) + dot(_rotation, _rotation);
 
-			float bias = powf(0.5, dt);
+			float bias = _motionBiasDt;
 			_motion = bias*_motion + (1-bias)*currentMotion;
 
 			if (_motion < phy::sleepEpsilon) setIsAwake(false);
@@ -158,72 +181,13 @@ namespace atta::phy
 
 	void Body::calculateTransformMatrix()
 	{
-		_transformMatrix.data[0] = 1-2*(*_orientation).j*(*_orientation).j-
-			2*(*_orientation).k*(*_orientation).k;
-		_transformMatrix.data[1] = 2*(*_orientation).i*(*_orientation).j -
-			2*(*_orientation).r*(*_orientation).k;
-		_transformMatrix.data[2] = 2*(*_orientation).i*(*_orientation).k +
-			2*(*_orientation).r*(*_orientation).j;
-		_transformMatrix.data[3] = _position->x;
-
-		_transformMatrix.data[4] = 2*(*_orientation).i*(*_orientation).j +
-			2*(*_orientation).r*(*_orientation).k;
-		_transformMatrix.data[5] = 1-2*(*_orientation).i*(*_orientation).i-
-			2*(*_orientation).k*(*_orientation).k;
-		_transformMatrix.data[6] = 2*(*_orientation).j*(*_orientation).k -
-			2*(*_orientation).r*(*_orientation).i;
-		_transformMatrix.data[7] = _position->y;
-
-		_transformMatrix.data[8] = 2*(*_orientation).i*(*_orientation).k -
-			2*(*_orientation).r*(*_orientation).j;
-		_transformMatrix.data[9] = 2*(*_orientation).j*(*_orientation).k +
-			2*(*_orientation).r*(*_orientation).i;
-		_transformMatrix.data[10] = 1-2*(*_orientation).i*(*_orientation).i-
-			2*(*_orientation).j*(*_orientation).j;
-		_transformMatrix.data[11] = _position->z;
+		_transformMatrix.setPosOri(*_position, *_orientation);
 	}
 
 	void Body::transformInertiaTensor()
 	{
 		// Calculate the inertia tensor in world coordinates
-		float t4 = _transformMatrix.data[0]*_inverseInertiaTensor.data[0] + 
-			_transformMatrix.data[1]*_inverseInertiaTensor.data[3] + 
-			_transformMatrix.data[2]*_inverseInertiaTensor.data[6];
-		float t9 = _transformMatrix.data[0]*_inverseInertiaTensor.data[1] + 
-			_transformMatrix.data[1]*_inverseInertiaTensor.data[4] + 
-			_transformMatrix.data[2]*_inverseInertiaTensor.data[7];
-		float t14 = _transformMatrix.data[0]*_inverseInertiaTensor.data[2] + 
-			_transformMatrix.data[1]*_inverseInertiaTensor.data[5] + 
-			_transformMatrix.data[2]*_inverseInertiaTensor.data[8];
-		float t28 = _transformMatrix.data[4]*_inverseInertiaTensor.data[0] + 
-			_transformMatrix.data[5]*_inverseInertiaTensor.data[3] + 
-			_transformMatrix.data[6]*_inverseInertiaTensor.data[6];
-		float t33 = _transformMatrix.data[4]*_inverseInertiaTensor.data[1] + 
-			_transformMatrix.data[5]*_inverseInertiaTensor.data[4] + 
-			_transformMatrix.data[6]*_inverseInertiaTensor.data[7];
-		float t38 = _transformMatrix.data[4]*_inverseInertiaTensor.data[2] + 
-			_transformMatrix.data[5]*_inverseInertiaTensor.data[5] + 
-			_transformMatrix.data[6]*_inverseInertiaTensor.data[8];
-		float t52 = _transformMatrix.data[8]*_inverseInertiaTensor.data[0] + 
-			_transformMatrix.data[9]*_inverseInertiaTensor.data[3] + 
-			_transformMatrix.data[10]*_inverseInertiaTensor.data[6];
-		float t57 = _transformMatrix.data[8]*_inverseInertiaTensor.data[1] + 
-			_transformMatrix.data[9]*_inverseInertiaTensor.data[4] + 
-			_transformMatrix.data[10]*_inverseInertiaTensor.data[7];
-		float t62 = _transformMatrix.data[8]*_inverseInertiaTensor.data[2] + 
-			_transformMatrix.data[9]*_inverseInertiaTensor.data[5] + 
-			_transformMatrix.data[10]*_inverseInertiaTensor.data[8];
-
-		_inverseInertiaTensorWorld.data[0] = t4*_transformMatrix.data[0] + t9*_transformMatrix.data[1] + t14*_transformMatrix.data[2];
-		_inverseInertiaTensorWorld.data[1] = t4*_transformMatrix.data[4] + t9*_transformMatrix.data[5] + t14*_transformMatrix.data[6];
-		_inverseInertiaTensorWorld.data[2] = t4*_transformMatrix.data[8] + t9*_transformMatrix.data[9] + t14*_transformMatrix.data[10];
-		_inverseInertiaTensorWorld.data[3] = t28*_transformMatrix.data[0] + t33*_transformMatrix.data[1] + t38*_transformMatrix.data[2];
-		_inverseInertiaTensorWorld.data[4] = t28*_transformMatrix.data[4] + t33*_transformMatrix.data[5] + t38*_transformMatrix.data[6];
-		_inverseInertiaTensorWorld.data[5] = t28*_transformMatrix.data[8] + t33*_transformMatrix.data[9] + t38*_transformMatrix.data[10];
-		_inverseInertiaTensorWorld.data[6] = t52*_transformMatrix.data[0] + t57*_transformMatrix.data[1] + t62*_transformMatrix.data[2];
-		_inverseInertiaTensorWorld.data[7] = t52*_transformMatrix.data[4] + t57*_transformMatrix.data[5] + t62*_transformMatrix.data[6];
-		_inverseInertiaTensorWorld.data[8] = t52*_transformMatrix.data[8] + t57*_transformMatrix.data[9] + t62*_transformMatrix.data[10];
-		//mat3 localToWorld = inverse(mat3(_transformMatrix));
-		//_inverseInertiaTensorWorld = transpose(localToWorld)*(_inverseInertiaTensor*localToWorld);
+		const mat3 rotation(_transformMatrix);
+		_inverseInertiaTensorWorld = rotation*_inverseInertiaTensor*transpose(rotation);
 	}
 }
@@ -69,7 +69,8 @@ namespace atta::phy
 				}
 			}
 			if(index == numContacts) break;
-			Log::debug("ContactResolver", "maxPen:$0", contacts[index].penetration);
+			if(Log::logLevel <= Log::LOG_LEVEL_VERBOSE)// Skip evaluating the arguments
+				Log::verbose("ContactResolver", "maxPen:$0", contacts[index].penetration);
 
 			// Match the awake state at the contact
 			contacts[index].matchAwakeState();
@@ -79,7 +80,8 @@ namespace atta::phy
 				linearChange,
 				angularChange,
 				max);
-			Log::debug("ContactResolver", "linChange:$0\tangChange:$1", linearChange[0].toString(), angularChange[0].toString());
+			if(Log::logLevel <= Log::LOG_LEVEL_VERBOSE)
+				Log::verbose("ContactResolver", "linChange:$0\tangChange:$1", linearChange[0].toString(), angularChange[0].toString());
 
 			//----- Update contacts for other bodies -----//
 			for(i = 0; i < numContacts; i++)
@@ -6,6 +6,7 @@
 //--------------------------------------------------
 #include <atta/physics/forces/forceGenerator.h>
 #include <iostream>
+#include <algorithm>
 
 namespace atta::phy
 {
@@ -29,6 +30,12 @@ namespace atta::phy
 
 	}
 
+	void ForceGenerator::removeBody(Body* object)
+	{
+		_registrations.erase(std::remove_if(_registrations.begin(), _registrations.end(),
+					[object](const ForceRegistration& r){ return r.object.get() == object; }), _registrations.end());
+	}
+
 	void ForceGenerator::clear()
 	{
 
@@ -6,72 +6,114 @@
 //--------------------------------------------------
 #include <atta/physics/physicsEngine.h>
 #include <atta/physics/forces/forces.h>
+#include <atta/helpers/profiler.h>
+#include <atta/math/batch.h>
 
 namespace atta::phy
 {
 	PhysicsEngine::PhysicsEngine(CreateInfo info):
-		_accelerator(info.accelerator)
+		_accelerator(info.accelerator), _scene(info.scene)
 	{
 		_forceGenerator = std::make_shared<ForceGenerator>();
 		_contactResolver = std::make_shared<ContactResolver>();
 		_contactGenerator = std::make_shared<ContactGenerator>();
+	}
+
+	PhysicsEngine::~PhysicsEngine()
+	{
 
-		// Get bodies from objects
-		for(auto object : _accelerator->getObjects())
+	}
+
+	void PhysicsEngine::addObject(std::shared_ptr<Object> object)
+	{
+		// The body was already added to the scene registry
+		_accelerator->addObject(object);
+	}
+
+	void PhysicsEngine::removeObject(Object* object)
+	{
+		_accelerator->removeObject(object);
+		if(object->getBodyPhysics() != nullptr)
+			_forceGenerator->removeBody(object->getBodyPhysics().get());
+	}
+
+	void PhysicsEngine::integrateBodies(float dt)
+	{
+		// The orientations of the awake bodies are gathered in chunks (structure of arrays) for the batch kernel
+		const size_t chunkSize = 64;
+		Body* bodies[chunkSize];
+		float orientation[4][chunkSize];
+		float rotation[3][chunkSize];
+		size_t qtyBodies = 0;
+		auto integrateOrientations = [&]()
 		{
-			if(object->isLight()) continue;
-			if(object->getBodyPhysics())
+			batch::integrateOrientations(qtyBodies, {orientation[0], orientation[1], orientation[2], orientation[3]},
+					{rotation[0], rotation[1], rotation[2]}, dt);
+			for(size_t c=0; c<qtyBodies; c++)
 			{
-				_bodies.push_back(object->getBodyPhysics());
+				bodies[c]->setOrientation(quat(orientation[0][c], orientation[1][c], orientation[2][c], orientation[3][c]));
+				bodies[c]->finishIntegration();
 			}
-		}
-	}
+			qtyBodies = 0;
+		};
 
-	PhysicsEngine::~PhysicsEngine()
-	{
+		for(Body* body : _scene->getRegistry().getBodies().getComponents())
+		{
+			body->addForce({0,-9.8,0});
+			if(!body->getIsAwake())
+				continue;
+			body->integrateVelocities(dt);
 
+			const quat q = body->getOrientation();
+			const vec3 w = body->getRotation();
+			for(int c=0; c<4; c++)
+				orientation[c][qtyBodies] = q.data[c];
+			rotation[0][qtyBodies] = w.x;
+			rotation[1][qtyBodies] = w.y;
+			rotation[2][qtyBodies] = w.z;
+			bodies[qtyBodies++] = body;
+			if(qtyBodies == chunkSize)
+				integrateOrientations();
+		}
+		integrateOrientations();
 	}
 
 	void PhysicsEngine::stepPhysics(float dt)
 	{
 		//---------- Move objects ----------//
-		_forceGenerator->updateForces(dt);
-		for(auto body : _bodies)
 		{
-			body->addForce({0,-9.8,0});
-			body->integrate(dt);
+			ATTA_PROFILE_ZONE("Physics integrate");
+			_forceGenerator->updateForces(dt);
+			integrateBodies(dt);
 		}
 		
-		//---------- Broad Phase ----------//
+		//---------- Broad Phase + Narrow Phase ----------//
 		// TODO After updating accelerator tree, get contacts from broadphase
 
-		// Simulating worst case
-		std::vector<std::pair<std::shared_ptr<Body>, std::shared_ptr<Body>>> possibleContacts;
-		unsigned size = _bodies.size();
-		for(unsigned i=0; i<size;i++)
+		// Simulating worst case (every pair is tested)
 		{
-			for(unsigned j=i+1; j<size;j++)
-			{
-				if(i!=j)
-				{
-					possibleContacts.push_back(std::make_pair(_bodies[i], _bodies[j]));
-				}
-			}
+			ATTA_PROFILE_ZONE("Physics narrow phase");
+			span<Body* const> bodies = _scene->getRegistry().getBodies().getComponents();
+			const size_t size = bodies.size();
+			ATTA_PROFILE_COUNTER("Physics possible contacts", size > 1 ? size*(size-1)/2 : 0);
+
+			_contactGenerator->clearContacts();
+			for(size_t i=0; i<size; i++)
+				for(size_t j=i+1; j<size; j++)
+					for(const auto& shape1 : bodies[i]->getShapes())
+						for(const auto& shape2 : bodies[j]->getShapes())
+							_contactGenerator->testContact(shape1, shape2);
+			ATTA_PROFILE_COUNTER("Physics contacts", _contactGenerator->qtyContacts());
 		}
-		//Log::debug("PhysicsEngine", "BroadPhase: $0", possibleContacts.size());
-
-		//---------- Narrow Phase ----------//
-		_contactGenerator->clearContacts();
-		for(auto contact : possibleContacts)
-			for(auto shape1 : contact.first->getShapes())
-				for(auto shape2 : contact.second->getShapes())
-					_contactGenerator->testContact(shape1, shape2);
 		//if(_contactGenerator->qtyContacts()>0)
 		//	Log::debug("PhysicsEngine", "Contacts: $0", _contactGenerator->getContacts());
 		
 		//---------- Resolve contacts ----------//
-		if(_contactGenerator->qtyContacts()==2)
-			_contactResolver->resolveContacts(_contactGenerator->getContacts(), dt);
+		{
+			ATTA_PROFILE_ZONE("Physics resolve");
+			if(_contactGenerator->qtyContacts()==2)
+				_contactResolver->resolveContacts(_contactGenerator->getContacts(), dt);
+		}
 	}
 
 	//---------- Static functions ----------//
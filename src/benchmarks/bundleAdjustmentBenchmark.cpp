@@ -0,0 +1,82 @@
+//--------------------------------------------------
+// Atta Benchmarks
+// bundleAdjustmentBenchmark.cpp
+// Date: 2021-06-05
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/algorithms/cv/bundleAdjustment/bundleAdjustment.h>
+#include <atta/helpers/log.h>
+#include <random>
+#include <cmath>
+
+using namespace atta;
+
+// Synthetic scene: cameras on a circle looking at a cloud of points around the origin
+// Poses and points are perturbed before the optimization, measurements have pixel noise
+cv::BundleAdjustment::Report runProblem(size_t qtyCameras, size_t qtyPoints)
+{
+	std::mt19937 gen(42);
+	std::normal_distribution<float> noise(0.0f, 1.0f);
+	std::uniform_real_distribution<float> cloud(-2.0f, 2.0f);
+	const float focal = 500.0f;
+	const float radius = 8.0f;
+
+	cv::BundleAdjustment::CreateInfo info;
+	info.focal = focal;
+	info.maxIterations = 10;
+	cv::BundleAdjustment ba(info);
+
+	std::vector<vec3> points(qtyPoints), noisyPoints(qtyPoints);
+	for(size_t i=0; i<qtyPoints; i++)
+	{
+		points[i] = vec3(cloud(gen), cloud(gen), cloud(gen));
+		noisyPoints[i] = points[i] + vec3(noise(gen), noise(gen), noise(gen))*0.05f;
+	}
+	ba.set3DPoints(noisyPoints);
+
+	for(size_t c=0; c<qtyCameras; c++)
+	{
+		// Rotation around y, camera at distance radius from the origin
+		const float theta = 2*M_PI*c/qtyCameras;
+		const float cs = cos(theta), sn = sin(theta);
+
+		std::vector<std::pair<size_t, vec2>> measurements;
+		measurements.reserve(qtyPoints);
+		for(size_t i=0; i<qtyPoints; i++)
+		{
+			const vec3& p = points[i];
+			const vec3 pc(cs*p.x+sn*p.z, p.y, -sn*p.x+cs*p.z+radius);
+			measurements.push_back({i, vec2(focal*pc.x/pc.z+0.5f*noise(gen), focal*pc.y/pc.z+0.5f*noise(gen))});
+		}
+
+		vec pose(6);
+		pose[1] = theta;
+		pose[5] = radius;
+		if(c > 0)// First camera fixes the gauge
+		{
+			pose[1] += 0.01f*noise(gen);
+			pose[3] += 0.05f*noise(gen);
+			pose[4] += 0.05f*noise(gen);
+		}
+		ba.addImage(pose, measurements);
+	}
+
+	ba.run();
+	return ba.getReport();
+}
+
+int main()
+{
+	const std::vector<std::pair<size_t, size_t>> sizes = {
+		{10, 1000}, {20, 2000}, {50, 5000}, {100, 10000}, {200, 20000}
+	};
+
+	for(auto [qtyCameras, qtyPoints] : sizes)
+	{
+		cv::BundleAdjustment::Report report = runProblem(qtyCameras, qtyPoints);
+		Log::info("BundleAdjustmentBenchmark", "cameras: $0 points: $1 measurements: $2 -> $3 ms/iteration ($4 iterations, $5 pcg iterations, cost $6 -> $7)",
+				qtyCameras, qtyPoints, qtyCameras*qtyPoints, report.msPerIteration,
+				report.iterations, report.pcgIterations, report.initialCost, report.finalCost);
+	}
+	return 0;
+}
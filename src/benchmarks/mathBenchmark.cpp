@@ -0,0 +1,227 @@
+//--------------------------------------------------
+// Atta Benchmarks
+// mathBenchmark.cpp
+// Date: 2021-07-27
+// By Breno Cunha Queiroz
+//--------------------------------------------------
+#include <atta/math/math.h>
+#include <atta/math/batch.h>
+#include <atta/physics/body.h>
+#include <atta/objects/object.h>
+#include <atta/core/transformSystem.h>
+#include <atta/helpers/log.h>
+#include <chrono>
+#include <random>
+#include <functional>
+
+using namespace atta;
+
+// Build with -DATTA_SIMD=OFF to get the scalar numbers
+#if defined(ATTA_SIMD_SSE)
+const char* backend = "SSE";
+#elif defined(ATTA_SIMD_NEON)
+const char* backend = "NEON";
+#else
+const char* backend = "scalar";
+#endif
+
+const size_t qtyElements = 4096;
+const unsigned qtyRepetitions = 200;
+
+// Best time of qtyRepetitions runs (ns per element)
+double measure(std::function<void()> run)
+{
+	double best = 1e30;
+	for(unsigned r=0; r<qtyRepetitions; r++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		run();
+		auto end = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double, std::nano>(end-start).count()/qtyElements);
+	}
+	return best;
+}
+
+void report(const std::string& name, double ns)
+{
+	Log::info("MathBenchmark", "[$0] $1: $2 ns", backend, name, ns);
+}
+
+int main()
+{
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	auto randQuat = [&]() { quat q(dist(gen), dist(gen), dist(gen), dist(gen)); q.normalize(); return q; };
+	auto randVec3 = [&]() { return vec3(dist(gen), dist(gen), dist(gen)); };
+
+	std::vector<mat4> matA(qtyElements), matB(qtyElements), matRes(qtyElements);
+	std::vector<quat> quatA(qtyElements), quatB(qtyElements);
+	std::vector<vec4> vecA(qtyElements);
+	std::vector<vec3> vec3A(qtyElements);
+	for(size_t i=0; i<qtyElements; i++)
+	{
+		matA[i] = posOriScale(randVec3(), randQuat(), vec3(1.5f, 0.5f, 2.0f));
+		matB[i] = posOriScale(randVec3(), randQuat(), vec3(1.0f, 1.0f, 1.0f));
+		quatA[i] = randQuat();
+		quatB[i] = randQuat();
+		vecA[i] = vec4(dist(gen), dist(gen), dist(gen), dist(gen));
+		vec3A[i] = randVec3();
+	}
+
+	//---------- Types ----------//
+	report("mat4*mat4", measure([&]() {
+		for(size_t i=0; i<qtyElements; i++)
+			matRes[i] = matA[i]*matB[i];
+	}));
+	report("inverse(mat4)", measure([&]() {
+		for(size_t i=0; i<qtyElements; i++)
+			matRes[i] = inverse(matA[i]);
+	}));
+	report("mat4*vec4", measure([&]() {
+		for(size_t i=0; i<qtyElements; i++)
+			vecA[i] = matB[i]*vecA[i];
+	}));
+	report("quat*quat", measure([&]() {
+		for(size_t i=0; i<qtyElements; i++)
+			quatA[i] *= quatB[i];
+	}));
+	report("quat.normalize", measure([&]() {
+		for(size_t i=0; i<qtyElements; i++)
+			quatA[i].normalize();
+	}));
+	report("quat.rotate(vec3)", measure([&]() {
+		for(size_t i=0; i<qtyElements; i++)
+			vec3A[i] = quatB[i].rotate(vec3A[i]);
+	}));
+	report("vec4.normalize", measure([&]() {
+		for(size_t i=0; i<qtyElements; i++)
+			vecA[i].normalize();
+	}));
+
+	//---------- Body::integrate ----------//
+	std::vector<vec3> positions(qtyElements);
+	std::vector<quat> orientations(qtyElements);
+	std::vector<std::shared_ptr<phy::Body>> bodies;
+	for(size_t i=0; i<qtyElements; i++)
+	{
+		positions[i] = randVec3();
+		orientations[i] = randQuat();
+		bodies.push_back(std::make_shared<phy::Body>(&positions[i], &orientations[i], 1.0f));
+		bodies.back()->setVelocity(randVec3());
+	}
+	report("Body::integrate", measure([&]() {
+		for(auto& body : bodies)
+		{
+			body->addForceAtBodyPoint(vec3(0,-9.8,0), vec3(0.1f, 0.2f, 0.3f));
+			body->integrate(0.001f);
+		}
+	}));
+
+	//---------- Object::getModelMat ----------//
+	// Objects not in a scene (no transform system), the parent chain is multiplied every call
+	std::vector<std::shared_ptr<Object>> leaves;
+	std::vector<std::shared_ptr<Object>> roots;
+	for(size_t i=0; i<qtyElements; i++)
+	{
+		std::shared_ptr<Object> object;
+		for(int depth=0; depth<4; depth++)
+		{
+			Object::CreateInfo info;
+			info.position = randVec3();
+			info.rotation = randVec3();
+			if(object)
+				info.children = {object};
+			else
+				leaves.push_back(nullptr);
+			object = std::make_shared<Object>(info);
+			if(depth == 0)
+				leaves.back() = object;
+		}
+		roots.push_back(object);
+	}
+	report("Object::getModelMat (depth 4)", measure([&]() {
+		for(size_t i=0; i<qtyElements; i++)
+			matRes[i] = leaves[i]->getModelMat();
+	}));
+
+	//---------- Batch kernels ----------//
+	// Structure of arrays copies of the same data
+	std::vector<float> px(qtyElements), py(qtyElements), pz(qtyElements);
+	std::vector<float> qr(qtyElements), qi(qtyElements), qj(qtyElements), qk(qtyElements);
+	std::vector<float> sx(qtyElements, 1.5f), sy(qtyElements, 0.5f), sz(qtyElements, 2.0f);
+	std::vector<float> wx(qtyElements), wy(qtyElements), wz(qtyElements);
+	std::vector<int> parentIndices(qtyElements);
+	for(size_t i=0; i<qtyElements; i++)
+	{
+		px[i] = vec3A[i].x; py[i] = vec3A[i].y; pz[i] = vec3A[i].z;
+		qr[i] = quatA[i].r; qi[i] = quatA[i].i; qj[i] = quatA[i].j; qk[i] = quatA[i].k;
+		wx[i] = dist(gen); wy[i] = dist(gen); wz[i] = dist(gen);
+		parentIndices[i] = gen()%qtyElements;
+	}
+	batch::Vec3Arrays points = {px.data(), py.data(), pz.data()};
+	batch::QuatArrays quats = {qr.data(), qi.data(), qj.data(), qk.data()};
+	batch::Vec3Arrays scales = {sx.data(), sy.data(), sz.data()};
+	batch::Vec3Arrays angularVelocities = {wx.data(), wy.data(), wz.data()};
+
+	// Per element reference
+	report("loop posOriScale", measure([&]() {
+		for(size_t i=0; i<qtyElements; i++)
+			matRes[i] = posOriScale(vec3A[i], quatA[i], vec3(sx[i], sy[i], sz[i]));
+	}));
+	report("loop compose", measure([&]() {
+		for(size_t i=0; i<qtyElements; i++)
+			matRes[i] = matA[parentIndices[i]]*matB[i];
+	}));
+	report("loop transformPoints", measure([&]() {
+		for(size_t i=0; i<qtyElements; i++)
+			vec3A[i] = matB[i]*vec3A[i];
+	}));
+	report("loop integrateOrientations", measure([&]() {
+		for(size_t i=0; i<qtyElements; i++)
+		{
+			quatA[i] += vec3(wx[i], wy[i], wz[i])*0.001f;
+			quatA[i].normalize();
+		}
+	}));
+
+	// Transform system with all objects dirty (chains of depth 4)
+	TransformSystem transformSystem(roots);
+	std::vector<Object*> allObjects;
+	for(auto& leaf : leaves)
+		for(Object* object = leaf.get(); object; object = object->getParent())
+			allObjects.push_back(object);
+
+	for(int t=batch::TARGET_BASELINE; t<=batch::TARGET_AVX512; t++)
+	{
+		batch::Target target = static_cast<batch::Target>(t);
+		if(!batch::isTargetSupported(target))
+			continue;
+		batch::setTarget(target);
+		const std::string name = std::string(" (")+batch::getTargetName(target)+")";
+
+		report("batch posOriScale"+name, measure([&]() {
+			batch::posOriScale(qtyElements, points, quats, scales, matRes.data());
+		}));
+		report("batch compose"+name, measure([&]() {
+			batch::compose(qtyElements, matA.data(), parentIndices.data(), matB.data(), matRes.data());
+		}));
+		report("batch transformPoints"+name, measure([&]() {
+			batch::transformPoints(qtyElements, matB.data(), points);
+		}));
+		report("batch integrateOrientations"+name, measure([&]() {
+			batch::integrateOrientations(qtyElements, quats, angularVelocities, 0.001f);
+		}));
+		report("TransformSystem::update per object"+name, measure([&]() {
+			for(Object* object : allObjects)
+				object->setPosition(object->getPosition());
+			transformSystem.update();
+		})/4);
+	}
+
+	// Keep the results alive
+	float sink = 0;
+	for(size_t i=0; i<qtyElements; i++)
+		sink += matRes[i].data[0] + vecA[i].x + quatA[i].r + vec3A[i].x + positions[i].x + px[i] + qr[i];
+	Log::verbose("MathBenchmark", "Checksum $0", sink);
+	return 0;
+}
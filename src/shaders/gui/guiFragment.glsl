@@ -0,0 +1,71 @@
+// GUI fragment shader body, GUI_TEXTURE_INDEX must be defined by the including shader
+#include "guiStructs.glsl"
+
+layout(binding = 0) readonly uniform GuiUniformBufferObjectStruct { GuiUniformBufferObject ubo; };
+layout(binding = 1) uniform sampler2D[] textureSamplers;
+
+layout(location = 0) in vec4 inFragColor;
+layout(location = 1) in vec2 inFragPos;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) flat in vec4 inObjPosSize;// xy position, zw size
+layout(location = 4) flat in float inRadius;
+layout(location = 5) flat in int inIsLetter;
+layout(location = 6) flat in int inTextureIndex;
+
+layout(location = 0) out vec4 outColor;
+
+void main() 
+{
+	if(inIsLetter == 0)
+	{
+		// Convert coordinates to [ratio, 1]
+		vec2 fragPos = ((inFragPos+vec2(1,1))/2.0)*vec2(ubo.ratio,1.0);
+		vec4 color = inFragColor;
+		if(inTextureIndex != -1)
+			color *= vec4(texture(textureSamplers[GUI_TEXTURE_INDEX(inTextureIndex)], inTexCoord));
+		
+		vec2 objPos = inObjPosSize.xy*vec2(ubo.ratio,1.0);// [0,1][0,1] -> [0,ratio][0,1]
+		vec2 objHalfSize = inObjPosSize.zw*vec2(ubo.ratio,1.0)*0.5;// New coord size
+		vec2 objPosCenter = objPos+objHalfSize;
+
+		// Radius centers
+		vec2 topLeft 	 = 	objPosCenter + vec2(-objHalfSize.x, -objHalfSize.y)	+ vec2(inRadius,inRadius);
+		vec2 topRight 	 = 	objPosCenter + vec2(objHalfSize.x, -objHalfSize.y)	+ vec2(-inRadius,inRadius);
+		vec2 bottomLeft  = 	objPosCenter + vec2(-objHalfSize.x, objHalfSize.y)	+ vec2(inRadius,-inRadius);
+		vec2 bottomRight = 	objPosCenter + vec2(objHalfSize.x, objHalfSize.y)	+ vec2(-inRadius,-inRadius);
+
+		// Check distance to create round borders
+		if(fragPos.x > topRight.x && fragPos.y < topRight.y)
+		{
+			bool inside = length(fragPos-topRight)<inRadius;
+			if(!inside)
+				color.a = 0;
+		}
+		else if(fragPos.x > bottomRight.x && fragPos.y > bottomRight.y)
+		{
+			bool inside = length(fragPos-bottomRight)<inRadius;
+			if(!inside)
+				color.a = 0;
+		}
+		else if(fragPos.x < bottomLeft.x && fragPos.y > bottomLeft.y)
+		{
+			bool inside = length(fragPos-bottomLeft)<inRadius;
+			if(!inside)
+				color.a = 0;
+		}
+		else if(fragPos.x < topLeft.x && fragPos.y < topLeft.y)
+		{
+			bool inside = length(fragPos-topLeft)<inRadius;
+			if(!inside)
+				color.a = 0;
+		}
+		outColor = color;
+	}
+	else
+	{
+		// Is letter (signed distance field, the edge is at 0.5)
+		float dist = texture(textureSamplers[0], inTexCoord).r;
+		float width = max(fwidth(dist), 1e-4);
+		outColor = inFragColor*vec4(1,1,1,smoothstep(0.5-width, 0.5+width, dist));
+	}
+}
@@ -4,11 +4,24 @@
 #include "guiStructs.glsl"
 
 layout(binding = 0) readonly uniform GuiUniformBufferObjectStruct { GuiUniformBufferObject uniformBuffer; };
-layout(push_constant) uniform GuiObjectInfoStruct { GuiObjectInfo objectInfo; };
+
+// Quad instance data (GuiObjectInfo)
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec2 inSize;
+layout(location = 2) in vec4 inColor;
+layout(location = 3) in float inRadius;
+layout(location = 4) in int inIsLetter;
+layout(location = 5) in int inTextureIndex;
+layout(location = 6) in vec2 inOffsetLetter;
+layout(location = 7) in vec2 inSizeLetter;
 
 layout(location = 0) out vec4 outFragColor;
 layout(location = 1) out vec2 outFragPos;
 layout(location = 2) out vec2 outTexCoord;
+layout(location = 3) flat out vec4 outObjPosSize;// xy position, zw size
+layout(location = 4) flat out float outRadius;
+layout(location = 5) flat out int outIsLetter;
+layout(location = 6) flat out int outTextureIndex;
 
 vec2 positions[6] = vec2[](
     vec2(0.0, 0.0),
@@ -21,16 +34,20 @@ vec2 positions[6] = vec2[](
 
 void main() 
 {
-	vec2 objPos = objectInfo.position.xy*2-vec2(1.0,1.0);// [0,1] to [-1,1] (top left position)
-	vec2 objSize = objectInfo.size*2;// width from 1 to 2
+	vec2 objPos = inPosition.xy*2-vec2(1.0,1.0);// [0,1] to [-1,1] (top left position)
+	vec2 objSize = inSize*2;// width from 1 to 2
 	vec2 rectCorner = objPos+positions[gl_VertexIndex]*objSize;
-    gl_Position = vec4(rectCorner,objectInfo.position.z,1);
+    gl_Position = vec4(rectCorner,inPosition.z,1);
 
-    outFragColor = objectInfo.color;
+    outFragColor = inColor;
     outFragPos = rectCorner;
+	outObjPosSize = vec4(inPosition.xy, inSize);
+	outRadius = inRadius;
+	outIsLetter = inIsLetter;
+	outTextureIndex = inTextureIndex;
 
-	if(objectInfo.isLetter == 1)
-    	outTexCoord = objectInfo.offsetLetter+positions[gl_VertexIndex]*objectInfo.sizeLetter;
+	if(inIsLetter == 1)
+    	outTexCoord = inOffsetLetter+positions[gl_VertexIndex]*inSizeLetter;
 	else
     	outTexCoord = positions[gl_VertexIndex];
 }
@@ -0,0 +1,7 @@
+#version 460
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_nonuniform_qualifier : require
+// The GUI batch splits the draws by texture, so the texture index is dynamically uniform
+#define GUI_TEXTURE_INDEX(index) index
+#include "guiFragment.glsl"